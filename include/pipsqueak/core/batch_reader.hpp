@@ -0,0 +1,129 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef BATCH_READER_HPP
+#define BATCH_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pipsqueak::core {
+    /**
+     * @struct ReadRequest
+     * @brief One positional read: @c length bytes at @c offset of @c fd into @c destination.
+     */
+    struct ReadRequest {
+        int fd{-1};
+        std::uint64_t offset{0};
+        void* destination{nullptr};
+        size_t length{0};
+        std::uint64_t userData{0}; // Returned untouched in the matching ReadResult
+    };
+
+    /**
+     * @struct ReadResult
+     * @brief The completion of one ReadRequest.
+     */
+    struct ReadResult {
+        std::uint64_t userData{0};
+        std::int64_t result{0}; // Bytes read (short only at end of file), or -errno
+    };
+
+    /**
+     * @class BatchReader
+     * @brief Issues many file reads at once and reaps their completions in any order.
+     * @details On Linux the reader drives an io_uring instance through the raw system calls
+     *          (no liburing), so a whole batch of reads costs one submission call. Where
+     *          io_uring is unavailable (older kernels, seccomp, other platforms) it falls back
+     *          to a small pool of threads issuing pread(2). Both backends have the same
+     *          semantics, and at most @c Options::queueDepth reads are in flight.
+     *
+     *          An optional registered arena lets io_uring skip per-read page pinning: reads
+     *          whose destination lies inside @c arena() use fixed-buffer reads. The arena is
+     *          page aligned, so it also satisfies O_DIRECT alignment.
+     *
+     *          One thread submits and reaps at a time; the reader is not internally synchronised.
+     */
+    class BatchReader {
+    public:
+        enum class Backend { Auto, IoUring, ThreadPool };
+
+        struct Options {
+            Backend backend{Backend::Auto};
+            unsigned queueDepth{64};     ///< Maximum reads in flight
+            unsigned threads{4};         ///< ThreadPool backend workers
+            size_t arenaBytes{0};        ///< Size of the registered, page-aligned staging arena (0 = none)
+        };
+
+        explicit BatchReader(Options options);
+        BatchReader();
+        ~BatchReader();
+
+        BatchReader(const BatchReader&) = delete;
+        BatchReader& operator=(const BatchReader&) = delete;
+
+        /**
+         * @brief The backend actually in use (never Auto).
+         */
+        [[nodiscard]] Backend backend() const noexcept;
+
+        [[nodiscard]] unsigned queueDepth() const noexcept;
+
+        /**
+         * @brief Queues as many of @p requests as there is room for and submits them together.
+         * @return The number accepted (from the front of the array).
+         */
+        size_t submit(const ReadRequest* requests, size_t count);
+
+        /**
+         * @brief Collects completed reads.
+         * @param out Space for at least @p max results.
+         * @param wait Block until at least one read completes (if any are in flight).
+         * @return The number of results written.
+         */
+        size_t reap(ReadResult* out, size_t max, bool wait);
+
+        /**
+         * @brief The number of submitted reads not yet reaped.
+         */
+        [[nodiscard]] size_t inFlight() const noexcept;
+
+        /**
+         * @brief Submits every request and waits for all of them.
+         * @return One result per request, in completion order.
+         */
+        std::vector<ReadResult> readAll(const std::vector<ReadRequest>& requests);
+
+        /**
+         * @brief The registered staging arena, or nullptr if none was requested.
+         */
+        [[nodiscard]] void* arena() const noexcept;
+        [[nodiscard]] size_t arenaBytes() const noexcept;
+
+        /**
+         * @brief Opens a file for reading, with O_DIRECT if asked and supported by the filesystem.
+         * @return The descriptor, or -1.
+         */
+        static int openForRead(const std::string& path, bool direct);
+
+        /**
+         * @brief Closes a descriptor returned by @c openForRead().
+         */
+        static void close(int fd);
+
+        /// Alignment that satisfies O_DIRECT on common block devices.
+        static constexpr size_t kDirectAlignment = 4096;
+
+    private:
+        struct Impl;
+        struct UringImpl;
+        struct PoolImpl;
+        std::unique_ptr<Impl> impl_;
+    };
+}
+
+#endif //BATCH_READER_HPP
@@ -5,30 +5,379 @@
 #ifndef BUFFER_STORE_HPP
 #define BUFFER_STORE_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <shared_mutex>
+#include <vector>
 
 #include "audio_buffer.hpp"
+#include "memory_placement.hpp"
+#include "sample_analysis.hpp"
+#include "transient_analysis.hpp"
+#include "waveform_overview.hpp"
 
 namespace pipsqueak::core {
     class BufferStore {
     public:
+        /**
+         * @struct InsertOptions
+         * @brief Load-time work to perform when a buffer enters the store.
+         */
+        struct InsertOptions {
+            /// Precompute a TransientMap for pitch-preserving (time-stretch) playback.
+            bool analyzeTransients{false};
+
+            /// Compute SampleMetadata (peak, RMS, silence, ...) for the entry.
+            bool analyzeSample{false};
+
+            /// Run the sample analysis on the store's worker thread instead of inside insert().
+            bool analyzeInBackground{false};
+
+            SampleAnalysisOptions analysis{};
+
+            /// Previously computed metadata (e.g. from a bundle); attached as-is, skipping analysis.
+            std::shared_ptr<const SampleMetadata> metadata{};
+
+            /// Build a WaveformOverview pyramid for editors to draw the sample.
+            bool buildOverview{false};
+
+            WaveformOverviewOptions overviewOptions{};
+
+            /// An existing overview (e.g. one grown while recording); attached as-is.
+            std::shared_ptr<WaveformOverview> overview{};
+
+            /// Group the entry belongs to (e.g. its instrument), for @c tagged() and @c eraseTag(); empty for none.
+            std::string tag{};
+        };
+
+        /**
+         * @struct InsertItem
+         * @brief One buffer of a batch insert with its own options.
+         */
+        struct InsertItem {
+            std::shared_ptr<const AudioBuffer> buffer;
+            InsertOptions options;
+        };
+
+        /**
+         * @struct Usage
+         * @brief Running totals, read from atomic counters without taking the store lock.
+         * @details Sizes count sample data only (channels x frames x sizeof(Sample)).
+         */
+        struct Usage {
+            size_t entries{0};
+            size_t bytes{0};
+            size_t evictions{0};     ///< Entries erased since construction
+            size_t evictedBytes{0};
+            size_t referencedBytes{0}; ///< Bytes of entries with a live pointer from get() / getBatch()
+            size_t storeOnlyBytes{0};  ///< The rest: freed if those entries were erased now
+        };
+
+        /**
+         * @struct TagUsage
+         * @brief Totals for one tag, read from atomic counters without taking the store lock.
+         */
+        struct TagUsage {
+            size_t entries{0};
+            size_t bytes{0};
+        };
+
+        /**
+         * @struct EntryInfo
+         * @brief One entry as seen by @c snapshot().
+         */
+        struct EntryInfo {
+            size_t key{0};
+            std::string tag;
+            size_t bytes{0};
+            unsigned channels{0};
+            unsigned frames{0};
+            long references{0}; ///< Holders other than the store (voices, loaders, ...)
+            bool hasMetadata{false};
+            bool hasOverview{false};
+        };
+
+        /**
+         * @struct Snapshot
+         * @brief Every entry at one instant, with the bytes only the store keeps alive.
+         */
+        struct Snapshot {
+            std::vector<EntryInfo> entries;
+            size_t bytes{0};
+            size_t storeOnlyBytes{0}; ///< Freed if the entries were erased now
+            size_t referencedBytes{0}; ///< Still held elsewhere; erasing them frees nothing yet
+        };
+
+        /**
+         * @brief Why an entry left the store.
+         */
+        enum class EvictionCause {
+            Erased,    ///< erase() or eraseBatch()
+            TagErased, ///< eraseTag()
+        };
+
+        /**
+         * @struct EvictionRecord
+         * @brief One entry of the eviction history.
+         */
+        struct EvictionRecord {
+            size_t key{0};
+            std::string tag;
+            size_t bytes{0};
+            EvictionCause cause{EvictionCause::Erased};
+            bool stillReferenced{false}; ///< Held elsewhere when erased, so its memory outlived the entry
+            std::chrono::steady_clock::time_point time{};
+        };
+
+        /// Records kept by the eviction history; older ones are dropped.
+        static constexpr size_t kEvictionHistory = 256;
+
         explicit BufferStore(size_t capacity);
-        ~BufferStore() = default;
+        ~BufferStore();
 
         size_t insert(std::shared_ptr<const AudioBuffer> buffer);
 
+        /**
+         * @brief Inserts a buffer, running the requested load-time analysis first.
+         * @details Analysis runs on the calling thread before the exclusive lock is taken,
+         *          so readers are never blocked by it.
+         * @return The key of the new entry.
+         */
+        size_t insert(std::shared_ptr<const AudioBuffer> buffer, const InsertOptions& options);
+
+        /**
+         * @brief Inserts many buffers with the same options under a single exclusive lock.
+         * @details Analysis and placement run first, outside the lock, exactly as for @c insert().
+         * @return The keys, in the order of @p buffers.
+         */
+        std::vector<size_t> insertBatch(const std::vector<std::shared_ptr<const AudioBuffer>>& buffers,
+                                        const InsertOptions& options);
+
+        /**
+         * @brief Inserts many buffers, each with its own options, under a single exclusive lock.
+         * @return The keys, in the order of @p items.
+         */
+        std::vector<size_t> insertBatch(const std::vector<InsertItem>& items);
+
+        /**
+         * @brief Looks up a buffer.
+         * @details Until every copy of the returned pointer is dropped, the entry counts towards
+         *          @c Usage::referencedBytes (hand it to a voice, and the voice's lifetime is
+         *          accounted). Returns nullptr for unknown keys.
+         */
         std::shared_ptr<const AudioBuffer> get(size_t key);
 
+        /**
+         * @brief Looks up many keys under a single shared lock.
+         * @return One buffer per key, nullptr for unknown keys.
+         */
+        std::vector<std::shared_ptr<const AudioBuffer>> getBatch(const std::vector<size_t>& keys);
+
+        /**
+         * @brief Gets the transient map cached alongside an entry.
+         * @return The map, or nullptr if the key is unknown or was inserted without analysis.
+         */
+        std::shared_ptr<const TransientMap> transients(size_t key);
+
+        /**
+         * @brief Gets the analysis metadata attached to an entry.
+         * @return The metadata, or nullptr if the key is unknown, the entry was inserted without
+         *         analysis, or its background analysis has not finished yet.
+         */
+        std::shared_ptr<const SampleMetadata> metadata(size_t key);
+
+        /**
+         * @brief Gets the waveform overview attached to an entry.
+         * @details The overview is shared, not copied: a recorder that keeps appending to it is
+         *          seen by every holder.
+         * @return The overview, or nullptr if the key is unknown or none was built.
+         */
+        std::shared_ptr<WaveformOverview> overview(size_t key);
+
+        /**
+         * @brief Blocks until every queued background analysis has been attached.
+         */
+        void waitForAnalysis();
+
         bool erase(size_t key);
 
+        /**
+         * @brief Erases many keys under a single exclusive lock.
+         * @details The buffers are released after the lock is dropped, so freeing large samples
+         *          never blocks readers.
+         * @return The number of entries erased; unknown keys are skipped.
+         */
+        size_t eraseBatch(const std::vector<size_t>& keys);
+
+        /**
+         * @brief Erases every entry inserted with @p tag, e.g. to unload an instrument.
+         * @details O(entries in the tag); one exclusive lock, buffers released after it.
+         * @return The number of entries erased.
+         */
+        size_t eraseTag(const std::string& tag);
+
+        /**
+         * @brief Gets the keys of every entry inserted with @p tag, in no particular order.
+         */
+        std::vector<size_t> tagged(const std::string& tag);
+
+        /**
+         * @brief Sizes the index for at least @p entries entries, so a large load does not rehash repeatedly.
+         */
+        void reserve(size_t entries);
+
+        /**
+         * @brief Gets the number of stored entries.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Reads the running totals; lock-free, cheap enough to poll every UI frame.
+         * @details The referenced / store-only split only sees pointers obtained from the store;
+         *          @c snapshot() also counts holders that kept the buffer they inserted.
+         */
+        Usage usage() const;
+
+        /**
+         * @brief Gets the entry count and bytes stored under @p tag; lock-free.
+         */
+        TagUsage tagUsage(const std::string& tag) const;
+
+        /**
+         * @brief Describes every entry under one shared lock, so the totals agree with the list.
+         * @details Reference counts are read at the same instant; they are exact unless other
+         *          threads copy or drop buffer pointers at that moment.
+         */
+        Snapshot snapshot() const;
+
+        /**
+         * @brief Gets the most recent evictions, oldest first (at most @c kEvictionHistory).
+         */
+        std::vector<EvictionRecord> evictions() const;
+
+        /**
+         * @brief Sets the page placement applied to every buffer inserted from now on.
+         * @details Applied on the inserting thread before the entry becomes visible. Use
+         *          @c PlacementPolicy::kCallerNode from a loader pinned to the render
+         *          worker's node, or name the node explicitly.
+         */
+        void setPlacementPolicy(const PlacementPolicy& policy);
+
+        /**
+         * @brief Re-places an existing entry, e.g. when its instrument moves to a worker on another node.
+         * @return False if the key is unknown, the buffer is too small to place (under 2 MiB), or the
+         *         placement could not be applied.
+         */
+        bool place(size_t key, const PlacementPolicy& policy);
+
+        /**
+         * @brief Reports where an entry's sample memory currently lives.
+         * @return The report, with @c bytes == 0 if the key is unknown.
+         */
+        PlacementReport placement(size_t key);
+
     private:
+        // Lock-free totals shared with outstanding get() pointers, which may outlive the store.
+        struct Counters {
+            std::atomic<size_t> referencedBytes{0};
+        };
+
+        // One entry's reference state: (pointers handed out << 1) | still in the store. Each
+        // change is a single atomic step, so the entry enters or leaves referencedBytes exactly once.
+        struct Leases {
+            std::atomic<size_t> state{1};
+            size_t bytes{0};
+            std::shared_ptr<Counters> counters;
+
+            void acquire();
+            void release();
+            void detach();
+        };
+
+        // A tag's totals, changed under the exclusive lock and read without it
+        struct TagCounters {
+            std::atomic<size_t> entries{0};
+            std::atomic<size_t> bytes{0};
+        };
+        using TagTable = std::unordered_map<std::string, std::shared_ptr<TagCounters>>;
+
+        // A stored buffer together with the analysis cached for it.
+        struct Entry {
+            std::shared_ptr<const AudioBuffer> buffer;
+            std::shared_ptr<const TransientMap> transients;
+            std::shared_ptr<const SampleMetadata> metadata;
+            std::shared_ptr<WaveformOverview> overview;
+            std::string tag;
+            std::shared_ptr<Leases> leases; // Tracks pointers handed out by get()
+        };
+
+        // A sample waiting for the background analysis worker.
+        struct AnalysisJob {
+            size_t key;
+            std::shared_ptr<const AudioBuffer> buffer;
+            SampleAnalysisOptions options;
+        };
+
+        // Runs an insert's load-time work (analysis, overview, placement) on the calling thread
+        Entry prepare(std::shared_ptr<const AudioBuffer> buffer, const InsertOptions& options,
+                      const PlacementPolicy& policy, bool& background) const;
+
+        // Wraps an entry's buffer in a pointer that counts towards referencedBytes while alive
+        static std::shared_ptr<const AudioBuffer> lease(const Entry& entry);
+
+        // Republishes the tag table read by tagUsage(); requires the exclusive lock
+        void publishTagsLocked();
+
+        // Adds a prepared entry and returns its key; requires the exclusive lock
+        size_t commitLocked(Entry entry);
+
+        // Removes an entry, its tag membership and its bytes from the counters, and records the
+        // eviction; requires the exclusive lock
+        Entry detachLocked(std::unordered_map<size_t, Entry>::iterator it, EvictionCause cause);
+
+        // Hands entries to the background analysis worker
+        void queueAnalysis(std::vector<AnalysisJob> jobs);
+
+        // Background analysis worker loop
+        void analysisLoop();
+
         size_t capacity_;
         size_t ID_{0};
+        PlacementPolicy placement_;
 
         mutable std::shared_mutex mutex_;
-        std::unordered_map<size_t, std::shared_ptr<const AudioBuffer>> cache_;
+        std::unordered_map<size_t, Entry> cache_;
+        // Members and byte total of each tag
+        struct TagGroup {
+            std::unordered_set<size_t> keys;
+            std::shared_ptr<TagCounters> counters;
+        };
+        std::unordered_map<std::string, TagGroup> tags_;
+        std::shared_ptr<const TagTable> tagTable_; // Swapped atomically when a tag appears or disappears
+
+        // Counters behind usage(); written under the exclusive lock, read without it
+        std::atomic<size_t> entries_{0};
+        std::atomic<size_t> bytes_{0};
+        std::atomic<size_t> evictions_{0};
+        std::atomic<size_t> evictedBytes_{0};
+        std::shared_ptr<Counters> counters_;
+        std::deque<EvictionRecord> evictionHistory_;
+
+        // Background analysis (the worker is started on first use)
+        std::mutex analysisMutex_;
+        std::condition_variable analysisCv_;
+        std::deque<AnalysisJob> analysisQueue_;
+        size_t analysisPending_{0}; // Queued plus in progress
+        bool analysisStopping_{false};
+        std::thread analysisThread_;
     };
 }
 
@@ -0,0 +1,151 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef BUNDLE_HPP
+#define BUNDLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "audio_buffer.hpp"
+#include "buffer_store.hpp"
+#include "sample_analysis.hpp"
+
+namespace pipsqueak::core {
+    /**
+     * @brief How a bundle stores sample data.
+     */
+    enum class SampleEncoding : std::uint16_t {
+        Float32 = 1, ///< Stored exactly as the engine's Sample; loads with a plain copy
+        Int16 = 2    ///< Half the size; scaled by the entry's peak so quiet samples keep their resolution
+    };
+
+    /**
+     * @struct BundleSample
+     * @brief One sample and its playback metadata, as written into a bundle.
+     */
+    struct BundleSample {
+        std::string name;
+        std::shared_ptr<const AudioBuffer> buffer;
+        unsigned sampleRate{44100};
+        int rootNote{60};
+        std::uint32_t loopStart{0};
+        std::uint32_t loopEnd{0}; ///< Exclusive; loopEnd <= loopStart means no loop
+        float peak{-1.0f};        ///< Absolute peak; negative to take it from the analysis
+        std::shared_ptr<const SampleMetadata> metadata{}; ///< nullptr to have the writer analyse the sample
+    };
+
+    /**
+     * @struct BundleEntry
+     * @brief The index record of one sample in an opened bundle.
+     */
+    struct BundleEntry {
+        std::string name;
+        unsigned channels{0};
+        unsigned frames{0};
+        unsigned sampleRate{0};
+        SampleEncoding encoding{SampleEncoding::Float32};
+        int rootNote{60};
+        std::uint32_t loopStart{0};
+        std::uint32_t loopEnd{0};
+        float peak{0.0f};
+        std::shared_ptr<const SampleMetadata> metadata; // nullptr for bundles written without analysis
+
+        [[nodiscard]] bool hasLoop() const noexcept { return loopEnd > loopStart; }
+    };
+
+    /**
+     * @class BundleWriter
+     * @brief Packs samples into a single bundle file.
+     * @details Layout: a fixed header, the index records, the name table, then one data block
+     *          per sample, each starting on a 4 KiB boundary so it can be mapped and read in
+     *          place. All fields are little-endian.
+     */
+    class BundleWriter {
+    public:
+        explicit BundleWriter(SampleEncoding encoding = SampleEncoding::Float32);
+
+        /**
+         * @brief Queues a sample for writing, analysing it first if it carries no metadata.
+         * @throws std::invalid_argument if the sample has no buffer or its loop lies outside it.
+         */
+        void add(BundleSample sample);
+
+        /**
+         * @brief Writes every queued sample to @p path.
+         * @return False (with @p error set, if given) if the file could not be written.
+         */
+        bool write(const std::string& path, std::string* error = nullptr) const;
+
+        [[nodiscard]] size_t count() const noexcept;
+
+    private:
+        SampleEncoding encoding_;
+        std::vector<BundleSample> samples_;
+    };
+
+    /**
+     * @class Bundle
+     * @brief A read-only, memory-mapped bundle.
+     * @details Opening maps the whole file once and validates the index; no sample data is
+     *          touched until it is loaded, so the cost of a load is the page faults on the
+     *          blocks actually used.
+     */
+    class Bundle {
+    public:
+        ~Bundle();
+        Bundle(const Bundle&) = delete;
+        Bundle& operator=(const Bundle&) = delete;
+
+        /**
+         * @brief Maps and validates a bundle file.
+         * @return The bundle, or nullptr (with @p error set, if given) if it is missing or malformed.
+         */
+        static std::shared_ptr<Bundle> open(const std::string& path, std::string* error = nullptr);
+
+        [[nodiscard]] size_t count() const noexcept;
+        [[nodiscard]] const BundleEntry& entry(size_t index) const;
+
+        /**
+         * @brief Finds an entry by name.
+         */
+        [[nodiscard]] std::optional<size_t> find(const std::string& name) const;
+
+        /**
+         * @brief Materialises one entry as an AudioBuffer.
+         * @details Float32 blocks are copied straight out of the mapping; Int16 blocks are scaled.
+         */
+        [[nodiscard]] std::shared_ptr<AudioBuffer> load(size_t index) const;
+
+        /**
+         * @brief Loads every entry into @p store in one batch insert, attaching each entry's stored metadata.
+         * @return The store keys, indexed like the bundle's entries.
+         */
+        std::vector<size_t> registerInto(BufferStore& store,
+                                         const BufferStore::InsertOptions& options = {}) const;
+
+    private:
+        Bundle() = default;
+
+        // The sample bytes of one entry within the mapping.
+        struct Block {
+            std::uint64_t offset;
+            std::uint64_t bytes;
+            float scale; // Int16 -> Sample factor
+        };
+
+        const std::uint8_t* base_{nullptr};
+        size_t size_{0};
+        bool mapped_{false};            // base_ comes from mmap (otherwise from fallback_)
+        std::vector<std::uint8_t> fallback_;
+        std::vector<BundleEntry> entries_;
+        std::vector<Block> blocks_;
+    };
+}
+
+#endif //BUNDLE_HPP
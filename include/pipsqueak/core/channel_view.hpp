@@ -44,7 +44,7 @@ namespace pipsqueak::core {
          * @return Reference to the writable sample.
          * @throws std::out_of_range if @p frameIndex is out of bounds (thrown by @c AudioBuffer::at()).
          */
-        template <typename T = BufferType, typename = std::enable_if_t<Writable>>
+        template <typename T = BufferType, typename = std::enable_if_t<!std::is_const_v<T>>>
         Sample& operator[](size_t frameIndex) {
             return const_cast<Sample&>(static_cast<const ChannelView&>(*this)[frameIndex]);
         }
@@ -127,7 +127,7 @@ namespace pipsqueak::core {
          * @details Enabled only when @c Writable is true. Uses unchecked pointer+stride access.
          * @return @c RawSpan<false> with @c Sample* pointer.
          */
-        template <typename T = BufferType, typename = std::enable_if_t<Writable>>
+        template <typename T = BufferType, typename = std::enable_if_t<!std::is_const_v<T>>>
         auto raw() noexcept -> RawSpan<false> {
             return { buffer_->dataPtr() + channelIndex_,
                      buffer_->numFrames(),
@@ -202,7 +202,7 @@ namespace pipsqueak::core {
          * @brief Begin iterator over frames (writable view).
          * @return Iterator to the first frame (enabled only when @c Writable is true).
          */
-        template <typename T = BufferType, typename = std::enable_if_t<Writable>>
+        template <typename T = BufferType, typename = std::enable_if_t<!std::is_const_v<T>>>
         auto begin() noexcept -> StridedIterator<false> {
             auto s = raw();
             return { s.ptr, 0, s.stride };
@@ -212,7 +212,7 @@ namespace pipsqueak::core {
          * @brief End iterator over frames (writable view).
          * @return Iterator past the last frame (enabled only when @c Writable is true).
          */
-        template <typename T = BufferType, typename = std::enable_if_t<Writable>>
+        template <typename T = BufferType, typename = std::enable_if_t<!std::is_const_v<T>>>
         auto end() noexcept -> StridedIterator<false> {
             auto s = raw();
             return { s.ptr, s.frames, s.stride };
@@ -0,0 +1,150 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef COMMAND_BUS_HPP
+#define COMMAND_BUS_HPP
+
+#include "mpsc_queue.hpp"
+#include "spsc_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace pipsqueak::core {
+    /**
+     * @struct Command
+     * @brief One preallocated control -> audio command record.
+     * @details A command is a pair of plain function pointers plus a few untyped operands, so
+     *          records are trivially copyable and fit in fixed queue slots. @c apply runs on
+     *          the audio thread and must not block or allocate. @c retire (optional) runs later
+     *          on a control thread with the same record, which is where objects handed back by
+     *          @c apply (e.g. a replaced snapshot) are destroyed.
+     */
+    struct Command {
+        using Fn = void (*)(Command&);
+
+        Fn apply{nullptr};
+        Fn retire{nullptr};
+
+        void* target{nullptr};  // The object the command acts on
+        void* payload{nullptr}; // Owned data handed across (and back)
+        double value{0.0};
+        std::int32_t arg{0};
+        float level{0.0f};
+
+        std::uint64_t sequence{0}; // Assigned when posted
+        std::uint32_t span{1};     // Records in this record's transaction (set on the first one)
+    };
+
+    /**
+     * @class CommandBus
+     * @brief The lock-free control -> audio command queue, with an audio -> control return path.
+     * @details Any number of control threads post commands; the audio thread @c drain()s them
+     *          at the top of each block, up to a per-block budget, and hands each applied record
+     *          back through a single-producer return queue. A control thread then @c collect()s
+     *          the returned records, running their @c retire hook, so nothing is freed on the
+     *          audio thread.
+     *
+     *          Commands posted together through a Transaction occupy contiguous slots and are
+     *          applied in the same block or not at all.
+     */
+    class CommandBus {
+    public:
+        /**
+         * @brief Allocates both queues.
+         * @param capacity Minimum number of in-flight commands.
+         */
+        explicit CommandBus(size_t capacity = 1024);
+
+        /**
+         * @brief Discards unapplied commands, running their retire hooks so payloads are released.
+         */
+        ~CommandBus();
+
+        CommandBus(const CommandBus&) = delete;
+        CommandBus& operator=(const CommandBus&) = delete;
+
+        /**
+         * @brief Thread-safely posts one command.
+         * @return The command's sequence number, or 0 if the queue is full.
+         */
+        std::uint64_t post(const Command& command);
+
+        /**
+         * @brief Thread-safely posts commands as one transaction.
+         * @return The sequence number of the last command, or 0 if there was no room for all of them.
+         */
+        std::uint64_t post(const Command* commands, size_t count);
+
+        /**
+         * @brief Audio thread: applies pending commands.
+         * @details A transaction is never split across calls. A transaction larger than the
+         *          budget is still applied when it is the first one in the call, so it cannot
+         *          stall the queue.
+         * @param budget The maximum number of commands to apply.
+         * @return The number of commands applied.
+         */
+        size_t drain(size_t budget);
+
+        /**
+         * @brief Control thread: retires applied commands.
+         * @return The number of commands retired.
+         */
+        size_t collect();
+
+        /**
+         * @brief The highest sequence number applied by the audio thread.
+         */
+        [[nodiscard]] std::uint64_t completed() const noexcept;
+
+        /**
+         * @brief True once the command with @p sequence has been applied.
+         */
+        [[nodiscard]] bool isComplete(std::uint64_t sequence) const noexcept;
+
+        [[nodiscard]] size_t capacity() const noexcept;
+
+    private:
+        MpscQueue<Command> commands_;
+        SpscQueue<Command> returns_;
+        std::atomic<std::uint64_t> completed_{0};
+        std::mutex collectMutex_;
+    };
+
+    /**
+     * @class Transaction
+     * @brief Collects commands on a control thread and posts them atomically.
+     */
+    class Transaction {
+    public:
+        explicit Transaction(CommandBus& bus) : bus_(bus) {}
+
+        /**
+         * @brief Appends a command to the transaction.
+         */
+        Transaction& add(const Command& command) {
+            commands_.push_back(command);
+            return *this;
+        }
+
+        /**
+         * @brief Posts all commands as one unit, then clears the transaction.
+         * @return The sequence number of the last command, or 0 if the bus had no room (nothing is posted).
+         */
+        std::uint64_t commit() {
+            const auto sequence = bus_.post(commands_.data(), commands_.size());
+            commands_.clear();
+            return sequence;
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return commands_.size(); }
+
+    private:
+        CommandBus& bus_;
+        std::vector<Command> commands_;
+    };
+}
+
+#endif //COMMAND_BUS_HPP
@@ -0,0 +1,181 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef EVENT_RING_HPP
+#define EVENT_RING_HPP
+
+#include "spsc_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace pipsqueak::core {
+    /**
+     * @brief What an Event reports.
+     */
+    enum class EventType : std::uint8_t {
+        SourceFinished, ///< A source (or a Mixer input) played out. @c source identifies it.
+        VoiceStolen,    ///< A Sampler reused a playing voice for a new note. @c value is the voice index.
+        Overload,       ///< The device reported an xrun. @c value holds the backend status bits.
+        StreamStatus    ///< The stream started (@c value 1) or stopped (@c value 0).
+    };
+
+    /**
+     * @struct Event
+     * @brief One audio -> control notification.
+     */
+    struct Event {
+        EventType type{EventType::SourceFinished};
+        std::int32_t value{0};       // Type-specific detail (see EventType)
+        std::uint64_t frame{0};      // Stream position in frames, exact to the sample
+        const void* source{nullptr}; // The object that raised the event, if any
+    };
+
+    /**
+     * @class EventRing
+     * @brief A wait-free notification ring written by the audio thread and drained by a control thread.
+     * @details The audio thread brackets each block with @c beginBlock() / @c endBlock() and
+     *          posts events with a frame offset into the block, which the ring turns into an
+     *          absolute stream position. Posting never blocks: if the ring is full the event is
+     *          counted in @c dropped() instead.
+     *
+     *          On Linux the ring also owns an eventfd that becomes readable at the end of any
+     *          block that posted events (one write per block, not per event), so a control
+     *          loop can sleep in poll()/epoll on @c fd() rather than polling the graph.
+     */
+    class EventCapture;
+
+    class EventRing {
+    public:
+        /**
+         * @param capacity Minimum number of undrained events; rounded up to a power of two.
+         */
+        explicit EventRing(size_t capacity = 1024);
+        ~EventRing();
+
+        EventRing(const EventRing&) = delete;
+        EventRing& operator=(const EventRing&) = delete;
+
+        // ---- Producer (audio thread) ----
+
+        /**
+         * @brief Marks the start of a block at stream position @p frame.
+         */
+        void beginBlock(std::uint64_t frame) noexcept;
+
+        /**
+         * @brief Posts an event @p offset frames into the current block.
+         * @return False if the ring was full (the event is dropped and counted).
+         */
+        bool post(EventType type, const void* source, std::uint32_t offset = 0, std::int32_t value = 0) noexcept;
+
+        /**
+         * @brief Marks the end of a block; wakes @c fd() waiters if anything was posted.
+         */
+        void endBlock() noexcept;
+
+        // ---- Consumer (control thread) ----
+
+        /**
+         * @brief Removes the oldest event.
+         * @return False if there is none.
+         */
+        bool poll(Event& event);
+
+        /**
+         * @brief Hands every pending event to @p handler.
+         * @return The number of events handled.
+         */
+        template <typename Handler>
+        size_t drain(Handler&& handler) {
+            clearWakeup();
+            size_t count = 0;
+            Event event;
+            while (events_.tryPop(event)) {
+                handler(event);
+                ++count;
+            }
+            return count;
+        }
+
+        /**
+         * @brief A file descriptor that is readable while events are pending, or -1 where unsupported.
+         */
+        [[nodiscard]] int fd() const noexcept;
+
+        /**
+         * @brief The number of events lost because the ring was full.
+         */
+        [[nodiscard]] std::uint64_t dropped() const noexcept;
+
+    private:
+        friend class EventCapture;
+
+        // Resets the eventfd counter so the next endBlock() wakes waiters again
+        void clearWakeup() noexcept;
+
+        SpscQueue<Event> events_;
+        std::uint64_t blockFrame_{0};
+        bool postedThisBlock_{false};
+        std::atomic<std::uint64_t> dropped_{0};
+        int fd_{-1};
+    };
+
+    /**
+     * @class EventCapture
+     * @brief Holds the events one thread posts to any EventRing, so they can be forwarded later.
+     * @details While a @c Scope is active, @c EventRing::post() on that thread lands here
+     *          instead of in the ring. A Mixer rendering inputs in parallel gives each input its
+     *          own capture and forwards them in input order from the rendering thread, so rings
+     *          keep a single producer and see the same order for any thread count. Capturing
+     *          never allocates; events beyond the capacity are counted in the ring's @c dropped().
+     */
+    class EventCapture {
+    public:
+        /**
+         * @param capacity Events held per capture (per input and block).
+         */
+        explicit EventCapture(size_t capacity = 64);
+
+        /**
+         * @class Scope
+         * @brief Routes the current thread's posts into a capture for its lifetime.
+         */
+        class Scope {
+        public:
+            explicit Scope(EventCapture& capture) noexcept;
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            EventCapture* previous_;
+        };
+
+        /**
+         * @brief Posts the captured events to their rings in capture order, then clears.
+         */
+        void forward() noexcept;
+
+    private:
+        friend class EventRing;
+
+        struct Pending {
+            EventRing* ring;
+            EventType type;
+            const void* source;
+            std::uint32_t offset;
+            std::int32_t value;
+        };
+
+        // Stores one post; false (and counted on the ring) when full
+        bool capture(const Pending& pending) noexcept;
+
+        std::vector<Pending> pending_;
+        size_t count_{0};
+    };
+}
+
+#endif //EVENT_RING_HPP
@@ -0,0 +1,75 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef FLAC_DECODER_HPP
+#define FLAC_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "audio_buffer.hpp"
+#include "buffer_store.hpp"
+#include "wav_loader.hpp"
+
+namespace pipsqueak::core {
+    /**
+     * @struct FlacInfo
+     * @brief The STREAMINFO of a FLAC stream and where its first frame starts.
+     */
+    struct FlacInfo {
+        unsigned channels{0};
+        unsigned sampleRate{0};
+        unsigned bitsPerSample{0};
+        std::uint64_t totalFrames{0}; // Inter-channel sample frames
+        unsigned minBlockSize{0};
+        unsigned maxBlockSize{0};
+        std::uint64_t framesOffset{0}; // File offset of the first audio frame
+    };
+
+    /**
+     * @brief Parses the "fLaC" marker and metadata blocks.
+     * @return The stream info, or nothing if this is not a FLAC stream the decoder supports
+     *         (4 to 24 bits per sample, up to 8 channels, known length).
+     */
+    std::optional<FlacInfo> parseFlacHeader(const std::uint8_t* bytes, size_t size);
+
+    /**
+     * @struct FlacDecodeOptions
+     * @brief Parallelism and store insertion for FLAC decoding.
+     */
+    struct FlacDecodeOptions {
+        unsigned threads{0};             ///< Worker threads; 0 = one per hardware thread
+        size_t bytesPerTask{256 * 1024}; ///< Compressed bytes per unit of work within a file
+        BufferStore::InsertOptions insert{};
+    };
+
+    /**
+     * @brief Decodes a whole in-memory FLAC stream, splitting its frames across threads.
+     * @details Each worker takes a byte range of the stream, locks onto the first frame that
+     *          starts in it (sync code, header CRC-8 and frame CRC-16 must all match) and decodes
+     *          frames until the next one starts past its range. The frame header's number gives
+     *          every frame's position, so samples are decorrelated and converted straight into
+     *          their final place in the interleaved output.
+     * @return The decoded buffer, or nullptr (with @p error set, if given) on malformed input.
+     */
+    std::shared_ptr<AudioBuffer> decodeFlac(const std::uint8_t* bytes, size_t size,
+                                            const FlacDecodeOptions& options = {}, std::string* error = nullptr);
+
+    /**
+     * @brief Reads and decodes many FLAC files on one shared pool of workers.
+     * @details Files are read and parsed in parallel, then every byte range of every file is
+     *          decoded from a single work list, so one long file and many short ones keep all
+     *          workers equally busy.
+     * @param store If given, every successfully decoded buffer is inserted and its key reported.
+     * @return One entry per path, in the same order.
+     */
+    std::vector<LoadedSample> loadFlacFiles(const std::vector<std::string>& paths, BufferStore* store = nullptr,
+                                            const FlacDecodeOptions& options = {});
+}
+
+#endif //FLAC_DECODER_HPP
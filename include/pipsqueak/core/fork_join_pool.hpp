@@ -0,0 +1,82 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef FORK_JOIN_POOL_HPP
+#define FORK_JOIN_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace pipsqueak::core {
+    /**
+     * @class ForkJoinPool
+     * @brief A fixed set of worker threads that join the calling thread on one loop at a time.
+     * @details @c parallelFor() hands out the indices of a loop to the workers and the caller
+     *          alike and returns when all of them are done, without allocating. Which thread runs
+     *          which index is unspecified, so callers that need reproducible results must make
+     *          each index's work independent of that (e.g. write only to per-index buffers).
+     *
+     *          A loop started while another one runs on the same pool (nested, or from a second
+     *          thread) runs serially on its caller instead of waiting.
+     */
+    class ForkJoinPool {
+    public:
+        /**
+         * @param threads Total participants, the calling thread included; 1 means no workers.
+         */
+        explicit ForkJoinPool(unsigned threads);
+        ~ForkJoinPool();
+
+        ForkJoinPool(const ForkJoinPool&) = delete;
+        ForkJoinPool& operator=(const ForkJoinPool&) = delete;
+
+        /**
+         * @brief Total participants, the calling thread included.
+         */
+        [[nodiscard]] unsigned threads() const noexcept { return static_cast<unsigned>(workers_.size()) + 1; }
+
+        /**
+         * @brief Runs @p fn(i) for every i in [0, count) and waits for all of them.
+         */
+        template <typename Fn>
+        void parallelFor(const size_t count, Fn&& fn) {
+            using Callable = std::remove_reference_t<Fn>;
+            run(count, [](void* context, const size_t index) { (*static_cast<Callable*>(context))(index); },
+                const_cast<void*>(static_cast<const void*>(&fn)));
+        }
+
+    private:
+        using Task = void (*)(void*, size_t);
+
+        void run(size_t count, Task task, void* context);
+
+        // Takes indices of the current loop until none are left
+        void drain();
+
+        void workerLoop();
+
+        std::vector<std::thread> workers_;
+
+        // The current loop
+        Task task_{nullptr};
+        void* context_{nullptr};
+        size_t count_{0};
+        std::atomic<size_t> next_{0};
+        std::atomic<unsigned> active_{0}; // Workers still inside the current loop
+        std::atomic<bool> busy_{false};
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        std::uint64_t generation_{0};
+        bool stopping_{false};
+    };
+}
+
+#endif //FORK_JOIN_POOL_HPP
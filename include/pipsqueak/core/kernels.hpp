@@ -0,0 +1,123 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "types.hpp"
+
+namespace pipsqueak::core::kernels {
+    /**
+     * @brief Instruction-set levels the hot kernels are compiled for.
+     */
+    enum class Isa {
+        Baseline, ///< The target's default ISA (SSE2 on x86-64); always available.
+        Sse42,
+        Avx2,
+        Avx512
+    };
+
+    /**
+     * @brief Channel routings of the fused resample-and-mix kernel (source -> output).
+     */
+    enum class MixRoute : std::uint8_t {
+        MonoToMono, ///< 1 -> 1
+        MonoToPair, ///< 1 -> 2, duplicated
+        PairToPair, ///< 2 -> 2
+        PairToMany  ///< 2 -> N, into the first two output channels
+    };
+
+    /**
+     * @struct KernelTable
+     * @brief One ISA level's implementation of every hot DSP kernel.
+     * @details All variants are built from the same source and produce bit-identical
+     *          results (no FMA contraction, no reordered reductions), so switching ISA
+     *          never changes the rendered audio.
+     */
+    struct KernelTable {
+        Isa isa;
+        const char* name;
+
+        /// data[i] *= gain
+        void (*gain)(Sample* data, size_t count, float gain);
+
+        /// data[i] = value
+        void (*fill)(Sample* data, size_t count, float value);
+
+        /// dst[i] += gain * src[i]
+        void (*mixAccumulate)(Sample* dst, const Sample* src, size_t count, float gain);
+
+        /**
+         * @brief Linear-interpolating read of interleaved frames at phase, phase + step, ...
+         * @details Writes interleaved frames to @p dst until @p frames are written or the read
+         *          position passes @p lastIndex. @p phase is advanced past the frames written.
+         * @return The number of frames written.
+         */
+        size_t (*interpolate)(const Sample* src, unsigned channels, size_t lastIndex,
+                              double& phase, double step, Sample* dst, size_t frames);
+
+        /// Float to signed 16-bit PCM, clamped to [-1, 1].
+        void (*toInt16)(const Sample* src, std::int16_t* dst, size_t count);
+
+        /// Signed 16-bit PCM to float in [-1, 1).
+        void (*fromInt16)(const std::int16_t* src, Sample* dst, size_t count);
+
+        /**
+         * @brief In-place linear-prediction restoration (FLAC LPC subframes).
+         * @details @p samples holds @p order warm-up samples followed by residuals; each residual
+         *          at i becomes residual + ((sum_j coefficients[j] * samples[i-1-j]) >> shift).
+         *          With @p wide false the sums are accumulated in 32 bits, which the caller may
+         *          only request when bits-per-sample + precision + log2(order) <= 32.
+         */
+        void (*lpcRestore)(std::int32_t* samples, size_t count, const std::int32_t* coefficients,
+                           unsigned order, int shift, bool wide);
+
+        /**
+         * @brief Per-channel absolute peak, sum and sum of squares of interleaved frames.
+         * @details Each output array has @p channels entries and is overwritten. Sums are
+         *          accumulated in double across fixed lanes, so every variant agrees exactly.
+         */
+        void (*channelStats)(const Sample* src, size_t frames, unsigned channels,
+                             float* peak, double* sum, double* sumSquares);
+
+        /**
+         * @brief Per-block, per-channel minimum, maximum and sum of squares of interleaved frames.
+         * @details Reads @p blocks consecutive blocks of @p blockFrames frames; outputs are indexed
+         *          block * channels + channel. Lanes are folded in a fixed order, so every variant
+         *          agrees exactly.
+         */
+        void (*blockMinMax)(const Sample* src, size_t blocks, size_t blockFrames, unsigned channels,
+                            float* min, float* max, float* sumSquares);
+
+        /**
+         * @brief Linear-interpolating read mixed straight into an output: dst += gain * frame.
+         * @details Reads the same positions with the same rounding as @c interpolate(), routed by
+         *          @p route into output frames @p dstStride samples apart (only PairToMany reads
+         *          the stride). @p phase is advanced past the frames written.
+         * @return The number of frames written.
+         */
+        size_t (*interpolateMix)(const Sample* src, MixRoute route, size_t lastIndex, double& phase, double step,
+                                 float gain, Sample* dst, unsigned dstStride, size_t frames);
+    };
+
+    /**
+     * @brief The best kernel table for this CPU.
+     * @details Chosen once, on first use, from the compiled variants the CPU supports. The
+     *          @c PIPSQUEAK_ISA environment variable (baseline, sse4.2, avx2, avx512) caps the
+     *          choice, e.g. to compare variants on one machine.
+     */
+    const KernelTable& active();
+
+    /**
+     * @brief All compiled kernel tables this CPU can run, lowest ISA first.
+     * @note Intended for tests and benchmarks that exercise every variant.
+     */
+    std::vector<const KernelTable*> available();
+}
+
+#endif //KERNELS_HPP
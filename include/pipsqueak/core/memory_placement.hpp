@@ -0,0 +1,80 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef MEMORY_PLACEMENT_HPP
+#define MEMORY_PLACEMENT_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace pipsqueak::core {
+    /**
+     * @brief How large sample allocations should be backed by huge pages.
+     */
+    enum class HugePages {
+        Off,         ///< Leave the kernel default.
+        Transparent, ///< Advise transparent huge pages (khugepaged collapses them in the background).
+        Collapse     ///< Advise, then ask the kernel to collapse the range now (Linux 6.1+; falls back to Transparent).
+    };
+
+    /**
+     * @struct PlacementPolicy
+     * @brief Where the pages of a sample buffer should live.
+     */
+    struct PlacementPolicy {
+        static constexpr int kAnyNode = -1;     ///< Do not bind; pages stay where they were first touched.
+        static constexpr int kCallerNode = -2;  ///< Bind to the NUMA node of the calling thread.
+
+        HugePages hugePages{HugePages::Off};
+        int node{kAnyNode};
+
+        /// Move pages that are already resident on another node (otherwise only new faults follow the policy).
+        bool migrate{true};
+    };
+
+    /**
+     * @struct PlacementReport
+     * @brief Where the pages of a range actually are.
+     */
+    struct PlacementReport {
+        bool supported{false};          ///< False where the platform cannot report placement.
+        size_t bytes{0};
+        size_t pages{0};                ///< Base pages covering the range
+        std::vector<size_t> pagesPerNode; ///< Resident base pages on each NUMA node
+        size_t nonResidentPages{0};     ///< Pages never touched or swapped out
+        size_t hugePageBytes{0};        ///< Bytes of the enclosing mappings backed by transparent huge pages
+    };
+
+    namespace placement {
+        /**
+         * @brief The number of NUMA nodes the kernel may use (1 on non-NUMA or non-Linux hosts).
+         */
+        [[nodiscard]] int nodeCount();
+
+        /**
+         * @brief The NUMA node the calling thread is running on (0 where unknown).
+         */
+        [[nodiscard]] int currentNode();
+
+        /**
+         * @brief Applies @p policy to the pages holding [@p data, @p data + @p bytes).
+         * @details Uses madvise(2) for huge pages and mbind(2) with a preferred-node policy
+         *          (so a full node falls back rather than failing) for binding. Only the whole
+         *          pages inside the range are affected, so neighbouring allocations that share
+         *          an edge page keep their policy; the partial edge pages are left as they are.
+         *          Ranges under 2 MiB are skipped: every placed range becomes its own mapping
+         *          in the kernel, and small ones are not worth one. Linux only; elsewhere this
+         *          does nothing and returns false.
+         * @return True if every requested step succeeded; false for skipped ranges.
+         */
+        bool apply(const void* data, size_t bytes, const PlacementPolicy& policy);
+
+        /**
+         * @brief Reports the NUMA node of every page of a range (via move_pages(2) in query mode).
+         */
+        [[nodiscard]] PlacementReport query(const void* data, size_t bytes);
+    }
+}
+
+#endif //MEMORY_PLACEMENT_HPP
@@ -0,0 +1,131 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace pipsqueak::core {
+    /**
+     * @class MpscQueue
+     * @brief A bounded, lock-free multi-producer / single-consumer FIFO of preallocated slots.
+     * @details Every slot carries a sequence number (Vyukov's bounded queue), so producers
+     *          only contend on one atomic position and the consumer never writes a shared
+     *          counter. Producers may claim several contiguous slots at once; the consumer can
+     *          look ahead to check whether such a batch is fully published before using it.
+     *
+     *          All storage is allocated in the constructor; pushing and popping never allocate.
+     * @tparam T A default-constructible, move-assignable element type.
+     */
+    template <typename T>
+    class MpscQueue {
+    public:
+        /**
+         * @brief Allocates the slots.
+         * @param capacity Minimum number of elements; rounded up to a power of two.
+         */
+        explicit MpscQueue(const size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+            mask_ = size - 1;
+            slots_ = std::make_unique<Slot[]>(size);
+            for (size_t i = 0; i < size; ++i)
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+        /**
+         * @brief Producer side: appends one element.
+         * @return False if the queue is full.
+         */
+        bool tryPush(T value) {
+            return tryPushBatch(1, [&](size_t, T& slot) { slot = std::move(value); }) != 0;
+        }
+
+        /**
+         * @brief Producer side: claims @p count contiguous slots and fills them in order.
+         * @param count Number of slots (at most @c capacity()).
+         * @param fill Called as fill(i, slot) for i in [0, count) before each slot is published.
+         * @return The 1-based queue position of the first element, or 0 if there was no room.
+         */
+        template <typename Fill>
+        size_t tryPushBatch(const size_t count, Fill&& fill) {
+            if (count == 0 || count > capacity())
+                return 0;
+
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            for (;;) {
+                // All slots of the batch must have been released by the consumer.
+                bool stale = false;
+                for (size_t k = 0; k < count; ++k) {
+                    const size_t seq = slots_[(pos + k) & mask_].sequence.load(std::memory_order_acquire);
+                    if (seq == pos + k) continue;
+                    if (seq < pos + k) return 0; // Full
+                    stale = true;                // Another producer claimed it first
+                    break;
+                }
+
+                if (stale) {
+                    pos = tail_.load(std::memory_order_relaxed);
+                } else if (tail_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+
+            for (size_t k = 0; k < count; ++k) {
+                Slot& slot = slots_[(pos + k) & mask_];
+                fill(k, slot.value);
+                slot.sequence.store(pos + k + 1, std::memory_order_release);
+            }
+            return pos + 1;
+        }
+
+        /**
+         * @brief Consumer side: the published element @p offset places behind the head, if any.
+         */
+        [[nodiscard]] T* peek(const size_t offset = 0) noexcept {
+            const size_t pos = head_ + offset;
+            Slot& slot = slots_[pos & mask_];
+            if (offset > mask_ || slot.sequence.load(std::memory_order_acquire) != pos + 1)
+                return nullptr;
+            return &slot.value;
+        }
+
+        /**
+         * @brief Consumer side: releases @p count published elements from the head.
+         * @pre The elements were observed through @c peek().
+         */
+        void pop(const size_t count = 1) noexcept {
+            for (size_t k = 0; k < count; ++k, ++head_)
+                slots_[head_ & mask_].sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Consumer side: the 1-based queue position of the head element.
+         */
+        [[nodiscard]] size_t headPosition() const noexcept { return head_ + 1; }
+
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence{0};
+            T value{};
+        };
+
+        std::unique_ptr<Slot[]> slots_;
+        size_t mask_{0};
+
+        // Producers and the consumer touch different cache lines.
+        alignas(64) std::atomic<size_t> tail_{0};
+        alignas(64) size_t head_{0};
+    };
+}
+
+#endif //MPSC_QUEUE_HPP
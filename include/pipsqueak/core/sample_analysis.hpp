@@ -0,0 +1,54 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef SAMPLE_ANALYSIS_HPP
+#define SAMPLE_ANALYSIS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "audio_buffer.hpp"
+
+namespace pipsqueak::core {
+    /**
+     * @struct SampleMetadata
+     * @brief Load-time facts about a sample, computed once and shared read-only.
+     * @details Lets voices skip leading silence and lets culling compare peaks without
+     *          touching sample data on the audio thread.
+     */
+    struct SampleMetadata {
+        float peak{0.0f};     ///< Absolute peak over all channels
+        float rms{0.0f};      ///< RMS over all channels
+        float dcOffset{0.0f}; ///< Mean sample value over all channels
+
+        /// Frames before the first / after the last frame with any channel above the silence
+        /// threshold; both equal the sample length when it is silent throughout.
+        std::uint32_t leadingSilence{0};
+        std::uint32_t trailingSilence{0};
+
+        /// Nearest zero crossings (channel sum) to the analysed loop points; equal to them when none is close.
+        std::uint32_t loopStartCrossing{0};
+        std::uint32_t loopEndCrossing{0};
+    };
+
+    /**
+     * @struct SampleAnalysisOptions
+     * @brief Parameters of @c analyzeSample().
+     */
+    struct SampleAnalysisOptions {
+        float silenceThreshold{1.0e-4f};   ///< Absolute level treated as silence (-80 dBFS)
+        std::uint32_t loopStart{0};
+        std::uint32_t loopEnd{0};          ///< loopEnd <= loopStart: no loop, crossings are left at 0
+        std::uint32_t crossingWindow{256}; ///< Frames searched either side of each loop point
+    };
+
+    /**
+     * @brief Measures peak, RMS, DC offset, silent head and tail, and loop-point zero crossings.
+     * @details One vectorised statistics pass (see @c KernelTable::channelStats) plus short scans
+     *          from each end and around each loop point.
+     */
+    SampleMetadata analyzeSample(const AudioBuffer& buffer, const SampleAnalysisOptions& options = {});
+}
+
+#endif //SAMPLE_ANALYSIS_HPP
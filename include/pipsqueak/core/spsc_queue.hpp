@@ -0,0 +1,88 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace pipsqueak::core {
+    /**
+     * @class SpscQueue
+     * @brief A bounded, wait-free single-producer / single-consumer ring.
+     * @details Storage is allocated once in the constructor. Each side owns one index and
+     *          only reads the other's, so push and pop are a load, a copy and a store.
+     * @tparam T A default-constructible, move-assignable element type.
+     */
+    template <typename T>
+    class SpscQueue {
+    public:
+        /**
+         * @brief Allocates the ring.
+         * @param capacity Minimum number of elements; rounded up to a power of two.
+         */
+        explicit SpscQueue(const size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+            mask_ = size - 1;
+            items_ = std::make_unique<T[]>(size);
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+        /**
+         * @brief Producer side: appends an element.
+         * @return False if the ring is full.
+         */
+        bool tryPush(T value) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) > mask_)
+                return false;
+            items_[tail & mask_] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Producer side: the number of elements that can be pushed without failing.
+         */
+        [[nodiscard]] size_t freeSpace() const noexcept {
+            return capacity() - (tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire));
+        }
+
+        /**
+         * @brief Consumer side: removes the oldest element.
+         * @return False if the ring is empty.
+         */
+        bool tryPop(T& out) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire))
+                return false;
+            out = std::move(items_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Either side: an instantaneous (possibly stale) element count.
+         */
+        [[nodiscard]] size_t size() const noexcept {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::unique_ptr<T[]> items_;
+        size_t mask_{0};
+
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+    };
+}
+
+#endif //SPSC_QUEUE_HPP
@@ -0,0 +1,207 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef TIERED_CACHE_HPP
+#define TIERED_CACHE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "audio_buffer.hpp"
+
+namespace pipsqueak::core {
+    /**
+     * @brief Losslessly compresses interleaved samples for the warm tier.
+     * @details Each sample's bits are XORed with the previous sample of the same channel and
+     *          only the non-zero byte span of the result is kept, behind a 4-bit code. Slowly
+     *          moving signals and 16/24-bit sources (zero low mantissa bytes) shrink the most.
+     */
+    std::vector<std::uint8_t> compressSamples(const Sample* data, size_t frames, unsigned channels);
+
+    /**
+     * @brief Reverses @c compressSamples() into @p out (frames * channels samples).
+     * @return False if the data is truncated or corrupt.
+     */
+    bool decompressSamples(const std::uint8_t* bytes, size_t size, Sample* out, size_t frames, unsigned channels);
+
+    /**
+     * @brief Where a @c TieredCache entry's sample data currently lives.
+     */
+    enum class CacheTier {
+        Hot,  ///< Decoded AudioBuffer, ready to play
+        Warm, ///< Compressed in RAM
+        Cold  ///< Compressed in a spill file (or reloaded by the entry's loader); only the head stays resident
+    };
+
+    /**
+     * @struct TieredCacheOptions
+     * @brief Budgets and policy of a @c TieredCache.
+     */
+    struct TieredCacheOptions {
+        size_t hotBytes{512u << 20};  ///< Decoded bytes allowed in the hot tier
+        size_t warmBytes{256u << 20}; ///< Compressed bytes allowed in the warm tier
+        unsigned headFrames{16384};   ///< Frames every entry keeps decoded, so notes can start at once
+        std::string spillDirectory{}; ///< Cold-tier files; empty for the system temp directory
+
+        /// Access score at which a warm or cold entry is promoted in the background. Scores are
+        /// recent accesses, halved (by @c decay) on every maintenance pass.
+        double promoteScore{2.0};
+        double decay{0.5};
+
+        bool background{true};                     ///< Run maintenance on a worker thread
+        std::chrono::milliseconds interval{100};   ///< Worker wake-up period
+    };
+
+    /**
+     * @class TieredCache
+     * @brief A sample cache larger than RAM: hot decoded buffers, warm compressed bytes, cold disk.
+     * @details Entries start in the tier they are inserted with. A maintenance pass (on the
+     *          worker thread, or @c maintain()) demotes the least-used entries while a tier is over
+     *          budget (hot to warm, warm to cold) and promotes requested or frequently used ones
+     *          back to hot. Entries whose buffer is still held elsewhere (e.g. by a playing voice)
+     *          are never demoted, since that would free nothing. Compression, decompression and
+     *          disk I/O run outside the cache lock.
+     *
+     *          None of this is for the audio thread: voices keep the buffer pointers they got, and
+     *          a note on a cold entry can start from @c head() while @c prefetch() brings the rest.
+     */
+    class TieredCache {
+    public:
+        /// Reloads a cold entry's samples from their original source instead of a spill file.
+        using Loader = std::function<std::shared_ptr<const AudioBuffer>()>;
+
+        /**
+         * @struct Usage
+         * @brief Current tier sizes and lifetime counters.
+         */
+        struct Usage {
+            size_t hotEntries{0}, warmEntries{0}, coldEntries{0};
+            size_t hotBytes{0};  ///< Decoded bytes
+            size_t warmBytes{0}; ///< Compressed bytes
+            size_t coldBytes{0}; ///< Decoded size of the cold entries (on disk, not in RAM)
+            size_t headBytes{0}; ///< Resident heads (short samples are their own head and add nothing)
+            size_t hits{0};      ///< Accesses served from the hot tier
+            size_t misses{0};
+            size_t promotions{0};
+            size_t demotions{0};
+        };
+
+        explicit TieredCache(const TieredCacheOptions& options);
+        ~TieredCache();
+
+        TieredCache(const TieredCache&) = delete;
+        TieredCache& operator=(const TieredCache&) = delete;
+
+        /**
+         * @brief Adds a buffer, placed straight into @p tier (compressing or spilling it here if needed).
+         * @details Inserting cold lets a library far larger than RAM be registered one sample at a time.
+         *          Samples no longer than @c headFrames always stay hot: their head is the whole sample.
+         * @param loader Optional; lets the entry go cold without writing a spill file.
+         * @return The key of the new entry.
+         * @throws std::invalid_argument if @p buffer is null.
+         */
+        size_t insert(std::shared_ptr<const AudioBuffer> buffer, CacheTier tier = CacheTier::Hot, Loader loader = {});
+
+        /**
+         * @brief Gets the decoded buffer, promoting the entry to hot first if necessary.
+         * @details Blocks while a warm entry decompresses or a cold one is read back.
+         * @return The buffer, or nullptr if the key is unknown or the cold data could not be read.
+         */
+        std::shared_ptr<const AudioBuffer> get(size_t key);
+
+        /**
+         * @brief Gets the decoded buffer only if the entry is hot; otherwise queues its promotion.
+         * @return The buffer, or nullptr if it is not hot (yet).
+         */
+        std::shared_ptr<const AudioBuffer> tryGet(size_t key);
+
+        /**
+         * @brief Gets the whole buffer if hot, otherwise the always-resident first @c headFrames frames.
+         */
+        std::shared_ptr<const AudioBuffer> head(size_t key);
+
+        /**
+         * @brief Queues a background promotion to hot, e.g. when an instrument is selected.
+         */
+        void prefetch(size_t key);
+
+        bool erase(size_t key);
+
+        /**
+         * @brief Gets an entry's tier; @c CacheTier::Cold for unknown keys.
+         */
+        CacheTier tier(size_t key) const;
+
+        Usage usage() const;
+
+        /**
+         * @brief Runs one maintenance pass on the calling thread: decay, demote, promote.
+         */
+        void maintain();
+
+    private:
+        struct Entry {
+            CacheTier tier{CacheTier::Hot};
+            unsigned channels{0};
+            unsigned frames{0};
+            size_t bytes{0}; // Decoded size
+
+            std::shared_ptr<const AudioBuffer> hot;
+            std::shared_ptr<const std::vector<std::uint8_t>> warm;
+            std::shared_ptr<const AudioBuffer> head;
+            Loader loader;
+            std::string spillPath; // Set once a spill file exists; kept while hot or warm
+
+            double score{0.0};
+            size_t accesses{0};       // Since the last maintenance pass
+            std::uint64_t version{0}; // Bumped on every tier change
+        };
+
+        // Decoded buffer of an entry captured outside the lock; nullptr on failure
+        static std::shared_ptr<const AudioBuffer> decode(const Entry& snapshot);
+
+        // Writes compressed samples to a spill file; returns its path, empty on failure
+        std::string spill(size_t key, const Entry& entry, const std::vector<std::uint8_t>& compressed);
+
+        // Moves an entry one tier down (hot to warm, warm to cold); false if it changed meanwhile
+        bool demote(size_t key);
+
+        // Decodes an entry into the hot tier; returns the buffer
+        std::shared_ptr<const AudioBuffer> promote(size_t key);
+
+        // Tier totals; requires the lock
+        void account(const Entry& entry, int sign);
+
+        void workerLoop();
+
+        // Demotable entries of a tier, least used first
+        std::vector<size_t> demotionOrder(CacheTier tier);
+
+        TieredCacheOptions options_;
+        std::string spillPrefix_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<size_t, Entry> entries_;
+        std::unordered_set<size_t> requested_; // Promotions asked for by tryGet()/prefetch()
+        bool overBudget_{false};               // Set when an insert or promotion overfills a tier
+        size_t nextKey_{0};
+        Usage usage_;
+
+        std::condition_variable wake_;
+        bool stopping_{false};
+        std::thread worker_;
+    };
+}
+
+#endif //TIERED_CACHE_HPP
@@ -0,0 +1,51 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef TRANSIENT_ANALYSIS_HPP
+#define TRANSIENT_ANALYSIS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "audio_buffer.hpp"
+
+namespace pipsqueak::core {
+    /**
+     * @struct TransientMap
+     * @brief Precomputed onset positions for a sample.
+     * @details Produced once at load time (see @c BufferStore::insert) so that time-stretching
+     *          voices can lock grain placement to attacks without analysing audio on the audio thread.
+     */
+    struct TransientMap {
+        /// Onset frame indices, sorted ascending.
+        std::vector<size_t> onsets;
+
+        /// The analysis hop (in frames) the onsets were quantised to.
+        size_t hopSize{0};
+
+        /// True when the material is sustained/tonal (few onsets relative to its length).
+        bool tonal{true};
+
+        /**
+         * @brief Finds the first onset inside a frame range.
+         * @param begin First frame of the range (inclusive).
+         * @param end   Last frame of the range (exclusive).
+         * @param onset Receives the onset frame when one is found.
+         * @return True if an onset lies in [begin, end).
+         */
+        bool firstOnsetIn(size_t begin, size_t end, size_t& onset) const;
+    };
+
+    /**
+     * @brief Detects onsets in a buffer using a spectral-free energy flux measure.
+     * @details The buffer is summed to mono and split into hops; a hop whose energy rises
+     *          sharply over the recent average is marked as an onset.
+     * @param buffer  The sample data to analyse.
+     * @param hopSize Analysis hop in frames.
+     * @return The detected transient map.
+     */
+    TransientMap detectTransients(const AudioBuffer& buffer, size_t hopSize = 256);
+}
+
+#endif //TRANSIENT_ANALYSIS_HPP
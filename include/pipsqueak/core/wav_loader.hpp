@@ -0,0 +1,96 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef WAV_LOADER_HPP
+#define WAV_LOADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "audio_buffer.hpp"
+#include "batch_reader.hpp"
+#include "buffer_store.hpp"
+
+namespace pipsqueak::core {
+    /**
+     * @struct WavInfo
+     * @brief The format and data location of a RIFF/WAVE file.
+     */
+    struct WavInfo {
+        unsigned channels{0};
+        unsigned sampleRate{0};
+        unsigned bitsPerSample{0};
+        bool isFloat{false};
+        std::uint64_t dataOffset{0}; // File offset of the first sample
+        std::uint64_t dataBytes{0};
+        int unityNote{-1};           // MIDI unity note from a 'smpl' chunk, -1 if there is none
+        std::uint32_t loopStart{0};  // First 'smpl' loop, in frames
+        std::uint32_t loopEnd{0};    // Exclusive; loopEnd <= loopStart means no loop
+    };
+
+    /**
+     * @brief Parses a WAVE header (PCM 16/24/32-bit or float32, including WAVE_FORMAT_EXTENSIBLE).
+     * @param bytes The start of the file.
+     * @param size Bytes available; the data chunk header must lie within them.
+     * @return The format, or nothing if the header is not a supported WAVE header.
+     */
+    std::optional<WavInfo> parseWavHeader(const std::uint8_t* bytes, size_t size);
+
+    /**
+     * @brief Reads the chunks that follow the data chunk, picking up a 'smpl' chunk into @p info.
+     * @details Editors often write sampler metadata after the audio, out of reach of the header.
+     * @param bytes The first chunk after the (padded) data chunk.
+     * @param size Bytes available; chunks running past them are ignored.
+     */
+    void parseWavTrailer(const std::uint8_t* bytes, size_t size, WavInfo& info);
+
+    /**
+     * @struct LoadedSample
+     * @brief The outcome of loading one file.
+     */
+    struct LoadedSample {
+        std::string path;
+        std::shared_ptr<const AudioBuffer> buffer; // nullptr on failure
+        unsigned sampleRate{0};
+        int unityNote{-1};                         // MIDI unity note from the file's 'smpl' chunk, -1 if none
+        std::uint32_t loopStart{0};                // First 'smpl' loop, in frames
+        std::uint32_t loopEnd{0};                  // Exclusive; loopEnd <= loopStart means no loop
+        size_t key{0};                             // BufferStore key, when a store was given
+        std::string error;                         // Empty on success
+    };
+
+    /**
+     * @struct WavLoadOptions
+     * @brief Tuning for bulk loads.
+     */
+    struct WavLoadOptions {
+        size_t chunkBytes{1u << 20}; ///< Size of each read
+        bool direct{false};          ///< Open with O_DIRECT (bypass the page cache) where supported
+        BufferStore::InsertOptions insert{};
+    };
+
+    /**
+     * @brief Loads many WAVE files at once through @p reader.
+     * @details Headers for every file are read in one batch, then all data chunks of all files
+     *          are kept in flight together (up to the reader's queue depth), each converted to
+     *          float as soon as it lands. Reads are block aligned into page-aligned staging
+     *          (the reader's registered arena when it is large enough), so O_DIRECT works.
+     *          A 'smpl' chunk before the data, or after it (one more batched read per file whose
+     *          trailing chunks lie beyond the header read), fills the unity note and loop.
+     *
+     *          The reader is used exclusively for the duration of the call: it must be idle on
+     *          entry (no reads in flight) and no other thread may use it until this returns.
+     *          A busy reader fails every path with "reader is busy".
+     * @param store If given, every successfully loaded buffer is inserted and its key reported.
+     * @return One entry per path, in the same order.
+     */
+    std::vector<LoadedSample> loadWavFiles(BatchReader& reader, const std::vector<std::string>& paths,
+                                           BufferStore* store = nullptr, const WavLoadOptions& options = {});
+}
+
+#endif //WAV_LOADER_HPP
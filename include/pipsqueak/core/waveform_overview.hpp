@@ -0,0 +1,115 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef WAVEFORM_OVERVIEW_HPP
+#define WAVEFORM_OVERVIEW_HPP
+
+#include <cstddef>
+#include <limits>
+#include <shared_mutex>
+#include <vector>
+
+#include "audio_buffer.hpp"
+
+namespace pipsqueak::core {
+    /**
+     * @struct WaveformOverviewOptions
+     * @brief Shape of a @c WaveformOverview pyramid.
+     */
+    struct WaveformOverviewOptions {
+        unsigned baseFrames{64}; ///< Frames per level-0 bucket (the finest resolution)
+        unsigned fanout{4};      ///< Buckets merged into each bucket of the next level
+    };
+
+    /**
+     * @class WaveformOverview
+     * @brief Multi-resolution min/max/RMS pyramid of a sample, for drawing waveforms at any zoom.
+     * @details Level 0 summarises blocks of @c WaveformOverviewOptions::baseFrames frames; each level above
+     *          merges @c WaveformOverviewOptions::fanout buckets of the one below. A query decomposes every
+     *          pixel's frame range into whole buckets taken from the coarsest levels that fit,
+     *          so its cost depends on the number of pixels, not on how many frames they span.
+     *
+     *          The pyramid can grow: @c append() extends it with new frames (e.g. from a live
+     *          recording) and only rebuilds the buckets those frames touch. Appends and queries
+     *          may run on different threads; neither is meant for the audio thread.
+     */
+    class WaveformOverview {
+    public:
+        /**
+         * @struct Column
+         * @brief The summary of one pixel column.
+         */
+        struct Column {
+            float min{0.0f};
+            float max{0.0f};
+            float rms{0.0f};
+        };
+
+        /// Pass as the channel to @c query() to merge all channels into each column.
+        static constexpr unsigned kAllChannels = std::numeric_limits<unsigned>::max();
+
+        /**
+         * @brief Creates an empty overview for @p channels interleaved channels.
+         * @throws std::invalid_argument if channels is 0, baseFrames is 0 or fanout is below 2.
+         */
+        explicit WaveformOverview(unsigned channels, const WaveformOverviewOptions& options = {});
+
+        /**
+         * @brief Builds the overview of a whole buffer.
+         */
+        static WaveformOverview build(const AudioBuffer& buffer, const WaveformOverviewOptions& options = {});
+
+        WaveformOverview(WaveformOverview&& other) noexcept;
+
+        /**
+         * @brief Extends the overview with @p frames interleaved frames.
+         * @details Bucket statistics come from the vectorised @c KernelTable::blockMinMax; the
+         *          partially filled last bucket of each level is merged, not recomputed.
+         */
+        void append(const Sample* interleaved, size_t frames);
+
+        /**
+         * @brief Summarises [startFrame, endFrame) in @p pixels equal columns.
+         * @details Column edges are rounded outwards to level-0 buckets, so when a pixel spans
+         *          fewer than @c baseFrames frames neighbouring columns repeat the same bucket
+         *          (draw the samples themselves at that zoom). Columns past the end of the data
+         *          are zeroed.
+         * @param channel A channel index, or @c kAllChannels.
+         * @return The number of columns that cover data.
+         * @throws std::invalid_argument if channel is out of range.
+         */
+        size_t query(unsigned channel, size_t startFrame, size_t endFrame, Column* out, size_t pixels) const;
+
+        [[nodiscard]] unsigned channels() const noexcept { return channels_; }
+        [[nodiscard]] size_t frames() const;
+        [[nodiscard]] size_t levels() const;
+        [[nodiscard]] const WaveformOverviewOptions& options() const noexcept { return options_; }
+
+        /// Bytes held by the pyramid.
+        [[nodiscard]] size_t memoryBytes() const;
+
+    private:
+        // One level of the pyramid; arrays are indexed bucket * channels + channel.
+        struct Level {
+            std::vector<float> min;
+            std::vector<float> max;
+            std::vector<float> sumSquares;
+
+            [[nodiscard]] size_t buckets(unsigned channels) const { return min.size() / channels; }
+        };
+
+        // Rebuilds the levels above 0 from level-0 bucket 'from' onwards
+        void propagate(size_t from);
+
+        unsigned channels_;
+        WaveformOverviewOptions options_;
+        size_t frames_{0};
+        std::vector<Level> levels_;
+
+        // Appends are exclusive; queries share
+        mutable std::shared_mutex mutex_;
+    };
+}
+
+#endif //WAVEFORM_OVERVIEW_HPP
@@ -0,0 +1,29 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef AUDIO_PROCESSOR_HPP
+#define AUDIO_PROCESSOR_HPP
+
+#include "pipsqueak/core/audio_buffer.hpp"
+
+namespace pipsqueak::dsp {
+    /**
+     * @class AudioProcessor
+     * @brief An in-place effect stage (reverb, delay, EQ, ...).
+     * @details Unlike an AudioSource, which adds its output into a buffer, a processor
+     *          transforms the buffer it is given.
+     */
+    class AudioProcessor {
+    public:
+        virtual ~AudioProcessor() = default;
+
+        /**
+         * @brief Process audio in place.
+         * @param buffer The buffer to read from and write the processed result back into.
+         */
+        virtual void process(core::AudioBuffer& buffer) = 0;
+    };
+}
+
+#endif //AUDIO_PROCESSOR_HPP
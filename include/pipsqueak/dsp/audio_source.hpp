@@ -19,6 +19,13 @@ namespace pipsqueak::dsp {
         virtual void process(core::AudioBuffer& buffer) = 0;
 
         virtual bool isFinished() const = 0;
+
+        /**
+         * @brief Whether the source posts its own SourceFinished event (e.g. a Sampler with an
+         *        event sink), stamped at the exact frame.
+         * @details A Mixer neither polls such an input for its end nor reports it again.
+         */
+        [[nodiscard]] virtual bool postsOwnEvents() const { return false; }
     };
 }
 
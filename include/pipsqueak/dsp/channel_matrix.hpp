@@ -0,0 +1,106 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef CHANNEL_MATRIX_HPP
+#define CHANNEL_MATRIX_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "pipsqueak/core/audio_buffer.hpp"
+
+namespace pipsqueak::dsp {
+    /**
+     * @struct ChannelLayout
+     * @brief Describes the speaker meaning of each channel in an interleaved buffer.
+     * @details Channel orders follow the WAVE/SMPTE convention:
+     *          - Stereo: L R
+     *          - 5.1:    L R C LFE Ls Rs
+     *          - 7.1:    L R C LFE Lb Rb Ls Rs
+     *          Discrete layouts carry no speaker meaning and are routed index-for-index.
+     */
+    struct ChannelLayout {
+        enum class Kind { Mono, Stereo, Surround51, Surround71, Discrete };
+
+        Kind kind{Kind::Discrete};
+        unsigned channels{0};
+
+        static ChannelLayout mono() { return {Kind::Mono, 1}; }
+        static ChannelLayout stereo() { return {Kind::Stereo, 2}; }
+        static ChannelLayout surround51() { return {Kind::Surround51, 6}; }
+        static ChannelLayout surround71() { return {Kind::Surround71, 8}; }
+        static ChannelLayout discrete(const unsigned numChannels) { return {Kind::Discrete, numChannels}; }
+
+        /**
+         * @brief Guesses the standard layout for a bare channel count (1, 2, 6, 8), else discrete.
+         * @note Meant for sample files, whose channel count is a reliable hint. Device channel
+         *       counts are not: use @c discrete() for those unless the speaker layout is known.
+         */
+        static ChannelLayout fromChannelCount(unsigned numChannels);
+
+        bool operator==(const ChannelLayout& other) const {
+            return kind == other.kind && channels == other.channels;
+        }
+        bool operator!=(const ChannelLayout& other) const { return !(*this == other); }
+    };
+
+    /**
+     * @class ChannelMatrix
+     * @brief A precomputed up/down-mix from one channel layout to another.
+     * @details Coefficients are built once at construction (off the audio thread). The mixing
+     *          kernel is also chosen at construction: common shapes (identity, 1→2, 2→1, 5.1→2,
+     *          7.1→2, ...) use compile-time specialised loops the compiler can fully unroll and
+     *          vectorise; everything else uses a generic fallback.
+     */
+    class ChannelMatrix {
+    public:
+        /**
+         * @brief Builds the standard mix between two layouts.
+         */
+        ChannelMatrix(ChannelLayout source, ChannelLayout destination);
+
+        [[nodiscard]] const ChannelLayout& source() const noexcept { return source_; }
+        [[nodiscard]] const ChannelLayout& destination() const noexcept { return destination_; }
+        [[nodiscard]] unsigned sourceChannels() const noexcept { return source_.channels; }
+        [[nodiscard]] unsigned destinationChannels() const noexcept { return destination_.channels; }
+
+        /**
+         * @brief Gets the gain applied from a source channel to a destination channel.
+         */
+        [[nodiscard]] float coefficient(unsigned destinationChannel, unsigned sourceChannel) const;
+
+        /**
+         * @brief Mixes interleaved source frames into interleaved destination frames (additive).
+         * @param in  Source frames, @c sourceChannels() samples per frame.
+         * @param out Destination frames, @c destinationChannels() samples per frame.
+         * @param frames Number of frames to mix.
+         * @param gain Extra linear gain applied on top of the matrix.
+         */
+        void accumulate(const core::Sample* in, core::Sample* out, size_t frames, float gain = 1.0f) const noexcept;
+
+        /**
+         * @brief Mixes a whole source buffer into a destination buffer (additive).
+         * @details Mixes min(in.numFrames(), out.numFrames()) frames. Does nothing if the
+         *          buffers' channel counts do not match the matrix shape.
+         */
+        void accumulate(const core::AudioBuffer& in, core::AudioBuffer& out, float gain = 1.0f) const noexcept;
+
+    private:
+        using Kernel = void (*)(const float* coeffs, unsigned srcCh, unsigned dstCh,
+                                const core::Sample* in, core::Sample* out, size_t frames, float gain);
+
+        // Picks the specialised kernel for this matrix's shape
+        void selectKernel();
+
+        ChannelLayout source_;
+        ChannelLayout destination_;
+
+        // Row-major [destination][source] coefficients
+        std::vector<float> coeffs_;
+
+        Kernel kernel_{nullptr};
+    };
+}
+
+#endif //CHANNEL_MATRIX_HPP
@@ -0,0 +1,171 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef COMPILED_GRAPH_HPP
+#define COMPILED_GRAPH_HPP
+
+#include "audio_source.hpp"
+#include "oscillator.hpp"
+#include "sampler.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace pipsqueak::dsp {
+    /**
+     * @class CompiledGraph
+     * @brief A fixed tree of audio nodes stored by value and processed in type-batched loops.
+     * @details A Mixer holds every input behind a @c shared_ptr and reaches it through virtual
+     *          calls, and @c Mixer::isFinished() walks the whole tree. For graphs of thousands of
+     *          small nodes that indirection dominates. A CompiledGraph instead keeps each known
+     *          node kind in its own contiguous array:
+     *          - Sampler and Oscillator leaves are stored by value and called directly (both
+     *            classes are final, so there is no virtual dispatch);
+     *          - buses (summing points with a gain, also used as plain gain stages) are a flat
+     *            array ordered parent-before-child, so one reverse sweep folds the tree;
+     *          - arbitrary AudioSource nodes remain available for extensions and are the only
+     *            nodes called virtually.
+     *
+     *          Each block runs one loop per node kind. Leaves accumulate straight into their
+     *          parent bus, and the number of unfinished leaves is kept as a running count, so
+     *          @c isFinished() is O(1).
+     *
+     *          The topology is fixed once built. Node parameters (@c sampler(), @c oscillator(),
+     *          @c noteOn()) are not synchronised with @c process(), the same contract as
+     *          driving a Sampler directly; bus gains may be set from any thread.
+     */
+    class CompiledGraph final : public AudioSource {
+    public:
+        enum class NodeKind : std::uint8_t { Bus, Sampler, Oscillator, Source };
+
+        /**
+         * @brief Identifies a node: its kind and its index within that kind's array.
+         */
+        struct NodeId {
+            NodeKind kind{NodeKind::Bus};
+            std::uint32_t index{0};
+        };
+
+        /**
+         * @class Builder
+         * @brief Collects nodes and their parent buses, then produces the graph.
+         * @details A builder starts with a root bus, which is the graph output. Every node names
+         *          its parent when added, so the result is always a tree.
+         */
+        class Builder {
+        public:
+            Builder();
+
+            /** @brief The root bus (the graph output). */
+            [[nodiscard]] NodeId root() const noexcept { return {NodeKind::Bus, 0}; }
+
+            /**
+             * @brief Adds a summing bus (or gain stage) under @p parent.
+             * @throws std::invalid_argument if @p parent is not a bus of this builder.
+             */
+            NodeId addBus(NodeId parent, float gain = 1.0f);
+
+            /**
+             * @brief Adds a sampler, stored by value, under @p parent.
+             * @throws std::invalid_argument if @p parent is not a bus of this builder.
+             */
+            NodeId addSampler(NodeId parent, Sampler sampler);
+
+            /**
+             * @brief Adds an oscillator, stored by value, under @p parent.
+             * @throws std::invalid_argument if @p parent is not a bus of this builder.
+             */
+            NodeId addOscillator(NodeId parent, Oscillator oscillator);
+
+            /**
+             * @brief Adds an arbitrary (virtually dispatched) source under @p parent.
+             * @throws std::invalid_argument if @p parent is not a bus of this builder, or @p source is null.
+             */
+            NodeId addSource(NodeId parent, std::shared_ptr<AudioSource> source);
+
+            /**
+             * @brief Moves the collected nodes into a new graph. The builder is left empty.
+             */
+            [[nodiscard]] std::shared_ptr<CompiledGraph> build();
+
+        private:
+            friend class CompiledGraph;
+
+            // Validates a parent id and returns its bus index
+            [[nodiscard]] std::uint32_t busIndex(NodeId parent) const;
+
+            std::vector<float> busGains_;
+            std::vector<std::uint32_t> busParents_; // Root's parent is itself (index 0)
+            std::vector<Sampler> samplers_;
+            std::vector<std::uint32_t> samplerParents_;
+            std::vector<Oscillator> oscillators_;
+            std::vector<std::uint32_t> oscillatorParents_;
+            std::vector<std::shared_ptr<AudioSource>> sources_;
+            std::vector<std::uint32_t> sourceParents_;
+        };
+
+        /**
+         * @brief Renders every node and mixes the root bus into @p buffer (additive).
+         */
+        void process(core::AudioBuffer& buffer) override;
+
+        /**
+         * @brief True once every leaf has finished (O(1)).
+         */
+        [[nodiscard]] bool isFinished() const override;
+
+        /**
+         * @brief The number of leaves that were still producing audio after the last block
+         *        (or were started since).
+         */
+        [[nodiscard]] size_t activeLeaves() const noexcept;
+
+        /**
+         * @brief Starts a note on a sampler node and counts it as active immediately.
+         */
+        void noteOn(NodeId sampler, int note, float velocity);
+
+        /**
+         * @brief Thread-safely sets a bus gain.
+         */
+        void setBusGain(NodeId bus, float gain);
+
+        /** @brief Direct access to a sampler node's parameters. */
+        [[nodiscard]] Sampler& sampler(NodeId node);
+
+        /** @brief Direct access to an oscillator node's parameters. */
+        [[nodiscard]] Oscillator& oscillator(NodeId node);
+
+        /** @brief The number of nodes of one kind (buses include the root). */
+        [[nodiscard]] size_t count(NodeKind kind) const noexcept;
+
+    private:
+        explicit CompiledGraph(Builder&& builder);
+
+        // The buffer a bus accumulates into this block (the output itself for a unity root)
+        core::AudioBuffer& target(std::uint32_t bus, core::AudioBuffer& output);
+
+        // Topology and gains (buses ordered parent-before-child)
+        std::unique_ptr<std::atomic<float>[]> busGains_;
+        std::vector<std::uint32_t> busParents_;
+
+        // Node arrays, one per kind, with each node's parent bus alongside
+        std::vector<Sampler> samplers_;
+        std::vector<std::uint32_t> samplerParents_;
+        std::vector<Oscillator> oscillators_;
+        std::vector<std::uint32_t> oscillatorParents_;
+        std::vector<std::shared_ptr<AudioSource>> sources_;
+        std::vector<std::uint32_t> sourceParents_;
+
+        // Leaves still producing audio, recounted by each block's batch loops
+        std::atomic<size_t> activeLeaves_{0};
+
+        // Audio-thread bus buffers, reshaped only when the block shape changes
+        std::vector<std::unique_ptr<core::AudioBuffer>> busBuffers_;
+        bool rootDirect_{false};
+    };
+}
+
+#endif //COMPILED_GRAPH_HPP
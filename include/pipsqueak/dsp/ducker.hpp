@@ -0,0 +1,46 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef DUCKER_HPP
+#define DUCKER_HPP
+
+#include "sidechain_source.hpp"
+#include <memory>
+
+namespace pipsqueak::dsp {
+    /**
+     * @class Ducker
+     * @brief Attenuates its input while a sidechain key is loud (e.g. music under a voice-over).
+     * @details A peak envelope follower (instant attack, exponential release) tracks the first
+     *          sidechain input. The input is attenuated by up to @c depth as the envelope rises
+     *          towards @c threshold. Without a connected sidechain the input passes unchanged.
+     */
+    class Ducker final : public SidechainSource {
+    public:
+        /**
+         * @param input The source to duck.
+         * @param threshold Key level at which full ducking is reached.
+         * @param depth Maximum attenuation, 0 (none) .. 1 (silence).
+         * @param releaseFrames Frames for the envelope to fall by ~63% once the key stops.
+         */
+        Ducker(std::shared_ptr<AudioSource> input, float threshold, float depth, float releaseFrames = 4800.0f);
+
+        using SidechainSource::process;
+        void process(core::AudioBuffer& buffer, const SidechainInputs& sidechains) override;
+
+        [[nodiscard]] bool isFinished() const override;
+
+    private:
+        std::shared_ptr<AudioSource> input_;
+        float threshold_;
+        float depth_;
+        float releaseCoeff_;
+        float envelope_{0.0f};
+
+        // Audio-thread scratch holding the unducked input for the current block.
+        std::unique_ptr<core::AudioBuffer> scratch_;
+    };
+}
+
+#endif //DUCKER_HPP
@@ -5,17 +5,52 @@
 #ifndef MIXER_HPP
 #define MIXER_HPP
 
+#include "audio_processor.hpp"
 #include "audio_source.hpp"
+#include "channel_matrix.hpp"
+#include "sidechain_source.hpp"
+#include "pipsqueak/core/command_bus.hpp"
+#include "pipsqueak/core/event_ring.hpp"
+#include "pipsqueak/core/fork_join_pool.hpp"
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <atomic>
 
 namespace pipsqueak::dsp {
+    /**
+     * @brief Where an aux send taps its input's signal.
+     */
+    enum class SendTiming {
+        PreFader, ///< Before the input gain; the send level alone sets the bus contribution.
+        PostFader ///< After the input gain; fading the input also fades the send.
+    };
+
     /**
      * @class Mixer
      * @brief An AudioSource that mixes the output of multiple other AudioSources.
      * @details Acts as a summing bus, allowing multiple sounds to be played
      * simultaneously. This class is thread-safe for adding and removing sources.
+     *
+     * Inputs may also feed named aux buses through pre- or post-fader sends. Each aux bus
+     * accumulates its sends, runs its return chain once per block, and is summed back into
+     * the output, so one heavy effect instance serves any number of inputs.
+     *
+     * A SidechainSource input can be keyed from other inputs (@c setSidechains()). Inputs are
+     * then evaluated in dependency order, and the keys' rendered buffers are handed to the
+     * dependent node as read-only views.
+     *
+     * By default every change is published to the audio thread immediately. With a command
+     * bus attached (@c setCommandBus()), changes are staged as versioned snapshots on the
+     * calling thread and installed by the audio thread when it drains the bus; the replaced
+     * snapshot is released back on the control side.
+     *
+     * With a render pool (@c setRenderPool()) the mixer renders deterministically: every input
+     * renders into its own buffer, independent inputs in parallel, and the buffers are then
+     * summed in a fixed order. The output is bit-identical for any pool size and from run to
+     * run, though not to the default mode, which lets sources sum straight into the output.
      */
     class Mixer final : public AudioSource {
     public:
@@ -27,13 +62,103 @@ namespace pipsqueak::dsp {
         /**
          * @brief Thread-safely adds a new audio source to the mixer.
          * @param source The source to add.
+         * @return False if a command bus is attached and full; the source is not added.
+         */
+        bool addSource(std::shared_ptr<AudioSource> source);
+
+        /**
+         * @brief Thread-safely adds a source whose channel layout differs from the mixer output.
+         * @details The source renders into a scratch buffer in its own layout, which is then
+         *          summed into the output through @p matrix. The matrix's destination channel
+         *          count must match the buffers passed to @c process().
+         * @param source The source to add.
+         * @param matrix The precomputed up/down-mix from the source layout to the output layout.
+         * @return False if a command bus is attached and full; the source is not added.
          */
-        void addSource(std::shared_ptr<AudioSource> source);
+        bool addSource(std::shared_ptr<AudioSource> source, ChannelMatrix matrix);
 
         /**
          * @brief Thread-safely removes all audio sources from the mixer.
+         * @note Aux buses are kept.
+         * @return False if a command bus is attached and full; nothing is removed.
+         */
+        bool clearSources();
+
+        /**
+         * @brief Thread-safely adds a named aux bus.
+         * @param name The bus name used by @c setSend(). Adding an existing name replaces its return chain.
+         * @param returnChain Processors run in order on the bus once per block.
+         * @param returnLevel Linear gain applied when the processed bus is summed into the output.
+         * @return False if a command bus is attached and full; the bus is not added.
+         */
+        bool addAuxBus(const std::string& name, std::vector<std::shared_ptr<AudioProcessor>> returnChain,
+                       float returnLevel = 1.0f);
+
+        /**
+         * @brief Thread-safely sets an input's fader gain.
+         * @return False if @p source is not an input of this mixer.
          */
-        void clearSources();
+        bool setSourceGain(const std::shared_ptr<AudioSource>& source, float gain);
+
+        /**
+         * @brief Thread-safely creates or updates a send from an input to an aux bus.
+         * @param source The input to send from.
+         * @param bus The aux bus name.
+         * @param level Linear send level (0 removes the send).
+         * @param timing Pre- or post-fader tap.
+         * @return False if the input or the bus does not exist.
+         */
+        bool setSend(const std::shared_ptr<AudioSource>& source, const std::string& bus, float level,
+                     SendTiming timing = SendTiming::PostFader);
+
+        /**
+         * @brief Thread-safely connects sidechain keys to a SidechainSource input.
+         * @details Replaces any previous connection. Keys must also be inputs of this mixer;
+         *          they are rendered before @p node each block.
+         * @param node An input of this mixer that derives from SidechainSource.
+         * @param keys Inputs of this mixer, in the order the node sees them.
+         * @return False if @p node is not a SidechainSource input, a key is not an input,
+         *         or the connection would create a cycle.
+         */
+        bool setSidechains(const std::shared_ptr<AudioSource>& node,
+                           const std::vector<std::shared_ptr<AudioSource>>& keys);
+
+        /**
+         * @brief Routes subsequent changes through @p bus instead of publishing them directly.
+         * @details Pass nullptr to publish directly again. Must not be called while other
+         *          threads are changing the mixer, nor while installs are still pending.
+         *
+         *          A change that does not fit in the bus is dropped and its call returns false;
+         *          the bus only makes room as the audio thread drains it.
+         */
+        void setCommandBus(core::CommandBus* bus);
+
+        /**
+         * @brief Posts a SourceFinished event to @p events whenever an input plays out.
+         * @details The event is stamped at the end of the block in which the input finished.
+         *          Inputs that post their own (@c AudioSource::postsOwnEvents(), e.g. a Sampler
+         *          with a sink, stamped at the exact frame) are neither polled nor reported
+         *          twice. Set before rendering starts; events are posted from the rendering
+         *          thread, which must be the ring's only producer.
+         */
+        void setEventSink(core::EventRing* events);
+
+        /**
+         * @brief Switches to deterministic parallel rendering on @p pool (nullptr: the default mode).
+         * @details Inputs with no sidechain dependency between them render concurrently; the
+         *          sums (output, aux buses, returns) are split into fixed frame ranges, each added
+         *          up in input order. Nothing about the result depends on the thread count, so
+         *          offline renders stay reproducible for golden-file and null tests. Events that
+         *          sources post themselves (e.g. through @c Sampler::setEventSink()) are captured
+         *          per input on the workers and forwarded from the calling thread in evaluation
+         *          order. Set before rendering starts.
+         */
+        void setRenderPool(std::shared_ptr<core::ForkJoinPool> pool);
+
+        /**
+         * @brief The version of the state the audio thread currently renders (one per change).
+         */
+        [[nodiscard]] std::uint64_t version() const;
 
         /**
          * @brief Renders audio by summing the output of all contained sources.
@@ -48,9 +173,114 @@ namespace pipsqueak::dsp {
         [[nodiscard]] bool isFinished() const override;
 
     private:
-        // A thread-safe pointer to the read-only list of sources for the audio thread.
-        std::shared_ptr<const std::vector<std::shared_ptr<AudioSource>>> activeSources_;
+        // A send from one input into an aux bus (by index into State::buses).
+        struct Send {
+            size_t bus;
+            float level;
+            SendTiming timing;
+        };
+
+        // A source together with its optional layout conversion and channel strip.
+        struct Input {
+            std::shared_ptr<AudioSource> source;
+            std::shared_ptr<const ChannelMatrix> matrix; // nullptr: source renders in the output layout
+            float gain{1.0f};
+            std::vector<Send> sends;
+
+            // Sidechain wiring (indices into State::inputs)
+            SidechainSource* sidechainNode{nullptr}; // Set when source is a SidechainSource
+            std::vector<size_t> sidechains;          // Keys this input reads
+            int tap{-1};                             // Tap buffer slot when another input reads this one
+
+            // Audio-thread flag shared by every state copy: was the source playing last block?
+            std::shared_ptr<bool> playing{std::make_shared<bool>(false)};
+        };
+
+        // A shared effect return.
+        struct AuxBus {
+            std::string name;
+            std::vector<std::shared_ptr<AudioProcessor>> returnChain;
+            float returnLevel{1.0f};
+        };
+
+        // Render buffers for one State, built with it on the control thread. The audio thread
+        // only reshapes them when the block shape or the render mode differs from the build.
+        struct Buffers {
+            unsigned channels{0}; // Output shape the buffers were built for (0: not yet known)
+            unsigned frames{0};
+            bool perInput{false};  // Deterministic mode: one buffer per input
+
+            // Per input: its buffer in slots, or -1 to render straight into the output. In the
+            // default mode sidechain keys get their own slot and other inputs share one per width.
+            std::vector<int> slotOf;
+            std::vector<unsigned> slotWidth; // Source channels per slot (0: the output width)
+            std::vector<std::unique_ptr<core::AudioBuffer>> slots;
+            std::vector<std::unique_ptr<core::AudioBuffer>> aux; // One accumulation buffer per bus
+
+            // Per input: its keys' buffers, the finished flag and (deterministic) captured events.
+            std::vector<std::vector<const core::AudioBuffer*>> views;
+            std::vector<char> finished;
+            std::vector<core::EventCapture> captures;
+        };
+
+        // Everything the audio thread needs for one block; replaced wholesale on every change.
+        struct State {
+            std::vector<Input> inputs;
+            std::vector<AuxBus> buses;
+            std::shared_ptr<Buffers> buffers;
+
+            // Evaluation order (keys before their dependents) and the number of tap buffers.
+            std::vector<size_t> order;
+            size_t numTaps{0};
+
+            // Deterministic mode: inputs grouped by dependency depth; each group renders in parallel.
+            std::vector<size_t> waves;
+            std::vector<size_t> waveEnds;
+
+            std::uint64_t version{0};
+        };
+
+        // Recomputes the evaluation order and tap slots; returns false on a dependency cycle.
+        static bool schedule(State& state);
+
+        // Assigns buffer slots for the render mode and sizes the per-input tables (allocates).
+        static void layoutBuffers(const State& state, Buffers& buffers, bool perInput);
+
+        // Allocates every slot and aux buffer for the given output shape and repoints the views.
+        static void shapeBuffers(const State& state, Buffers& buffers, unsigned channels, unsigned frames);
+
+        // The state's buffers for this block; rebuilt in place only on a shape or mode change.
+        Buffers& buffersFor(const State& state, unsigned channels, unsigned frames);
+
+        // Deterministic-mode process(): isolated renders, fixed-order sums.
+        void processDeterministic(const State& state, core::AudioBuffer& buffer);
+
+        // Copy-on-write helper: copies the live state, lets @p edit modify it, publishes the result.
+        template <typename Edit>
+        bool update(Edit&& edit);
+
+        // Command hooks: swap a staged state in on the audio thread, release the old one on the control side.
+        static void installState(core::Command& command);
+        static void retireState(core::Command& command);
+
+        // A thread-safe pointer to the read-only state for the audio thread.
+        std::shared_ptr<const State> state_;
+
+        core::EventRing* events_{nullptr};
+
+        // Command-bus staging: the newest posted (not necessarily installed) state.
+        core::CommandBus* bus_{nullptr};
+        std::mutex stageMutex_;
+        std::shared_ptr<const State> staged_;
+
+        // The last block shape rendered ((channels << 32) | frames), so update() can build
+        // each State's buffers ahead of the audio thread. 0 until the first block.
+        std::atomic<std::uint64_t> blockShape_{0};
+
+        // Deterministic mode's pool; finished flags and source events are posted from the
+        // calling thread only.
+        std::shared_ptr<core::ForkJoinPool> pool_;
     };
 }
 
-#endif //MIXER_HPP
\ No newline at end of file
+#endif //MIXER_HPP
@@ -0,0 +1,63 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef OSCILLATOR_HPP
+#define OSCILLATOR_HPP
+
+#include "audio_source.hpp"
+
+namespace pipsqueak::dsp {
+    /**
+     * @brief The shape of an Oscillator's cycle.
+     */
+    enum class Waveform {
+        Sine,
+        Saw,     ///< Rising ramp from -1 to 1 (not band-limited).
+        Square,  ///< +1 for the first half cycle, -1 for the second (not band-limited).
+        Triangle
+    };
+
+    /**
+     * @class Oscillator
+     * @brief A free-running periodic source (test tones, LFO-rate signals, simple synth layers).
+     * @details Writes the same signal to every output channel. The phase is kept in cycles
+     *          and wrapped every sample, so long runs do not lose precision.
+     */
+    class Oscillator final : public AudioSource {
+    public:
+        /**
+         * @brief Constructs an oscillator.
+         * @param waveform Cycle shape.
+         * @param frequency Frequency in Hz.
+         * @param sampleRate Output sample rate in Hz.
+         * @param amplitude Linear peak amplitude.
+         */
+        Oscillator(Waveform waveform, double frequency, double sampleRate, float amplitude = 1.0f);
+
+        void setFrequency(double frequency);
+        void setAmplitude(float amplitude);
+
+        /**
+         * @brief Stops (or restarts) output; a stopped oscillator reports finished.
+         */
+        void setRunning(bool running);
+
+        /**
+         * @brief Mixes the next block of the waveform into every channel of @p buffer.
+         */
+        void process(core::AudioBuffer& buffer) override;
+
+        [[nodiscard]] bool isFinished() const override;
+
+    private:
+        Waveform waveform_;
+        double sampleRate_;
+        double increment_{0.0}; // Cycles per sample
+        double phase_{0.0};     // Position in the cycle, [0, 1)
+        float amplitude_;
+        bool running_{true};
+    };
+}
+
+#endif //OSCILLATOR_HPP
@@ -0,0 +1,100 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef PANNER_HPP
+#define PANNER_HPP
+
+#include "audio_source.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace pipsqueak::dsp {
+    /**
+     * @brief How a Panner distributes its source over the output channels.
+     */
+    enum class PanningMode {
+        Vbap,       ///< Pairwise constant-power panning over a horizontal speaker ring.
+        Ambisonic1, ///< First-order ambisonic encoding (ACN/SN3D, 4 channels).
+        Ambisonic3  ///< Third-order ambisonic encoding (ACN/SN3D, 16 channels).
+    };
+
+    /**
+     * @class Panner
+     * @brief An AudioSource that spatialises a mono input across many output channels.
+     * @details The input is rendered to a mono scratch buffer, then multiplied into every
+     *          output channel by a per-channel gain. Gains are recomputed at block rate only
+     *          when the direction changes, and ramp linearly across the block to avoid zipper
+     *          noise. In VBAP mode only the few channels with non-zero gain are touched, so
+     *          cost per source does not grow with the speaker count.
+     */
+    class Panner final : public AudioSource {
+    public:
+        /**
+         * @brief Constructs a panner.
+         * @param input The mono source to spatialise (multichannel sources are downmixed).
+         * @param mode  VBAP or ambisonic encoding.
+         * @param speakerAzimuths Speaker azimuths in degrees (VBAP only; counter-clockwise, 0 = front).
+         */
+        Panner(std::shared_ptr<AudioSource> input, PanningMode mode,
+               std::vector<double> speakerAzimuths = {});
+
+        /**
+         * @brief Thread-safely sets the source direction.
+         * @param azimuthDegrees   Horizontal angle, counter-clockwise from the front.
+         * @param elevationDegrees Vertical angle (ambisonic modes only).
+         */
+        void setDirection(double azimuthDegrees, double elevationDegrees = 0.0);
+
+        /**
+         * @brief The number of output channels this panner writes (speakers or ambisonic components).
+         */
+        [[nodiscard]] unsigned outputChannels() const noexcept;
+
+        /**
+         * @brief Renders the input and mixes it spatialised into @p buffer.
+         */
+        void process(core::AudioBuffer& buffer) override;
+
+        [[nodiscard]] bool isFinished() const override;
+
+        /**
+         * @brief Computes the gains for a direction without touching the smoothing state.
+         * @return One gain per output channel.
+         */
+        [[nodiscard]] std::vector<float> gainsFor(double azimuthDegrees, double elevationDegrees) const;
+
+    private:
+        // Writes the target gains for a direction into out (outputChannels() entries).
+        void computeGains(double azimuthDegrees, double elevationDegrees, float* out) const;
+
+        // Packs/unpacks a direction so it can be published in one atomic store.
+        static std::uint64_t packDirection(float azimuth, float elevation) noexcept;
+        static void unpackDirection(std::uint64_t packed, float& azimuth, float& elevation) noexcept;
+
+        std::shared_ptr<AudioSource> input_;
+        PanningMode mode_;
+
+        // VBAP speaker ring, sorted by azimuth (radians) with the original channel index.
+        struct Speaker {
+            double azimuth;
+            unsigned channel;
+        };
+        std::vector<Speaker> ring_;
+        unsigned channels_{0};
+
+        // Control -> audio direction handoff
+        std::atomic<std::uint64_t> direction_;
+        std::uint64_t appliedDirection_{~0ull};
+
+        // Audio-thread state
+        std::vector<float> current_;          // Gains reached at the end of the last block
+        std::vector<float> target_;           // Gains for the latest direction
+        std::vector<unsigned> activeChannels_; // Channels with a non-zero start or end gain
+        std::unique_ptr<core::AudioBuffer> scratch_;
+    };
+}
+
+#endif //PANNER_HPP
@@ -6,6 +6,8 @@
 #define SAMPLER_HPP
 #include "audio_source.hpp"
 #include "pipsqueak/core/audio_buffer.hpp"
+#include "pipsqueak/core/event_ring.hpp"
+#include "pipsqueak/core/sample_analysis.hpp"
 #include <memory>
 
 #include "sampler_voice.hpp"
@@ -20,6 +22,15 @@ namespace pipsqueak::dsp {
         void setRootNote(int note);
         void setTuneCents(double cents);
 
+        /**
+         * @brief Switches between resampling and pitch-preserving (time-stretch) playback.
+         * @param mode Playback mode for subsequent notes.
+         * @param stretchRatio Output duration / source duration in TimeStretch mode.
+         * @param transients Optional precomputed onsets (see @c BufferStore::transients()).
+         */
+        void setPlaybackMode(PlaybackMode mode, double stretchRatio = 1.0,
+                             std::shared_ptr<const core::TransientMap> transients = nullptr);
+
         /**
          * @brief Renders the next block of audio into the output buffer.
          * @param buffer The buffer to mix audio into.
@@ -32,10 +43,33 @@ namespace pipsqueak::dsp {
          */
         [[nodiscard]] bool isFinished() const override;
 
+        /**
+         * @brief Attaches the sample's load-time analysis (see @c BufferStore::metadata()).
+         * @param skipLeadingSilence Start notes at the first audible frame instead of frame 0.
+         */
+        void setMetadata(std::shared_ptr<const core::SampleMetadata> metadata, bool skipLeadingSilence = true);
+
+        /**
+         * @brief The attached analysis, or nullptr; e.g. for culling quiet voices by peak.
+         */
+        [[nodiscard]] const core::SampleMetadata* metadata() const noexcept;
+
         // Instrument API
         void noteOn(int note, float velocity);
         void noteOff(int note);
 
+        /**
+         * @brief Posts SourceFinished (at the exact frame the last voice ended) and VoiceStolen
+         *        events to @p events. Pass nullptr to stop posting.
+         * @details Events are posted from the rendering thread, which must be the ring's only producer.
+         */
+        void setEventSink(core::EventRing* events);
+
+        /**
+         * @brief True while an event sink is set.
+         */
+        [[nodiscard]] bool postsOwnEvents() const override;
+
     private:
         // The shared audio data this sampler will read from.
         std::shared_ptr<const core::AudioBuffer> sampleData_;
@@ -46,8 +80,14 @@ namespace pipsqueak::dsp {
         int rootNote_{48}; // C3
         double tuneCents_{0.0};
 
+        // Load-time analysis and the frame notes start from
+        std::shared_ptr<const core::SampleMetadata> metadata_;
+        size_t startFrame_{0};
+
         size_t maxPolyphony_{1};
         std::vector<SamplerVoice> voices_;
+
+        core::EventRing* events_{nullptr};
     };
 }
 
@@ -5,9 +5,23 @@
 #ifndef SAMPLER_VOICE_HPP
 #define SAMPLER_VOICE_HPP
 
+#include <memory>
+#include <optional>
+#include <vector>
 #include <pipsqueak/core/audio_buffer.hpp>
+#include <pipsqueak/core/kernels.hpp>
+#include <pipsqueak/core/transient_analysis.hpp>
+#include <pipsqueak/dsp/channel_matrix.hpp>
 
 namespace pipsqueak::dsp {
+    /**
+     * @brief How a voice maps playback speed to pitch.
+     */
+    enum class PlaybackMode {
+        Resample,    ///< Speed and pitch are tied together through the read step.
+        TimeStretch  ///< Duration is set by the stretch ratio, independently of pitch (WSOLA).
+    };
+
     class SamplerVoice {
     public:
         SamplerVoice() = default;
@@ -15,15 +29,51 @@ namespace pipsqueak::dsp {
         // Establish sample context
         void configure(std::shared_ptr<const core::AudioBuffer> sample, double nativeRate, double engineRate);
 
-        // Start a note: compute step, reset phase, set gain/active
-        void start(int note, float velocity, int rootNote, double tuneCents);
+        /**
+         * @brief Selects the playback mode used by subsequent notes.
+         * @param mode Resample or TimeStretch.
+         * @param stretchRatio Output duration / source duration in TimeStretch mode (2.0 = half speed).
+         * @param transients Optional precomputed onsets; grains lock onto them to keep attacks intact.
+         */
+        void setPlaybackMode(PlaybackMode mode, double stretchRatio,
+                             std::shared_ptr<const core::TransientMap> transients);
+
+        // Start a note: compute step, reset phase (to startFrame), set gain/active
+        void start(int note, float velocity, int rootNote, double tuneCents, size_t startFrame = 0);
 
-        // Render up to framesToRender
-        void render(core::AudioBuffer& out, size_t framesToRender);
+        // Render up to framesToRender; returns the frames actually produced (less once the sample ends)
+        size_t render(core::AudioBuffer& out, size_t framesToRender);
 
         [[nodiscard]] bool finished() const;
 
     private:
+        // One windowed read head of the WSOLA overlap-add.
+        struct Grain {
+            double position{0.0}; // Source read position (frames)
+            size_t age{0};        // Frames rendered since the grain started
+            bool live{false};
+        };
+
+        // Picks the fused kernel route matching matrix_ (once per output shape change); none
+        // means interpolating into block_ and mixing through matrix_
+        [[nodiscard]] std::optional<core::kernels::MixRoute> classifyRoute() const;
+
+        // Render paths: write interpolated source-layout frames into block_, return frames written
+        size_t renderResampled(size_t framesToRender);
+        size_t renderStretched(size_t framesToRender);
+
+        // Fused resample path: interpolates and mixes straight into the output (kernels::interpolateMix)
+        size_t renderDirect(core::AudioBuffer& out, size_t framesToRender);
+
+        // Starts a new grain near the current analysis position
+        void spawnGrain(Grain& grain, double continuation);
+
+        // Finds the best-matching grain start in a window around @p nominal
+        [[nodiscard]] double searchGrainStart(double nominal, double continuation) const;
+
+        // Linearly interpolated mono (channel-summed) read used by the similarity search
+        [[nodiscard]] double monoAt(double position) const;
+
         // Sample context
         std::shared_ptr<const core::AudioBuffer> sample_{nullptr};
         unsigned srcChannels_{0};
@@ -37,6 +87,22 @@ namespace pipsqueak::dsp {
         double step_{1.0};
         bool active_{false};
         float gain_{0.0};
+
+        // Time-stretch state
+        PlaybackMode mode_{PlaybackMode::Resample};
+        double stretchRatio_{1.0};
+        std::shared_ptr<const core::TransientMap> transients_{nullptr};
+        size_t grainSize_{1024};
+        double analysisStep_{1.0}; // Source frames advanced per output frame
+        Grain grains_[2];
+        size_t nextGrain_{0};
+        size_t sinceSpawn_{0};     // Output frames since the last grain was spawned
+        size_t onsetFloor_{0};     // Onsets before this frame have already been locked to
+
+        // Output routing
+        std::optional<ChannelMatrix> matrix_;  // Source layout -> output layout
+        std::optional<core::kernels::MixRoute> route_;
+        std::vector<core::Sample> block_;      // Interpolated source frames for the current call
     };
 }
 #endif //SAMPLER_VOICE_HPP
@@ -0,0 +1,59 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef SIDECHAIN_SOURCE_HPP
+#define SIDECHAIN_SOURCE_HPP
+
+#include "audio_source.hpp"
+#include <cstddef>
+
+namespace pipsqueak::dsp {
+    /**
+     * @class SidechainInputs
+     * @brief Read-only, non-owning views of the upstream buffers a node is keyed from.
+     * @details The views point straight at the buffers the upstream sources rendered into
+     *          for the current block; nothing is copied. They are only valid during the
+     *          @c process() call they are passed to.
+     */
+    class SidechainInputs {
+    public:
+        SidechainInputs() = default;
+        SidechainInputs(const core::AudioBuffer* const* buffers, const size_t count)
+            : buffers_(buffers), count_(count) {}
+
+        /// Number of connected sidechain inputs.
+        [[nodiscard]] size_t size() const noexcept { return count_; }
+        [[nodiscard]] bool empty() const noexcept { return count_ == 0; }
+
+        /// The rendered buffer of sidechain input @p index (unchecked).
+        [[nodiscard]] const core::AudioBuffer& operator[](const size_t index) const noexcept {
+            return *buffers_[index];
+        }
+
+    private:
+        const core::AudioBuffer* const* buffers_{nullptr};
+        size_t count_{0};
+    };
+
+    /**
+     * @class SidechainSource
+     * @brief An AudioSource that can read other sources' output (e.g. a ducker or keyed compressor).
+     * @details Connect keys with @c Mixer::setSidechains(). The mixer then renders the keys
+     *          first and passes their buffers to the overload below. When used outside a
+     *          mixer, the plain @c process() runs the node with no sidechain connected.
+     */
+    class SidechainSource : public AudioSource {
+    public:
+        /**
+         * @brief Process audio, adding output into @p buffer, keyed from @p sidechains.
+         */
+        virtual void process(core::AudioBuffer& buffer, const SidechainInputs& sidechains) = 0;
+
+        void process(core::AudioBuffer& buffer) override {
+            process(buffer, SidechainInputs{});
+        }
+    };
+}
+
+#endif //SIDECHAIN_SOURCE_HPP
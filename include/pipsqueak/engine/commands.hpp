@@ -0,0 +1,60 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef COMMANDS_HPP
+#define COMMANDS_HPP
+
+#include "pipsqueak/core/command_bus.hpp"
+#include "pipsqueak/dsp/sampler.hpp"
+
+namespace pipsqueak::engine::commands {
+    /**
+     * @brief A command that starts a note on @p sampler from the audio thread.
+     */
+    inline core::Command noteOn(dsp::Sampler& sampler, const int note, const float velocity) {
+        core::Command command;
+        command.apply = [](core::Command& c) { static_cast<dsp::Sampler*>(c.target)->noteOn(c.arg, c.level); };
+        command.target = &sampler;
+        command.arg = note;
+        command.level = velocity;
+        return command;
+    }
+
+    /**
+     * @brief A command that changes @p sampler's engine rate between blocks rather than mid-render.
+     */
+    inline core::Command setEngineRate(dsp::Sampler& sampler, const double rate) {
+        core::Command command;
+        command.apply = [](core::Command& c) { static_cast<dsp::Sampler*>(c.target)->setEngineRate(c.value); };
+        command.target = &sampler;
+        command.value = rate;
+        return command;
+    }
+
+    /**
+     * @brief A command that changes @p sampler's native (source) rate between blocks.
+     */
+    inline core::Command setNativeRate(dsp::Sampler& sampler, const double rate) {
+        core::Command command;
+        command.apply = [](core::Command& c) { static_cast<dsp::Sampler*>(c.target)->setNativeRate(c.value); };
+        command.target = &sampler;
+        command.value = rate;
+        return command;
+    }
+
+    /**
+     * @brief A user-defined command: @p apply runs on the audio thread, @p retire (optional) on the control side.
+     */
+    inline core::Command custom(const core::Command::Fn apply, void* target, void* payload = nullptr,
+                                const core::Command::Fn retire = nullptr) {
+        core::Command command;
+        command.apply = apply;
+        command.retire = retire;
+        command.target = target;
+        command.payload = payload;
+        return command;
+    }
+}
+
+#endif //COMMANDS_HPP
@@ -5,8 +5,16 @@
 #ifndef ENGINE_HPP
 #define ENGINE_HPP
 #include <RtAudio.h>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+#include "output_sink.hpp"
+#include "stream_clock.hpp"
+#include "pipsqueak/core/command_bus.hpp"
+#include "pipsqueak/core/event_ring.hpp"
 #include "pipsqueak/dsp/audio_source.hpp"
 #include "pipsqueak/dsp/mixer.hpp"
 
@@ -37,8 +45,27 @@ namespace pipsqueak::engine {
         bool startStream(unsigned int deviceId, unsigned int sampleRate, unsigned int bufferSize);
 
         /**
-         * @brief Stops and closes the currently active audio stream.
-         * @return True if the stream was stopped successfully, false otherwise.
+         * @brief Runs the engine without an audio device, delivering every block to @p sink.
+         * @details A render thread takes the place of the device callback: commands, events and
+         *          the master mixer behave exactly as with @c startStream(). Use an @c FdOutput
+         *          sink to stream to a pipe or file, e.g. on a headless render server.
+         * @param pacing RealTime releases each block when its stream time arrives; FreeRunning
+         *               renders as fast as the sink accepts blocks.
+         * @param maxFrames Stop by itself once this many frames are rendered, rounded up to whole
+         *                  blocks (0 = run until @c stopStream()). A StreamStatus event with value
+         *                  0 is posted when it stops.
+         * @return False if a stream is already running or a parameter is zero.
+         */
+        bool startOffline(std::shared_ptr<OutputSink> sink, unsigned int channels, unsigned int sampleRate,
+                          unsigned int bufferSize, Pacing pacing = Pacing::RealTime, std::uint64_t maxFrames = 0);
+
+        /**
+         * @brief Waits for an offline run started with @c maxFrames to finish, then releases it.
+         */
+        void waitForOffline();
+
+        /**
+         * @brief Stops and closes the currently active audio stream (or offline render thread).
          */
         void stopStream();
 
@@ -58,20 +85,101 @@ namespace pipsqueak::engine {
          */
         dsp::Mixer& masterMixer();
 
+        /**
+         * @brief Gets the engine's command bus.
+         * @details Commands are applied at the top of each audio block. While the stream runs,
+         *          master mixer changes are also routed through it. Call @c collect() on it
+         *          from a control thread now and then to release retired objects.
+         */
+        core::CommandBus& commands();
+
+        /**
+         * @brief Gets the engine's audio -> control event ring.
+         * @details Receives master-mixer SourceFinished events, Overload events for device
+         *          xruns and StreamStatus events on start/stop. Samplers can post to it too
+         *          (@c Sampler::setEventSink()). Drain it from one control thread, or wait on
+         *          its @c fd() where supported.
+         */
+        core::EventRing& events();
+
+        /**
+         * @brief Gets the clock mapping stream frames to CLOCK_MONOTONIC, for A/V sync and timestamping.
+         * @details Updated at the start of every block; read it from any thread with
+         *          @c snapshot(). The latency is the device's reported output latency. In offline
+         *          mode the clock runs only with RealTime pacing.
+         */
+        [[nodiscard]] const StreamClock& streamClock() const noexcept;
+
+        /**
+         * @brief Sets the maximum number of commands applied per audio block.
+         */
+        void setCommandBudget(size_t budget);
+
+        /**
+         * @brief Renders the master mixer deterministically on @p threads threads (0: default mode).
+         * @details Any thread count from 1 up gives bit-identical output (see
+         *          @c Mixer::setRenderPool()); with @c startOffline() this makes renders
+         *          reproducible across runs and machines with different core counts. Samplers
+         *          posting to @c events() stay safe: their events are collected per input on
+         *          the render threads and posted from the audio thread in input order.
+         * @return False while a stream is running.
+         */
+        bool setRenderThreads(unsigned threads);
+
+        /**
+         * @brief Adds a sink that receives every rendered master block, e.g. a @c ShmOutput that
+         *        lets other processes follow the output.
+         * @details Taps run on the audio thread right after the master mixer, so their @c write()
+         *          must not block: the tap's @c setRealtime() is called first, which makes an
+         *          FdOutput drop blocks rather than wait for a slow reader. While a stream runs
+         *          the change is applied through the command bus.
+         * @return False if the command bus was full.
+         */
+        bool addOutputTap(std::shared_ptr<OutputSink> tap);
+
+        /**
+         * @brief Removes a tap added with @c addOutputTap().
+         * @return False if it was not a tap (or the command bus was full).
+         */
+        bool removeOutputTap(const std::shared_ptr<OutputSink>& tap);
+
     private:
         /**
          * @brief The static C-style callback function passed to RtAudio.
          * Acts as a bridge to the processBlock member function.
          */
         static int audioCallback(void *outputBuffer, void * /*inputBuffer*/,
-            unsigned int nFrames, double /*streamTime*/, RtAudioStreamStatus status,
+            unsigned int nFrames, double streamTime, RtAudioStreamStatus status,
             void *userData);
 
         /**
          * @brief The main audio processing function called by the audio thread.
          * This is where all mixing and processing occurs.
          */
-        int processBlock(void* outputBuffer, unsigned int numFrames);
+        int processBlock(void* outputBuffer, unsigned int numFrames, RtAudioStreamStatus status = 0,
+                         double streamTime = 0.0);
+
+        // Renders one block into mixerBuffer_ (shared by the device callback and offline mode)
+        void renderBlock(unsigned int numFrames, RtAudioStreamStatus status);
+
+        // The offline render thread
+        void offlineLoop(std::shared_ptr<OutputSink> sink, unsigned int sampleRate, unsigned int bufferSize,
+                         Pacing pacing, std::uint64_t maxFrames);
+
+        // Applies pending commands and hands the mixer back to the control thread once rendering stopped
+        void releaseStream();
+
+        using TapList = std::vector<std::shared_ptr<OutputSink>>;
+
+        // Copies the newest tap list, edits it and installs it (directly, or through the bus while running)
+        template <typename Edit>
+        bool updateTaps(Edit&& edit);
+
+        // Routes tap changes through the command bus while the audio thread owns taps_
+        void routeTaps(bool viaBus);
+
+        static void installTaps(core::Command& command);
+        static void retireTaps(core::Command& command);
 
         // The unique_ptr manages the lifetime of the RtAudio object.
         std::unique_ptr<RtAudio> audio_;
@@ -79,6 +187,29 @@ namespace pipsqueak::engine {
         // A reusable buffer to avoid real-time allocation in the audio callback.
         std::unique_ptr<core::AudioBuffer> mixerBuffer_{nullptr};
 
+        // Control -> audio commands, drained at the top of every block.
+        core::CommandBus commands_{1024};
+        std::atomic<size_t> commandBudget_{64};
+
+        // Audio -> control notifications, stamped with the stream position in frames.
+        core::EventRing events_{1024};
+        std::uint64_t framePosition_{0};
+        std::atomic<bool> streamStarting_{false};
+
+        // Output taps: taps_ is read by the audio thread; stagedTaps_ is the newest list posted
+        std::shared_ptr<const TapList> taps_;
+        std::shared_ptr<const TapList> stagedTaps_;
+        std::mutex tapMutex_;
+        bool tapsViaBus_{false};
+
+        // Frame -> host time mapping, updated by the audio thread
+        StreamClock clock_;
+
+        // Offline mode: the render thread replacing the device callback
+        std::thread offlineThread_;
+        std::atomic<bool> offlineRunning_{false};
+        std::atomic<bool> offlineStop_{false};
+
         // The master mixer; the single entry point for all audio to be rendered.
         dsp::Mixer masterMixer_;
     };
@@ -0,0 +1,185 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef FD_OUTPUT_HPP
+#define FD_OUTPUT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "output_sink.hpp"
+
+namespace pipsqueak::engine {
+    /**
+     * @brief Sample format written by an @c FdOutput.
+     */
+    enum class PcmFormat {
+        Float32, ///< The engine's samples as-is (ffmpeg: -f f32le)
+        Int16    ///< Clamped and scaled to signed 16-bit (ffmpeg: -f s16le)
+    };
+
+    /**
+     * @brief Byte stream layout written by an @c FdOutput.
+     */
+    enum class StreamContainer {
+        Raw, ///< Bare interleaved samples
+        Wav  ///< RIFF/WAVE header first; its sizes are patched on close when the fd is seekable
+    };
+
+    /**
+     * @struct FdOutputOptions
+     * @brief Stream format and ring geometry of an @c FdOutput.
+     */
+    struct FdOutputOptions {
+        unsigned channels{2};
+        unsigned sampleRate{48000};
+        PcmFormat format{PcmFormat::Float32};
+        StreamContainer container{StreamContainer::Raw};
+
+        unsigned segmentFrames{1024}; ///< Frames per ring segment (one iovec each)
+        unsigned segments{32};        ///< Ring length; total buffering is segments * segmentFrames
+
+        /// Wait for ring space when the reader falls behind (offline rendering). When false the
+        /// block is dropped and counted instead, so a stalled reader never holds up rendering.
+        /// Switched off when the output becomes an engine output tap (@c setRealtime()).
+        bool blockWhenFull{true};
+
+        bool closeFd{false}; ///< Close the descriptor when the output is destroyed
+    };
+
+    /**
+     * @class FdOutput
+     * @brief Streams rendered blocks to a file descriptor (pipe, FIFO or file) for encoders.
+     * @details Blocks are converted once into a preallocated ring of fixed-size segments. A
+     *          writer thread polls for filled segments (every quarter segment) and hands them
+     *          to the kernel in a single writev(). Publishing a segment is one atomic store, so
+     *          the rendering thread never takes a lock or makes a system call, unless
+     *          @c blockWhenFull lets it wait for ring space. SIGPIPE is blocked on the writer
+     *          thread: a reader that goes away shows up as @c failed(), not a dead process.
+     *
+     *          Use it as the sink of @c AudioEngine::startOffline() or of a RenderHost tenant,
+     *          e.g. @c "render | ffmpeg -f f32le -ar 48000 -ac 2 -i - out.opus".
+     */
+    class FdOutput final : public OutputSink {
+    public:
+        /**
+         * @struct Stats
+         * @brief Delivery counters.
+         */
+        struct Stats {
+            std::uint64_t framesQueued{0};  ///< Accepted into the ring
+            std::uint64_t framesDropped{0}; ///< Rejected because the ring was full (blockWhenFull off) or after a failure
+            std::uint64_t bytesWritten{0};  ///< Delivered to the descriptor, header included
+            std::uint64_t writeCalls{0};    ///< writev() calls made
+        };
+
+        /**
+         * @brief Streams to an open descriptor.
+         * @throws std::invalid_argument if the channel count or ring geometry is zero.
+         */
+        FdOutput(int fd, const FdOutputOptions& options);
+
+        /**
+         * @brief Opens (creating or truncating) a file, or opens a FIFO for writing.
+         * @return The output, or nullptr with @p error set if the path cannot be opened.
+         */
+        static std::unique_ptr<FdOutput> open(const std::string& path, FdOutputOptions options,
+                                              std::string* error = nullptr);
+
+        /**
+         * @brief Flushes and closes the stream (see @c close()).
+         */
+        ~FdOutput() override;
+
+        FdOutput(const FdOutput&) = delete;
+        FdOutput& operator=(const FdOutput&) = delete;
+
+        /**
+         * @brief Queues a block; blocks whose channel count differs from the options are dropped.
+         */
+        void write(const core::AudioBuffer& block, std::uint64_t frame) override;
+
+        /**
+         * @brief Turns @c blockWhenFull off, so a slow reader drops blocks instead of stalling the audio thread.
+         */
+        void setRealtime() override;
+
+        /**
+         * @brief Queues interleaved frames (of @c FdOutputOptions::channels channels).
+         * @return False if any of them were dropped.
+         */
+        bool write(const core::Sample* interleaved, size_t frames);
+
+        /**
+         * @brief Queues the partly filled segment and waits until everything queued is written.
+         */
+        void flush();
+
+        /**
+         * @brief Flushes, stops the writer, patches the WAV sizes if possible, and closes the fd if owned.
+         */
+        void close();
+
+        /**
+         * @brief True once a write failed (e.g. the reader closed the pipe); later frames are dropped.
+         */
+        [[nodiscard]] bool failed() const noexcept;
+
+        [[nodiscard]] Stats stats() const noexcept;
+
+        [[nodiscard]] const FdOutputOptions& options() const noexcept { return options_; }
+
+    private:
+        // Hands the segment being filled to the writer
+        void publish();
+
+        // Waits for a free segment; false if the block must be dropped
+        bool acquire();
+
+        void writerLoop();
+
+        // Delivers segments [from, to) with as few writev() calls as possible
+        bool writeSegments(std::uint64_t from, std::uint64_t to);
+
+        void writeHeader();
+        void patchHeader();
+
+        int fd_;
+        FdOutputOptions options_;
+        size_t bytesPerFrame_;
+        size_t segmentBytes_;
+        std::chrono::microseconds pollInterval_; // How often the writer looks for published segments
+
+        // Ring: segment i lives at storage_[(i % segments) * segmentBytes_]
+        std::vector<std::uint8_t> storage_;
+        std::vector<size_t> used_;        // Filled bytes per slot, set before publishing
+        std::uint64_t filling_{0};        // Segment being filled by the producer
+        size_t fill_{0};                  // Bytes in it so far
+        bool haveSegment_{false};         // The producer owns segment filling_
+        std::atomic<std::uint64_t> published_{0};
+        std::atomic<std::uint64_t> written_{0};
+
+        std::mutex mutex_;
+        std::condition_variable dataReady_; // Signalled on close only; the producer never signals
+        std::condition_variable spaceFree_;
+        bool stopping_{false};
+        bool closed_{false};              // Set by close(); producer side
+        std::atomic<bool> failed_{false};
+        std::thread writer_;
+
+        std::atomic<std::uint64_t> framesQueued_{0};
+        std::atomic<std::uint64_t> framesDropped_{0};
+        std::atomic<std::uint64_t> bytesWritten_{0};
+        std::atomic<std::uint64_t> writeCalls_{0};
+    };
+}
+
+#endif //FD_OUTPUT_HPP
@@ -0,0 +1,85 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef OUTPUT_SINK_HPP
+#define OUTPUT_SINK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "pipsqueak/core/audio_buffer.hpp"
+
+namespace pipsqueak::engine {
+    /**
+     * @brief How a device-less renderer (RenderHost, AudioEngine offline mode) paces its blocks.
+     */
+    enum class Pacing {
+        RealTime,   ///< Each block is released when its stream time arrives (live output).
+        FreeRunning ///< Blocks are rendered as fast as the pool allows (offline, batch, tests).
+    };
+
+    /**
+     * @class OutputSink
+     * @brief Where a device-less engine delivers its rendered blocks.
+     */
+    class OutputSink {
+    public:
+        virtual ~OutputSink() = default;
+
+        /**
+         * @brief Consumes one rendered block.
+         * @param block Interleaved output of the tenant's master mixer.
+         * @param frame Stream position of the block's first frame.
+         */
+        virtual void write(const core::AudioBuffer& block, std::uint64_t frame) = 0;
+
+        /**
+         * @brief Called before the sink is attached to an audio thread (an engine output tap).
+         * @details From then on @c write() must not wait for the consumer; a sink that could
+         *          (e.g. FdOutput with @c blockWhenFull) switches to dropping instead.
+         */
+        virtual void setRealtime() {}
+    };
+
+    /**
+     * @class NullSink
+     * @brief Discards audio, keeping only a frame count (benchmarks, headless rendering).
+     */
+    class NullSink final : public OutputSink {
+    public:
+        void write(const core::AudioBuffer& block, std::uint64_t frame) override;
+
+        [[nodiscard]] std::uint64_t framesWritten() const noexcept;
+
+    private:
+        std::atomic<std::uint64_t> frames_{0};
+    };
+
+    /**
+     * @class FileSink
+     * @brief Appends raw interleaved float32 PCM to a file.
+     */
+    class FileSink final : public OutputSink {
+    public:
+        /**
+         * @brief Opens (truncating) @p path.
+         */
+        explicit FileSink(const std::string& path);
+        ~FileSink() override;
+
+        FileSink(const FileSink&) = delete;
+        FileSink& operator=(const FileSink&) = delete;
+
+        [[nodiscard]] bool isOpen() const noexcept;
+
+        void write(const core::AudioBuffer& block, std::uint64_t frame) override;
+
+    private:
+        std::FILE* file_{nullptr};
+    };
+}
+
+#endif //OUTPUT_SINK_HPP
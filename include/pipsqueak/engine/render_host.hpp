@@ -0,0 +1,212 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef RENDER_HOST_HPP
+#define RENDER_HOST_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "output_sink.hpp"
+#include "pipsqueak/core/buffer_store.hpp"
+#include "pipsqueak/core/command_bus.hpp"
+#include "pipsqueak/core/event_ring.hpp"
+#include "pipsqueak/dsp/mixer.hpp"
+
+namespace pipsqueak::engine {
+    /**
+     * @struct TenantConfig
+     * @brief The shape and limits of one hosted session.
+     */
+    struct TenantConfig {
+        std::string name;
+        unsigned channels{2};
+        unsigned blockFrames{512};
+        double sampleRate{48000.0};
+
+        /// Share of one core the tenant may use, averaged over time (1.0 = a whole core).
+        double cpuQuota{1.0};
+
+        /// Stop after this many blocks (0 = run until the host stops).
+        std::uint64_t maxBlocks{0};
+
+        /// Capacity hint for the tenant's own BufferStore.
+        size_t storeCapacity{256};
+
+        /// Receives every rendered block; nullptr discards output.
+        std::shared_ptr<OutputSink> sink;
+
+        /// Commands applied per block, as with @c AudioEngine::setCommandBudget().
+        size_t commandBudget{64};
+    };
+
+    /**
+     * @struct TenantStats
+     * @brief Counters a tenant accumulates while hosted.
+     */
+    struct TenantStats {
+        std::uint64_t blocksRendered{0};
+        std::uint64_t deadlineMisses{0}; ///< Blocks finished after their deadline (RealTime only)
+        std::uint64_t throttled{0};      ///< Times the tenant was held back by its CPU quota
+        double cpuSeconds{0.0};          ///< Thread CPU time spent rendering (what the quota charges)
+    };
+
+    /**
+     * @class Tenant
+     * @brief One logical engine inside a RenderHost: a master Mixer, its own BufferStore
+     *        namespace, and the same command bus / event ring pair an AudioEngine has.
+     */
+    class Tenant {
+    public:
+        explicit Tenant(TenantConfig config);
+
+        [[nodiscard]] const TenantConfig& config() const noexcept { return config_; }
+        [[nodiscard]] const std::string& name() const noexcept { return config_.name; }
+
+        /**
+         * @brief The tenant's master mixer; its changes always stage through @c commands().
+         * @note The bus holds 256 changes and a block installs up to 64, so check the result of
+         *       each mixer edit when making many of them at once (e.g. before the host starts).
+         */
+        dsp::Mixer& masterMixer() noexcept { return mixer_; }
+        core::BufferStore& store() noexcept { return store_; }
+        core::CommandBus& commands() noexcept { return commands_; }
+        core::EventRing& events() noexcept { return events_; }
+
+        /**
+         * @brief A consistent copy of the tenant's counters.
+         */
+        [[nodiscard]] TenantStats stats() const;
+
+    private:
+        friend class RenderHost;
+
+        // Renders one block and hands it to the sink (called by one worker at a time)
+        void renderBlock();
+
+        TenantConfig config_;
+        dsp::Mixer mixer_;
+        core::BufferStore store_;
+        core::CommandBus commands_{256};
+        core::EventRing events_{256};
+        std::unique_ptr<core::AudioBuffer> buffer_;
+        std::uint64_t framePosition_{0};
+
+        // Scheduler state (guarded by the host's mutex)
+        std::mutex* hostMutex_{nullptr};
+        std::chrono::nanoseconds period_{0};
+        std::chrono::steady_clock::time_point deadline_;
+        std::chrono::nanoseconds credit_{0}; // CPU time the quota still allows
+        std::chrono::steady_clock::time_point refilled_;
+        bool busy_{false};
+        bool held_{false};                    // Currently out of quota
+        bool removing_{false};                // removeTenant() is waiting for it; never picked again
+        TenantStats stats_;
+    };
+
+    /**
+     * @class RenderHost
+     * @brief Renders many independent tenants on one shared pool of worker threads.
+     * @details Each worker repeatedly picks the runnable tenant with the earliest deadline
+     *          (EDF), renders one block of it, and delivers it to the tenant's sink. A tenant
+     *          is runnable when its next block has been released (RealTime pacing), no other
+     *          worker is rendering it, and its CPU quota has credit left. Quotas are token
+     *          buckets refilled at @c cpuQuota seconds of CPU per wall-clock second and spent
+     *          by the render's thread CPU time (CLOCK_THREAD_CPUTIME_ID), so an expensive tenant
+     *          is held back instead of starving its neighbours, while time a worker spends
+     *          preempted is not charged to anyone.
+     *
+     *          With RealTime pacing the workers ask for SCHED_FIFO at @c kRealtimePriority; where
+     *          that is not permitted (no CAP_SYS_NICE or rtprio limit) they log it once and keep
+     *          the normal class. Quotas still bound how much of a core each tenant may take.
+     *
+     *          The pick is a short O(tenants) scan under one mutex; rendering itself runs
+     *          without locks. Density is therefore bounded by cores, not by one thread per
+     *          session as with a device-driven AudioEngine.
+     */
+    class RenderHost {
+    public:
+        /// SCHED_FIFO priority of RealTime workers (below typical device threads, above desktop work).
+        static constexpr int kRealtimePriority = 60;
+
+        /**
+         * @param workers Number of render threads (0 = hardware concurrency).
+         * @param pacing RealTime for live output, FreeRunning for offline rendering.
+         */
+        explicit RenderHost(unsigned workers = 0, Pacing pacing = Pacing::RealTime);
+
+        /**
+         * @brief Stops the workers.
+         */
+        ~RenderHost();
+
+        RenderHost(const RenderHost&) = delete;
+        RenderHost& operator=(const RenderHost&) = delete;
+
+        /**
+         * @brief Thread-safely adds a tenant; it is scheduled from the next pick on.
+         * @return The tenant, owned by the host for its whole lifetime.
+         */
+        Tenant& addTenant(TenantConfig config);
+
+        /**
+         * @brief Thread-safely removes a tenant and destroys it.
+         * @details Waits for a block of it that a worker is rendering to finish; no block starts
+         *          after the call. Must not be called from the tenant's own render (e.g. its sink).
+         * @return False if @p tenant does not belong to this host.
+         */
+        bool removeTenant(Tenant& tenant);
+
+        /**
+         * @brief Starts the worker pool.
+         */
+        void start();
+
+        /**
+         * @brief Stops the pool after the blocks in flight complete.
+         */
+        void stop();
+
+        /**
+         * @brief Blocks until every tenant with a @c maxBlocks limit has reached it.
+         */
+        void waitIdle();
+
+        [[nodiscard]] bool isRunning() const noexcept;
+        [[nodiscard]] unsigned workerCount() const noexcept;
+        [[nodiscard]] size_t tenantCount() const;
+
+    private:
+        // One worker's loop
+        void run();
+
+        // Picks the runnable tenant with the earliest deadline, or nullptr (sets @p wake)
+        Tenant* pick(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point& wake);
+
+        // Adds the quota earned since the last refill
+        static void refill(Tenant& tenant, std::chrono::steady_clock::time_point now);
+
+        [[nodiscard]] static bool done(const Tenant& tenant);
+
+        unsigned workerCount_;
+        Pacing pacing_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        std::vector<std::unique_ptr<Tenant>> tenants_;
+        std::vector<std::thread> workers_;
+        std::atomic<bool> running_{false};
+        std::atomic<bool> realtimeWarned_{false};
+    };
+}
+
+#endif //RENDER_HOST_HPP
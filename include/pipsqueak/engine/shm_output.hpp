@@ -0,0 +1,92 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef SHM_OUTPUT_HPP
+#define SHM_OUTPUT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "output_sink.hpp"
+#include "shm_ring.hpp"
+
+namespace pipsqueak::engine {
+    /**
+     * @struct ShmOutputOptions
+     * @brief Format and geometry of a shared-memory ring.
+     */
+    struct ShmOutputOptions {
+        unsigned channels{2};
+        unsigned sampleRate{48000};
+        unsigned slotFrames{1024}; ///< Largest block stored in one slot; longer blocks span several
+        unsigned slots{64};        ///< Blocks a reader may fall behind before it overruns
+        bool unlinkOnClose{true};  ///< Remove the name when the output is destroyed
+    };
+
+    /**
+     * @class ShmOutput
+     * @brief Publishes rendered blocks into a POSIX shared-memory ring for other processes.
+     * @details Each block is copied once into the next slot and stamped with a sequence number;
+     *          readers (@c ShmRingReader, from the standalone shm_ring.hpp) map the ring read-only
+     *          and use the samples in place. The producer never waits: a slow reader is overrun
+     *          and notices by the sequence numbers. @c write() neither locks, allocates nor makes
+     *          system calls, so the output can be an @c AudioEngine output tap on the audio thread.
+     */
+    class ShmOutput final : public OutputSink {
+    public:
+        /**
+         * @brief Creates (or replaces) the ring @p name, e.g. "/pipsqueak-master".
+         * @return The output, or nullptr with @p error set if the segment cannot be created.
+         * @throws std::invalid_argument if the channel count or ring geometry is zero.
+         */
+        static std::unique_ptr<ShmOutput> create(const std::string& name, const ShmOutputOptions& options,
+                                                  std::string* error = nullptr);
+
+        /**
+         * @brief Marks the ring closed for readers, unmaps it and (by default) unlinks its name.
+         */
+        ~ShmOutput() override;
+
+        ShmOutput(const ShmOutput&) = delete;
+        ShmOutput& operator=(const ShmOutput&) = delete;
+
+        /**
+         * @brief Publishes one block; blocks of another channel count are dropped.
+         */
+        void write(const core::AudioBuffer& block, std::uint64_t frame) override;
+
+        /**
+         * @brief Publishes interleaved frames whose first frame is at stream position @p frame.
+         */
+        void write(const core::Sample* interleaved, size_t frames, std::uint64_t frame);
+
+        [[nodiscard]] const std::string& name() const noexcept { return name_; }
+        [[nodiscard]] const ShmOutputOptions& options() const noexcept { return options_; }
+
+        /**
+         * @brief Sequence number of the newest published block.
+         */
+        [[nodiscard]] std::uint64_t published() const noexcept;
+
+        /**
+         * @brief Frames dropped because their block did not match the ring's channel count.
+         */
+        [[nodiscard]] std::uint64_t framesDropped() const noexcept;
+
+    private:
+        ShmOutput(std::string name, const ShmOutputOptions& options, std::uint8_t* base, size_t bytes);
+
+        std::string name_;
+        ShmOutputOptions options_;
+        std::uint8_t* base_;
+        size_t bytes_;
+        ShmRingHeader* header_;
+        std::uint64_t sequence_{0}; // Last published; producer side
+        std::atomic<std::uint64_t> framesDropped_{0};
+    };
+}
+
+#endif //SHM_OUTPUT_HPP
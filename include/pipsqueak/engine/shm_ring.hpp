@@ -0,0 +1,246 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+// Client header: consumers of a ShmOutput ring include only this file (no pipsqueak library needed).
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pipsqueak::engine {
+    /// Identifies a pipsqueak audio ring; bumped with the layout version.
+    inline constexpr char kShmRingMagic[8] = {'P', 'S', 'Q', 'R', 'I', 'N', 'G', '1'};
+    inline constexpr std::uint32_t kShmRingVersion = 1;
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "the ring needs address-free 64-bit atomics to be shared between processes");
+
+    /**
+     * @struct ShmRingHeader
+     * @brief Start of the shared-memory segment; written once by the producer, except @c published.
+     */
+    struct ShmRingHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t channels;
+        std::uint32_t sampleRate;
+        std::uint32_t slotFrames;  ///< Capacity of one slot in frames
+        std::uint32_t slots;
+        std::uint32_t reserved;
+        std::uint64_t slotStride;  ///< Bytes from one slot to the next
+        std::uint64_t dataOffset;  ///< Offset of the first slot
+
+        /// Sequence of the newest complete block; sequences start at 1, 0 means none yet.
+        alignas(64) std::atomic<std::uint64_t> published;
+        /// The producer's pid, or 0 once it has closed the ring.
+        std::atomic<std::int32_t> producer;
+    };
+
+    /**
+     * @struct ShmSlotHeader
+     * @brief Start of each slot; interleaved float32 samples follow at @c kShmSlotHeaderBytes.
+     * @details Block n lives in slot (n - 1) % slots. @c sequence is n once the block is complete
+     *          and 0 while the producer rewrites the slot, so a reader that sees the same n before
+     *          and after using the samples knows they were not overwritten meanwhile.
+     */
+    struct ShmSlotHeader {
+        std::atomic<std::uint64_t> sequence;
+        std::uint64_t frame;  ///< Stream position of the block's first frame
+        std::uint32_t frames; ///< Frames in this block (at most slotFrames)
+        std::uint32_t reserved;
+    };
+
+    inline constexpr size_t kShmSlotHeaderBytes = 64;
+    static_assert(sizeof(ShmSlotHeader) <= kShmSlotHeaderBytes);
+
+    /**
+     * @class ShmRingReader
+     * @brief Reads the blocks a ShmOutput publishes, straight from shared memory.
+     * @details Any number of readers, in any number of processes, may follow one ring; each keeps
+     *          its own cursor and the producer never waits for them. A reader that falls more than
+     *          a ring behind gets @c Status::Overrun once, with the number of lost blocks, and
+     *          continues from the newest block.
+     *
+     *          Zero-copy use: @c next() hands out a view into the ring; process it, then check
+     *          @c valid() before trusting the result. @c read() does the same with a copy.
+     */
+    class ShmRingReader {
+    public:
+        enum class Status {
+            Ok,      ///< A block was returned
+            Empty,   ///< No new block yet
+            Overrun, ///< Blocks were overwritten before they were read; the cursor moved to the newest
+            Closed   ///< Not open
+        };
+
+        /**
+         * @struct Block
+         * @brief A view of one published block.
+         */
+        struct Block {
+            std::uint64_t sequence{0};
+            std::uint64_t frame{0};
+            std::uint32_t frames{0};
+            const float* data{nullptr}; ///< frames * channels interleaved samples, inside the mapping
+        };
+
+        ShmRingReader() = default;
+        ~ShmRingReader() { close(); }
+
+        ShmRingReader(const ShmRingReader&) = delete;
+        ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+        /**
+         * @brief Maps the ring named @p name (as given to ShmOutput::create()).
+         * @param fromOldest Start at the oldest block still in the ring instead of the next new one.
+         * @return False with @p error set if the ring does not exist or is not a compatible ring.
+         */
+        bool open(const std::string& name, std::string* error = nullptr, const bool fromOldest = false) {
+            close();
+            const std::string path = name.empty() || name[0] != '/' ? "/" + name : name;
+            const int fd = ::shm_open(path.c_str(), O_RDONLY, 0);
+            if (fd < 0)
+                return fail(error, path + ": " + std::strerror(errno));
+
+            struct stat info{};
+            if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ShmRingHeader)) {
+                ::close(fd);
+                return fail(error, path + ": not a pipsqueak ring");
+            }
+            void* map = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (map == MAP_FAILED)
+                return fail(error, path + ": " + std::strerror(errno));
+
+            base_ = static_cast<const std::uint8_t*>(map);
+            bytes_ = static_cast<size_t>(info.st_size);
+            header_ = reinterpret_cast<const ShmRingHeader*>(base_);
+            if (std::memcmp(header_->magic, kShmRingMagic, sizeof(kShmRingMagic)) != 0
+                || header_->version != kShmRingVersion || header_->slots == 0
+                || header_->dataOffset + header_->slotStride * header_->slots > bytes_) {
+                close();
+                return fail(error, path + ": not a compatible pipsqueak ring");
+            }
+
+            const std::uint64_t newest = header_->published.load(std::memory_order_acquire);
+            next_ = fromOldest && newest > header_->slots ? newest - header_->slots + 1 : fromOldest ? 1 : newest + 1;
+            return true;
+        }
+
+        void close() {
+            if (base_)
+                ::munmap(const_cast<std::uint8_t*>(base_), bytes_);
+            base_ = nullptr;
+            header_ = nullptr;
+            bytes_ = 0;
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept { return header_ != nullptr; }
+        [[nodiscard]] unsigned channels() const noexcept { return header_ ? header_->channels : 0; }
+        [[nodiscard]] unsigned sampleRate() const noexcept { return header_ ? header_->sampleRate : 0; }
+        [[nodiscard]] unsigned slotFrames() const noexcept { return header_ ? header_->slotFrames : 0; }
+
+        /**
+         * @brief True while the producer has the ring open.
+         */
+        [[nodiscard]] bool producerAlive() const noexcept {
+            return header_ && header_->producer.load(std::memory_order_acquire) != 0;
+        }
+
+        /**
+         * @brief Blocks lost to overruns so far.
+         */
+        [[nodiscard]] std::uint64_t lost() const noexcept { return lost_; }
+
+        /**
+         * @brief Returns a view of the next block, without copying.
+         */
+        Status next(Block& block) {
+            if (!header_)
+                return Status::Closed;
+
+            const std::uint64_t newest = header_->published.load(std::memory_order_acquire);
+            if (next_ > newest)
+                return Status::Empty;
+            if (newest - next_ >= header_->slots)
+                return overrun(newest);
+
+            const auto* slot = slotFor(next_);
+            if (slot->sequence.load(std::memory_order_acquire) != next_)
+                return overrun(header_->published.load(std::memory_order_acquire));
+
+            block.sequence = next_;
+            block.frame = slot->frame;
+            block.frames = slot->frames < header_->slotFrames ? slot->frames : header_->slotFrames;
+            block.data = reinterpret_cast<const float*>(reinterpret_cast<const std::uint8_t*>(slot) + kShmSlotHeaderBytes);
+            if (!valid(block))
+                return overrun(header_->published.load(std::memory_order_acquire));
+
+            ++next_;
+            return Status::Ok;
+        }
+
+        /**
+         * @brief True if the producer has not started overwriting @p block since @c next() returned it.
+         */
+        [[nodiscard]] bool valid(const Block& block) const noexcept {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slotFor(block.sequence)->sequence.load(std::memory_order_relaxed) == block.sequence;
+        }
+
+        /**
+         * @brief Copies the next block into @p out (room for slotFrames * channels samples).
+         */
+        Status read(float* out, Block& block) {
+            const Status status = next(block);
+            if (status != Status::Ok)
+                return status;
+
+            std::memcpy(out, block.data, static_cast<size_t>(block.frames) * header_->channels * sizeof(float));
+            if (!valid(block))
+                return overrun(header_->published.load(std::memory_order_acquire));
+            block.data = out;
+            return Status::Ok;
+        }
+
+    private:
+        static bool fail(std::string* error, const std::string& message) {
+            if (error)
+                *error = message;
+            return false;
+        }
+
+        const ShmSlotHeader* slotFor(const std::uint64_t sequence) const noexcept {
+            const std::uint64_t index = (sequence - 1) % header_->slots;
+            return reinterpret_cast<const ShmSlotHeader*>(base_ + header_->dataOffset + index * header_->slotStride);
+        }
+
+        Status overrun(const std::uint64_t newest) {
+            // Skip to the newest block, which is the one least likely to be overwritten next
+            if (newest > next_) {
+                lost_ += newest - next_;
+                next_ = newest;
+            }
+            return Status::Overrun;
+        }
+
+        const std::uint8_t* base_{nullptr};
+        size_t bytes_{0};
+        const ShmRingHeader* header_{nullptr};
+        std::uint64_t next_{1}; // Sequence of the next block to read
+        std::uint64_t lost_{0};
+    };
+}
+
+#endif //SHM_RING_HPP
@@ -0,0 +1,122 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef STREAM_CLOCK_HPP
+#define STREAM_CLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace pipsqueak::engine {
+    /**
+     * @struct ClockSnapshot
+     * @brief A consistent reading of a @c StreamClock: one point of the frame -> time line and its slope.
+     * @details Times are CLOCK_MONOTONIC nanoseconds. @c timeOf() gives when a frame is rendered
+     *          (enters the callback); @c presentationTime() adds the output latency, giving when it
+     *          is heard. Both extrapolate along the filtered rate, so they work for future frames.
+     */
+    struct ClockSnapshot {
+        std::uint64_t frame{0};    ///< Stream position of the latest block
+        std::int64_t timeNs{0};    ///< Filtered time at which that block was rendered
+        double nsPerFrame{0.0};    ///< Filtered frame period (the device's actual rate, not the nominal one)
+        std::int64_t latencyNs{0}; ///< Estimated delay from rendering to the speaker
+        double streamTime{0.0};    ///< The driver's own stream time for that block, in seconds
+        std::uint64_t updates{0};  ///< Blocks since the last reset
+
+        [[nodiscard]] double sampleRate() const noexcept { return nsPerFrame > 0.0 ? 1e9 / nsPerFrame : 0.0; }
+
+        [[nodiscard]] std::int64_t timeOf(const std::uint64_t position) const noexcept {
+            const double offset = static_cast<double>(static_cast<std::int64_t>(position - frame)) * nsPerFrame;
+            return timeNs + static_cast<std::int64_t>(offset);
+        }
+
+        [[nodiscard]] std::int64_t presentationTime(const std::uint64_t position) const noexcept {
+            return timeOf(position) + latencyNs;
+        }
+
+        /**
+         * @brief The (fractional) frame rendered at @p ns; inverse of @c timeOf().
+         */
+        [[nodiscard]] double frameAt(const std::int64_t ns) const noexcept {
+            return nsPerFrame > 0.0 ? static_cast<double>(frame) + static_cast<double>(ns - timeNs) / nsPerFrame
+                                    : static_cast<double>(frame);
+        }
+    };
+
+    /**
+     * @class StreamClock
+     * @brief Maps stream frame positions to CLOCK_MONOTONIC with a second-order delay-locked loop.
+     * @details The audio thread calls @c update() once per block with the time the callback ran.
+     *          Callback times jitter by scheduling noise; the loop (F. Adriaensen, "Using a DLL to
+     *          filter time") smooths that out while tracking the device's true rate, which drifts
+     *          from the nominal one. Readers on any thread get a consistent @c ClockSnapshot through
+     *          a seqlock: the writer never waits, and readers retry only if they race an update.
+     *
+     *          A gap in the frame positions, a block size change or a time error of several periods
+     *          (an xrun, a suspended process) restarts the loop from the nominal rate.
+     */
+    class StreamClock {
+    public:
+        /**
+         * @param bandwidth Loop bandwidth in Hz; lower filters more jitter but follows rate changes slower.
+         */
+        explicit StreamClock(double bandwidth = 0.5) noexcept;
+
+        /**
+         * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+         */
+        static std::int64_t now() noexcept;
+
+        /**
+         * @brief Restarts the loop for a new stream; call before its first block.
+         * @param latencyFrames Output latency reported by the device (a block is assumed if 0).
+         */
+        void reset(double sampleRate, unsigned blockFrames, unsigned latencyFrames) noexcept;
+
+        /**
+         * @brief Audio thread: feeds the time at which the block starting at @p frame is rendered.
+         */
+        void update(std::uint64_t frame, unsigned frames, std::int64_t nowNs, double streamTime = 0.0) noexcept;
+
+        /**
+         * @brief Reads the current estimate.
+         * @return False until the first block after @c reset().
+         */
+        bool snapshot(ClockSnapshot& out) const noexcept;
+
+    private:
+        // Restarts the loop at (frame, t) with the nominal period
+        void restart(std::uint64_t frame, unsigned frames, double t) noexcept;
+
+        // Writer side of the seqlock
+        void publish(double streamTime) noexcept;
+
+        double bandwidth_;
+
+        // Loop state; audio thread only. Times are seconds since origin_.
+        double sampleRate_{48000.0};
+        std::int64_t latencyNs_{0};
+        std::int64_t origin_{0};
+        std::uint64_t frame_{0};     // Position of the block t0_ belongs to
+        std::uint64_t expected_{0};  // Position the next block should have
+        unsigned frames_{0};         // Size of the blocks the loop is tuned to
+        double t0_{0.0};             // Filtered time of the current block
+        double t1_{0.0};             // Predicted time of the next block
+        double period_{0.0};         // Filtered block period (e2)
+        double b_{0.0}, c_{0.0};     // Loop coefficients
+        std::uint64_t updates_{0};
+        bool running_{false};
+
+        // Published snapshot, guarded by sequence_ (odd while being written)
+        std::atomic<std::uint32_t> sequence_{0};
+        std::atomic<std::uint64_t> publishedFrame_{0};
+        std::atomic<std::int64_t> publishedTime_{0};
+        std::atomic<double> publishedPeriod_{0.0};
+        std::atomic<std::int64_t> publishedLatency_{0};
+        std::atomic<double> publishedStreamTime_{0.0};
+        std::atomic<std::uint64_t> publishedUpdates_{0};
+    };
+}
+
+#endif //STREAM_CLOCK_HPP
@@ -1,5 +1,6 @@
 #include "core/audio_buffer.hpp"
 #include "core/channel_view.hpp"
+#include "core/kernels.hpp"
 #include "core/logging.hpp"
 #include <stdexcept>
 #include <string>
@@ -88,13 +89,11 @@ namespace pipsqueak::core {
 
     // Applies the gain factor to all channels in the buffer.
     void AudioBuffer::applyGain(const double gainFactor) {
-        const auto g = static_cast<Sample>(gainFactor);
-        for (auto& s : data_) s *= g;
+        kernels::active().gain(data_.data(), data_.size(), static_cast<Sample>(gainFactor));
     }
 
     // Sets all samples in the buffer to a given value.
     void AudioBuffer::fill(const double value) {
-        const auto v = static_cast<Sample>(value);
-        std::fill(data_.begin(), data_.end(), v);
+        kernels::active().fill(data_.data(), data_.size(), static_cast<Sample>(value));
     }
 }
\ No newline at end of file
@@ -0,0 +1,451 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <pipsqueak/core/batch_reader.hpp>
+
+#include "core/logging.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define PIPSQUEAK_HAS_IO_URING 1
+#endif
+
+namespace pipsqueak::core {
+    // Shared interface of the two backends.
+    struct BatchReader::Impl {
+        virtual ~Impl() = default;
+        virtual size_t submit(const ReadRequest* requests, size_t count) = 0;
+        virtual size_t reap(ReadResult* out, size_t max, bool wait) = 0;
+
+        Backend backend{Backend::ThreadPool};
+        unsigned depth{64};
+        size_t inFlight{0};
+        void* arena{nullptr};
+        size_t arenaBytes{0};
+    };
+
+    namespace {
+        void* allocateArena(const size_t bytes) {
+            if (bytes == 0)
+                return nullptr;
+            const size_t rounded = (bytes + BatchReader::kDirectAlignment - 1) & ~(BatchReader::kDirectAlignment - 1);
+            return std::aligned_alloc(BatchReader::kDirectAlignment, rounded);
+        }
+    }
+
+    // ---- pread worker pool ----
+
+    struct BatchReader::PoolImpl final : Impl {
+        PoolImpl(const unsigned threads, const unsigned queueDepth) {
+            backend = Backend::ThreadPool;
+            depth = queueDepth;
+            for (unsigned i = 0; i < std::max(1u, threads); ++i)
+                workers.emplace_back([this] { run(); });
+        }
+
+        ~PoolImpl() override {
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+            requestReady.notify_all();
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        size_t submit(const ReadRequest* requests, const size_t count) override {
+            const size_t accepted = std::min(count, depth - inFlight);
+            {
+                std::lock_guard lock(mutex);
+                pending.insert(pending.end(), requests, requests + accepted);
+            }
+            inFlight += accepted;
+            requestReady.notify_all();
+            return accepted;
+        }
+
+        size_t reap(ReadResult* out, const size_t max, const bool wait) override {
+            std::unique_lock lock(mutex);
+            if (wait && inFlight > 0)
+                resultReady.wait(lock, [&] { return !completed.empty(); });
+
+            size_t n = 0;
+            while (n < max && !completed.empty()) {
+                out[n++] = completed.front();
+                completed.pop_front();
+            }
+            inFlight -= n;
+            return n;
+        }
+
+        void run() {
+            std::unique_lock lock(mutex);
+            for (;;) {
+                requestReady.wait(lock, [&] { return stopping || !pending.empty(); });
+                if (stopping)
+                    return;
+
+                const ReadRequest request = pending.front();
+                pending.pop_front();
+                lock.unlock();
+
+                // Loop over short reads so the result is only short at end of file.
+                size_t done = 0;
+                std::int64_t result = 0;
+                while (done < request.length) {
+                    const auto r = ::pread(request.fd, static_cast<char*>(request.destination) + done,
+                                           request.length - done, static_cast<off_t>(request.offset + done));
+                    if (r < 0 && errno == EINTR) continue;
+                    if (r < 0) { result = -errno; break; }
+                    if (r == 0) break;
+                    done += static_cast<size_t>(r);
+                }
+                if (result == 0) result = static_cast<std::int64_t>(done);
+
+                lock.lock();
+                completed.push_back({request.userData, result});
+                resultReady.notify_one();
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable requestReady;
+        std::condition_variable resultReady;
+        std::deque<ReadRequest> pending;
+        std::deque<ReadResult> completed;
+        std::vector<std::thread> workers;
+        bool stopping{false};
+    };
+
+#ifdef PIPSQUEAK_HAS_IO_URING
+    // ---- io_uring, through the raw system calls ----
+
+    struct BatchReader::UringImpl final : Impl {
+        static std::unique_ptr<UringImpl> create(const unsigned queueDepth, void* arenaPtr, const size_t arenaSize) {
+            auto ring = std::unique_ptr<UringImpl>(new UringImpl());
+            if (!ring->setup(queueDepth))
+                return nullptr;
+
+            // Registration is an optimisation; plain reads into the arena still work without it.
+            if (arenaPtr) {
+                iovec iov{arenaPtr, arenaSize};
+                ring->registered = ::syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+            }
+            return ring;
+        }
+
+        ~UringImpl() override {
+            if (sqes) ::munmap(sqes, sqesBytes);
+            if (cqRing && cqRing != sqRing) ::munmap(cqRing, cqBytes);
+            if (sqRing) ::munmap(sqRing, sqBytes);
+            if (fd >= 0) ::close(fd);
+        }
+
+        bool setup(const unsigned queueDepth) {
+            io_uring_params params{};
+            fd = static_cast<int>(::syscall(__NR_io_uring_setup, queueDepth, &params));
+            if (fd < 0)
+                return false;
+
+            backend = Backend::IoUring;
+            depth = std::min(params.sq_entries, params.cq_entries);
+            sqEntries = params.sq_entries;
+            slots.resize(depth);
+            for (unsigned i = depth; i > 0; --i)
+                freeSlots.push_back(i - 1);
+
+            sqBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single)
+                sqBytes = cqBytes = std::max(sqBytes, cqBytes);
+
+            sqRing = ::mmap(nullptr, sqBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) { sqRing = nullptr; return false; }
+            cqRing = single ? sqRing
+                            : ::mmap(nullptr, cqBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) { cqRing = nullptr; return false; }
+
+            sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE,
+                                                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+            if (sqes == MAP_FAILED) { sqes = nullptr; return false; }
+
+            auto* sq = static_cast<char*>(sqRing);
+            auto* cq = static_cast<char*>(cqRing);
+            sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        size_t submit(const ReadRequest* requests, const size_t count) override {
+            const size_t room = std::min(count, depth - inFlight);
+            if (room == 0)
+                return 0;
+
+            std::vector<unsigned> taken;
+            taken.reserve(room);
+            for (size_t i = 0; i < room; ++i) {
+                const unsigned slot = freeSlots.back();
+                freeSlots.pop_back();
+                slots[slot] = {requests[i], 0};
+                taken.push_back(slot);
+            }
+
+            // Requests the kernel did not take are handed back to the caller, in order
+            const size_t accepted = push(taken.data(), taken.size());
+            for (size_t i = taken.size(); i > accepted; --i)
+                freeSlots.push_back(taken[i - 1]);
+            inFlight += accepted;
+            return accepted;
+        }
+
+        size_t reap(ReadResult* out, const size_t max, const bool wait) override {
+            size_t n = 0;
+            for (;;) {
+                n += drainCompletions(out + n, max - n);
+                if (!resubmit.empty())
+                    resubmit.erase(resubmit.begin(), resubmit.begin() + static_cast<std::ptrdiff_t>(
+                                                         push(resubmit.data(), resubmit.size())));
+                if (n > 0 || !wait || inFlight == 0)
+                    break;
+
+                // Only the kernel can finish what is left; continuations it refuses fail instead
+                if (inKernel == 0) {
+                    while (!resubmit.empty() && n < max) {
+                        finish(resubmit.front(), -EIO, out[n++]);
+                        resubmit.erase(resubmit.begin());
+                    }
+                    break;
+                }
+                const auto r = ::syscall(__NR_io_uring_enter, fd, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (r < 0 && errno != EINTR)
+                    break;
+            }
+            return n;
+        }
+
+        // Writes one SQE per slot (reading whatever the slot still lacks) and submits them.
+        // Returns how many the kernel consumed; the rest are taken back off the ring.
+        size_t push(const unsigned* pending, const size_t count) {
+            unsigned tail = *sqTail; // Only this thread writes the tail
+            const unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            const size_t fits = std::min<size_t>(count, sqEntries - (tail - head));
+            for (size_t i = 0; i < fits; ++i, ++tail) {
+                const Slot& slot = slots[pending[i]];
+                const ReadRequest& r = slot.request;
+                const unsigned index = tail & sqMask;
+                io_uring_sqe& sqe = sqes[index];
+                sqe = io_uring_sqe{};
+
+                auto* dst = static_cast<char*>(r.destination) + slot.done;
+                const auto* base = static_cast<const char*>(arena);
+                const size_t length = r.length - slot.done;
+                const bool fixed = registered && dst >= base && dst + length <= base + arenaBytes;
+                sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+                sqe.fd = r.fd;
+                sqe.off = r.offset + slot.done;
+                sqe.addr = reinterpret_cast<std::uint64_t>(dst);
+                sqe.len = static_cast<std::uint32_t>(length);
+                sqe.buf_index = 0;
+                sqe.user_data = pending[i];
+                sqArray[index] = index;
+            }
+            __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+            size_t submitted = 0;
+            while (submitted < fits) {
+                const auto r = ::syscall(__NR_io_uring_enter, fd, static_cast<unsigned>(fits - submitted), 0u, 0u,
+                                         nullptr, 0);
+                if (r < 0 && errno == EINTR) continue;
+                if (r <= 0) break;
+                submitted += static_cast<size_t>(r);
+            }
+
+            // The kernel reads SQEs only inside io_uring_enter, so unconsumed ones can be withdrawn
+            const unsigned consumed = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) - head;
+            __atomic_store_n(sqTail, head + consumed, __ATOMIC_RELEASE);
+            inKernel += consumed;
+            return consumed;
+        }
+
+        size_t drainCompletions(ReadResult* out, const size_t max) {
+            unsigned head = *cqHead;
+            const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            size_t n = 0;
+            for (; head != tail && n < max; ++head) {
+                const io_uring_cqe& cqe = cqes[head & cqMask];
+                const auto index = static_cast<unsigned>(cqe.user_data);
+                Slot& slot = slots[index];
+                --inKernel;
+
+                // A short read before end of file continues where it stopped, as the pread pool does
+                if (cqe.res > 0 && slot.done + static_cast<size_t>(cqe.res) < slot.request.length) {
+                    slot.done += static_cast<size_t>(cqe.res);
+                    resubmit.push_back(index);
+                    continue;
+                }
+                const std::int64_t result = cqe.res < 0 ? cqe.res : static_cast<std::int64_t>(slot.done + cqe.res);
+                finish(index, result, out[n++]);
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            return n;
+        }
+
+        void finish(const unsigned index, const std::int64_t result, ReadResult& out) {
+            out = {slots[index].request.userData, result};
+            freeSlots.push_back(index);
+            --inFlight;
+        }
+
+        // One accepted request and the bytes it has read so far; SQEs carry the slot index.
+        struct Slot {
+            ReadRequest request;
+            size_t done{0};
+        };
+        std::vector<Slot> slots;
+        std::vector<unsigned> freeSlots;
+        std::vector<unsigned> resubmit; // Short reads waiting for SQ space
+        size_t inKernel{0};             // Consumed SQEs whose completion is not yet drained
+
+        int fd{-1};
+        void* sqRing{nullptr};
+        void* cqRing{nullptr};
+        size_t sqBytes{0};
+        size_t cqBytes{0};
+        io_uring_sqe* sqes{nullptr};
+        size_t sqesBytes{0};
+        unsigned* sqHead{nullptr};
+        unsigned* sqTail{nullptr};
+        unsigned sqMask{0};
+        unsigned sqEntries{0};
+        unsigned* sqArray{nullptr};
+        unsigned* cqHead{nullptr};
+        unsigned* cqTail{nullptr};
+        unsigned cqMask{0};
+        io_uring_cqe* cqes{nullptr};
+        bool registered{false};
+
+    private:
+        UringImpl() = default;
+    };
+#else
+    struct BatchReader::UringImpl final : Impl {};
+#endif
+
+    // ---- BatchReader ----
+
+    BatchReader::BatchReader() : BatchReader(Options{}) {}
+
+    BatchReader::BatchReader(const Options options) {
+        void* arenaPtr = allocateArena(options.arenaBytes);
+        const unsigned depth = std::max(1u, options.queueDepth);
+
+#ifdef PIPSQUEAK_HAS_IO_URING
+        if (options.backend != Backend::ThreadPool) {
+            impl_ = UringImpl::create(depth, arenaPtr, options.arenaBytes);
+            if (!impl_ && options.backend == Backend::IoUring)
+                logging::Logger::log("pipsqueak", "BatchReader: io_uring unavailable, using the pread pool");
+        }
+#endif
+        if (!impl_)
+            impl_ = std::make_unique<PoolImpl>(options.threads, depth);
+
+        impl_->arena = arenaPtr;
+        impl_->arenaBytes = arenaPtr ? options.arenaBytes : 0;
+    }
+
+    BatchReader::~BatchReader() {
+        // Outstanding reads still target the arena; let them land first.
+        ReadResult sink[64];
+        while (impl_->inFlight > 0 && impl_->reap(sink, 64, true) > 0) {}
+
+        void* arenaPtr = impl_->arena;
+        impl_.reset();
+        std::free(arenaPtr);
+    }
+
+    BatchReader::Backend BatchReader::backend() const noexcept {
+        return impl_->backend;
+    }
+
+    unsigned BatchReader::queueDepth() const noexcept {
+        return impl_->depth;
+    }
+
+    size_t BatchReader::submit(const ReadRequest* requests, const size_t count) {
+        return impl_->submit(requests, count);
+    }
+
+    size_t BatchReader::reap(ReadResult* out, const size_t max, const bool wait) {
+        return impl_->reap(out, max, wait);
+    }
+
+    size_t BatchReader::inFlight() const noexcept {
+        return impl_->inFlight;
+    }
+
+    std::vector<ReadResult> BatchReader::readAll(const std::vector<ReadRequest>& requests) {
+        std::vector<ReadResult> results(requests.size());
+        size_t submitted = 0, reaped = 0;
+        while (reaped < requests.size()) {
+            const size_t accepted = submit(requests.data() + submitted, requests.size() - submitted);
+            submitted += accepted;
+            const size_t done = reap(results.data() + reaped, results.size() - reaped, true);
+            reaped += done;
+
+            // Nothing queued, nothing pending and the backend refuses more: fail the rest
+            if (accepted == 0 && done == 0 && inFlight() == 0) {
+                for (; submitted < requests.size(); ++submitted)
+                    results[reaped++] = {requests[submitted].userData, -EIO};
+                break;
+            }
+        }
+        return results;
+    }
+
+    void* BatchReader::arena() const noexcept {
+        return impl_->arena;
+    }
+
+    size_t BatchReader::arenaBytes() const noexcept {
+        return impl_->arenaBytes;
+    }
+
+    int BatchReader::openForRead(const std::string& path, const bool direct) {
+#ifdef O_DIRECT
+        if (direct) {
+            // Some filesystems (tmpfs, overlays) reject O_DIRECT; fall back to buffered reads there.
+            if (const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT); fd >= 0)
+                return fd;
+        }
+#endif
+        return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+
+    void BatchReader::close(const int fd) {
+        if (fd >= 0)
+            ::close(fd);
+    }
+}
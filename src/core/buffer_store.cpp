@@ -6,42 +6,466 @@
 
 #include "core/logging.hpp"
 
+#include <algorithm>
+
 namespace pipsqueak::core {
-    BufferStore::BufferStore(const size_t capacity) : capacity_(capacity) {
+    namespace {
+        size_t sampleBytes(const std::shared_ptr<const AudioBuffer>& buffer) {
+            return buffer ? buffer->data().size() * sizeof(Sample) : 0;
+        }
+    }
+
+    void BufferStore::Leases::acquire() {
+        // Stored with no pointer out -> referenced
+        if (state.fetch_add(2, std::memory_order_acq_rel) == 1)
+            counters->referencedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void BufferStore::Leases::release() {
+        // Stored with the last pointer out -> store-only
+        if (state.fetch_sub(2, std::memory_order_acq_rel) == 3)
+            counters->referencedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void BufferStore::Leases::detach() {
+        // Leaving the store while referenced: its bytes are no longer the store's to count
+        if (state.fetch_sub(1, std::memory_order_acq_rel) > 1)
+            counters->referencedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    BufferStore::BufferStore(const size_t capacity)
+        : capacity_(capacity), tagTable_(std::make_shared<const TagTable>()), counters_(std::make_shared<Counters>()) {
         logging::Logger::log(
             "pipsqueak", "AudioStore initialized. Capacity - " + std::to_string(capacity_)
         );
     }
 
+    BufferStore::~BufferStore() {
+        {
+            std::lock_guard lock(analysisMutex_);
+            analysisStopping_ = true;
+        }
+        analysisCv_.notify_all();
+        if (analysisThread_.joinable())
+            analysisThread_.join();
+    }
+
     size_t BufferStore::insert(std::shared_ptr<const AudioBuffer> buffer) {
+        return insert(std::move(buffer), InsertOptions{});
+    }
+
+    size_t BufferStore::insert(std::shared_ptr<const AudioBuffer> buffer, const InsertOptions& options) {
+        PlacementPolicy policy;
+        {
+            std::shared_lock lock(mutex_);
+            policy = placement_;
+        }
+
+        // Run the load-time work before taking the lock
+        bool background = false;
+        Entry entry = prepare(std::move(buffer), options, policy, background);
+        auto analysed = background ? entry.buffer : nullptr;
+
         std::unique_lock lock(mutex_);
+        const size_t ID = commitLocked(std::move(entry));
+        lock.unlock();
+
+        // Queue the analysis; the metadata is attached when the worker finishes.
+        if (analysed) {
+            queueAnalysis({{ID, std::move(analysed), options.analysis}});
+        }
+
+        return ID;
+    }
+
+    std::vector<size_t> BufferStore::insertBatch(const std::vector<std::shared_ptr<const AudioBuffer>>& buffers,
+                                                 const InsertOptions& options) {
+        std::vector<InsertItem> items;
+        items.reserve(buffers.size());
+        for (const auto& buffer : buffers) {
+            items.push_back({buffer, options});
+        }
+        return insertBatch(items);
+    }
+
+    std::vector<size_t> BufferStore::insertBatch(const std::vector<InsertItem>& items) {
+        PlacementPolicy policy;
+        {
+            std::shared_lock lock(mutex_);
+            policy = placement_;
+        }
+
+        std::vector<Entry> entries;
+        std::vector<bool> background(items.size(), false);
+        entries.reserve(items.size());
+        for (size_t i = 0; i < items.size(); ++i) {
+            bool queued = false;
+            entries.push_back(prepare(items[i].buffer, items[i].options, policy, queued));
+            background[i] = queued;
+        }
+
+        // One exclusive section for the whole batch
+        std::vector<size_t> keys(items.size());
+        std::vector<AnalysisJob> jobs;
+        {
+            std::unique_lock lock(mutex_);
+            cache_.reserve(cache_.size() + items.size());
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (background[i]) {
+                    jobs.push_back({0, entries[i].buffer, items[i].options.analysis});
+                }
+                keys[i] = commitLocked(std::move(entries[i]));
+                if (background[i]) {
+                    jobs.back().key = keys[i];
+                }
+            }
+        }
+
+        if (!jobs.empty()) {
+            queueAnalysis(std::move(jobs));
+        }
+        return keys;
+    }
 
-        // Get the new ID and move the buffer
+    BufferStore::Entry BufferStore::prepare(std::shared_ptr<const AudioBuffer> buffer, const InsertOptions& options,
+                                            const PlacementPolicy& policy, bool& background) const {
+        Entry entry;
+
+        if (options.analyzeTransients && buffer) {
+            entry.transients = std::make_shared<const TransientMap>(detectTransients(*buffer));
+        }
+        background = options.analyzeSample && options.analyzeInBackground && !options.metadata && buffer;
+        if (options.metadata) {
+            entry.metadata = options.metadata;
+        } else if (options.analyzeSample && !background && buffer) {
+            entry.metadata = std::make_shared<const SampleMetadata>(analyzeSample(*buffer, options.analysis));
+        }
+        if (options.overview) {
+            entry.overview = options.overview;
+        } else if (options.buildOverview && buffer) {
+            entry.overview = std::make_shared<WaveformOverview>(WaveformOverview::build(*buffer, options.overviewOptions));
+        }
+        entry.buffer = std::move(buffer);
+        entry.tag = options.tag;
+
+        // Place the sample memory before the entry is visible to readers
+        if (entry.buffer && (policy.hugePages != HugePages::Off || policy.node != PlacementPolicy::kAnyNode)) {
+            placement::apply(entry.buffer->dataPtr(), entry.buffer->data().size() * sizeof(Sample), policy);
+        }
+        return entry;
+    }
+
+    size_t BufferStore::commitLocked(Entry entry) {
+        // Get the new ID and move the entry
         const size_t ID = ID_++;
-        cache_[ID] = std::move(buffer);
+        const size_t bytes = sampleBytes(entry.buffer);
+        entry.leases = std::make_shared<Leases>();
+        entry.leases->bytes = bytes;
+        entry.leases->counters = counters_;
+        if (!entry.tag.empty()) {
+            auto [group, created] = tags_.try_emplace(entry.tag);
+            if (created)
+                group->second.counters = std::make_shared<TagCounters>();
+            group->second.keys.insert(ID);
+            group->second.counters->entries.fetch_add(1, std::memory_order_relaxed);
+            group->second.counters->bytes.fetch_add(bytes, std::memory_order_relaxed);
+            if (created)
+                publishTagsLocked();
+        }
+        cache_[ID] = std::move(entry);
 
+        entries_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
         return ID;
     }
 
+    BufferStore::Entry BufferStore::detachLocked(const std::unordered_map<size_t, Entry>::iterator it,
+                                                 const EvictionCause cause) {
+        const size_t key = it->first;
+        Entry entry = std::move(it->second);
+        cache_.erase(it);
+
+        const size_t bytes = sampleBytes(entry.buffer);
+        entry.leases->detach();
+        if (!entry.tag.empty()) {
+            if (const auto tag = tags_.find(entry.tag); tag != tags_.end()) {
+                tag->second.keys.erase(key);
+                tag->second.counters->entries.fetch_sub(1, std::memory_order_relaxed);
+                tag->second.counters->bytes.fetch_sub(bytes, std::memory_order_relaxed);
+                if (tag->second.keys.empty()) {
+                    tags_.erase(tag);
+                    publishTagsLocked();
+                }
+            }
+        }
+
+        entries_.fetch_sub(1, std::memory_order_relaxed);
+        bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+        evictedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+
+        // The entry's own pointer is the only one the store had; anything beyond it is held elsewhere.
+        evictionHistory_.push_back({key, entry.tag, bytes, cause, entry.buffer && entry.buffer.use_count() > 1,
+                                    std::chrono::steady_clock::now()});
+        if (evictionHistory_.size() > kEvictionHistory)
+            evictionHistory_.pop_front();
+        return entry;
+    }
+
+    void BufferStore::queueAnalysis(std::vector<AnalysisJob> jobs) {
+        std::lock_guard queueLock(analysisMutex_);
+        for (auto& job : jobs) {
+            analysisQueue_.push_back(std::move(job));
+        }
+        analysisPending_ += jobs.size();
+        if (!analysisThread_.joinable())
+            analysisThread_ = std::thread(&BufferStore::analysisLoop, this);
+        analysisCv_.notify_all();
+    }
+
+    std::shared_ptr<const AudioBuffer> BufferStore::lease(const Entry& entry) {
+        if (!entry.buffer)
+            return nullptr;
+
+        // The handed-out pointer aliases the buffer; its control block releases the lease.
+        struct Handle {
+            Handle(std::shared_ptr<const AudioBuffer> b, std::shared_ptr<Leases> l)
+                : buffer(std::move(b)), leases(std::move(l)) { leases->acquire(); }
+            ~Handle() { leases->release(); }
+            Handle(const Handle&) = delete;
+            Handle& operator=(const Handle&) = delete;
+
+            std::shared_ptr<const AudioBuffer> buffer;
+            std::shared_ptr<Leases> leases;
+        };
+        auto handle = std::make_shared<Handle>(entry.buffer, entry.leases);
+        const AudioBuffer* raw = handle->buffer.get();
+        return {std::move(handle), raw};
+    }
+
+    void BufferStore::publishTagsLocked() {
+        auto table = std::make_shared<TagTable>();
+        for (const auto& [name, group] : tags_)
+            table->emplace(name, group.counters);
+        std::atomic_store(&tagTable_, std::shared_ptr<const TagTable>(std::move(table)));
+    }
+
     std::shared_ptr<const AudioBuffer> BufferStore::get(const size_t key) {
         std::shared_lock lock(mutex_);
 
         // Find and return the buffer
         if (const auto it = cache_.find(key); it != cache_.end()) {
-            return it->second;
+            return lease(it->second);
         }
 
         return nullptr;
     }
 
+    std::vector<std::shared_ptr<const AudioBuffer>> BufferStore::getBatch(const std::vector<size_t>& keys) {
+        std::vector<std::shared_ptr<const AudioBuffer>> buffers(keys.size());
+        std::shared_lock lock(mutex_);
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (const auto it = cache_.find(keys[i]); it != cache_.end()) {
+                buffers[i] = lease(it->second);
+            }
+        }
+        return buffers;
+    }
+
+    std::shared_ptr<const TransientMap> BufferStore::transients(const size_t key) {
+        std::shared_lock lock(mutex_);
+
+        if (const auto it = cache_.find(key); it != cache_.end()) {
+            return it->second.transients;
+        }
+
+        return nullptr;
+    }
+
+    std::shared_ptr<const SampleMetadata> BufferStore::metadata(const size_t key) {
+        std::shared_lock lock(mutex_);
+
+        if (const auto it = cache_.find(key); it != cache_.end()) {
+            return it->second.metadata;
+        }
+
+        return nullptr;
+    }
+
+    std::shared_ptr<WaveformOverview> BufferStore::overview(const size_t key) {
+        std::shared_lock lock(mutex_);
+
+        if (const auto it = cache_.find(key); it != cache_.end()) {
+            return it->second.overview;
+        }
+
+        return nullptr;
+    }
+
+    void BufferStore::waitForAnalysis() {
+        std::unique_lock lock(analysisMutex_);
+        analysisCv_.wait(lock, [this] { return analysisPending_ == 0; });
+    }
+
+    void BufferStore::analysisLoop() {
+        std::unique_lock lock(analysisMutex_);
+        for (;;) {
+            analysisCv_.wait(lock, [this] { return analysisStopping_ || !analysisQueue_.empty(); });
+            if (analysisStopping_)
+                return;
+
+            AnalysisJob job = std::move(analysisQueue_.front());
+            analysisQueue_.pop_front();
+            lock.unlock();
+
+            auto result = std::make_shared<const SampleMetadata>(analyzeSample(*job.buffer, job.options));
+            {
+                // The entry may have been erased meanwhile; then the result is simply dropped.
+                std::unique_lock storeLock(mutex_);
+                if (const auto it = cache_.find(job.key); it != cache_.end() && it->second.buffer == job.buffer)
+                    it->second.metadata = std::move(result);
+            }
+
+            lock.lock();
+            --analysisPending_;
+            analysisCv_.notify_all();
+        }
+    }
+
     bool BufferStore::erase(const size_t key) {
         std::unique_lock lock(mutex_);
 
         // Delete the buffer if found
         if (const auto it = cache_.find(key); it != cache_.end()) {
-            cache_.erase(it);
+            detachLocked(it, EvictionCause::Erased);
             return true;
         }
         return false;
     }
+
+    size_t BufferStore::eraseBatch(const std::vector<size_t>& keys) {
+        std::vector<Entry> erased;
+        erased.reserve(keys.size());
+        {
+            std::unique_lock lock(mutex_);
+            for (const size_t key : keys) {
+                if (const auto it = cache_.find(key); it != cache_.end()) {
+                    erased.push_back(detachLocked(it, EvictionCause::Erased));
+                }
+            }
+        }
+
+        // 'erased' frees the buffers here, outside the lock
+        return erased.size();
+    }
+
+    size_t BufferStore::eraseTag(const std::string& tag) {
+        std::vector<Entry> erased;
+        {
+            std::unique_lock lock(mutex_);
+            const auto members = tags_.find(tag);
+            if (members == tags_.end())
+                return 0;
+
+            // Detaching edits the group, so walk a copy of its keys
+            const std::vector<size_t> keys(members->second.keys.begin(), members->second.keys.end());
+            erased.reserve(keys.size());
+            for (const size_t key : keys) {
+                if (const auto it = cache_.find(key); it != cache_.end()) {
+                    erased.push_back(detachLocked(it, EvictionCause::TagErased));
+                }
+            }
+        }
+
+        return erased.size();
+    }
+
+    std::vector<size_t> BufferStore::tagged(const std::string& tag) {
+        std::shared_lock lock(mutex_);
+
+        if (const auto it = tags_.find(tag); it != tags_.end()) {
+            return {it->second.keys.begin(), it->second.keys.end()};
+        }
+        return {};
+    }
+
+    void BufferStore::reserve(const size_t entries) {
+        std::unique_lock lock(mutex_);
+        cache_.reserve(entries);
+    }
+
+    size_t BufferStore::size() const {
+        return entries_.load(std::memory_order_relaxed);
+    }
+
+    BufferStore::Usage BufferStore::usage() const {
+        Usage usage;
+        usage.entries = entries_.load(std::memory_order_relaxed);
+        usage.bytes = bytes_.load(std::memory_order_relaxed);
+        usage.evictions = evictions_.load(std::memory_order_relaxed);
+        usage.evictedBytes = evictedBytes_.load(std::memory_order_relaxed);
+        // Read separately, so clamp in case an erase lands between the two loads
+        usage.referencedBytes = std::min(counters_->referencedBytes.load(std::memory_order_relaxed), usage.bytes);
+        usage.storeOnlyBytes = usage.bytes - usage.referencedBytes;
+        return usage;
+    }
+
+    BufferStore::TagUsage BufferStore::tagUsage(const std::string& tag) const {
+        const auto table = std::atomic_load(&tagTable_);
+
+        if (const auto it = table->find(tag); it != table->end()) {
+            return {it->second->entries.load(std::memory_order_relaxed), it->second->bytes.load(std::memory_order_relaxed)};
+        }
+        return {};
+    }
+
+    BufferStore::Snapshot BufferStore::snapshot() const {
+        Snapshot snapshot;
+        std::shared_lock lock(mutex_);
+
+        snapshot.entries.reserve(cache_.size());
+        for (const auto& [key, entry] : cache_) {
+            EntryInfo info;
+            info.key = key;
+            info.tag = entry.tag;
+            info.bytes = sampleBytes(entry.buffer);
+            if (entry.buffer) {
+                info.channels = entry.buffer->numChannels();
+                info.frames = entry.buffer->numFrames();
+                info.references = entry.buffer.use_count() - 1;
+            }
+            info.hasMetadata = entry.metadata != nullptr;
+            info.hasOverview = entry.overview != nullptr;
+
+            snapshot.bytes += info.bytes;
+            (info.references > 0 ? snapshot.referencedBytes : snapshot.storeOnlyBytes) += info.bytes;
+            snapshot.entries.push_back(std::move(info));
+        }
+        return snapshot;
+    }
+
+    std::vector<BufferStore::EvictionRecord> BufferStore::evictions() const {
+        std::shared_lock lock(mutex_);
+        return {evictionHistory_.begin(), evictionHistory_.end()};
+    }
+
+    void BufferStore::setPlacementPolicy(const PlacementPolicy& policy) {
+        std::unique_lock lock(mutex_);
+        placement_ = policy;
+    }
+
+    bool BufferStore::place(const size_t key, const PlacementPolicy& policy) {
+        const auto buffer = get(key);
+        if (!buffer)
+            return false;
+        return placement::apply(buffer->dataPtr(), buffer->data().size() * sizeof(Sample), policy);
+    }
+
+    PlacementReport BufferStore::placement(const size_t key) {
+        const auto buffer = get(key);
+        if (!buffer)
+            return {};
+        return placement::query(buffer->dataPtr(), buffer->data().size() * sizeof(Sample));
+    }
 }
@@ -0,0 +1,346 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <pipsqueak/core/bundle.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PIPSQUEAK_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pipsqueak::core {
+    namespace {
+        constexpr char kMagic[8] = {'P', 'S', 'Q', 'B', 'N', 'D', 'L', '1'};
+        constexpr std::uint32_t kVersion = 2;
+        constexpr size_t kHeaderBytes = 64;
+        constexpr size_t kRecordBytes = 96;
+        constexpr size_t kRecordBytesV1 = 64; // Version 1 records end before the analysis fields
+        constexpr std::uint64_t kBlockAlignment = 4096;
+        constexpr std::uint16_t kFlagLoop = 1;
+        constexpr std::uint16_t kFlagAnalysis = 2;
+
+        std::uint64_t alignUp(const std::uint64_t n) { return (n + kBlockAlignment - 1) & ~(kBlockAlignment - 1); }
+
+        size_t bytesPerSample(const SampleEncoding encoding) {
+            return encoding == SampleEncoding::Int16 ? 2 : 4;
+        }
+
+        // Little-endian field writer over a fixed-size record.
+        struct Put {
+            std::uint8_t* p;
+            void u16(const std::uint16_t v) { for (int i = 0; i < 2; ++i) *p++ = static_cast<std::uint8_t>(v >> 8 * i); }
+            void u32(const std::uint32_t v) { for (int i = 0; i < 4; ++i) *p++ = static_cast<std::uint8_t>(v >> 8 * i); }
+            void u64(const std::uint64_t v) { for (int i = 0; i < 8; ++i) *p++ = static_cast<std::uint8_t>(v >> 8 * i); }
+            void f32(const float v) { std::uint32_t bits; std::memcpy(&bits, &v, 4); u32(bits); }
+        };
+
+        // Little-endian field reader over a validated record.
+        struct Get {
+            const std::uint8_t* p;
+            std::uint16_t u16() { std::uint16_t v = 0; for (int i = 0; i < 2; ++i) v |= static_cast<std::uint16_t>(*p++ << 8 * i); return v; }
+            std::uint32_t u32() { std::uint32_t v = 0; for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(*p++) << 8 * i; return v; }
+            std::uint64_t u64() { std::uint64_t v = 0; for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(*p++) << 8 * i; return v; }
+            float f32() { const std::uint32_t bits = u32(); float v; std::memcpy(&v, &bits, 4); return v; }
+        };
+
+        bool fail(std::string* error, const std::string& message) {
+            if (error) *error = message;
+            return false;
+        }
+    }
+
+    // ---- Writer ----
+
+    BundleWriter::BundleWriter(const SampleEncoding encoding) : encoding_(encoding) {}
+
+    void BundleWriter::add(BundleSample sample) {
+        if (!sample.buffer)
+            throw std::invalid_argument("BundleWriter: sample '" + sample.name + "' has no buffer");
+        if (sample.loopEnd > sample.loopStart && sample.loopEnd > sample.buffer->numFrames())
+            throw std::invalid_argument("BundleWriter: loop of '" + sample.name + "' runs past its end");
+        if (!sample.metadata) {
+            SampleAnalysisOptions options;
+            options.loopStart = sample.loopStart;
+            options.loopEnd = sample.loopEnd;
+            sample.metadata = std::make_shared<const SampleMetadata>(analyzeSample(*sample.buffer, options));
+        }
+        if (sample.peak < 0.0f)
+            sample.peak = sample.metadata->peak;
+        samples_.push_back(std::move(sample));
+    }
+
+    size_t BundleWriter::count() const noexcept {
+        return samples_.size();
+    }
+
+    bool BundleWriter::write(const std::string& path, std::string* error) const {
+        // Lay out the name table and the data blocks.
+        const std::uint64_t indexOffset = kHeaderBytes;
+        const std::uint64_t namesOffset = indexOffset + kRecordBytes * samples_.size();
+        std::uint64_t namesBytes = 0;
+        for (const auto& s : samples_) namesBytes += s.name.size();
+
+        std::vector<std::uint64_t> dataOffsets;
+        std::uint64_t cursor = alignUp(namesOffset + namesBytes);
+        for (const auto& s : samples_) {
+            dataOffsets.push_back(cursor);
+            cursor = alignUp(cursor + s.buffer->data().size() * bytesPerSample(encoding_));
+        }
+        const std::uint64_t fileBytes = cursor;
+
+        // Header, index and names in one contiguous prefix.
+        std::vector<std::uint8_t> prefix(namesOffset + namesBytes, 0);
+        std::memcpy(prefix.data(), kMagic, sizeof(kMagic));
+        Put header{prefix.data() + sizeof(kMagic)};
+        header.u32(kVersion);
+        header.u32(static_cast<std::uint32_t>(samples_.size()));
+        header.u64(indexOffset);
+        header.u64(namesOffset);
+        header.u64(namesBytes);
+        header.u64(fileBytes);
+
+        std::uint64_t nameCursor = 0;
+        for (size_t i = 0; i < samples_.size(); ++i) {
+            const auto& s = samples_[i];
+            const float scale = encoding_ == SampleEncoding::Int16 && s.peak > 0.0f ? s.peak / 32767.0f : 1.0f / 32767.0f;
+
+            Put record{prefix.data() + indexOffset + kRecordBytes * i};
+            record.u64(dataOffsets[i]);
+            record.u64(s.buffer->data().size() * bytesPerSample(encoding_));
+            record.u32(static_cast<std::uint32_t>(nameCursor));
+            record.u32(static_cast<std::uint32_t>(s.name.size()));
+            record.u32(s.buffer->numChannels());
+            record.u32(s.buffer->numFrames());
+            record.u32(s.sampleRate);
+            record.u16(static_cast<std::uint16_t>(encoding_));
+            record.u16(static_cast<std::uint16_t>((s.loopEnd > s.loopStart ? kFlagLoop : 0) | kFlagAnalysis));
+            record.u32(static_cast<std::uint32_t>(s.rootNote));
+            record.u32(s.loopStart);
+            record.u32(s.loopEnd);
+            record.f32(s.peak);
+            record.f32(scale);
+            record.u32(0); // Reserved
+            record.f32(s.metadata->rms);
+            record.f32(s.metadata->dcOffset);
+            record.u32(s.metadata->leadingSilence);
+            record.u32(s.metadata->trailingSilence);
+            record.u32(s.metadata->loopStartCrossing);
+            record.u32(s.metadata->loopEndCrossing);
+
+            std::memcpy(prefix.data() + namesOffset + nameCursor, s.name.data(), s.name.size());
+            nameCursor += s.name.size();
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return fail(error, "cannot create " + path);
+        out.write(reinterpret_cast<const char*>(prefix.data()), static_cast<std::streamsize>(prefix.size()));
+
+        // Each block, zero padded up to the next boundary.
+        std::uint64_t written = prefix.size();
+        const std::vector<char> zeros(kBlockAlignment, 0);
+        std::vector<std::int16_t> quantized;
+        for (size_t i = 0; i < samples_.size(); ++i) {
+            out.write(zeros.data(), static_cast<std::streamsize>(dataOffsets[i] - written));
+            const auto& s = samples_[i];
+            const PCMData& data = s.buffer->data();
+            if (encoding_ == SampleEncoding::Int16) {
+                const float inverse = s.peak > 0.0f ? 32767.0f / s.peak : 32767.0f;
+                quantized.resize(data.size());
+                for (size_t n = 0; n < data.size(); ++n) {
+                    const float q = std::round(std::clamp(data[n] * inverse, -32767.0f, 32767.0f));
+                    quantized[n] = static_cast<std::int16_t>(q);
+                }
+                out.write(reinterpret_cast<const char*>(quantized.data()),
+                          static_cast<std::streamsize>(quantized.size() * sizeof(std::int16_t)));
+                written = dataOffsets[i] + quantized.size() * sizeof(std::int16_t);
+            } else {
+                out.write(reinterpret_cast<const char*>(data.data()),
+                          static_cast<std::streamsize>(data.size() * sizeof(Sample)));
+                written = dataOffsets[i] + data.size() * sizeof(Sample);
+            }
+        }
+        out.write(zeros.data(), static_cast<std::streamsize>(fileBytes - written));
+
+        if (!out)
+            return fail(error, "write to " + path + " failed");
+        return true;
+    }
+
+    // ---- Reader ----
+
+    Bundle::~Bundle() {
+#ifdef PIPSQUEAK_HAS_MMAP
+        if (mapped_)
+            ::munmap(const_cast<std::uint8_t*>(base_), size_);
+#endif
+    }
+
+    std::shared_ptr<Bundle> Bundle::open(const std::string& path, std::string* error) {
+        const auto reject = [&](const std::string& message) -> std::shared_ptr<Bundle> {
+            if (error) *error = message;
+            return nullptr;
+        };
+        std::shared_ptr<Bundle> bundle(new Bundle());
+
+#ifdef PIPSQUEAK_HAS_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return reject("cannot open " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                bundle->base_ = static_cast<const std::uint8_t*>(map);
+                bundle->size_ = static_cast<size_t>(st.st_size);
+                bundle->mapped_ = true;
+            }
+        }
+        ::close(fd);
+#endif
+        if (!bundle->mapped_) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in)
+                return reject("cannot open " + path);
+            bundle->fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            bundle->base_ = bundle->fallback_.data();
+            bundle->size_ = bundle->fallback_.size();
+        }
+
+        // ---- Validate the header and every record against the file size ----
+        const std::uint8_t* base = bundle->base_;
+        const std::uint64_t size = bundle->size_;
+        if (size < kHeaderBytes || std::memcmp(base, kMagic, sizeof(kMagic)) != 0)
+            return reject(path + " is not a bundle");
+
+        Get header{base + sizeof(kMagic)};
+        const std::uint32_t version = header.u32();
+        const std::uint32_t count = header.u32();
+        const std::uint64_t indexOffset = header.u64();
+        const std::uint64_t namesOffset = header.u64();
+        const std::uint64_t namesBytes = header.u64();
+        const std::uint64_t fileBytes = header.u64();
+        if (version != kVersion && version != 1)
+            return reject(path + " has unsupported bundle version " + std::to_string(version));
+        const size_t recordBytes = version == 1 ? kRecordBytesV1 : kRecordBytes;
+        // Each range is checked against the space left after its start, so no sum can wrap
+        if (fileBytes > size || indexOffset > size || count > (size - indexOffset) / recordBytes ||
+            namesOffset > size || namesBytes > size - namesOffset)
+            return reject(path + " is truncated");
+
+        bundle->entries_.reserve(count);
+        bundle->blocks_.reserve(count);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            Get record{base + indexOffset + recordBytes * i};
+            Block block{};
+            BundleEntry entry;
+            block.offset = record.u64();
+            block.bytes = record.u64();
+            const std::uint32_t nameOffset = record.u32();
+            const std::uint32_t nameLength = record.u32();
+            entry.channels = record.u32();
+            entry.frames = record.u32();
+            entry.sampleRate = record.u32();
+            const std::uint16_t encoding = record.u16();
+            const std::uint16_t flags = record.u16();
+            entry.rootNote = static_cast<std::int32_t>(record.u32());
+            entry.loopStart = record.u32();
+            entry.loopEnd = record.u32();
+            entry.peak = record.f32();
+            block.scale = record.f32();
+            if (version >= 2 && (flags & kFlagAnalysis)) {
+                record.u32(); // Reserved
+                SampleMetadata meta;
+                meta.peak = entry.peak;
+                meta.rms = record.f32();
+                meta.dcOffset = record.f32();
+                meta.leadingSilence = record.u32();
+                meta.trailingSilence = record.u32();
+                meta.loopStartCrossing = record.u32();
+                meta.loopEndCrossing = record.u32();
+                entry.metadata = std::make_shared<const SampleMetadata>(meta);
+            }
+
+            if (encoding != static_cast<std::uint16_t>(SampleEncoding::Float32) &&
+                encoding != static_cast<std::uint16_t>(SampleEncoding::Int16))
+                return reject(path + ": entry " + std::to_string(i) + " has an unknown encoding");
+            entry.encoding = static_cast<SampleEncoding>(encoding);
+            if (!(flags & kFlagLoop))
+                entry.loopStart = entry.loopEnd = 0;
+
+            const std::uint64_t expected = std::uint64_t{entry.channels} * entry.frames * bytesPerSample(entry.encoding);
+            if (std::uint64_t{nameOffset} + nameLength > namesBytes || block.bytes != expected ||
+                block.offset % kBlockAlignment != 0 || block.offset > size || block.bytes > size - block.offset ||
+                entry.loopEnd > entry.frames)
+                return reject(path + ": entry " + std::to_string(i) + " is malformed");
+
+            entry.name.assign(reinterpret_cast<const char*>(base + namesOffset + nameOffset), nameLength);
+            bundle->entries_.push_back(std::move(entry));
+            bundle->blocks_.push_back(block);
+        }
+        return bundle;
+    }
+
+    size_t Bundle::count() const noexcept {
+        return entries_.size();
+    }
+
+    const BundleEntry& Bundle::entry(const size_t index) const {
+        return entries_.at(index);
+    }
+
+    std::optional<size_t> Bundle::find(const std::string& name) const {
+        const auto it = std::find_if(entries_.begin(), entries_.end(),
+                                     [&](const BundleEntry& e) { return e.name == name; });
+        if (it == entries_.end())
+            return std::nullopt;
+        return static_cast<size_t>(it - entries_.begin());
+    }
+
+    std::shared_ptr<AudioBuffer> Bundle::load(const size_t index) const {
+        const BundleEntry& e = entries_.at(index);
+        const Block& block = blocks_[index];
+        const std::uint8_t* src = base_ + block.offset;
+
+#ifdef PIPSQUEAK_HAS_MMAP
+        // Start readahead on the whole block before the copy faults through it.
+        if (mapped_ && block.bytes > 0)
+            ::madvise(const_cast<std::uint8_t*>(src), static_cast<size_t>(block.bytes), MADV_WILLNEED);
+#endif
+
+        auto buffer = std::make_shared<AudioBuffer>(e.channels, e.frames);
+        Sample* dst = buffer->dataPtr();
+        const size_t samples = buffer->data().size();
+        if (e.encoding == SampleEncoding::Float32) {
+            std::memcpy(dst, src, samples * sizeof(Sample));
+        } else {
+            for (size_t n = 0; n < samples; ++n) {
+                std::int16_t v;
+                std::memcpy(&v, src + 2 * n, 2);
+                dst[n] = static_cast<Sample>(v) * block.scale;
+            }
+        }
+        return buffer;
+    }
+
+    std::vector<size_t> Bundle::registerInto(BufferStore& store, const BufferStore::InsertOptions& options) const {
+        std::vector<BufferStore::InsertItem> items;
+        items.reserve(entries_.size());
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            items.push_back({load(i), options});
+            if (entries_[i].metadata)
+                items.back().options.metadata = entries_[i].metadata;
+        }
+        return store.insertBatch(items);
+    }
+}
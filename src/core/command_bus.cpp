@@ -0,0 +1,93 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <pipsqueak/core/command_bus.hpp>
+
+namespace pipsqueak::core {
+    CommandBus::CommandBus(const size_t capacity) : commands_(capacity), returns_(capacity) {}
+
+    CommandBus::~CommandBus() {
+        collect();
+
+        // Whatever was never applied is released here, on the owning thread.
+        while (Command* pending = commands_.peek()) {
+            if (pending->retire) pending->retire(*pending);
+            commands_.pop();
+        }
+    }
+
+    std::uint64_t CommandBus::post(const Command& command) {
+        return post(&command, 1);
+    }
+
+    std::uint64_t CommandBus::post(const Command* commands, const size_t count) {
+        // Retire finished work first so payloads do not pile up between explicit collects.
+        if (std::unique_lock lock(collectMutex_, std::try_to_lock); lock.owns_lock()) {
+            Command done;
+            while (returns_.tryPop(done))
+                if (done.retire) done.retire(done);
+        }
+
+        const size_t first = commands_.tryPushBatch(count, [&](const size_t i, Command& slot) {
+            slot = commands[i];
+            slot.span = (i == 0) ? static_cast<std::uint32_t>(count) : 1;
+        });
+        if (first == 0)
+            return 0;
+
+        // Sequence numbers are queue positions, so they are dense and in apply order.
+        return first + count - 1;
+    }
+
+    size_t CommandBus::drain(const size_t budget) {
+        size_t applied = 0;
+        while (applied < budget) {
+            const Command* head = commands_.peek();
+            if (!head)
+                break;
+
+            // Whole transactions only, and only once every record has been published.
+            const size_t span = head->span;
+            if (applied > 0 && applied + span > budget)
+                break;
+            if (!commands_.peek(span - 1) || returns_.freeSpace() < span)
+                break;
+
+            const std::uint64_t base = commands_.headPosition();
+            for (size_t k = 0; k < span; ++k) {
+                Command& command = *commands_.peek(k);
+                command.sequence = base + k;
+                if (command.apply) command.apply(command);
+                returns_.tryPush(command);
+            }
+            commands_.pop(span);
+            applied += span;
+            completed_.store(base + span - 1, std::memory_order_release);
+        }
+        return applied;
+    }
+
+    size_t CommandBus::collect() {
+        std::lock_guard lock(collectMutex_);
+        size_t retired = 0;
+        Command done;
+        while (returns_.tryPop(done)) {
+            if (done.retire) done.retire(done);
+            ++retired;
+        }
+        return retired;
+    }
+
+    std::uint64_t CommandBus::completed() const noexcept {
+        return completed_.load(std::memory_order_acquire);
+    }
+
+    bool CommandBus::isComplete(const std::uint64_t sequence) const noexcept {
+        return sequence != 0 && completed() >= sequence;
+    }
+
+    size_t CommandBus::capacity() const noexcept {
+        return commands_.capacity();
+    }
+}
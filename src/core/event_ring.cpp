@@ -0,0 +1,108 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <pipsqueak/core/event_ring.hpp>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace pipsqueak::core {
+    namespace {
+        // The capture this thread's posts go to, if any
+        thread_local EventCapture* activeCapture = nullptr;
+    }
+
+    EventRing::EventRing(const size_t capacity) : events_(capacity) {
+#ifdef __linux__
+        fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    }
+
+    EventRing::~EventRing() {
+#ifdef __linux__
+        if (fd_ >= 0)
+            ::close(fd_);
+#endif
+    }
+
+    void EventRing::beginBlock(const std::uint64_t frame) noexcept {
+        blockFrame_ = frame;
+    }
+
+    bool EventRing::post(const EventType type, const void* source, const std::uint32_t offset,
+                         const std::int32_t value) noexcept {
+        if (activeCapture)
+            return activeCapture->capture({this, type, source, offset, value});
+        if (!events_.tryPush({type, value, blockFrame_ + offset, source})) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        postedThisBlock_ = true;
+        return true;
+    }
+
+    void EventRing::endBlock() noexcept {
+        if (!postedThisBlock_)
+            return;
+        postedThisBlock_ = false;
+#ifdef __linux__
+        if (fd_ >= 0) {
+            // Non-blocking; a saturated counter just means waiters are already awake.
+            const std::uint64_t one = 1;
+            [[maybe_unused]] const auto written = ::write(fd_, &one, sizeof(one));
+        }
+#endif
+    }
+
+    bool EventRing::poll(Event& event) {
+        return events_.tryPop(event);
+    }
+
+    int EventRing::fd() const noexcept {
+        return fd_;
+    }
+
+    std::uint64_t EventRing::dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    void EventRing::clearWakeup() noexcept {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            std::uint64_t count = 0;
+            [[maybe_unused]] const auto read = ::read(fd_, &count, sizeof(count));
+        }
+#endif
+    }
+
+    EventCapture::EventCapture(const size_t capacity) : pending_(capacity) {}
+
+    EventCapture::Scope::Scope(EventCapture& capture) noexcept : previous_(activeCapture) {
+        activeCapture = &capture;
+    }
+
+    EventCapture::Scope::~Scope() {
+        activeCapture = previous_;
+    }
+
+    bool EventCapture::capture(const Pending& pending) noexcept {
+        if (count_ == pending_.size()) {
+            pending.ring->dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        pending_[count_++] = pending;
+        return true;
+    }
+
+    void EventCapture::forward() noexcept {
+        // post() again rather than pushing directly, so an enclosing capture still applies
+        for (size_t i = 0; i < count_; ++i) {
+            const auto& pending = pending_[i];
+            pending.ring->post(pending.type, pending.source, pending.offset, pending.value);
+        }
+        count_ = 0;
+    }
+}
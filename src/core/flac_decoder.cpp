@@ -0,0 +1,596 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <pipsqueak/core/flac_decoder.hpp>
+
+#include <pipsqueak/core/kernels.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace pipsqueak::core {
+    namespace {
+        constexpr unsigned kMaxChannels = 8;
+        constexpr unsigned kMaxBitsPerSample = 24;
+
+        // ---- Checksums ----
+
+        struct CrcTables {
+            std::uint8_t crc8[256];
+            std::uint16_t crc16[256];
+
+            CrcTables() : crc8{}, crc16{} {
+                for (unsigned i = 0; i < 256; ++i) {
+                    unsigned c8 = i;
+                    unsigned c16 = i << 8;
+                    for (int b = 0; b < 8; ++b) {
+                        c8 = (c8 & 0x80) ? (c8 << 1) ^ 0x07 : c8 << 1;
+                        c16 = (c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : c16 << 1;
+                    }
+                    crc8[i] = static_cast<std::uint8_t>(c8);
+                    crc16[i] = static_cast<std::uint16_t>(c16);
+                }
+            }
+        };
+
+        const CrcTables& crcTables() {
+            static const CrcTables tables;
+            return tables;
+        }
+
+        std::uint8_t crc8(const std::uint8_t* p, const size_t n) {
+            const auto& t = crcTables().crc8;
+            std::uint8_t crc = 0;
+            for (size_t i = 0; i < n; ++i) crc = t[crc ^ p[i]];
+            return crc;
+        }
+
+        std::uint16_t crc16(const std::uint8_t* p, const size_t n) {
+            const auto& t = crcTables().crc16;
+            std::uint16_t crc = 0;
+            for (size_t i = 0; i < n; ++i)
+                crc = static_cast<std::uint16_t>((crc << 8) ^ t[(crc >> 8) ^ p[i]]);
+            return crc;
+        }
+
+        unsigned leadingZeros(const std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_clzll(v));
+#else
+            unsigned n = 0;
+            for (std::uint64_t bit = std::uint64_t{1} << 63; !(v & bit); bit >>= 1) ++n;
+            return n;
+#endif
+        }
+
+        // ---- Bitstream ----
+
+        // MSB-first reader; reads past the end yield zeros and set overrun().
+        class BitReader {
+        public:
+            BitReader(const std::uint8_t* data, const size_t size) : data_(data), size_(size) {}
+
+            std::uint32_t read(const unsigned n) {
+                if (n == 0) return 0;
+                const auto v = static_cast<std::uint32_t>(window() >> (64 - n));
+                pos_ += n;
+                return v;
+            }
+
+            std::int32_t readSigned(const unsigned n) {
+                if (n == 0) return 0;
+                const std::int64_t sign = std::int64_t{1} << (n - 1);
+                return static_cast<std::int32_t>((static_cast<std::int64_t>(read(n)) ^ sign) - sign);
+            }
+
+            // Counts zero bits up to (and consumes) the next one bit.
+            std::uint32_t readUnary() {
+                std::uint32_t count = 0;
+                for (;;) {
+                    // At least 57 bits of the window are real (or zero past the end).
+                    const std::uint64_t v = window();
+                    const unsigned zeros = v ? leadingZeros(v) : 64;
+                    if (zeros < 57) {
+                        pos_ += zeros + 1;
+                        return count + zeros;
+                    }
+                    pos_ += 56;
+                    count += 56;
+                    if (overrun()) return count;
+                }
+            }
+
+            void alignToByte() { pos_ = (pos_ + 7) & ~size_t{7}; }
+            [[nodiscard]] size_t bytePosition() const { return pos_ >> 3; }
+            [[nodiscard]] bool overrun() const { return pos_ > size_ * 8; }
+
+        private:
+            // The next 64 bits starting at the read position, left aligned.
+            [[nodiscard]] std::uint64_t window() const {
+                const size_t byte = pos_ >> 3;
+                std::uint64_t v = 0;
+                if (byte + 8 <= size_) {
+                    for (int i = 0; i < 8; ++i) v = (v << 8) | data_[byte + i];
+                } else {
+                    for (size_t i = 0; i < 8; ++i) v = (v << 8) | (byte + i < size_ ? data_[byte + i] : 0);
+                }
+                return v << (pos_ & 7);
+            }
+
+            const std::uint8_t* data_;
+            size_t size_;
+            size_t pos_{0};
+        };
+
+        // ---- Frames ----
+
+        struct FrameHeader {
+            unsigned blockSize{0};
+            unsigned channelAssignment{0}; // 0-7 independent, 8 left/side, 9 right/side, 10 mid/side
+            unsigned bitsPerSample{0};
+            bool variable{false};          // Number is a sample number rather than a frame number
+            std::uint64_t number{0};
+            size_t bytes{0};               // Header length including the CRC-8
+        };
+
+        // Parses and CRC-checks the frame header at p; false if it is not a valid header for this stream.
+        bool parseFrameHeader(const std::uint8_t* p, const size_t avail, const FlacInfo& info, FrameHeader& h) {
+            if (avail < 6 || p[0] != 0xFF || (p[1] & 0xFE) != 0xF8)
+                return false;
+            h.variable = p[1] & 1;
+            const unsigned blockCode = p[2] >> 4;
+            const unsigned rateCode = p[2] & 0x0F;
+            h.channelAssignment = p[3] >> 4;
+            const unsigned sizeCode = (p[3] >> 1) & 0x07;
+            if (blockCode == 0 || rateCode == 15 || h.channelAssignment > 10 || sizeCode == 3 || (p[3] & 1))
+                return false;
+
+            // UTF-8 style coded frame / sample number
+            size_t pos = 4;
+            const std::uint8_t lead = p[pos++];
+            unsigned extra = 0;
+            std::uint64_t number = 0;
+            if (lead < 0x80) { number = lead; }
+            else if ((lead & 0xE0) == 0xC0) { extra = 1; number = lead & 0x1F; }
+            else if ((lead & 0xF0) == 0xE0) { extra = 2; number = lead & 0x0F; }
+            else if ((lead & 0xF8) == 0xF0) { extra = 3; number = lead & 0x07; }
+            else if ((lead & 0xFC) == 0xF8) { extra = 4; number = lead & 0x03; }
+            else if ((lead & 0xFE) == 0xFC) { extra = 5; number = lead & 0x01; }
+            else if (lead == 0xFE) { extra = 6; }
+            else return false;
+            if ((!h.variable && extra > 5) || pos + extra + 4 > avail)
+                return false;
+            for (unsigned i = 0; i < extra; ++i) {
+                const std::uint8_t c = p[pos++];
+                if ((c & 0xC0) != 0x80) return false;
+                number = (number << 6) | (c & 0x3F);
+            }
+            h.number = number;
+
+            // Block size
+            if (blockCode == 1) h.blockSize = 192;
+            else if (blockCode <= 5) h.blockSize = 576u << (blockCode - 2);
+            else if (blockCode == 6) h.blockSize = p[pos++] + 1u;
+            else if (blockCode == 7) { h.blockSize = ((p[pos] << 8) | p[pos + 1]) + 1u; pos += 2; }
+            else h.blockSize = 256u << (blockCode - 8);
+
+            // Sample rate (only its length matters here)
+            if (rateCode == 12) pos += 1;
+            else if (rateCode == 13 || rateCode == 14) pos += 2;
+
+            static constexpr unsigned kSizes[8] = {0, 8, 12, 0, 16, 20, 24, 32};
+            h.bitsPerSample = sizeCode == 0 ? info.bitsPerSample : kSizes[sizeCode];
+
+            if (pos >= avail || crc8(p, pos) != p[pos])
+                return false;
+            h.bytes = pos + 1;
+
+            const unsigned channels = h.channelAssignment < 8 ? h.channelAssignment + 1 : 2;
+            return channels == info.channels && h.bitsPerSample == info.bitsPerSample;
+        }
+
+        bool decodeResidual(BitReader& in, std::int32_t* dst, const unsigned blockSize, const unsigned order) {
+            const std::uint32_t method = in.read(2);
+            if (method > 1)
+                return false;
+            const unsigned paramBits = method == 0 ? 4 : 5;
+            const std::uint32_t escape = method == 0 ? 15 : 31;
+
+            const unsigned partitionOrder = in.read(4);
+            const unsigned partitions = 1u << partitionOrder;
+            if (blockSize & (partitions - 1))
+                return false;
+            const unsigned perPartition = blockSize >> partitionOrder;
+            if (perPartition < order)
+                return false;
+
+            size_t i = order;
+            for (unsigned part = 0; part < partitions; ++part) {
+                const unsigned n = perPartition - (part == 0 ? order : 0);
+                const std::uint32_t k = in.read(paramBits);
+                if (k == escape) {
+                    const unsigned bits = in.read(5);
+                    for (unsigned s = 0; s < n; ++s) dst[i++] = in.readSigned(bits);
+                } else {
+                    for (unsigned s = 0; s < n; ++s) {
+                        const std::uint32_t u = (in.readUnary() << k) | in.read(k);
+                        dst[i++] = static_cast<std::int32_t>(u >> 1) ^ -static_cast<std::int32_t>(u & 1);
+                    }
+                }
+                if (in.overrun())
+                    return false;
+            }
+            return true;
+        }
+
+        void restoreFixed(std::int32_t* s, const unsigned blockSize, const unsigned order) {
+            for (unsigned i = order; i < blockSize; ++i) {
+                std::int64_t prediction = 0;
+                switch (order) {
+                    case 1: prediction = s[i - 1]; break;
+                    case 2: prediction = 2 * std::int64_t{s[i - 1]} - s[i - 2]; break;
+                    case 3: prediction = 3 * (std::int64_t{s[i - 1]} - s[i - 2]) + s[i - 3]; break;
+                    case 4: prediction = 4 * (std::int64_t{s[i - 1]} + s[i - 3]) - 6 * std::int64_t{s[i - 2]} - s[i - 4]; break;
+                    default: break;
+                }
+                s[i] = static_cast<std::int32_t>(s[i] + prediction);
+            }
+        }
+
+        unsigned ceilLog2(const unsigned n) {
+            unsigned bits = 0;
+            while ((1u << bits) < n) ++bits;
+            return bits;
+        }
+
+        bool decodeSubframe(BitReader& in, std::int32_t* dst, const unsigned blockSize, const unsigned bps) {
+            if (in.read(1) != 0)
+                return false;
+            const unsigned type = in.read(6);
+            unsigned wasted = 0;
+            if (in.read(1)) {
+                wasted = in.readUnary() + 1;
+                if (wasted >= bps)
+                    return false;
+            }
+            const unsigned bits = bps - wasted;
+
+            if (type == 0) {
+                const std::int32_t value = in.readSigned(bits);
+                std::fill(dst, dst + blockSize, value);
+            } else if (type == 1) {
+                for (unsigned i = 0; i < blockSize; ++i) dst[i] = in.readSigned(bits);
+            } else if (type >= 8 && type <= 12) {
+                const unsigned order = type - 8;
+                if (order > blockSize) return false;
+                for (unsigned i = 0; i < order; ++i) dst[i] = in.readSigned(bits);
+                if (!decodeResidual(in, dst, blockSize, order)) return false;
+                restoreFixed(dst, blockSize, order);
+            } else if (type >= 32) {
+                const unsigned order = type - 31;
+                if (order > blockSize) return false;
+                for (unsigned i = 0; i < order; ++i) dst[i] = in.readSigned(bits);
+                const unsigned precision = in.read(4) + 1;
+                const std::int32_t shift = in.readSigned(5);
+                if (precision == 16 || shift < 0) return false;
+                std::int32_t coefficients[32];
+                for (unsigned i = 0; i < order; ++i) coefficients[i] = in.readSigned(precision);
+                if (!decodeResidual(in, dst, blockSize, order)) return false;
+                const bool wide = bits + precision + ceilLog2(order) > 32;
+                kernels::active().lpcRestore(dst, blockSize, coefficients, order, shift, wide);
+            } else {
+                return false;
+            }
+
+            if (wasted) {
+                for (unsigned i = 0; i < blockSize; ++i)
+                    dst[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(dst[i]) << wasted);
+            }
+            return !in.overrun();
+        }
+
+        // Per-worker decode scratch, one integer block per channel.
+        struct Scratch {
+            std::vector<std::int32_t> channels[kMaxChannels];
+        };
+
+        // Decodes the frame at p into its place in @p out. Nothing is written unless the frame's
+        // CRC-16 matches. Returns the frame length in bytes, or 0 if it is not a valid frame.
+        size_t decodeFrame(const std::uint8_t* p, const size_t avail, const FlacInfo& info, const bool variable,
+                           AudioBuffer& out, Scratch& scratch, unsigned& blockSize) {
+            FrameHeader h;
+            if (!parseFrameHeader(p, avail, info, h) || h.variable != variable)
+                return 0;
+
+            const std::uint64_t position = variable ? h.number : h.number * info.maxBlockSize;
+            if (position + h.blockSize > out.numFrames())
+                return 0;
+
+            const unsigned channels = info.channels;
+            BitReader in(p + h.bytes, avail - h.bytes);
+            for (unsigned c = 0; c < channels; ++c) {
+                auto& block = scratch.channels[c];
+                if (block.size() < h.blockSize) block.resize(h.blockSize);
+                // The side channel of a stereo decorrelation carries one extra bit.
+                const bool side = (h.channelAssignment == 8 && c == 1) || (h.channelAssignment == 9 && c == 0) ||
+                                  (h.channelAssignment == 10 && c == 1);
+                if (!decodeSubframe(in, block.data(), h.blockSize, h.bitsPerSample + (side ? 1 : 0)))
+                    return 0;
+            }
+
+            // Footer: zero padding to a byte boundary, then CRC-16 of the whole frame.
+            in.alignToByte();
+            const size_t end = h.bytes + in.bytePosition() + 2;
+            if (end > avail || crc16(p, end - 2) != static_cast<std::uint16_t>((p[end - 2] << 8) | p[end - 1]))
+                return 0;
+
+            // Decorrelate and convert straight into the interleaved destination.
+            const Sample scale = 1.0f / static_cast<Sample>(1u << (info.bitsPerSample - 1));
+            Sample* dst = out.dataPtr() + position * channels;
+            const std::int32_t* a = scratch.channels[0].data();
+            const std::int32_t* b = channels > 1 ? scratch.channels[1].data() : nullptr;
+            const unsigned n = h.blockSize;
+            switch (h.channelAssignment) {
+                case 8: // left / side
+                    for (unsigned i = 0; i < n; ++i) {
+                        dst[2 * i] = static_cast<Sample>(a[i]) * scale;
+                        dst[2 * i + 1] = static_cast<Sample>(a[i] - b[i]) * scale;
+                    }
+                    break;
+                case 9: // side / right
+                    for (unsigned i = 0; i < n; ++i) {
+                        dst[2 * i] = static_cast<Sample>(a[i] + b[i]) * scale;
+                        dst[2 * i + 1] = static_cast<Sample>(b[i]) * scale;
+                    }
+                    break;
+                case 10: // mid / side
+                    for (unsigned i = 0; i < n; ++i) {
+                        const std::int32_t mid = static_cast<std::int32_t>(static_cast<std::uint32_t>(a[i]) << 1) | (b[i] & 1);
+                        dst[2 * i] = static_cast<Sample>((mid + b[i]) >> 1) * scale;
+                        dst[2 * i + 1] = static_cast<Sample>((mid - b[i]) >> 1) * scale;
+                    }
+                    break;
+                default:
+                    if (channels == 1) {
+                        for (unsigned i = 0; i < n; ++i) dst[i] = static_cast<Sample>(a[i]) * scale;
+                    } else {
+                        for (unsigned c = 0; c < channels; ++c) {
+                            const std::int32_t* src = scratch.channels[c].data();
+                            for (unsigned i = 0; i < n; ++i) dst[i * channels + c] = static_cast<Sample>(src[i]) * scale;
+                        }
+                    }
+                    break;
+            }
+
+            blockSize = n;
+            return end;
+        }
+
+        // ---- Work distribution ----
+
+        // One stream being decoded.
+        struct Job {
+            std::vector<std::uint8_t> storage; // File contents, when read by the loader
+            const std::uint8_t* data{nullptr};
+            size_t size{0};
+            FlacInfo info;
+            bool variable{false};
+            std::shared_ptr<AudioBuffer> buffer;
+            std::atomic<std::uint64_t> decoded{0};
+            std::atomic<bool> failed{false};
+            std::string error;
+
+            void fail(const std::string& message) {
+                if (!failed.exchange(true))
+                    error = message;
+            }
+        };
+
+        // One byte range of one stream.
+        struct Task {
+            Job* job;
+            size_t begin;
+            size_t end;
+        };
+
+        // Parses the header and allocates the output; false (with job.error set) on failure.
+        bool prepare(Job& job) {
+            const auto info = parseFlacHeader(job.data, job.size);
+            if (!info) {
+                job.fail("not a supported FLAC stream");
+                return false;
+            }
+            FrameHeader first;
+            if (!parseFrameHeader(job.data + info->framesOffset, job.size - info->framesOffset, *info, first)) {
+                job.fail("no audio frame after the metadata");
+                return false;
+            }
+            job.info = *info;
+            job.variable = first.variable;
+            job.buffer = std::make_shared<AudioBuffer>(info->channels, static_cast<unsigned>(info->totalFrames));
+            return true;
+        }
+
+        void split(Job& job, const size_t bytesPerTask, std::vector<Task>& tasks) {
+            const size_t step = std::max<size_t>(bytesPerTask, 64);
+            for (size_t begin = job.info.framesOffset; begin < job.size; begin += step)
+                tasks.push_back({&job, begin, std::min(job.size, begin + step)});
+        }
+
+        // Decodes every frame that starts within [begin, end).
+        void decodeRange(const Task& task, Scratch& scratch) {
+            Job& job = *task.job;
+            const std::uint8_t* data = job.data;
+            size_t pos = task.begin;
+            bool locked = false; // Found the first frame of the range
+
+            while (pos < task.end && !job.failed.load(std::memory_order_relaxed)) {
+                if (!locked) {
+                    // Skip to the next possible sync code.
+                    const void* hit = std::memchr(data + pos, 0xFF, task.end - pos);
+                    if (!hit) return;
+                    pos = static_cast<size_t>(static_cast<const std::uint8_t*>(hit) - data);
+                }
+
+                unsigned blockSize = 0;
+                const size_t length = decodeFrame(data + pos, job.size - pos, job.info, job.variable,
+                                                  *job.buffer, scratch, blockSize);
+                if (length == 0) {
+                    if (locked) {
+                        job.fail("corrupt frame at byte " + std::to_string(pos));
+                        return;
+                    }
+                    ++pos; // A false sync; keep scanning
+                    continue;
+                }
+                locked = true;
+                job.decoded.fetch_add(blockSize, std::memory_order_relaxed);
+                pos += length;
+            }
+        }
+
+        // Runs fn(index, scratch) for every index in [0, count) on up to @p threads threads.
+        template <typename Fn>
+        void parallelFor(const size_t count, unsigned threads, const Fn& fn) {
+            if (threads == 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+
+            std::atomic<size_t> next{0};
+            const auto worker = [&] {
+                Scratch scratch;
+                for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+                    fn(i, scratch);
+            };
+
+            std::vector<std::thread> pool;
+            for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+            if (threads > 0) worker();
+            for (auto& thread : pool) thread.join();
+        }
+
+        // Checks that every sample of a decoded job was covered.
+        void finish(Job& job) {
+            if (!job.failed && job.decoded.load() != job.info.totalFrames)
+                job.fail("stream is truncated or has unreadable frames");
+            if (job.failed)
+                job.buffer.reset();
+        }
+    }
+
+    std::optional<FlacInfo> parseFlacHeader(const std::uint8_t* bytes, const size_t size) {
+        if (size < 8 || std::memcmp(bytes, "fLaC", 4) != 0)
+            return std::nullopt;
+
+        FlacInfo info;
+        bool haveStreamInfo = false;
+        size_t pos = 4;
+        for (bool last = false; !last;) {
+            if (pos + 4 > size)
+                return std::nullopt;
+            last = bytes[pos] & 0x80;
+            const unsigned type = bytes[pos] & 0x7F;
+            const size_t length = (size_t{bytes[pos + 1]} << 16) | (size_t{bytes[pos + 2]} << 8) | bytes[pos + 3];
+            pos += 4;
+            if (pos + length > size)
+                return std::nullopt;
+
+            if (type == 0 && length >= 34) {
+                BitReader in(bytes + pos, length);
+                info.minBlockSize = in.read(16);
+                info.maxBlockSize = in.read(16);
+                in.read(24); // Minimum frame size
+                in.read(24); // Maximum frame size
+                info.sampleRate = in.read(20);
+                info.channels = in.read(3) + 1;
+                info.bitsPerSample = in.read(5) + 1;
+                info.totalFrames = (std::uint64_t{in.read(4)} << 32) | in.read(32);
+                haveStreamInfo = true;
+            }
+            pos += length;
+        }
+
+        if (!haveStreamInfo || info.bitsPerSample < 4 || info.bitsPerSample > kMaxBitsPerSample ||
+            info.channels > kMaxChannels || info.maxBlockSize < 16 || info.totalFrames == 0 ||
+            info.totalFrames > 0xFFFFFFFFull)
+            return std::nullopt;
+        info.framesOffset = pos;
+        return info;
+    }
+
+    std::shared_ptr<AudioBuffer> decodeFlac(const std::uint8_t* bytes, const size_t size,
+                                            const FlacDecodeOptions& options, std::string* error) {
+        Job job;
+        job.data = bytes;
+        job.size = size;
+        std::vector<Task> tasks;
+        if (prepare(job))
+            split(job, options.bytesPerTask, tasks);
+
+        parallelFor(tasks.size(), options.threads,
+                    [&](const size_t i, Scratch& scratch) { decodeRange(tasks[i], scratch); });
+        if (tasks.empty() && !job.failed)
+            job.fail("no audio frames");
+        finish(job);
+
+        if (!job.buffer && error)
+            *error = job.error;
+        return job.buffer;
+    }
+
+    std::vector<LoadedSample> loadFlacFiles(const std::vector<std::string>& paths, BufferStore* store,
+                                            const FlacDecodeOptions& options) {
+        std::vector<std::unique_ptr<Job>> jobs;
+        for (size_t i = 0; i < paths.size(); ++i) jobs.push_back(std::make_unique<Job>());
+
+        // ---- Phase 1: read and parse every file ----
+        parallelFor(paths.size(), options.threads, [&](const size_t i, Scratch&) {
+            Job& job = *jobs[i];
+            std::ifstream in(paths[i], std::ios::binary | std::ios::ate);
+            if (!in) {
+                job.fail("cannot open file");
+                return;
+            }
+            job.storage.resize(static_cast<size_t>(in.tellg()));
+            in.seekg(0);
+            if (!in.read(reinterpret_cast<char*>(job.storage.data()), static_cast<std::streamsize>(job.storage.size()))) {
+                job.fail("read failed");
+                return;
+            }
+            job.data = job.storage.data();
+            job.size = job.storage.size();
+            prepare(job);
+        });
+
+        // ---- Phase 2: every range of every file from one work list ----
+        std::vector<Task> tasks;
+        for (auto& job : jobs) {
+            if (!job->failed)
+                split(*job, options.bytesPerTask, tasks);
+        }
+        parallelFor(tasks.size(), options.threads,
+                    [&](const size_t i, Scratch& scratch) { decodeRange(tasks[i], scratch); });
+
+        // ---- Publish ----
+        std::vector<LoadedSample> results(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            Job& job = *jobs[i];
+            finish(job);
+            results[i].path = paths[i];
+            if (job.failed) {
+                results[i].error = job.error;
+                continue;
+            }
+            results[i].sampleRate = job.info.sampleRate;
+            results[i].buffer = job.buffer;
+            if (store)
+                results[i].key = store->insert(job.buffer, options.insert);
+        }
+        return results;
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include "pipsqueak/core/fork_join_pool.hpp"
+
+namespace pipsqueak::core {
+    ForkJoinPool::ForkJoinPool(const unsigned threads) {
+        const unsigned workers = threads > 1 ? threads - 1 : 0;
+        workers_.reserve(workers);
+        for (unsigned i = 0; i < workers; ++i)
+            workers_.emplace_back(&ForkJoinPool::workerLoop, this);
+    }
+
+    ForkJoinPool::~ForkJoinPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_)
+            worker.join();
+    }
+
+    void ForkJoinPool::run(const size_t count, const Task task, void* context) {
+        // Small loops, a pool without workers, and loops started while one runs: do it here
+        if (count == 0)
+            return;
+        if (count == 1 || workers_.empty() || busy_.exchange(true, std::memory_order_acquire)) {
+            for (size_t i = 0; i < count; ++i)
+                task(context, i);
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            task_ = task;
+            context_ = context;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            active_.store(static_cast<unsigned>(workers_.size()), std::memory_order_relaxed);
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        drain();
+
+        // Workers that woke late find no indices left and check out at once
+        {
+            std::unique_lock lock(mutex_);
+            done_.wait(lock, [&] { return active_.load(std::memory_order_acquire) == 0; });
+        }
+        busy_.store(false, std::memory_order_release);
+    }
+
+    void ForkJoinPool::drain() {
+        for (;;) {
+            const size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count_)
+                return;
+            task_(context_, index);
+        }
+    }
+
+    void ForkJoinPool::workerLoop() {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_)
+                    return;
+                seen = generation_;
+            }
+
+            drain();
+
+            if (active_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard lock(mutex_);
+                done_.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <pipsqueak/core/kernels.hpp>
+#include <pipsqueak/core/logging.hpp>
+
+namespace pipsqueak::core::kernels {
+    // Tables defined by the per-ISA translation units.
+    namespace baseline { extern const KernelTable table; }
+#ifdef PIPSQUEAK_X86_KERNELS
+    namespace sse42 { extern const KernelTable table; }
+    namespace avx2 { extern const KernelTable table; }
+    namespace avx512 { extern const KernelTable table; }
+#endif
+
+    namespace {
+        bool cpuSupports(const Isa isa) {
+            switch (isa) {
+                case Isa::Baseline: return true;
+#ifdef PIPSQUEAK_X86_KERNELS
+                case Isa::Sse42: return __builtin_cpu_supports("sse4.2");
+                case Isa::Avx2: return __builtin_cpu_supports("avx2");
+                // The AVX-512 unit is built with -mavx512f -mavx512vl -mavx512bw; F alone (e.g.
+                // Knights Landing) would fault on the first VL/BW instruction.
+                case Isa::Avx512: return __builtin_cpu_supports("avx512f")
+                                         && __builtin_cpu_supports("avx512vl")
+                                         && __builtin_cpu_supports("avx512bw");
+#endif
+                default: return false;
+            }
+        }
+
+        // Every compiled table, lowest ISA first.
+        std::vector<const KernelTable*> compiled() {
+            return {
+                &baseline::table,
+#ifdef PIPSQUEAK_X86_KERNELS
+                &sse42::table, &avx2::table, &avx512::table,
+#endif
+            };
+        }
+
+        const KernelTable& select() {
+            // Optional cap from the environment, e.g. PIPSQUEAK_ISA=sse4.2
+            const char* cap = std::getenv("PIPSQUEAK_ISA");
+
+            // The cap must name a compiled table; anything else is reported and ignored.
+            const KernelTable* capTable = nullptr;
+            if (cap) {
+                for (const auto* table : compiled()) {
+                    if (std::strcmp(cap, table->name) == 0)
+                        capTable = table;
+                }
+                if (!capTable) {
+                    std::string known;
+                    for (const auto* table : compiled())
+                        known += std::string(known.empty() ? "" : ", ") + table->name;
+                    logging::Logger::log("pipsqueak", std::string("Ignoring unknown PIPSQUEAK_ISA '") + cap +
+                                                          "' (expected one of: " + known + ")");
+                }
+            }
+
+            // The highest supported table at or below the cap.
+            const KernelTable* best = &baseline::table;
+            for (const auto* table : available()) {
+                if (capTable && table->isa > capTable->isa)
+                    break;
+                best = table;
+            }
+
+            logging::Logger::log("pipsqueak", std::string("DSP kernels: ") + best->name);
+            return *best;
+        }
+    }
+
+    std::vector<const KernelTable*> available() {
+        std::vector<const KernelTable*> tables;
+        for (const auto* table : compiled()) {
+            if (cpuSupports(table->isa))
+                tables.push_back(table);
+        }
+        return tables;
+    }
+
+    const KernelTable& active() {
+        // Selected once; function-local statics are initialised thread-safely.
+        static const KernelTable& table = select();
+        return table;
+    }
+}
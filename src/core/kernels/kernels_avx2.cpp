@@ -0,0 +1,9 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+// avx2 kernel variant; only compiled (with avx2 target flags) on x86 GCC/Clang builds
+#define PIPSQUEAK_KERNEL_NS avx2
+#define PIPSQUEAK_KERNEL_ISA Isa::Avx2
+#define PIPSQUEAK_KERNEL_NAME "avx2"
+#include "kernels_impl.hpp"
@@ -0,0 +1,9 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+// avx512 kernel variant; only compiled (with avx512 target flags) on x86 GCC/Clang builds
+#define PIPSQUEAK_KERNEL_NS avx512
+#define PIPSQUEAK_KERNEL_ISA Isa::Avx512
+#define PIPSQUEAK_KERNEL_NAME "avx512"
+#include "kernels_impl.hpp"
@@ -0,0 +1,9 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+// baseline kernel variant; built with the target's default flags
+#define PIPSQUEAK_KERNEL_NS baseline
+#define PIPSQUEAK_KERNEL_ISA Isa::Baseline
+#define PIPSQUEAK_KERNEL_NAME "baseline"
+#include "kernels_impl.hpp"
@@ -0,0 +1,316 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+// Kernel bodies shared by every ISA variant. Each kernels_<isa>.cpp defines
+// PIPSQUEAK_KERNEL_NS / PIPSQUEAK_KERNEL_ISA / PIPSQUEAK_KERNEL_NAME and includes this file,
+// and is compiled with that ISA's target flags so the loops vectorise to its width.
+//
+// This file deliberately uses no inline functions from other headers (std::min, std::clamp,
+// ...): those would be emitted once per ISA TU and the linker may keep the AVX copy for
+// everyone, crashing older CPUs. Everything here lives in a per-ISA namespace.
+
+#include <pipsqueak/core/kernels.hpp>
+
+#include <cstring>
+
+namespace pipsqueak::core::kernels::PIPSQUEAK_KERNEL_NS {
+    namespace {
+        void gain(Sample* data, const size_t count, const float g) {
+            for (size_t i = 0; i < count; ++i) data[i] *= g;
+        }
+
+        void fill(Sample* data, const size_t count, const float value) {
+            for (size_t i = 0; i < count; ++i) data[i] = value;
+        }
+
+        void mixAccumulate(Sample* dst, const Sample* src, const size_t count, const float g) {
+            for (size_t i = 0; i < count; ++i) dst[i] += g * src[i];
+        }
+
+        // Frame body for a fixed (or, with C == 0, runtime) channel count.
+        template <unsigned C>
+        size_t interpolateFrames(const Sample* src, const unsigned runtimeChannels, const size_t lastIndex,
+                                 const double phase, const double step, Sample* dst, const size_t n) {
+            const unsigned ch = C ? C : runtimeChannels;
+            for (size_t f = 0; f < n; ++f) {
+                // Closed-form position: no drift, and no loop-carried dependency for the vectoriser.
+                const double pos = phase + static_cast<double>(f) * step;
+                size_t i = static_cast<size_t>(pos);
+                i = i > lastIndex ? lastIndex : i;
+                const size_t j = i + (i < lastIndex ? 1 : 0);
+                const auto frac = static_cast<Sample>(pos - static_cast<double>(i));
+
+                for (unsigned c = 0; c < ch; ++c) {
+                    const Sample x0 = src[i * ch + c];
+                    const Sample x1 = src[j * ch + c];
+                    dst[f * ch + c] = x0 + (x1 - x0) * frac;
+                }
+            }
+            return n;
+        }
+
+        size_t interpolate(const Sample* src, const unsigned channels, const size_t lastIndex,
+                           double& phase, const double step, Sample* dst, const size_t frames) {
+            if (phase > static_cast<double>(lastIndex) || step <= 0.0)
+                return 0;
+
+            // Frames whose read position stays within the source.
+            size_t n = static_cast<size_t>((static_cast<double>(lastIndex) - phase) / step) + 1;
+            n = n < frames ? n : frames;
+
+            switch (channels) {
+                case 1: interpolateFrames<1>(src, 1, lastIndex, phase, step, dst, n); break;
+                case 2: interpolateFrames<2>(src, 2, lastIndex, phase, step, dst, n); break;
+                default: interpolateFrames<0>(src, channels, lastIndex, phase, step, dst, n); break;
+            }
+
+            phase += static_cast<double>(n) * step;
+            return n;
+        }
+
+        // Fused interpolate-and-mix for one (source, destination) channel pair known at compile
+        // time; Dst == 0 means "stereo into the first two channels of a runtime-width output".
+        // With both counts constant the channel loops vanish and the body is straight-line code.
+        template <unsigned Src, unsigned Dst>
+        void interpolateMixFrames(const Sample* src, const size_t lastIndex, const double phase, const double step,
+                                  const float g, Sample* out, const unsigned outStride, const size_t n) {
+            const unsigned stride = Dst ? Dst : outStride;
+            for (size_t f = 0; f < n; ++f) {
+                const double pos = phase + static_cast<double>(f) * step;
+                size_t i = static_cast<size_t>(pos);
+                i = i > lastIndex ? lastIndex : i;
+                const size_t j = i + (i < lastIndex ? 1 : 0);
+                const auto frac = static_cast<Sample>(pos - static_cast<double>(i));
+
+                Sample* o = out + f * stride;
+                if constexpr (Src == 1) {
+                    const Sample x = src[i] + (src[j] - src[i]) * frac;
+                    o[0] += g * x;
+                    if constexpr (Dst == 2) o[1] += g * x;
+                } else {
+                    const Sample l = src[2 * i] + (src[2 * j] - src[2 * i]) * frac;
+                    const Sample r = src[2 * i + 1] + (src[2 * j + 1] - src[2 * i + 1]) * frac;
+                    o[0] += g * l;
+                    o[1] += g * r;
+                }
+            }
+        }
+
+        size_t interpolateMix(const Sample* src, const MixRoute route, const size_t lastIndex, double& phase,
+                              const double step, const float g, Sample* dst, const unsigned dstStride,
+                              const size_t frames) {
+            if (phase > static_cast<double>(lastIndex) || step <= 0.0)
+                return 0;
+
+            // Frames whose read position stays within the source.
+            size_t n = static_cast<size_t>((static_cast<double>(lastIndex) - phase) / step) + 1;
+            n = n < frames ? n : frames;
+
+            switch (route) {
+                case MixRoute::MonoToMono: interpolateMixFrames<1, 1>(src, lastIndex, phase, step, g, dst, 1, n); break;
+                case MixRoute::MonoToPair: interpolateMixFrames<1, 2>(src, lastIndex, phase, step, g, dst, 2, n); break;
+                case MixRoute::PairToPair: interpolateMixFrames<2, 2>(src, lastIndex, phase, step, g, dst, 2, n); break;
+                case MixRoute::PairToMany:
+                    interpolateMixFrames<2, 0>(src, lastIndex, phase, step, g, dst, dstStride, n);
+                    break;
+            }
+
+            phase += static_cast<double>(n) * step;
+            return n;
+        }
+
+        // std::min / std::max shapes (minps / maxps), kept local for the reason at the top.
+        Sample minOf(const Sample a, const Sample b) { return b < a ? b : a; }
+        Sample maxOf(const Sample a, const Sample b) { return a < b ? b : a; }
+
+        void toInt16(const Sample* src, std::int16_t* dst, const size_t count) {
+            // Clamp with min/max and convert through int32 (cvttps2dq), then narrow: a direct
+            // float -> int16 conversion has no vector form below AVX-512.
+            for (size_t i = 0; i < count; ++i) {
+                const Sample s = minOf(maxOf(src[i], -1.0f), 1.0f);
+                dst[i] = static_cast<std::int16_t>(static_cast<std::int32_t>(s * 32767.0f));
+            }
+        }
+
+        void fromInt16(const std::int16_t* src, Sample* dst, const size_t count) {
+            constexpr Sample scale = 1.0f / 32768.0f;
+            for (size_t i = 0; i < count; ++i) dst[i] = static_cast<Sample>(src[i]) * scale;
+        }
+
+        // Prediction with a compile-time tap count N; reversed[] holds the coefficients oldest
+        // first (zero padded up to N), so each output is a fixed-length contiguous dot product.
+        template <typename Acc, unsigned N>
+        void lpcTaps(std::int32_t* s, const size_t from, const size_t count, const std::int32_t* reversed,
+                     const int shift) {
+            for (size_t i = from; i < count; ++i) {
+                const std::int32_t* history = s + i - N;
+                Acc sum = 0;
+                for (unsigned j = 0; j < N; ++j)
+                    sum += static_cast<Acc>(reversed[j]) * static_cast<Acc>(history[j]);
+                s[i] += static_cast<std::int32_t>(sum >> shift);
+            }
+        }
+
+        template <typename Acc>
+        void lpcRestoreWith(std::int32_t* s, const size_t count, const std::int32_t* coefficients,
+                            const unsigned order, const int shift) {
+            if (order == 0 || count <= order)
+                return;
+
+            // Round the tap count up to a size the loops are specialised for.
+            const unsigned taps = order <= 4 ? 4 : order <= 8 ? 8 : order <= 12 ? 12 : order <= 16 ? 16 : 32;
+            std::int32_t reversed[32] = {};
+            for (unsigned j = 0; j < order; ++j)
+                reversed[taps - 1 - j] = coefficients[j];
+
+            // The first outputs lack a full padded history; predict them at the true order.
+            size_t i = order;
+            for (; i < count && i < taps; ++i) {
+                Acc sum = 0;
+                for (unsigned j = 0; j < order; ++j)
+                    sum += static_cast<Acc>(coefficients[j]) * static_cast<Acc>(s[i - 1 - j]);
+                s[i] += static_cast<std::int32_t>(sum >> shift);
+            }
+
+            switch (taps) {
+                case 4: lpcTaps<Acc, 4>(s, i, count, reversed, shift); break;
+                case 8: lpcTaps<Acc, 8>(s, i, count, reversed, shift); break;
+                case 12: lpcTaps<Acc, 12>(s, i, count, reversed, shift); break;
+                case 16: lpcTaps<Acc, 16>(s, i, count, reversed, shift); break;
+                default: lpcTaps<Acc, 32>(s, i, count, reversed, shift); break;
+            }
+        }
+
+        void lpcRestore(std::int32_t* samples, const size_t count, const std::int32_t* coefficients,
+                        const unsigned order, const int shift, const bool wide) {
+            if (wide) lpcRestoreWith<std::int64_t>(samples, count, coefficients, order, shift);
+            else lpcRestoreWith<std::int32_t>(samples, count, coefficients, order, shift);
+        }
+
+        std::uint32_t magnitudeBits(const Sample x) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            return bits & 0x7FFFFFFFu;
+        }
+
+        void channelStats(const Sample* src, const size_t frames, const unsigned channels,
+                          float* peak, double* sum, double* sumSquares) {
+            // Peaks are tracked as the bit patterns of |x|: for non-negative floats these order
+            // like the values, and an integer max reduction vectorises without fast-math.
+            constexpr unsigned L = 16;
+            std::uint32_t peakBits[L] = {};
+            double s[L] = {};
+            double q[L] = {};
+            for (unsigned c = 0; c < channels; ++c) {
+                peak[c] = 0.0f;
+                sum[c] = 0.0;
+                sumSquares[c] = 0.0;
+            }
+            if (channels == 0)
+                return;
+
+            const size_t count = frames * channels;
+            size_t i = 0;
+            if (L % channels == 0) {
+                // Every lane always holds the same channel (lane % channels).
+                for (; i + L <= count; i += L) {
+                    for (unsigned l = 0; l < L; ++l) {
+                        const Sample x = src[i + l];
+                        const std::uint32_t bits = magnitudeBits(x);
+                        peakBits[l] = bits > peakBits[l] ? bits : peakBits[l];
+                        const double d = x;
+                        s[l] += d;
+                        q[l] += d * d;
+                    }
+                }
+            }
+
+            // Fold the lanes (in a fixed order), then the remaining samples.
+            std::uint32_t channelBits[L] = {};
+            const unsigned lanes = L % channels == 0 ? L : 0;
+            for (unsigned l = 0; l < lanes; ++l) {
+                const unsigned c = l % channels;
+                channelBits[c] = peakBits[l] > channelBits[c] ? peakBits[l] : channelBits[c];
+                sum[c] += s[l];
+                sumSquares[c] += q[l];
+            }
+            for (; i < count; ++i) {
+                const unsigned c = static_cast<unsigned>(i % channels);
+                const Sample x = src[i];
+                const std::uint32_t bits = magnitudeBits(x);
+                if (c < L) channelBits[c] = bits > channelBits[c] ? bits : channelBits[c];
+                else if (bits > magnitudeBits(peak[c])) std::memcpy(&peak[c], &bits, sizeof(bits));
+                sum[c] += x;
+                sumSquares[c] += static_cast<double>(x) * x;
+            }
+            for (unsigned c = 0; c < channels && c < L; ++c)
+                std::memcpy(&peak[c], &channelBits[c], sizeof(channelBits[c]));
+        }
+
+        void blockMinMax(const Sample* src, const size_t blocks, const size_t blockFrames, const unsigned channels,
+                         float* min, float* max, float* sumSquares) {
+            constexpr unsigned L = 16;
+            const size_t n = blockFrames * channels;
+            const bool laned = channels != 0 && L % channels == 0 && n % L == 0 && n != 0;
+
+            for (size_t b = 0; b < blocks; ++b) {
+                const Sample* p = src + b * n;
+                float* mn = min + b * channels;
+                float* mx = max + b * channels;
+                float* sq = sumSquares + b * channels;
+
+                if (laned) {
+                    // Every lane always holds the same channel (lane % channels).
+                    Sample lo[L], hi[L], q[L];
+                    for (unsigned l = 0; l < L; ++l) {
+                        lo[l] = p[l];
+                        hi[l] = p[l];
+                        q[l] = 0.0f;
+                    }
+                    for (size_t i = 0; i < n; i += L) {
+                        for (unsigned l = 0; l < L; ++l) {
+                            const Sample x = p[i + l];
+                            lo[l] = x < lo[l] ? x : lo[l];
+                            hi[l] = x > hi[l] ? x : hi[l];
+                            q[l] += x * x;
+                        }
+                    }
+                    for (unsigned c = 0; c < channels; ++c) {
+                        mn[c] = lo[c];
+                        mx[c] = hi[c];
+                        sq[c] = q[c];
+                    }
+                    for (unsigned l = channels; l < L; ++l) {
+                        const unsigned c = l % channels;
+                        mn[c] = lo[l] < mn[c] ? lo[l] : mn[c];
+                        mx[c] = hi[l] > mx[c] ? hi[l] : mx[c];
+                        sq[c] += q[l];
+                    }
+                    continue;
+                }
+
+                for (unsigned c = 0; c < channels; ++c) {
+                    mn[c] = blockFrames ? p[c] : 0.0f;
+                    mx[c] = mn[c];
+                    sq[c] = 0.0f;
+                }
+                for (size_t f = 0; f < blockFrames; ++f) {
+                    for (unsigned c = 0; c < channels; ++c) {
+                        const Sample x = p[f * channels + c];
+                        mn[c] = x < mn[c] ? x : mn[c];
+                        mx[c] = x > mx[c] ? x : mx[c];
+                        sq[c] += x * x;
+                    }
+                }
+            }
+        }
+    }
+
+    extern const KernelTable table;
+    const KernelTable table{
+        PIPSQUEAK_KERNEL_ISA, PIPSQUEAK_KERNEL_NAME,
+        &gain, &fill, &mixAccumulate, &interpolate, &toInt16, &fromInt16, &lpcRestore,
+        &channelStats, &blockMinMax, &interpolateMix
+    };
+}
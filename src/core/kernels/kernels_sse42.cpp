@@ -0,0 +1,9 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+// sse4.2 kernel variant; only compiled (with sse4.2 target flags) on x86 GCC/Clang builds
+#define PIPSQUEAK_KERNEL_NS sse42
+#define PIPSQUEAK_KERNEL_ISA Isa::Sse42
+#define PIPSQUEAK_KERNEL_NAME "sse4.2"
+#include "kernels_impl.hpp"
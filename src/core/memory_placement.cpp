@@ -0,0 +1,167 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <pipsqueak/core/memory_placement.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace pipsqueak::core::placement {
+#ifdef __linux__
+    namespace {
+        // From <linux/mempolicy.h>; spelled out so no libnuma headers are needed.
+        constexpr int kMpolPreferred = 1;
+        constexpr unsigned kMpolMfMove = 1u << 1;
+        constexpr int kMadvCollapse = 25;
+
+        // Ranges smaller than one transparent huge page are left alone: each placed range is its
+        // own VMA, and binding small buffers would fragment the heap towards vm.max_map_count.
+        constexpr size_t kMinPlacedBytes = size_t{2} << 20;
+
+        // The whole pages inside a byte range; begin == end if there are none. Placement must not
+        // reach pages shared with neighbouring allocations.
+        void innerPageRange(const void* data, const size_t bytes, std::uintptr_t& begin, std::uintptr_t& end) {
+            const auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+            const auto start = reinterpret_cast<std::uintptr_t>(data);
+            begin = (start + page - 1) & ~(page - 1);
+            end = std::max(begin, (start + bytes) & ~(page - 1));
+        }
+
+        // Page-aligned [begin, end) enclosing a byte range.
+        void pageRange(const void* data, const size_t bytes, std::uintptr_t& begin, std::uintptr_t& end) {
+            const auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+            const auto start = reinterpret_cast<std::uintptr_t>(data);
+            begin = start & ~(page - 1);
+            end = (start + bytes + page - 1) & ~(page - 1);
+        }
+
+        // Sums AnonHugePages of the mappings overlapping [begin, end) from /proc/self/smaps.
+        size_t hugePageBytes(const std::uintptr_t begin, const std::uintptr_t end) {
+            std::ifstream smaps("/proc/self/smaps");
+            std::string line;
+            bool overlapping = false;
+            size_t total = 0;
+            while (std::getline(smaps, line)) {
+                // Mapping header: "start-end perms offset dev inode path"
+                if (const auto dash = line.find('-'); dash != std::string::npos && dash < 17 &&
+                    std::isxdigit(static_cast<unsigned char>(line[0]))) {
+                    const auto lo = std::stoull(line.substr(0, dash), nullptr, 16);
+                    const auto hi = std::stoull(line.substr(dash + 1, line.find(' ') - dash - 1), nullptr, 16);
+                    overlapping = lo < end && hi > begin;
+                } else if (overlapping && line.rfind("AnonHugePages:", 0) == 0) {
+                    std::istringstream fields(line.substr(14));
+                    size_t kb = 0;
+                    fields >> kb;
+                    total += kb * 1024;
+                }
+            }
+            return total;
+        }
+    }
+
+    int nodeCount() {
+        // "0" or "0-3"
+        std::ifstream possible("/sys/devices/system/node/possible");
+        std::string ranges;
+        if (!(possible >> ranges))
+            return 1;
+        const auto dash = ranges.find_last_of("-,");
+        return std::stoi(dash == std::string::npos ? ranges : ranges.substr(dash + 1)) + 1;
+    }
+
+    int currentNode() {
+        unsigned cpu = 0, node = 0;
+        if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+            return 0;
+        return static_cast<int>(node);
+    }
+
+    bool apply(const void* data, const size_t bytes, const PlacementPolicy& policy) {
+        if (!data || bytes < kMinPlacedBytes)
+            return false;
+
+        std::uintptr_t begin = 0, end = 0;
+        innerPageRange(data, bytes, begin, end);
+        auto* base = reinterpret_cast<void*>(begin);
+        const size_t length = end - begin;
+        bool ok = true;
+
+        if (policy.hugePages != HugePages::Off) {
+            ok = ::madvise(base, length, MADV_HUGEPAGE) == 0 && ok;
+            // Best effort: older kernels reject MADV_COLLAPSE and khugepaged does it later instead.
+            if (policy.hugePages == HugePages::Collapse)
+                ::madvise(base, length, kMadvCollapse);
+        }
+
+        if (policy.node != PlacementPolicy::kAnyNode) {
+            const int node = policy.node == PlacementPolicy::kCallerNode ? currentNode() : policy.node;
+            if (node < 0 || node >= 64)
+                return false;
+            const unsigned long mask = 1ul << node;
+            const unsigned flags = policy.migrate ? kMpolMfMove : 0u;
+            ok = ::syscall(SYS_mbind, base, length, kMpolPreferred, &mask, sizeof(mask) * 8 + 1, flags) == 0 && ok;
+        }
+        return ok;
+    }
+
+    PlacementReport query(const void* data, const size_t bytes) {
+        PlacementReport report;
+        report.bytes = bytes;
+        if (!data || bytes == 0)
+            return report;
+
+        std::uintptr_t begin = 0, end = 0;
+        pageRange(data, bytes, begin, end);
+        const auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+        report.pages = (end - begin) / page;
+        report.pagesPerNode.assign(static_cast<size_t>(nodeCount()), 0);
+
+        // Query in fixed batches so huge libraries do not need huge scratch arrays.
+        constexpr size_t kBatch = 4096;
+        std::vector<void*> pages(kBatch);
+        std::vector<int> status(kBatch);
+        report.supported = true;
+        for (size_t first = 0; first < report.pages; first += kBatch) {
+            const size_t n = std::min(kBatch, report.pages - first);
+            for (size_t i = 0; i < n; ++i)
+                pages[i] = reinterpret_cast<void*>(begin + (first + i) * page);
+
+            if (::syscall(SYS_move_pages, 0, n, pages.data(), nullptr, status.data(), 0) != 0) {
+                report.supported = false;
+                return report;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                const int node = status[i];
+                if (node >= 0 && static_cast<size_t>(node) < report.pagesPerNode.size()) ++report.pagesPerNode[node];
+                else ++report.nonResidentPages;
+            }
+        }
+
+        report.hugePageBytes = hugePageBytes(begin, end);
+        return report;
+    }
+#else
+    int nodeCount() { return 1; }
+
+    int currentNode() { return 0; }
+
+    bool apply(const void*, size_t, const PlacementPolicy&) { return false; }
+
+    PlacementReport query(const void*, const size_t bytes) {
+        PlacementReport report;
+        report.bytes = bytes;
+        return report;
+    }
+#endif
+}
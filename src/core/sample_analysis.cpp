@@ -0,0 +1,84 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <pipsqueak/core/sample_analysis.hpp>
+
+#include <pipsqueak/core/kernels.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace pipsqueak::core {
+    namespace {
+        bool loud(const Sample* frame, const unsigned channels, const float threshold) {
+            for (unsigned c = 0; c < channels; ++c) {
+                if (std::fabs(frame[c]) > threshold) return true;
+            }
+            return false;
+        }
+
+        float monoAt(const Sample* data, const unsigned channels, const size_t frame) {
+            float sum = 0.0f;
+            for (unsigned c = 0; c < channels; ++c) sum += data[frame * channels + c];
+            return sum;
+        }
+
+        // The frame nearest @p point where the channel sum changes sign (moving upwards), within the window.
+        std::uint32_t nearestCrossing(const Sample* data, const unsigned channels, const size_t frames,
+                                      const std::uint32_t point, const std::uint32_t window) {
+            if (frames < 2)
+                return point;
+            for (std::uint32_t distance = 0; distance <= window; ++distance) {
+                for (const std::int64_t f : {std::int64_t{point} - distance, std::int64_t{point} + distance}) {
+                    if (f < 1 || f >= static_cast<std::int64_t>(frames))
+                        continue;
+                    const auto i = static_cast<size_t>(f);
+                    if (monoAt(data, channels, i - 1) < 0.0f && monoAt(data, channels, i) >= 0.0f)
+                        return static_cast<std::uint32_t>(i);
+                }
+            }
+            return point;
+        }
+    }
+
+    SampleMetadata analyzeSample(const AudioBuffer& buffer, const SampleAnalysisOptions& options) {
+        SampleMetadata meta;
+        const unsigned channels = buffer.numChannels();
+        const size_t frames = buffer.numFrames();
+        if (channels == 0 || frames == 0)
+            return meta;
+        const Sample* data = buffer.dataPtr();
+
+        // ---- Level statistics in one pass ----
+        std::vector<float> peak(channels);
+        std::vector<double> sum(channels), sumSquares(channels);
+        kernels::active().channelStats(data, frames, channels, peak.data(), sum.data(), sumSquares.data());
+
+        double total = 0.0, totalSquares = 0.0;
+        for (unsigned c = 0; c < channels; ++c) {
+            meta.peak = std::max(meta.peak, peak[c]);
+            total += sum[c];
+            totalSquares += sumSquares[c];
+        }
+        const auto count = static_cast<double>(frames * channels);
+        meta.rms = static_cast<float>(std::sqrt(totalSquares / count));
+        meta.dcOffset = static_cast<float>(total / count);
+
+        // ---- Silent head and tail ----
+        size_t first = 0;
+        while (first < frames && !loud(data + first * channels, channels, options.silenceThreshold)) ++first;
+        size_t last = frames;
+        while (last > first && !loud(data + (last - 1) * channels, channels, options.silenceThreshold)) --last;
+        meta.leadingSilence = static_cast<std::uint32_t>(first);
+        meta.trailingSilence = static_cast<std::uint32_t>(first == frames ? frames : frames - last);
+
+        // ---- Loop-point zero crossings ----
+        if (options.loopEnd > options.loopStart) {
+            meta.loopStartCrossing = nearestCrossing(data, channels, frames, options.loopStart, options.crossingWindow);
+            meta.loopEndCrossing = nearestCrossing(data, channels, frames, options.loopEnd, options.crossingWindow);
+        }
+        return meta;
+    }
+}
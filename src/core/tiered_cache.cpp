@@ -0,0 +1,528 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include "pipsqueak/core/tiered_cache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+#include "core/logging.hpp"
+
+namespace pipsqueak::core {
+    namespace {
+        // Kept byte span [lo, hi) of each 4-bit code; code 0 is an unchanged sample.
+        constexpr std::uint8_t kLo[11] = {0, 0, 0, 0, 0, 1, 1, 1, 2, 2, 3};
+        constexpr std::uint8_t kHi[11] = {0, 1, 2, 3, 4, 2, 3, 4, 3, 4, 4};
+        constexpr std::uint8_t kFirstCode[4] = {1, 5, 8, 10}; // First code for each lo
+
+        std::uint8_t codeFor(const std::uint32_t v) {
+            if (v == 0)
+                return 0;
+            unsigned lo = 0;
+            while (((v >> (8 * lo)) & 0xFFu) == 0) ++lo;
+            unsigned hi = 4;
+            while (((v >> (8 * (hi - 1))) & 0xFFu) == 0) --hi;
+            return static_cast<std::uint8_t>(kFirstCode[lo] + (hi - lo - 1));
+        }
+
+        constexpr char kSpillMagic[8] = {'P', 'S', 'Q', 'S', 'P', 'I', 'L', '1'};
+
+        struct SpillHeader {
+            char magic[8];
+            std::uint32_t channels;
+            std::uint32_t frames;
+            std::uint64_t size;
+        };
+    }
+
+    std::vector<std::uint8_t> compressSamples(const Sample* data, const size_t frames, const unsigned channels) {
+        const size_t count = frames * channels;
+        std::vector<std::uint8_t> out;
+        out.reserve(count * 3 + count / 2 + 1);
+        std::vector<std::uint32_t> previous(channels, 0);
+
+        // One control byte per two samples, each followed by its kept XOR bytes
+        size_t i = 0;
+        while (i < count) {
+            const size_t control = out.size();
+            out.push_back(0);
+            for (unsigned half = 0; half < 2 && i < count; ++half, ++i) {
+                std::uint32_t bits;
+                std::memcpy(&bits, &data[i], sizeof(bits));
+                const unsigned c = static_cast<unsigned>(i % channels);
+                const std::uint32_t v = bits ^ previous[c];
+                previous[c] = bits;
+
+                const std::uint8_t code = codeFor(v);
+                out[control] |= static_cast<std::uint8_t>(code << (4 * half));
+                for (unsigned b = kLo[code]; b < kHi[code]; ++b)
+                    out.push_back(static_cast<std::uint8_t>(v >> (8 * b)));
+            }
+        }
+        out.shrink_to_fit();
+        return out;
+    }
+
+    bool decompressSamples(const std::uint8_t* bytes, const size_t size, Sample* out, const size_t frames,
+                           const unsigned channels) {
+        const size_t count = frames * channels;
+        std::vector<std::uint32_t> previous(channels, 0);
+
+        size_t pos = 0;
+        size_t i = 0;
+        while (i < count) {
+            if (pos >= size)
+                return false;
+            const std::uint8_t control = bytes[pos++];
+            for (unsigned half = 0; half < 2 && i < count; ++half, ++i) {
+                const unsigned code = (control >> (4 * half)) & 0x0Fu;
+                if (code > 10 || pos + (kHi[code] - kLo[code]) > size)
+                    return false;
+
+                std::uint32_t v = 0;
+                for (unsigned b = kLo[code]; b < kHi[code]; ++b)
+                    v |= static_cast<std::uint32_t>(bytes[pos++]) << (8 * b);
+
+                const unsigned c = static_cast<unsigned>(i % channels);
+                previous[c] ^= v;
+                std::memcpy(&out[i], &previous[c], sizeof(Sample));
+            }
+        }
+        return pos == size;
+    }
+
+    TieredCache::TieredCache(const TieredCacheOptions& options) : options_(options) {
+        // A random token keeps spill files of different caches and processes apart
+        std::random_device random;
+        const std::filesystem::path directory = options_.spillDirectory.empty()
+            ? std::filesystem::temp_directory_path()
+            : std::filesystem::path(options_.spillDirectory);
+        spillPrefix_ = (directory / ("pipsqueak-" + std::to_string(random()) + "-")).string();
+
+        if (options_.background) {
+            worker_ = std::thread(&TieredCache::workerLoop, this);
+        }
+    }
+
+    TieredCache::~TieredCache() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (worker_.joinable())
+            worker_.join();
+
+        for (const auto& [key, entry] : entries_) {
+            if (!entry.spillPath.empty())
+                std::remove(entry.spillPath.c_str());
+        }
+    }
+
+    size_t TieredCache::insert(std::shared_ptr<const AudioBuffer> buffer, CacheTier tier, Loader loader) {
+        if (!buffer) {
+            throw std::invalid_argument("TieredCache: null buffer");
+        }
+
+        size_t key;
+        {
+            std::lock_guard lock(mutex_);
+            key = nextKey_++;
+        }
+
+        Entry entry;
+        entry.channels = buffer->numChannels();
+        entry.frames = buffer->numFrames();
+        entry.bytes = buffer->data().size() * sizeof(Sample);
+        entry.loader = std::move(loader);
+        if (entry.frames <= options_.headFrames) {
+            entry.head = buffer;
+            tier = CacheTier::Hot;
+        } else {
+            entry.head = std::make_shared<const AudioBuffer>(entry.channels, options_.headFrames, buffer->dataPtr());
+        }
+
+        // Compress or spill on the calling thread, so a cold insert never holds the decoded sample
+        entry.tier = tier;
+        if (tier == CacheTier::Hot) {
+            entry.hot = std::move(buffer);
+        } else if (tier == CacheTier::Warm || !entry.loader) {
+            auto compressed = std::make_shared<const std::vector<std::uint8_t>>(
+                compressSamples(buffer->dataPtr(), entry.frames, entry.channels));
+            if (tier == CacheTier::Cold) {
+                entry.spillPath = spill(key, entry, *compressed);
+                if (entry.spillPath.empty())
+                    entry.tier = CacheTier::Warm; // Keep it in RAM rather than lose it
+            }
+            if (entry.tier == CacheTier::Warm)
+                entry.warm = std::move(compressed);
+        }
+
+        std::lock_guard lock(mutex_);
+        const auto [it, inserted] = entries_.emplace(key, std::move(entry));
+        account(it->second, +1);
+        if (usage_.hotBytes > options_.hotBytes || usage_.warmBytes > options_.warmBytes) {
+            overBudget_ = true;
+            wake_.notify_all();
+        }
+        return key;
+    }
+
+    std::shared_ptr<const AudioBuffer> TieredCache::get(const size_t key) {
+        {
+            std::lock_guard lock(mutex_);
+            const auto it = entries_.find(key);
+            if (it == entries_.end())
+                return nullptr;
+
+            ++it->second.accesses;
+            if (it->second.hot) {
+                ++usage_.hits;
+                return it->second.hot;
+            }
+            ++usage_.misses;
+        }
+        return promote(key);
+    }
+
+    std::shared_ptr<const AudioBuffer> TieredCache::tryGet(const size_t key) {
+        std::lock_guard lock(mutex_);
+        const auto it = entries_.find(key);
+        if (it == entries_.end())
+            return nullptr;
+
+        ++it->second.accesses;
+        if (it->second.hot) {
+            ++usage_.hits;
+            return it->second.hot;
+        }
+        ++usage_.misses;
+        requested_.insert(key);
+        wake_.notify_all();
+        return nullptr;
+    }
+
+    std::shared_ptr<const AudioBuffer> TieredCache::head(const size_t key) {
+        std::lock_guard lock(mutex_);
+        const auto it = entries_.find(key);
+        if (it == entries_.end())
+            return nullptr;
+
+        ++it->second.accesses;
+        return it->second.hot ? it->second.hot : it->second.head;
+    }
+
+    void TieredCache::prefetch(const size_t key) {
+        std::lock_guard lock(mutex_);
+        if (const auto it = entries_.find(key); it != entries_.end() && !it->second.hot) {
+            requested_.insert(key);
+            wake_.notify_all();
+        }
+    }
+
+    bool TieredCache::erase(const size_t key) {
+        std::string spillPath;
+        {
+            std::lock_guard lock(mutex_);
+            const auto it = entries_.find(key);
+            if (it == entries_.end())
+                return false;
+
+            account(it->second, -1);
+            spillPath = std::move(it->second.spillPath);
+            entries_.erase(it);
+            requested_.erase(key);
+        }
+
+        if (!spillPath.empty())
+            std::remove(spillPath.c_str());
+        return true;
+    }
+
+    CacheTier TieredCache::tier(const size_t key) const {
+        std::lock_guard lock(mutex_);
+        const auto it = entries_.find(key);
+        return it == entries_.end() ? CacheTier::Cold : it->second.tier;
+    }
+
+    TieredCache::Usage TieredCache::usage() const {
+        std::lock_guard lock(mutex_);
+        return usage_;
+    }
+
+    void TieredCache::account(const Entry& entry, const int sign) {
+        const auto add = [sign](size_t& total, const size_t value) {
+            total = sign > 0 ? total + value : total - value;
+        };
+
+        switch (entry.tier) {
+            case CacheTier::Hot:
+                add(usage_.hotEntries, 1);
+                add(usage_.hotBytes, entry.bytes);
+                break;
+            case CacheTier::Warm:
+                add(usage_.warmEntries, 1);
+                add(usage_.warmBytes, entry.warm ? entry.warm->size() : 0);
+                break;
+            case CacheTier::Cold:
+                add(usage_.coldEntries, 1);
+                add(usage_.coldBytes, entry.bytes);
+                break;
+        }
+        if (entry.frames > options_.headFrames)
+            add(usage_.headBytes, entry.head->data().size() * sizeof(Sample));
+    }
+
+    std::shared_ptr<const AudioBuffer> TieredCache::decode(const Entry& snapshot) {
+        if (snapshot.hot)
+            return snapshot.hot;
+
+        auto buffer = std::make_shared<AudioBuffer>(snapshot.channels, snapshot.frames);
+        if (snapshot.warm) {
+            if (decompressSamples(snapshot.warm->data(), snapshot.warm->size(), buffer->dataPtr(), snapshot.frames,
+                                  snapshot.channels))
+                return buffer;
+            logging::Logger::log("pipsqueak", "TieredCache: corrupt warm entry");
+            return nullptr;
+        }
+        if (snapshot.loader)
+            return snapshot.loader();
+
+        std::ifstream file(snapshot.spillPath, std::ios::binary);
+        SpillHeader header{};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || std::memcmp(header.magic, kSpillMagic, sizeof(kSpillMagic)) != 0
+            || header.channels != snapshot.channels || header.frames != snapshot.frames) {
+            logging::Logger::log("pipsqueak", "TieredCache: unreadable spill file " + snapshot.spillPath);
+            return nullptr;
+        }
+
+        std::vector<std::uint8_t> compressed(static_cast<size_t>(header.size));
+        if (!file.read(reinterpret_cast<char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()))
+            || !decompressSamples(compressed.data(), compressed.size(), buffer->dataPtr(), snapshot.frames,
+                                  snapshot.channels)) {
+            logging::Logger::log("pipsqueak", "TieredCache: corrupt spill file " + snapshot.spillPath);
+            return nullptr;
+        }
+        return buffer;
+    }
+
+    std::string TieredCache::spill(const size_t key, const Entry& entry, const std::vector<std::uint8_t>& compressed) {
+        const std::string path = spillPrefix_ + std::to_string(key) + ".spill";
+
+        SpillHeader header{};
+        std::memcpy(header.magic, kSpillMagic, sizeof(kSpillMagic));
+        header.channels = entry.channels;
+        header.frames = entry.frames;
+        header.size = compressed.size();
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+        file.close();
+        if (!file) {
+            logging::Logger::log("pipsqueak", "TieredCache: failed to write spill file " + path);
+            std::remove(path.c_str());
+            return {};
+        }
+        return path;
+    }
+
+    std::shared_ptr<const AudioBuffer> TieredCache::promote(const size_t key) {
+        Entry snapshot;
+        std::uint64_t version;
+        {
+            std::lock_guard lock(mutex_);
+            const auto it = entries_.find(key);
+            if (it == entries_.end())
+                return nullptr;
+            if (it->second.hot)
+                return it->second.hot;
+            snapshot = it->second;
+            version = it->second.version;
+        }
+
+        // Decompress or read back outside the lock
+        auto buffer = decode(snapshot);
+
+        std::lock_guard lock(mutex_);
+        const auto it = entries_.find(key);
+        if (it == entries_.end() || !buffer)
+            return buffer;
+
+        Entry& entry = it->second;
+        if (entry.version != version && entry.hot)
+            return entry.hot; // Promoted by another thread meanwhile
+
+        account(entry, -1);
+        entry.hot = buffer;
+        entry.warm.reset();
+        entry.tier = CacheTier::Hot;
+        entry.score = std::max(entry.score, options_.promoteScore);
+        ++entry.version;
+        account(entry, +1);
+        ++usage_.promotions;
+        requested_.erase(key);
+        if (usage_.hotBytes > options_.hotBytes)
+            overBudget_ = true;
+        return buffer;
+    }
+
+    bool TieredCache::demote(const size_t key) {
+        Entry snapshot;
+        std::uint64_t version;
+        {
+            std::lock_guard lock(mutex_);
+            const auto it = entries_.find(key);
+            if (it == entries_.end() || it->second.frames <= options_.headFrames || it->second.tier == CacheTier::Cold)
+                return false;
+            if (it->second.hot && it->second.hot.use_count() > 1)
+                return false; // Playing somewhere: demoting would free nothing
+            snapshot = it->second;
+            version = it->second.version;
+        }
+
+        if (snapshot.tier == CacheTier::Hot) {
+            auto compressed = std::make_shared<const std::vector<std::uint8_t>>(
+                compressSamples(snapshot.hot->dataPtr(), snapshot.frames, snapshot.channels));
+
+            std::lock_guard lock(mutex_);
+            const auto it = entries_.find(key);
+            // Ours and the entry's are the only references unless someone fetched it meanwhile
+            if (it == entries_.end() || it->second.version != version || snapshot.hot.use_count() > 2)
+                return false;
+
+            Entry& entry = it->second;
+            account(entry, -1);
+            entry.hot.reset();
+            entry.warm = std::move(compressed);
+            entry.tier = CacheTier::Warm;
+            ++entry.version;
+            account(entry, +1);
+            ++usage_.demotions;
+            return true;
+        }
+
+        // Warm to cold: write the spill file once; later demotions reuse it
+        std::string path = snapshot.spillPath;
+        if (path.empty() && !snapshot.loader) {
+            path = spill(key, snapshot, *snapshot.warm);
+            if (path.empty())
+                return false;
+        }
+
+        std::lock_guard lock(mutex_);
+        const auto it = entries_.find(key);
+        if (it == entries_.end() || it->second.version != version) {
+            if (path != snapshot.spillPath)
+                std::remove(path.c_str());
+            return false;
+        }
+
+        Entry& entry = it->second;
+        account(entry, -1);
+        entry.warm.reset();
+        entry.spillPath = std::move(path);
+        entry.tier = CacheTier::Cold;
+        ++entry.version;
+        account(entry, +1);
+        ++usage_.demotions;
+        return true;
+    }
+
+    std::vector<size_t> TieredCache::demotionOrder(const CacheTier tier) {
+        std::vector<std::pair<double, size_t>> candidates;
+        {
+            std::lock_guard lock(mutex_);
+            for (const auto& [key, entry] : entries_) {
+                if (entry.tier == tier && entry.frames > options_.headFrames)
+                    candidates.emplace_back(entry.score, key);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        std::vector<size_t> keys;
+        keys.reserve(candidates.size());
+        for (const auto& candidate : candidates)
+            keys.push_back(candidate.second);
+        return keys;
+    }
+
+    void TieredCache::maintain() {
+        // Age the scores and pick the entries worth promoting, requested ones first
+        struct Candidate {
+            bool requested;
+            double score;
+            size_t key;
+        };
+        std::vector<Candidate> promotions;
+        {
+            std::lock_guard lock(mutex_);
+            std::unordered_set<size_t> requested;
+            requested.swap(requested_);
+            overBudget_ = false;
+            for (auto& [key, entry] : entries_) {
+                entry.score = entry.score * options_.decay + static_cast<double>(entry.accesses);
+                entry.accesses = 0;
+                if (entry.hot)
+                    continue;
+                const bool asked = requested.count(key) != 0;
+                if (asked || entry.score >= options_.promoteScore)
+                    promotions.push_back({asked, entry.score, key});
+            }
+        }
+        std::sort(promotions.begin(), promotions.end(), [](const Candidate& a, const Candidate& b) {
+            return a.requested != b.requested ? a.requested : a.score > b.score;
+        });
+
+        std::unordered_set<size_t> promoted;
+        for (const auto& candidate : promotions) {
+            if (!candidate.requested) {
+                // Frequency promotions only fill free room in the hot budget
+                std::lock_guard lock(mutex_);
+                const auto it = entries_.find(candidate.key);
+                if (it == entries_.end() || usage_.hotBytes + it->second.bytes > options_.hotBytes)
+                    continue;
+            }
+            if (promote(candidate.key))
+                promoted.insert(candidate.key);
+        }
+
+        // Demote the least used entries until each tier fits its budget
+        const auto over = [this](const CacheTier tier) {
+            std::lock_guard lock(mutex_);
+            return tier == CacheTier::Hot ? usage_.hotBytes > options_.hotBytes : usage_.warmBytes > options_.warmBytes;
+        };
+        for (const CacheTier tier : {CacheTier::Hot, CacheTier::Warm}) {
+            if (!over(tier))
+                continue;
+            for (const size_t key : demotionOrder(tier)) {
+                if (!over(tier))
+                    break;
+                if (!promoted.count(key))
+                    demote(key);
+            }
+        }
+    }
+
+    void TieredCache::workerLoop() {
+        std::unique_lock lock(mutex_);
+        while (!stopping_) {
+            wake_.wait_for(lock, options_.interval, [this] {
+                return stopping_ || overBudget_ || !requested_.empty();
+            });
+            if (stopping_)
+                break;
+
+            lock.unlock();
+            maintain();
+            lock.lock();
+        }
+    }
+}
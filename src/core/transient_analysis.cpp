@@ -0,0 +1,85 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <algorithm>
+#include <pipsqueak/core/transient_analysis.hpp>
+
+namespace pipsqueak::core {
+    namespace {
+        // A hop must be this many times louder than the recent average to count as an onset.
+        constexpr double kFluxThreshold = 4.0;
+        // Hops quieter than this (mean square) are never onsets; avoids triggering on noise floors.
+        constexpr double kEnergyFloor = 1e-6;
+        // Number of preceding hops averaged to form the reference energy.
+        constexpr size_t kHistoryHops = 8;
+        // Minimum spacing between two onsets, in hops.
+        constexpr size_t kMinSpacingHops = 4;
+        // Material with fewer onsets per second (at 44.1k) than this is treated as tonal.
+        constexpr double kTonalOnsetsPerFrame = 2.0 / 44100.0;
+    }
+
+    bool TransientMap::firstOnsetIn(const size_t begin, const size_t end, size_t& onset) const {
+        const auto it = std::lower_bound(onsets.begin(), onsets.end(), begin);
+        if (it == onsets.end() || *it >= end)
+            return false;
+
+        onset = *it;
+        return true;
+    }
+
+    TransientMap detectTransients(const AudioBuffer& buffer, const size_t hopSize) {
+        TransientMap map;
+        map.hopSize = hopSize;
+
+        const size_t frames = buffer.numFrames();
+        const unsigned channels = buffer.numChannels();
+        if (hopSize == 0 || frames == 0 || channels == 0)
+            return map;
+
+        // ---- Mean-square energy per hop (channels summed) ----
+        const Sample* data = buffer.dataPtr();
+        const size_t numHops = (frames + hopSize - 1) / hopSize;
+        std::vector<double> energy(numHops, 0.0);
+
+        for (size_t h = 0; h < numHops; ++h) {
+            const size_t first = h * hopSize;
+            const size_t last = std::min(first + hopSize, frames);
+            double acc = 0.0;
+            for (size_t f = first; f < last; ++f) {
+                double mono = 0.0;
+                for (unsigned c = 0; c < channels; ++c)
+                    mono += data[f * channels + c];
+                acc += mono * mono;
+            }
+            energy[h] = acc / static_cast<double>((last - first) * channels);
+        }
+
+        // ---- Energy flux against a short running average ----
+        size_t lastOnsetHop = 0;
+        bool haveOnset = false;
+        for (size_t h = 0; h < numHops; ++h) {
+            if (energy[h] < kEnergyFloor)
+                continue;
+
+            const size_t histBegin = h > kHistoryHops ? h - kHistoryHops : 0;
+            double reference = 0.0;
+            for (size_t k = histBegin; k < h; ++k)
+                reference += energy[k];
+            reference = (h > histBegin) ? reference / static_cast<double>(h - histBegin) : 0.0;
+
+            const bool spaced = !haveOnset || (h - lastOnsetHop) >= kMinSpacingHops;
+            if (spaced && energy[h] > kFluxThreshold * std::max(reference, kEnergyFloor)) {
+                map.onsets.push_back(h * hopSize);
+                lastOnsetHop = h;
+                haveOnset = true;
+            }
+        }
+
+        // The very first onset of a sample is just the sound starting; density counts the rest.
+        const size_t interior = map.onsets.empty() ? 0 : map.onsets.size() - 1;
+        map.tonal = static_cast<double>(interior) < kTonalOnsetsPerFrame * static_cast<double>(frames);
+
+        return map;
+    }
+}
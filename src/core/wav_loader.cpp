@@ -0,0 +1,351 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <pipsqueak/core/wav_loader.hpp>
+#include "core/logging.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <string>
+
+#include <sys/stat.h>
+
+namespace pipsqueak::core {
+    namespace {
+        constexpr size_t kAlign = BatchReader::kDirectAlignment;
+        constexpr size_t kHeaderBytes = 64 * 1024;
+
+        constexpr std::uint16_t kFormatPcm = 1;
+        constexpr std::uint16_t kFormatFloat = 3;
+        constexpr std::uint16_t kFormatExtensible = 0xFFFE;
+
+        std::uint16_t le16(const std::uint8_t* p) { return static_cast<std::uint16_t>(p[0] | (p[1] << 8)); }
+        std::uint32_t le32(const std::uint8_t* p) {
+            return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+                   (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+        }
+
+        size_t alignUp(const size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+        std::uint64_t alignDown(const std::uint64_t n) { return n & ~static_cast<std::uint64_t>(kAlign - 1); }
+
+        // Converts little-endian PCM/float samples to Sample.
+        void convert(const WavInfo& info, const std::uint8_t* src, Sample* dst, const size_t count) {
+            switch (info.bitsPerSample) {
+                case 16:
+                    for (size_t i = 0; i < count; ++i) {
+                        std::int16_t v;
+                        std::memcpy(&v, src + 2 * i, 2);
+                        dst[i] = static_cast<Sample>(v) * (1.0f / 32768.0f);
+                    }
+                    break;
+                case 24:
+                    for (size_t i = 0; i < count; ++i) {
+                        const std::uint8_t* p = src + 3 * i;
+                        // Assemble in the top bytes so the shift sign-extends.
+                        const auto v = static_cast<std::int32_t>(static_cast<std::uint32_t>(p[0]) << 8 |
+                                                                 static_cast<std::uint32_t>(p[1]) << 16 |
+                                                                 static_cast<std::uint32_t>(p[2]) << 24) >> 8;
+                        dst[i] = static_cast<Sample>(v) * (1.0f / 8388608.0f);
+                    }
+                    break;
+                case 32:
+                    if (info.isFloat) {
+                        std::memcpy(dst, src, count * sizeof(float));
+                    } else {
+                        for (size_t i = 0; i < count; ++i) {
+                            std::int32_t v;
+                            std::memcpy(&v, src + 4 * i, 4);
+                            dst[i] = static_cast<Sample>(static_cast<double>(v) * (1.0 / 2147483648.0));
+                        }
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // Reads the MIDI unity note and the first loop of a 'smpl' chunk body.
+        void readSamplerChunk(const std::uint8_t* body, const size_t bytes, WavInfo& info) {
+            if (bytes < 36)
+                return;
+            if (const std::uint32_t unity = le32(body + 12); unity <= 127)
+                info.unityNote = static_cast<int>(unity);
+
+            // Loops follow the 36-byte header, 24 bytes each; the end frame is inclusive.
+            if (le32(body + 28) == 0 || bytes < 36 + 24)
+                return;
+            const std::uint32_t start = le32(body + 36 + 8);
+            const std::uint32_t end = le32(body + 36 + 12);
+            if (end >= start && end < std::numeric_limits<std::uint32_t>::max()) {
+                info.loopStart = start;
+                info.loopEnd = end + 1;
+            }
+        }
+
+        // One aligned read and the byte slice of it that is actually wanted.
+        struct Job {
+            size_t file;
+            std::uint64_t wantOffset; // File offset of the wanted bytes
+            size_t wantBytes;
+            bool header;
+        };
+
+        struct FileState {
+            int fd{-1};
+            WavInfo info;
+            std::shared_ptr<AudioBuffer> buffer;
+            std::uint64_t trailer{0}; // File offset of the chunks after the data; 0 once read
+        };
+    }
+
+    std::optional<WavInfo> parseWavHeader(const std::uint8_t* bytes, const size_t size) {
+        if (size < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0)
+            return std::nullopt;
+
+        WavInfo info;
+        bool haveFormat = false;
+        size_t pos = 12;
+        while (pos + 8 <= size) {
+            const std::uint8_t* chunk = bytes + pos;
+            const std::uint32_t chunkSize = le32(chunk + 4);
+
+            if (std::memcmp(chunk, "fmt ", 4) == 0) {
+                if (chunkSize < 16 || pos + 8 + 16 > size)
+                    return std::nullopt;
+                std::uint16_t format = le16(chunk + 8);
+                info.channels = le16(chunk + 10);
+                info.sampleRate = le32(chunk + 12);
+                info.bitsPerSample = le16(chunk + 22);
+                // WAVE_FORMAT_EXTENSIBLE keeps the real format in the sub-format GUID's first two bytes.
+                if (format == kFormatExtensible && chunkSize >= 40 && pos + 8 + 26 <= size)
+                    format = le16(chunk + 8 + 24);
+                info.isFloat = (format == kFormatFloat);
+                if (format != kFormatPcm && format != kFormatFloat)
+                    return std::nullopt;
+                haveFormat = true;
+            } else if (std::memcmp(chunk, "smpl", 4) == 0) {
+                readSamplerChunk(chunk + 8, std::min<size_t>(chunkSize, size - pos - 8), info);
+            } else if (std::memcmp(chunk, "data", 4) == 0) {
+                if (!haveFormat)
+                    return std::nullopt;
+                info.dataOffset = pos + 8;
+                info.dataBytes = chunkSize;
+                const bool supported = info.channels > 0 &&
+                    (info.isFloat ? info.bitsPerSample == 32
+                                  : (info.bitsPerSample == 16 || info.bitsPerSample == 24 || info.bitsPerSample == 32));
+                return supported ? std::optional<WavInfo>(info) : std::nullopt;
+            }
+
+            // Chunks are padded to even sizes.
+            pos += 8 + chunkSize + (chunkSize & 1u);
+        }
+        return std::nullopt;
+    }
+
+    void parseWavTrailer(const std::uint8_t* bytes, const size_t size, WavInfo& info) {
+        size_t pos = 0;
+        while (pos + 8 <= size) {
+            const std::uint8_t* chunk = bytes + pos;
+            const std::uint32_t chunkSize = le32(chunk + 4);
+            if (std::memcmp(chunk, "smpl", 4) == 0)
+                readSamplerChunk(chunk + 8, std::min<size_t>(chunkSize, size - pos - 8), info);
+            pos += 8 + static_cast<size_t>(chunkSize) + (chunkSize & 1u);
+        }
+    }
+
+    std::vector<LoadedSample> loadWavFiles(BatchReader& reader, const std::vector<std::string>& paths,
+                                           BufferStore* store, const WavLoadOptions& options) {
+        std::vector<LoadedSample> results(paths.size());
+        std::vector<FileState> files(paths.size());
+
+        // Every completion reaped below is taken to be ours and its arena to be free.
+        if (reader.inFlight() != 0) {
+            logging::Logger::log("pipsqueak", "loadWavFiles: reader has " + std::to_string(reader.inFlight()) +
+                                                  " reads in flight; it must be idle");
+            for (size_t i = 0; i < paths.size(); ++i) {
+                results[i].path = paths[i];
+                results[i].error = "reader is busy";
+            }
+            return results;
+        }
+
+        // ---- Staging: one page-aligned slot per read in flight ----
+        const size_t chunkBytes = std::max<size_t>(options.chunkBytes, kAlign);
+        const size_t slotBytes = alignUp(std::max(chunkBytes, kHeaderBytes) + 2 * kAlign);
+        size_t slots = reader.queueDepth();
+        std::uint8_t* staging = nullptr;
+        std::unique_ptr<std::uint8_t, decltype(&std::free)> owned(nullptr, &std::free);
+        if (reader.arena() && reader.arenaBytes() >= slotBytes) {
+            slots = std::min(slots, reader.arenaBytes() / slotBytes);
+            staging = static_cast<std::uint8_t*>(reader.arena());
+        } else {
+            owned.reset(static_cast<std::uint8_t*>(std::aligned_alloc(kAlign, slots * slotBytes)));
+            staging = owned.get();
+        }
+
+        // Runs a set of jobs through the reader, calling onData(job, bytes) for each completed one.
+        const auto run = [&](std::deque<Job>& jobs, const auto& onData) {
+            std::vector<Job> slotJob(slots);
+            std::vector<size_t> freeSlots(slots);
+            for (size_t i = 0; i < slots; ++i) freeSlots[i] = slots - 1 - i;
+
+            std::vector<ReadRequest> batch;
+            std::vector<ReadResult> done(slots);
+            size_t inFlight = 0;
+
+            while (!jobs.empty() || inFlight > 0) {
+                batch.clear();
+                while (!jobs.empty() && !freeSlots.empty()) {
+                    const Job job = jobs.front();
+                    jobs.pop_front();
+                    if (!results[job.file].error.empty())
+                        continue; // The file already failed
+
+                    const size_t slot = freeSlots.back();
+                    freeSlots.pop_back();
+                    slotJob[slot] = job;
+
+                    const std::uint64_t readOffset = alignDown(job.wantOffset);
+                    const size_t readBytes = alignUp(static_cast<size_t>(job.wantOffset - readOffset) + job.wantBytes);
+                    batch.push_back({files[job.file].fd, readOffset, staging + slot * slotBytes, readBytes, slot});
+                }
+
+                // Anything the reader had no room for (its submission queue is full) goes back
+                // to the front of the queue for the next round.
+                const size_t submitted = reader.submit(batch.data(), batch.size());
+                inFlight += submitted;
+                for (size_t i = batch.size(); i-- > submitted;) {
+                    const auto slot = static_cast<size_t>(batch[i].userData);
+                    jobs.push_front(slotJob[slot]);
+                    freeSlots.push_back(slot);
+                }
+
+                const size_t reaped = reader.reap(done.data(), done.size(), inFlight > 0);
+                inFlight -= reaped;
+                for (size_t i = 0; i < reaped; ++i) {
+                    const auto slot = static_cast<size_t>(done[i].userData);
+                    const Job& job = slotJob[slot];
+                    const std::uint64_t readOffset = alignDown(job.wantOffset);
+                    const auto skip = static_cast<size_t>(job.wantOffset - readOffset);
+
+                    LoadedSample& result = results[job.file];
+                    if (done[i].result < 0) {
+                        if (result.error.empty()) result.error = std::strerror(static_cast<int>(-done[i].result));
+                    } else if (static_cast<size_t>(done[i].result) < skip + (job.header ? 12 : job.wantBytes)) {
+                        if (result.error.empty()) result.error = "unexpected end of file";
+                    } else if (result.error.empty()) {
+                        const size_t available = std::min(job.wantBytes, static_cast<size_t>(done[i].result) - skip);
+                        onData(job, staging + slot * slotBytes + skip, available);
+                    }
+                    freeSlots.push_back(slot);
+                }
+            }
+        };
+
+        // ---- Phase 1: every header in one batch ----
+        std::deque<Job> jobs;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            results[i].path = paths[i];
+            files[i].fd = BatchReader::openForRead(paths[i], options.direct);
+            if (files[i].fd < 0) {
+                results[i].error = "cannot open file";
+                continue;
+            }
+            jobs.push_back({i, 0, kHeaderBytes, true});
+        }
+
+        run(jobs, [&](const Job& job, const std::uint8_t* bytes, const size_t size) {
+            auto info = parseWavHeader(bytes, size);
+            LoadedSample& result = results[job.file];
+            if (!info) {
+                result.error = "not a supported WAVE file";
+                return;
+            }
+
+            const size_t frameBytes = static_cast<size_t>(info->channels) * (info->bitsPerSample / 8);
+            const std::uint64_t frames = info->dataBytes / frameBytes;
+            if (frames == 0 || frames > std::numeric_limits<unsigned>::max()) {
+                result.error = "unsupported data length";
+                return;
+            }
+
+            // A short header read saw the whole file, so any chunks after the data are here too.
+            std::uint64_t trailer = info->dataOffset + info->dataBytes + (info->dataBytes & 1u);
+            if (size < kHeaderBytes && trailer < size) {
+                parseWavTrailer(bytes + trailer, size - static_cast<size_t>(trailer), *info);
+                trailer = 0;
+            }
+            files[job.file].trailer = trailer;
+            info->dataBytes = frames * frameBytes;
+            files[job.file].info = *info;
+            files[job.file].buffer = std::make_shared<AudioBuffer>(info->channels, static_cast<unsigned>(frames));
+            result.sampleRate = info->sampleRate;
+        });
+
+        // ---- Phase 1b: chunks after the data, for files that have any beyond the header read ----
+        for (size_t i = 0; i < paths.size(); ++i) {
+            FileState& file = files[i];
+            struct stat st{};
+            if (!results[i].error.empty() || file.trailer == 0 || fstat(file.fd, &st) != 0)
+                continue;
+            const auto fileBytes = static_cast<std::uint64_t>(st.st_size);
+            if (fileBytes >= file.trailer + 8)
+                jobs.push_back({i, file.trailer, static_cast<size_t>(std::min<std::uint64_t>(
+                                                     fileBytes - file.trailer, kHeaderBytes)), false});
+        }
+        run(jobs, [&](const Job& job, const std::uint8_t* bytes, const size_t size) {
+            parseWavTrailer(bytes, size, files[job.file].info);
+        });
+
+        // ---- Phase 2: all data chunks of all files, interleaved so every file progresses ----
+        std::vector<std::deque<Job>> perFile(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (!results[i].error.empty())
+                continue;
+            const WavInfo& info = files[i].info;
+            const size_t frameBytes = static_cast<size_t>(info.channels) * (info.bitsPerSample / 8);
+            const size_t step = std::max<size_t>(1, chunkBytes / frameBytes) * frameBytes;
+            for (std::uint64_t at = 0; at < info.dataBytes; at += step) {
+                const auto bytes = static_cast<size_t>(std::min<std::uint64_t>(step, info.dataBytes - at));
+                perFile[i].push_back({i, info.dataOffset + at, bytes, false});
+            }
+        }
+        for (bool any = true; any;) {
+            any = false;
+            for (auto& queue : perFile) {
+                if (queue.empty()) continue;
+                jobs.push_back(queue.front());
+                queue.pop_front();
+                any = true;
+            }
+        }
+
+        run(jobs, [&](const Job& job, const std::uint8_t* bytes, const size_t size) {
+            FileState& file = files[job.file];
+            const size_t bytesPerSample = file.info.bitsPerSample / 8;
+            const size_t first = static_cast<size_t>(job.wantOffset - file.info.dataOffset) / bytesPerSample;
+            convert(file.info, bytes, file.buffer->dataPtr() + first, size / bytesPerSample);
+        });
+
+        // ---- Publish ----
+        for (size_t i = 0; i < paths.size(); ++i) {
+            BatchReader::close(files[i].fd);
+            if (!results[i].error.empty())
+                continue;
+            const WavInfo& info = files[i].info;
+            results[i].unityNote = info.unityNote;
+            if (info.loopEnd > info.loopStart && info.loopEnd <= files[i].buffer->numFrames()) {
+                results[i].loopStart = info.loopStart;
+                results[i].loopEnd = info.loopEnd;
+            }
+            results[i].buffer = std::move(files[i].buffer);
+            if (store)
+                results[i].key = store->insert(results[i].buffer, options.insert);
+        }
+        return results;
+    }
+}
@@ -0,0 +1,200 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include "pipsqueak/core/waveform_overview.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+#include "pipsqueak/core/kernels.hpp"
+
+namespace pipsqueak::core {
+    WaveformOverview::WaveformOverview(const unsigned channels, const WaveformOverviewOptions& options)
+        : channels_(channels), options_(options) {
+        if (channels_ == 0 || options_.baseFrames == 0 || options_.fanout < 2) {
+            throw std::invalid_argument("WaveformOverview: invalid channel count or pyramid shape");
+        }
+    }
+
+    WaveformOverview::WaveformOverview(WaveformOverview&& other) noexcept
+        : channels_(other.channels_), options_(other.options_) {
+        std::unique_lock lock(other.mutex_);
+        frames_ = other.frames_;
+        levels_ = std::move(other.levels_);
+        other.frames_ = 0;
+    }
+
+    WaveformOverview WaveformOverview::build(const AudioBuffer& buffer, const WaveformOverviewOptions& options) {
+        WaveformOverview overview(buffer.numChannels(), options);
+        overview.append(buffer.dataPtr(), buffer.numFrames());
+        return overview;
+    }
+
+    void WaveformOverview::append(const Sample* interleaved, const size_t frames) {
+        if (frames == 0)
+            return;
+
+        std::unique_lock lock(mutex_);
+        if (levels_.empty())
+            levels_.emplace_back();
+
+        const auto& k = kernels::active();
+        const size_t bf = options_.baseFrames;
+        const unsigned ch = channels_;
+        Level& base = levels_[0];
+        const size_t firstDirty = frames_ / bf;
+        size_t done = 0;
+
+        // Top up the partially filled last bucket
+        if (const size_t filled = frames_ % bf; filled != 0) {
+            done = std::min(bf - filled, frames);
+            std::vector<float> mn(ch), mx(ch), sq(ch);
+            k.blockMinMax(interleaved, 1, done, ch, mn.data(), mx.data(), sq.data());
+
+            const size_t at = firstDirty * ch;
+            for (unsigned c = 0; c < ch; ++c) {
+                base.min[at + c] = std::min(base.min[at + c], mn[c]);
+                base.max[at + c] = std::max(base.max[at + c], mx[c]);
+                base.sumSquares[at + c] += sq[c];
+            }
+        }
+
+        // Whole buckets straight into level 0, then the new partial one
+        const size_t whole = (frames - done) / bf;
+        const size_t tail = (frames - done) % bf;
+        const size_t first = base.buckets(ch);
+        const size_t total = (first + whole + (tail ? 1 : 0)) * ch;
+        base.min.resize(total);
+        base.max.resize(total);
+        base.sumSquares.resize(total);
+
+        const Sample* src = interleaved + done * ch;
+        k.blockMinMax(src, whole, bf, ch, base.min.data() + first * ch, base.max.data() + first * ch,
+                      base.sumSquares.data() + first * ch);
+        if (tail) {
+            const size_t at = (first + whole) * ch;
+            k.blockMinMax(src + whole * bf * ch, 1, tail, ch, base.min.data() + at, base.max.data() + at,
+                          base.sumSquares.data() + at);
+        }
+
+        frames_ += frames;
+        propagate(firstDirty);
+    }
+
+    void WaveformOverview::propagate(size_t from) {
+        const size_t f = options_.fanout;
+        const unsigned ch = channels_;
+
+        for (size_t i = 0; levels_[i].buckets(ch) > 1; ++i) {
+            if (i + 1 == levels_.size())
+                levels_.emplace_back();
+            const Level& lower = levels_[i];
+            Level& upper = levels_[i + 1];
+
+            const size_t n = lower.buckets(ch);
+            const size_t count = (n + f - 1) / f;
+            from /= f;
+            upper.min.resize(count * ch);
+            upper.max.resize(count * ch);
+            upper.sumSquares.resize(count * ch);
+
+            for (size_t j = from; j < count; ++j) {
+                const size_t last = std::min(j * f + f, n);
+                for (unsigned c = 0; c < ch; ++c) {
+                    float mn = lower.min[j * f * ch + c];
+                    float mx = lower.max[j * f * ch + c];
+                    float sq = 0.0f;
+                    for (size_t child = j * f; child < last; ++child) {
+                        mn = std::min(mn, lower.min[child * ch + c]);
+                        mx = std::max(mx, lower.max[child * ch + c]);
+                        sq += lower.sumSquares[child * ch + c];
+                    }
+                    upper.min[j * ch + c] = mn;
+                    upper.max[j * ch + c] = mx;
+                    upper.sumSquares[j * ch + c] = sq;
+                }
+            }
+        }
+    }
+
+    size_t WaveformOverview::query(const unsigned channel, const size_t startFrame, const size_t endFrame,
+                                   Column* out, const size_t pixels) const {
+        if (channel != kAllChannels && channel >= channels_) {
+            throw std::invalid_argument("WaveformOverview: channel out of range");
+        }
+
+        std::shared_lock lock(mutex_);
+        const size_t bf = options_.baseFrames;
+        const size_t f = options_.fanout;
+        const unsigned ch = channels_;
+        const unsigned c0 = channel == kAllChannels ? 0 : channel;
+        const unsigned c1 = channel == kAllChannels ? ch : channel + 1;
+        const double span = endFrame > startFrame ? static_cast<double>(endFrame - startFrame) : 0.0;
+
+        size_t covered = 0;
+        for (size_t p = 0; p < pixels; ++p) {
+            const size_t a = startFrame + static_cast<size_t>(span * static_cast<double>(p) / static_cast<double>(pixels));
+            size_t b = startFrame + static_cast<size_t>(span * static_cast<double>(p + 1) / static_cast<double>(pixels));
+            if (a >= frames_) {
+                out[p] = Column{};
+                continue;
+            }
+            b = std::min(std::max(b, a + 1), frames_);
+
+            // Level-0 buckets [lo, hi), covered by whole buckets of the coarsest levels that fit
+            size_t lo = a / bf;
+            size_t hi = (b + bf - 1) / bf;
+            const size_t frames = std::min(hi * bf, frames_) - lo * bf;
+
+            float mn = std::numeric_limits<float>::infinity();
+            float mx = -mn;
+            double sq = 0.0;
+            auto take = [&](const Level& level, const size_t bucket) {
+                for (unsigned c = c0; c < c1; ++c) {
+                    mn = std::min(mn, level.min[bucket * ch + c]);
+                    mx = std::max(mx, level.max[bucket * ch + c]);
+                    sq += level.sumSquares[bucket * ch + c];
+                }
+            };
+
+            for (size_t l = 0; lo < hi; ++l) {
+                const Level& level = levels_[l];
+                if (l + 1 == levels_.size()) {
+                    while (lo < hi) take(level, lo++);
+                    break;
+                }
+                while (lo < hi && lo % f != 0) take(level, lo++);
+                while (lo < hi && hi % f != 0) take(level, --hi);
+                lo /= f;
+                hi /= f;
+            }
+
+            out[p].min = mn;
+            out[p].max = mx;
+            out[p].rms = static_cast<float>(std::sqrt(sq / static_cast<double>(frames * (c1 - c0))));
+            ++covered;
+        }
+        return covered;
+    }
+
+    size_t WaveformOverview::frames() const {
+        std::shared_lock lock(mutex_);
+        return frames_;
+    }
+
+    size_t WaveformOverview::levels() const {
+        std::shared_lock lock(mutex_);
+        return levels_.size();
+    }
+
+    size_t WaveformOverview::memoryBytes() const {
+        std::shared_lock lock(mutex_);
+        size_t bytes = 0;
+        for (const auto& level : levels_)
+            bytes += (level.min.size() + level.max.size() + level.sumSquares.size()) * sizeof(float);
+        return bytes;
+    }
+}
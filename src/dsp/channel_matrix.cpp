@@ -0,0 +1,202 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <algorithm>
+#include <pipsqueak/core/kernels.hpp>
+#include <pipsqueak/dsp/channel_matrix.hpp>
+
+namespace pipsqueak::dsp {
+    namespace {
+        using Kind = ChannelLayout::Kind;
+
+        // Standard -3 dB fold-down coefficient (ITU-R BS.775).
+        constexpr float kMinus3dB = 0.70710678f;
+
+        // Channel indices within the WAVE/SMPTE surround orders.
+        constexpr unsigned L = 0, R = 1, C = 2;
+        constexpr unsigned Ls51 = 4, Rs51 = 5;
+        constexpr unsigned Lb71 = 4, Rb71 = 5, Ls71 = 6, Rs71 = 7;
+
+        bool isSurround(const Kind kind) {
+            return kind == Kind::Surround51 || kind == Kind::Surround71;
+        }
+
+        // Writes the stereo fold-down of a surround layout into rows L/R of a [2][channels] matrix.
+        void foldToStereo(const Kind kind, const unsigned channels, std::vector<float>& m) {
+            m.assign(2 * static_cast<size_t>(channels), 0.0f);
+            auto at = [&](const unsigned row, const unsigned col) -> float& { return m[row * channels + col]; };
+
+            at(0, L) = 1.0f;
+            at(1, R) = 1.0f;
+            at(0, C) = kMinus3dB;
+            at(1, C) = kMinus3dB;
+            // LFE is dropped in a fold-down.
+            if (kind == Kind::Surround51) {
+                at(0, Ls51) = kMinus3dB;
+                at(1, Rs51) = kMinus3dB;
+            } else {
+                at(0, Ls71) = kMinus3dB;
+                at(1, Rs71) = kMinus3dB;
+                at(0, Lb71) = kMinus3dB;
+                at(1, Rb71) = kMinus3dB;
+            }
+        }
+
+        // Packs a (source, destination) channel-count pair into a switchable key.
+        constexpr unsigned long shape(const unsigned src, const unsigned dst) {
+            return (static_cast<unsigned long>(src) << 16) | dst;
+        }
+
+        // ---- Mixing kernels ----
+
+        // Shapes known at compile time: the gains are folded into a local table and both
+        // channel loops unroll completely, leaving a straight-line, vectorisable frame body.
+        template <unsigned S, unsigned D>
+        void fixedKernel(const float* coeffs, unsigned, unsigned,
+                         const core::Sample* in, core::Sample* out, const size_t frames, const float gain) {
+            float g[D * S];
+            for (unsigned i = 0; i < D * S; ++i) g[i] = coeffs[i] * gain;
+
+            for (size_t f = 0; f < frames; ++f) {
+                const core::Sample* x = in + f * S;
+                core::Sample* y = out + f * D;
+                for (unsigned d = 0; d < D; ++d) {
+                    float acc = 0.0f;
+                    for (unsigned s = 0; s < S; ++s) acc += g[d * S + s] * x[s];
+                    y[d] += acc;
+                }
+            }
+        }
+
+        // Identity of any width: a flat multiply-accumulate over the interleaved block.
+        void identityKernel(const float*, const unsigned srcCh, unsigned,
+                            const core::Sample* in, core::Sample* out, const size_t frames, const float gain) {
+            core::kernels::active().mixAccumulate(out, in, frames * srcCh, gain);
+        }
+
+        // Arbitrary shapes.
+        void genericKernel(const float* coeffs, const unsigned srcCh, const unsigned dstCh,
+                           const core::Sample* in, core::Sample* out, const size_t frames, const float gain) {
+            for (size_t f = 0; f < frames; ++f) {
+                const core::Sample* x = in + f * srcCh;
+                core::Sample* y = out + f * dstCh;
+                for (unsigned d = 0; d < dstCh; ++d) {
+                    const float* row = coeffs + static_cast<size_t>(d) * srcCh;
+                    float acc = 0.0f;
+                    for (unsigned s = 0; s < srcCh; ++s) acc += row[s] * x[s];
+                    y[d] += gain * acc;
+                }
+            }
+        }
+    }
+
+    ChannelLayout ChannelLayout::fromChannelCount(const unsigned numChannels) {
+        switch (numChannels) {
+            case 1: return mono();
+            case 2: return stereo();
+            case 6: return surround51();
+            case 8: return surround71();
+            default: return discrete(numChannels);
+        }
+    }
+
+    ChannelMatrix::ChannelMatrix(const ChannelLayout source, const ChannelLayout destination)
+        : source_(source), destination_(destination) {
+        const unsigned S = source_.channels;
+        const unsigned D = destination_.channels;
+        coeffs_.assign(static_cast<size_t>(S) * D, 0.0f);
+        auto at = [&](const unsigned d, const unsigned s) -> float& { return coeffs_[static_cast<size_t>(d) * S + s]; };
+
+        const Kind sk = source_.kind;
+        const Kind dk = destination_.kind;
+
+        if (S == 0 || D == 0) {
+            // Nothing to route.
+        } else if (source_ == destination_) {
+            for (unsigned c = 0; c < S; ++c) at(c, c) = 1.0f;
+        } else if (sk == Kind::Mono) {
+            // Mono feeds the centre of a surround layout, and the first pair (or the only
+            // channel) of anything else, like a stereo source would.
+            if (isSurround(dk)) {
+                at(C, 0) = 1.0f;
+            } else {
+                for (unsigned d = 0; d < std::min(D, 2u); ++d) at(d, 0) = 1.0f;
+            }
+        } else if (dk == Kind::Mono) {
+            if (isSurround(sk)) {
+                std::vector<float> stereo;
+                foldToStereo(sk, S, stereo);
+                for (unsigned s = 0; s < S; ++s) at(0, s) = 0.5f * (stereo[s] + stereo[S + s]);
+            } else {
+                const float w = 1.0f / static_cast<float>(S);
+                for (unsigned s = 0; s < S; ++s) at(0, s) = w;
+            }
+        } else if (isSurround(sk) && dk == Kind::Stereo) {
+            foldToStereo(sk, S, coeffs_);
+        } else if (sk == Kind::Surround71 && dk == Kind::Surround51) {
+            for (unsigned c = 0; c <= 3; ++c) at(c, c) = 1.0f;
+            at(Ls51, Ls71) = 1.0f;
+            at(Rs51, Rs71) = 1.0f;
+            at(Ls51, Lb71) = kMinus3dB;
+            at(Rs51, Rb71) = kMinus3dB;
+        } else if (sk == Kind::Surround51 && dk == Kind::Surround71) {
+            for (unsigned c = 0; c <= 3; ++c) at(c, c) = 1.0f;
+            at(Ls71, Ls51) = 1.0f;
+            at(Rs71, Rs51) = 1.0f;
+        } else {
+            // Stereo into surround, and anything involving discrete layouts: index-for-index.
+            for (unsigned c = 0; c < std::min(S, D); ++c) at(c, c) = 1.0f;
+        }
+
+        selectKernel();
+    }
+
+    float ChannelMatrix::coefficient(const unsigned destinationChannel, const unsigned sourceChannel) const {
+        return coeffs_.at(static_cast<size_t>(destinationChannel) * source_.channels + sourceChannel);
+    }
+
+    void ChannelMatrix::selectKernel() {
+        const unsigned S = source_.channels;
+        const unsigned D = destination_.channels;
+
+        // A square matrix with a unit diagonal and nothing else is a plain accumulate.
+        bool identity = (S == D);
+        for (unsigned d = 0; identity && d < D; ++d)
+            for (unsigned s = 0; identity && s < S; ++s)
+                identity = coeffs_[static_cast<size_t>(d) * S + s] == (d == s ? 1.0f : 0.0f);
+
+        if (identity) { kernel_ = &identityKernel; return; }
+
+        switch (shape(S, D)) {
+            case shape(1, 2): kernel_ = &fixedKernel<1, 2>; break;
+            case shape(1, 6): kernel_ = &fixedKernel<1, 6>; break;
+            case shape(1, 8): kernel_ = &fixedKernel<1, 8>; break;
+            case shape(2, 1): kernel_ = &fixedKernel<2, 1>; break;
+            case shape(2, 6): kernel_ = &fixedKernel<2, 6>; break;
+            case shape(2, 8): kernel_ = &fixedKernel<2, 8>; break;
+            case shape(6, 1): kernel_ = &fixedKernel<6, 1>; break;
+            case shape(6, 2): kernel_ = &fixedKernel<6, 2>; break;
+            case shape(6, 8): kernel_ = &fixedKernel<6, 8>; break;
+            case shape(8, 1): kernel_ = &fixedKernel<8, 1>; break;
+            case shape(8, 2): kernel_ = &fixedKernel<8, 2>; break;
+            case shape(8, 6): kernel_ = &fixedKernel<8, 6>; break;
+            default:  kernel_ = &genericKernel; break;
+        }
+    }
+
+    void ChannelMatrix::accumulate(const core::Sample* in, core::Sample* out,
+                                   const size_t frames, const float gain) const noexcept {
+        if (frames == 0 || coeffs_.empty())
+            return;
+        kernel_(coeffs_.data(), source_.channels, destination_.channels, in, out, frames, gain);
+    }
+
+    void ChannelMatrix::accumulate(const core::AudioBuffer& in, core::AudioBuffer& out, const float gain) const noexcept {
+        if (in.numChannels() != source_.channels || out.numChannels() != destination_.channels)
+            return;
+
+        const size_t frames = std::min(in.numFrames(), out.numFrames());
+        accumulate(in.dataPtr(), out.dataPtr(), frames, gain);
+    }
+}
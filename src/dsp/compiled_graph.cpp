@@ -0,0 +1,185 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <stdexcept>
+#include <pipsqueak/core/kernels.hpp>
+#include <pipsqueak/dsp/compiled_graph.hpp>
+
+namespace pipsqueak::dsp {
+    namespace {
+        // Reallocates a bus buffer only if its shape differs from the one requested.
+        void ensureShape(std::unique_ptr<core::AudioBuffer>& buffer, const unsigned channels, const unsigned frames) {
+            if (!buffer || buffer->numChannels() != channels || buffer->numFrames() != frames) {
+                buffer = std::make_unique<core::AudioBuffer>(channels, frames);
+            }
+        }
+    }
+
+    // ---- Builder ----
+
+    CompiledGraph::Builder::Builder() {
+        busGains_.push_back(1.0f);
+        busParents_.push_back(0);
+    }
+
+    std::uint32_t CompiledGraph::Builder::busIndex(const NodeId parent) const {
+        if (parent.kind != NodeKind::Bus || parent.index >= busGains_.size())
+            throw std::invalid_argument("CompiledGraph parent must be an existing bus.");
+        return parent.index;
+    }
+
+    CompiledGraph::NodeId CompiledGraph::Builder::addBus(const NodeId parent, const float gain) {
+        const std::uint32_t p = busIndex(parent);
+        busGains_.push_back(gain);
+        busParents_.push_back(p);
+        return {NodeKind::Bus, static_cast<std::uint32_t>(busGains_.size() - 1)};
+    }
+
+    CompiledGraph::NodeId CompiledGraph::Builder::addSampler(const NodeId parent, Sampler sampler) {
+        const std::uint32_t p = busIndex(parent);
+        samplers_.push_back(std::move(sampler));
+        samplerParents_.push_back(p);
+        return {NodeKind::Sampler, static_cast<std::uint32_t>(samplers_.size() - 1)};
+    }
+
+    CompiledGraph::NodeId CompiledGraph::Builder::addOscillator(const NodeId parent, Oscillator oscillator) {
+        const std::uint32_t p = busIndex(parent);
+        oscillators_.push_back(oscillator);
+        oscillatorParents_.push_back(p);
+        return {NodeKind::Oscillator, static_cast<std::uint32_t>(oscillators_.size() - 1)};
+    }
+
+    CompiledGraph::NodeId CompiledGraph::Builder::addSource(const NodeId parent, std::shared_ptr<AudioSource> source) {
+        const std::uint32_t p = busIndex(parent);
+        if (!source)
+            throw std::invalid_argument("CompiledGraph source must not be null.");
+        sources_.push_back(std::move(source));
+        sourceParents_.push_back(p);
+        return {NodeKind::Source, static_cast<std::uint32_t>(sources_.size() - 1)};
+    }
+
+    std::shared_ptr<CompiledGraph> CompiledGraph::Builder::build() {
+        // The constructor is private, so make_shared cannot reach it.
+        std::shared_ptr<CompiledGraph> graph(new CompiledGraph(std::move(*this)));
+        *this = Builder();
+        return graph;
+    }
+
+    // ---- Graph ----
+
+    CompiledGraph::CompiledGraph(Builder&& builder)
+        : busParents_(std::move(builder.busParents_)),
+          samplers_(std::move(builder.samplers_)),
+          samplerParents_(std::move(builder.samplerParents_)),
+          oscillators_(std::move(builder.oscillators_)),
+          oscillatorParents_(std::move(builder.oscillatorParents_)),
+          sources_(std::move(builder.sources_)),
+          sourceParents_(std::move(builder.sourceParents_)) {
+        const size_t numBuses = busParents_.size();
+        busGains_ = std::make_unique<std::atomic<float>[]>(numBuses);
+        for (size_t b = 0; b < numBuses; ++b)
+            busGains_[b].store(builder.busGains_[b], std::memory_order_relaxed);
+        busBuffers_.resize(numBuses);
+
+        size_t active = 0;
+        for (const auto& s : samplers_) active += s.isFinished() ? 0 : 1;
+        for (const auto& o : oscillators_) active += o.isFinished() ? 0 : 1;
+        for (const auto& src : sources_) active += src->isFinished() ? 0 : 1;
+        activeLeaves_.store(active, std::memory_order_relaxed);
+    }
+
+    core::AudioBuffer& CompiledGraph::target(const std::uint32_t bus, core::AudioBuffer& output) {
+        return (bus == 0 && rootDirect_) ? output : *busBuffers_[bus];
+    }
+
+    void CompiledGraph::process(core::AudioBuffer& buffer) {
+        const unsigned channels = buffer.numChannels();
+        const unsigned frames = buffer.numFrames();
+        if (channels == 0 || frames == 0)
+            return;
+
+        // A unity root adds its children straight into the output; otherwise it needs its own sum.
+        const float rootGain = busGains_[0].load(std::memory_order_relaxed);
+        rootDirect_ = (rootGain == 1.0f);
+
+        for (size_t b = rootDirect_ ? 1 : 0; b < busBuffers_.size(); ++b) {
+            ensureShape(busBuffers_[b], channels, frames);
+            busBuffers_[b]->fill(0.0);
+        }
+
+        // ---- Leaves, one batch per kind ----
+        size_t active = 0;
+        for (size_t i = 0; i < samplers_.size(); ++i) {
+            Sampler& s = samplers_[i];
+            s.process(target(samplerParents_[i], buffer));
+            active += s.isFinished() ? 0 : 1;
+        }
+        for (size_t i = 0; i < oscillators_.size(); ++i) {
+            Oscillator& o = oscillators_[i];
+            o.process(target(oscillatorParents_[i], buffer));
+            active += o.isFinished() ? 0 : 1;
+        }
+        for (size_t i = 0; i < sources_.size(); ++i) {
+            AudioSource& src = *sources_[i];
+            src.process(target(sourceParents_[i], buffer));
+            active += src.isFinished() ? 0 : 1;
+        }
+        activeLeaves_.store(active, std::memory_order_relaxed);
+
+        // ---- Buses: children have higher indices than their parents, so one reverse sweep folds the tree ----
+        const auto& kernels = core::kernels::active();
+        const size_t n = static_cast<size_t>(channels) * frames;
+        for (size_t b = busBuffers_.size(); b-- > 1;) {
+            core::AudioBuffer& dst = target(busParents_[b], buffer);
+            kernels.mixAccumulate(dst.dataPtr(), busBuffers_[b]->dataPtr(), n,
+                                  busGains_[b].load(std::memory_order_relaxed));
+        }
+        if (!rootDirect_)
+            kernels.mixAccumulate(buffer.dataPtr(), busBuffers_[0]->dataPtr(), n, rootGain);
+    }
+
+    bool CompiledGraph::isFinished() const {
+        return activeLeaves_.load(std::memory_order_relaxed) == 0;
+    }
+
+    size_t CompiledGraph::activeLeaves() const noexcept {
+        return activeLeaves_.load(std::memory_order_relaxed);
+    }
+
+    void CompiledGraph::noteOn(const NodeId sampler, const int note, const float velocity) {
+        Sampler& s = this->sampler(sampler);
+        const bool wasFinished = s.isFinished();
+        s.noteOn(note, velocity);
+        if (wasFinished && !s.isFinished())
+            activeLeaves_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void CompiledGraph::setBusGain(const NodeId bus, const float gain) {
+        if (bus.kind != NodeKind::Bus || bus.index >= busParents_.size())
+            return;
+        busGains_[bus.index].store(gain, std::memory_order_relaxed);
+    }
+
+    Sampler& CompiledGraph::sampler(const NodeId node) {
+        if (node.kind != NodeKind::Sampler)
+            throw std::invalid_argument("CompiledGraph node is not a sampler.");
+        return samplers_.at(node.index);
+    }
+
+    Oscillator& CompiledGraph::oscillator(const NodeId node) {
+        if (node.kind != NodeKind::Oscillator)
+            throw std::invalid_argument("CompiledGraph node is not an oscillator.");
+        return oscillators_.at(node.index);
+    }
+
+    size_t CompiledGraph::count(const NodeKind kind) const noexcept {
+        switch (kind) {
+            case NodeKind::Bus: return busParents_.size();
+            case NodeKind::Sampler: return samplers_.size();
+            case NodeKind::Oscillator: return oscillators_.size();
+            case NodeKind::Source: return sources_.size();
+        }
+        return 0;
+    }
+}
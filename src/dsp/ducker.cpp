@@ -0,0 +1,60 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <pipsqueak/dsp/ducker.hpp>
+
+namespace pipsqueak::dsp {
+    Ducker::Ducker(std::shared_ptr<AudioSource> input, const float threshold, const float depth,
+                   const float releaseFrames)
+        : input_(std::move(input)),
+          threshold_(std::max(threshold, 1e-6f)),
+          depth_(std::clamp(depth, 0.0f, 1.0f)),
+          releaseCoeff_(releaseFrames > 0.0f ? std::exp(-1.0f / releaseFrames) : 0.0f) {}
+
+    void Ducker::process(core::AudioBuffer& buffer, const SidechainInputs& sidechains) {
+        if (!input_)
+            return;
+
+        // No key connected: behave like the plain input.
+        if (sidechains.empty()) {
+            input_->process(buffer);
+            return;
+        }
+
+        const unsigned channels = buffer.numChannels();
+        const unsigned frames = buffer.numFrames();
+        if (!scratch_ || scratch_->numChannels() != channels || scratch_->numFrames() != frames) {
+            scratch_ = std::make_unique<core::AudioBuffer>(channels, frames);
+        }
+        scratch_->fill(0.0);
+        input_->process(*scratch_);
+
+        const core::AudioBuffer& key = sidechains[0];
+        const unsigned keyChannels = key.numChannels();
+        const unsigned keyFrames = std::min(key.numFrames(), frames);
+        const core::Sample* k = key.dataPtr();
+        const core::Sample* in = scratch_->dataPtr();
+        core::Sample* out = buffer.dataPtr();
+
+        for (unsigned f = 0; f < frames; ++f) {
+            // Peak across the key's channels for this frame (silence past the key's end).
+            float peak = 0.0f;
+            if (f < keyFrames) {
+                for (unsigned c = 0; c < keyChannels; ++c)
+                    peak = std::max(peak, std::abs(k[f * keyChannels + c]));
+            }
+            envelope_ = std::max(peak, envelope_ * releaseCoeff_);
+
+            const float gain = 1.0f - depth_ * std::min(envelope_ / threshold_, 1.0f);
+            for (unsigned c = 0; c < channels; ++c)
+                out[f * channels + c] += gain * in[f * channels + c];
+        }
+    }
+
+    bool Ducker::isFinished() const {
+        return !input_ || input_->isFinished();
+    }
+}
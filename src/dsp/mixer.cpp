@@ -3,50 +3,501 @@
 //
 
 #include <algorithm>
+#include <pipsqueak/core/kernels.hpp>
 #include <pipsqueak/dsp/mixer.hpp>
 
 namespace pipsqueak::dsp {
+    namespace {
+        // Flat multiply-accumulate of two identically shaped interleaved buffers.
+        void accumulate(const core::AudioBuffer& src, core::AudioBuffer& dst, const float gain) {
+            const size_t n = std::min(src.data().size(), dst.data().size());
+            core::kernels::active().mixAccumulate(dst.dataPtr(), src.dataPtr(), n, gain);
+        }
+
+        // Reallocates a scratch buffer only if its shape differs from the one requested.
+        void ensureShape(std::unique_ptr<core::AudioBuffer>& buffer, const unsigned channels, const unsigned frames) {
+            if (!buffer || buffer->numChannels() != channels || buffer->numFrames() != frames) {
+                buffer = std::make_unique<core::AudioBuffer>(channels, frames);
+            }
+        }
+    }
+
     Mixer::Mixer() {
-        // Initialize with a valid, empty list of sources to ensure thread safety from the start.
-        const auto initialSources = std::make_shared<const std::vector<std::shared_ptr<AudioSource>>>();
-        std::atomic_store(&activeSources_, initialSources);
+        // Initialize with a valid, empty state to ensure thread safety from the start.
+        auto initialState = std::make_shared<State>();
+        initialState->buffers = std::make_shared<Buffers>();
+        std::atomic_store(&state_, std::shared_ptr<const State>(std::move(initialState)));
+    }
+
+    template <typename Edit>
+    bool Mixer::update(Edit&& edit) {
+        // Builds the new state's render buffers here, on the control thread, for the last block
+        // shape the audio thread saw, so installing the state never allocates there.
+        const auto buildBuffers = [this](State& state) {
+            state.buffers = std::make_shared<Buffers>();
+            layoutBuffers(state, *state.buffers, pool_ != nullptr);
+            const std::uint64_t shape = blockShape_.load(std::memory_order_relaxed);
+            if (shape != 0)
+                shapeBuffers(state, *state.buffers, static_cast<unsigned>(shape >> 32), static_cast<unsigned>(shape));
+        };
+
+        if (bus_) {
+            // Stage on top of the newest posted state; the bus applies installs in posting order.
+            std::lock_guard lock(stageMutex_);
+            const auto base = staged_ ? staged_ : std::atomic_load(&state_);
+            auto next = std::make_shared<State>(*base);
+            if (!edit(*next) || !schedule(*next))
+                return false;
+            buildBuffers(*next);
+            next->version = base->version + 1;
+
+            core::Command command;
+            command.apply = &Mixer::installState;
+            command.retire = &Mixer::retireState;
+            command.target = this;
+            command.payload = new std::shared_ptr<const State>(next);
+            if (bus_->post(command) == 0) {
+                delete static_cast<std::shared_ptr<const State>*>(command.payload);
+                return false;
+            }
+            staged_ = std::move(next);
+            return true;
+        }
+
+        // Atomically get a snapshot of the current state.
+        auto current = std::atomic_load(&state_);
+        for (;;) {
+            // Create a new, mutable state by copying the current one and apply the edit to it.
+            auto next = std::make_shared<State>(*current);
+            if (!edit(*next) || !schedule(*next))
+                return false;
+            buildBuffers(*next);
+            next->version = current->version + 1;
+
+            // Atomically publish the new state, unless another writer got there first; in that
+            // case 'current' now holds their state and the edit is re-applied on top of it.
+            const std::shared_ptr<const State> finalState = std::move(next);
+            if (std::atomic_compare_exchange_weak(&state_, &current, finalState))
+                return true;
+        }
+    }
+
+    void Mixer::installState(core::Command& command) {
+        auto* mixer = static_cast<Mixer*>(command.target);
+        auto* staged = static_cast<std::shared_ptr<const State>*>(command.payload);
+        // The payload now carries the replaced state back to the control side.
+        *staged = std::atomic_exchange(&mixer->state_, std::shared_ptr<const State>(std::move(*staged)));
+    }
+
+    void Mixer::retireState(core::Command& command) {
+        delete static_cast<std::shared_ptr<const State>*>(command.payload);
+    }
+
+    void Mixer::setCommandBus(core::CommandBus* bus) {
+        std::lock_guard lock(stageMutex_);
+        bus_ = bus;
+        staged_.reset();
+    }
+
+    void Mixer::setEventSink(core::EventRing* events) {
+        events_ = events;
     }
 
-    void Mixer::addSource(std::shared_ptr<AudioSource> source) {
-        // Atomically get a snapshot of the current list of sources.
-        const auto currentSources = std::atomic_load(&activeSources_);
-        // Create a new, mutable list by copying the current one.
-        auto mutableSources = std::make_shared<std::vector<std::shared_ptr<AudioSource>>>(*currentSources);
-        // Add the new source to our private, mutable copy.
-        mutableSources->push_back(std::move(source));
-        // Create a final, read-only shared_ptr that matches the member variable's type.
-        const std::shared_ptr<const std::vector<std::shared_ptr<AudioSource>>> finalSources = mutableSources;
-        // Atomically swap the active pointer to make the new list live for the audio thread.
-        std::atomic_store(&activeSources_, finalSources);
+    std::uint64_t Mixer::version() const {
+        return std::atomic_load(&state_)->version;
     }
 
-    void Mixer::clearSources() {
-        // Create a new, completely empty list of sources.
-        const auto emptySources = std::make_shared<const std::vector<std::shared_ptr<AudioSource>>>();
-        // Atomically swap the active pointer to point to the new empty list.
-        std::atomic_store(&activeSources_, emptySources);
+    bool Mixer::addSource(std::shared_ptr<AudioSource> source) {
+        auto* node = dynamic_cast<SidechainSource*>(source.get());
+        return update([&](State& s) {
+            s.inputs.push_back({source, nullptr, 1.0f, {}, node, {}, -1});
+            return true;
+        });
+    }
+
+    bool Mixer::addSource(std::shared_ptr<AudioSource> source, ChannelMatrix matrix) {
+        auto shared = std::make_shared<const ChannelMatrix>(std::move(matrix));
+        auto* node = dynamic_cast<SidechainSource*>(source.get());
+        return update([&](State& s) {
+            s.inputs.push_back({source, shared, 1.0f, {}, node, {}, -1});
+            return true;
+        });
+    }
+
+    bool Mixer::clearSources() {
+        return update([](State& s) {
+            s.inputs.clear();
+            return true;
+        });
+    }
+
+    bool Mixer::addAuxBus(const std::string& name, std::vector<std::shared_ptr<AudioProcessor>> returnChain,
+                          const float returnLevel) {
+        return update([&](State& s) {
+            const auto it = std::find_if(s.buses.begin(), s.buses.end(),
+                                         [&](const AuxBus& b) { return b.name == name; });
+            if (it != s.buses.end()) {
+                it->returnChain = returnChain;
+                it->returnLevel = returnLevel;
+            } else {
+                s.buses.push_back({name, returnChain, returnLevel});
+            }
+            return true;
+        });
+    }
+
+    bool Mixer::setSourceGain(const std::shared_ptr<AudioSource>& source, const float gain) {
+        return update([&](State& s) {
+            const auto it = std::find_if(s.inputs.begin(), s.inputs.end(),
+                                         [&](const Input& in) { return in.source == source; });
+            if (it == s.inputs.end())
+                return false;
+            it->gain = gain;
+            return true;
+        });
+    }
+
+    bool Mixer::setSend(const std::shared_ptr<AudioSource>& source, const std::string& bus,
+                        const float level, const SendTiming timing) {
+        return update([&](State& s) {
+            const auto input = std::find_if(s.inputs.begin(), s.inputs.end(),
+                                            [&](const Input& in) { return in.source == source; });
+            const auto target = std::find_if(s.buses.begin(), s.buses.end(),
+                                             [&](const AuxBus& b) { return b.name == bus; });
+            if (input == s.inputs.end() || target == s.buses.end())
+                return false;
+
+            const auto busIndex = static_cast<size_t>(target - s.buses.begin());
+            auto& sends = input->sends;
+            sends.erase(std::remove_if(sends.begin(), sends.end(),
+                                       [&](const Send& send) { return send.bus == busIndex; }),
+                        sends.end());
+            if (level != 0.0f)
+                sends.push_back({busIndex, level, timing});
+            return true;
+        });
+    }
+
+    bool Mixer::setSidechains(const std::shared_ptr<AudioSource>& node,
+                              const std::vector<std::shared_ptr<AudioSource>>& keys) {
+        return update([&](State& s) {
+            const auto indexOf = [&](const std::shared_ptr<AudioSource>& source, size_t& index) {
+                const auto it = std::find_if(s.inputs.begin(), s.inputs.end(),
+                                             [&](const Input& in) { return in.source == source; });
+                index = static_cast<size_t>(it - s.inputs.begin());
+                return it != s.inputs.end();
+            };
+
+            size_t nodeIndex = 0;
+            if (!indexOf(node, nodeIndex) || !s.inputs[nodeIndex].sidechainNode)
+                return false;
+
+            std::vector<size_t> keyIndices;
+            keyIndices.reserve(keys.size());
+            for (const auto& key : keys) {
+                size_t keyIndex = 0;
+                if (!indexOf(key, keyIndex))
+                    return false;
+                keyIndices.push_back(keyIndex);
+            }
+
+            s.inputs[nodeIndex].sidechains = std::move(keyIndices);
+            return true;
+        });
+    }
+
+    bool Mixer::schedule(State& state) {
+        const size_t n = state.inputs.size();
+
+        // Assign a tap buffer to every input that some other input reads.
+        for (auto& input : state.inputs) input.tap = -1;
+        state.numTaps = 0;
+        for (const auto& input : state.inputs) {
+            for (const size_t key : input.sidechains) {
+                if (state.inputs[key].tap < 0)
+                    state.inputs[key].tap = static_cast<int>(state.numTaps++);
+            }
+        }
+
+        // Depth-first topological sort; insertion order is kept wherever dependencies allow.
+        enum class Mark { None, Visiting, Done };
+        std::vector<Mark> marks(n, Mark::None);
+        state.order.clear();
+        state.order.reserve(n);
+
+        const auto visit = [&](const auto& self, const size_t i) -> bool {
+            if (marks[i] == Mark::Done) return true;
+            if (marks[i] == Mark::Visiting) return false; // cycle
+            marks[i] = Mark::Visiting;
+            for (const size_t key : state.inputs[i].sidechains) {
+                if (!self(self, key)) return false;
+            }
+            marks[i] = Mark::Done;
+            state.order.push_back(i);
+            return true;
+        };
+
+        for (size_t i = 0; i < n; ++i) {
+            if (!visit(visit, i)) return false;
+        }
+
+        // Group inputs by dependency depth (keys are always in an earlier wave), keeping
+        // evaluation order within a wave.
+        std::vector<size_t> depth(n, 0);
+        size_t maxDepth = 0;
+        for (const size_t i : state.order) {
+            for (const size_t key : state.inputs[i].sidechains)
+                depth[i] = std::max(depth[i], depth[key] + 1);
+            maxDepth = std::max(maxDepth, depth[i]);
+        }
+        state.waves.clear();
+        state.waveEnds.clear();
+        for (size_t d = 0; n > 0 && d <= maxDepth; ++d) {
+            for (const size_t i : state.order) {
+                if (depth[i] == d) state.waves.push_back(i);
+            }
+            state.waveEnds.push_back(state.waves.size());
+        }
+        return true;
+    }
+
+    void Mixer::layoutBuffers(const State& state, Buffers& buffers, const bool perInput) {
+        const size_t numInputs = state.inputs.size();
+        buffers.perInput = perInput;
+        buffers.channels = 0;
+        buffers.frames = 0;
+        buffers.slotOf.assign(numInputs, -1);
+        buffers.slotWidth.clear();
+
+        const auto newSlot = [&](const unsigned width) {
+            buffers.slotWidth.push_back(width);
+            return static_cast<int>(buffers.slotWidth.size() - 1);
+        };
+        std::vector<std::pair<unsigned, int>> shared; // Default mode: width -> shared slot
+        for (size_t i = 0; i < numInputs; ++i) {
+            const auto& input = state.inputs[i];
+            const unsigned width = input.matrix ? input.matrix->sourceChannels() : 0;
+            if (perInput || input.tap >= 0) {
+                // Rendered in isolation, or read by other inputs later in the block
+                buffers.slotOf[i] = newSlot(width);
+            } else if (input.matrix || input.gain != 1.0f || !input.sends.empty()) {
+                // Rendered in its own layout, then faded and sent: one scratch per width is enough
+                const auto it = std::find_if(shared.begin(), shared.end(),
+                                             [&](const auto& entry) { return entry.first == width; });
+                buffers.slotOf[i] = it != shared.end() ? it->second : shared.emplace_back(width, newSlot(width)).second;
+            }
+        }
+
+        buffers.slots.clear();
+        buffers.slots.resize(buffers.slotWidth.size());
+        buffers.aux.clear();
+        buffers.aux.resize(state.buses.size());
+        buffers.views.resize(numInputs);
+        for (size_t i = 0; i < numInputs; ++i)
+            buffers.views[i].assign(state.inputs[i].sidechains.size(), nullptr);
+        buffers.finished.assign(numInputs, 0);
+        buffers.captures.resize(perInput ? numInputs : 0);
+    }
+
+    void Mixer::shapeBuffers(const State& state, Buffers& buffers, const unsigned channels, const unsigned frames) {
+        for (size_t slot = 0; slot < buffers.slots.size(); ++slot) {
+            const unsigned width = buffers.slotWidth[slot];
+            ensureShape(buffers.slots[slot], width > 0 ? width : channels, frames);
+        }
+        for (auto& aux : buffers.aux)
+            ensureShape(aux, channels, frames);
+        for (size_t i = 0; i < state.inputs.size(); ++i) {
+            const auto& keys = state.inputs[i].sidechains;
+            for (size_t k = 0; k < keys.size(); ++k)
+                buffers.views[i][k] = buffers.slots[buffers.slotOf[keys[k]]].get();
+        }
+        buffers.channels = channels;
+        buffers.frames = frames;
+    }
+
+    Mixer::Buffers& Mixer::buffersFor(const State& state, const unsigned channels, const unsigned frames) {
+        auto& buffers = *state.buffers;
+        const bool perInput = pool_ != nullptr;
+        if (buffers.channels == channels && buffers.frames == frames && buffers.perInput == perInput)
+            return buffers;
+
+        // First block, a new block shape or a new render mode: the only time this thread allocates.
+        if (buffers.perInput != perInput)
+            layoutBuffers(state, buffers, perInput);
+        shapeBuffers(state, buffers, channels, frames);
+        blockShape_.store(static_cast<std::uint64_t>(channels) << 32 | frames, std::memory_order_relaxed);
+        return buffers;
     }
 
     bool Mixer::isFinished() const {
-        // Atomically get the current list of sources.
-        const auto currentSources = std::atomic_load(&activeSources_);
+        // Atomically get the current state.
+        const auto current = std::atomic_load(&state_);
         // A mixer is considered finished if and only if all of its sources are finished.
-        return std::all_of(currentSources->begin(), currentSources->end(),
-                           [](const auto& source) { return source->isFinished(); });
+        return std::all_of(current->inputs.begin(), current->inputs.end(),
+                           [](const Input& input) { return input.source->isFinished(); });
+    }
+
+    void Mixer::setRenderPool(std::shared_ptr<core::ForkJoinPool> pool) {
+        pool_ = std::move(pool);
     }
 
     void Mixer::process(core::AudioBuffer& buffer) {
-        // Atomically get the list of sources to process for this specific audio block.
-        const auto sourcesToProcess = std::atomic_load(&activeSources_);
+        // Atomically get the state to process for this specific audio block.
+        const auto state = std::atomic_load(&state_);
+        if (pool_) {
+            processDeterministic(*state, buffer);
+            return;
+        }
 
-        // Process each source, mixing (adding) its output into the provided buffer.
-        for (const auto& source : *sourcesToProcess) {
-            source->process(buffer);
+        const unsigned frames = buffer.numFrames();
+        auto& buffers = buffersFor(*state, buffer.numChannels(), frames);
+
+        // Silence the aux bus accumulators.
+        for (auto& aux : buffers.aux)
+            aux->fill(0.0);
+
+        // Process each source in dependency order, mixing (adding) its output into the provided buffer.
+        for (const size_t index : state->order) {
+            const auto& input = state->inputs[index];
+
+            // Read-only views of this input's keys (already rendered this block).
+            const auto& views = buffers.views[index];
+            const SidechainInputs sidechains(views.data(), views.size());
+
+            const auto render = [&](core::AudioBuffer& dst) {
+                if (input.sidechainNode) input.sidechainNode->process(dst, sidechains);
+                else input.source->process(dst);
+
+                // Report the playing -> finished transition once, unless the source reports it itself.
+                if (events_ && !input.source->postsOwnEvents()) {
+                    const bool finished = input.source->isFinished();
+                    if (finished && *input.playing)
+                        events_->post(core::EventType::SourceFinished, input.source.get(), frames);
+                    *input.playing = !finished;
+                }
+            };
+
+            // Fast path: unity gain, no sends, output layout, not a key -> render straight into the output.
+            const int slot = buffers.slotOf[index];
+            if (slot < 0) {
+                render(buffer);
+                continue;
+            }
+
+            // Otherwise render into its slot in the source's own layout (a key's slot stays valid
+            // for the rest of the block)...
+            core::AudioBuffer& local = *buffers.slots[slot];
+            local.fill(0.0);
+            render(local);
+
+            // ...then fan it out to the output (post-fader) and to each send.
+            const auto mixInto = [&](core::AudioBuffer& dst, const float gain) {
+                if (input.matrix) input.matrix->accumulate(local, dst, gain);
+                else accumulate(local, dst, gain);
+            };
+
+            mixInto(buffer, input.gain);
+            for (const auto& send : input.sends) {
+                if (send.bus >= buffers.aux.size())
+                    continue;
+                const float level = send.timing == SendTiming::PreFader ? send.level : send.level * input.gain;
+                mixInto(*buffers.aux[send.bus], level);
+            }
+        }
+
+        // Run each return chain once on its accumulated bus, then sum it back.
+        for (size_t b = 0; b < state->buses.size(); ++b) {
+            auto& aux = *buffers.aux[b];
+            for (const auto& processor : state->buses[b].returnChain) {
+                processor->process(aux);
+            }
+            accumulate(aux, buffer, state->buses[b].returnLevel);
+        }
+    }
+
+    void Mixer::processDeterministic(const State& state, core::AudioBuffer& buffer) {
+        const unsigned outCh = buffer.numChannels();
+        const unsigned frames = buffer.numFrames();
+        const size_t numBuses = state.buses.size();
+        auto& buffers = buffersFor(state, outCh, frames);
+        for (auto& aux : buffers.aux)
+            aux->fill(0.0);
+
+        // 1. Render each input into its own silent buffer, one dependency wave at a time. No
+        //    input's result depends on which thread ran it or on what ran beside it.
+        size_t waveBegin = 0;
+        for (const size_t waveEnd : state.waveEnds) {
+            pool_->parallelFor(waveEnd - waveBegin, [&](const size_t k) {
+                const size_t index = state.waves[waveBegin + k];
+                const auto& input = state.inputs[index];
+                core::AudioBuffer& local = *buffers.slots[buffers.slotOf[index]];
+                local.fill(0.0);
+                const core::EventCapture::Scope capture(buffers.captures[index]);
+                if (input.sidechainNode) {
+                    const auto& views = buffers.views[index];
+                    input.sidechainNode->process(local, SidechainInputs(views.data(), views.size()));
+                } else {
+                    input.source->process(local);
+                }
+                if (events_ && !input.source->postsOwnEvents())
+                    buffers.finished[index] = input.source->isFinished();
+            });
+            waveBegin = waveEnd;
         }
+
+        // Forward the sources' own events and report playing -> finished transitions from this
+        // thread, in evaluation order, as the default mode would have posted them.
+        for (const size_t index : state.order) {
+            const auto& input = state.inputs[index];
+            buffers.captures[index].forward();
+            if (!events_ || input.source->postsOwnEvents())
+                continue;
+            if (buffers.finished[index] && *input.playing)
+                events_->post(core::EventType::SourceFinished, input.source.get(), frames);
+            *input.playing = !buffers.finished[index];
+        }
+
+        // 2. Sum into the output and the aux buses over fixed frame ranges. Each sample is added
+        //    up in evaluation order whatever the range or thread, so the split changes nothing.
+        constexpr unsigned kRangeFrames = 256;
+        const size_t ranges = (frames + kRangeFrames - 1) / kRangeFrames;
+        const auto mixRange = [&](const core::AudioBuffer& src, core::AudioBuffer& dst, const ChannelMatrix* matrix,
+                                  const unsigned first, const unsigned count, const float gain) {
+            const unsigned srcCh = src.numChannels();
+            const core::Sample* in = src.dataPtr() + static_cast<size_t>(first) * srcCh;
+            core::Sample* out = dst.dataPtr() + static_cast<size_t>(first) * outCh;
+            if (matrix) matrix->accumulate(in, out, count, gain);
+            else core::kernels::active().mixAccumulate(out, in, static_cast<size_t>(count) * outCh, gain);
+        };
+
+        pool_->parallelFor(ranges, [&](const size_t r) {
+            const auto first = static_cast<unsigned>(r * kRangeFrames);
+            const unsigned count = std::min(kRangeFrames, frames - first);
+            for (const size_t index : state.order) {
+                const auto& input = state.inputs[index];
+                const auto& local = *buffers.slots[buffers.slotOf[index]];
+                mixRange(local, buffer, input.matrix.get(), first, count, input.gain);
+                for (const auto& send : input.sends) {
+                    if (send.bus >= numBuses)
+                        continue;
+                    const float level = send.timing == SendTiming::PreFader ? send.level : send.level * input.gain;
+                    mixRange(local, *buffers.aux[send.bus], input.matrix.get(), first, count, level);
+                }
+            }
+        });
+
+        // 3. Run the return chains (each bus on one thread), then sum them back in bus order.
+        if (numBuses == 0)
+            return;
+        pool_->parallelFor(numBuses, [&](const size_t b) {
+            for (const auto& processor : state.buses[b].returnChain)
+                processor->process(*buffers.aux[b]);
+        });
+        pool_->parallelFor(ranges, [&](const size_t r) {
+            const auto first = static_cast<unsigned>(r * kRangeFrames);
+            const unsigned count = std::min(kRangeFrames, frames - first);
+            for (size_t b = 0; b < numBuses; ++b)
+                mixRange(*buffers.aux[b], buffer, nullptr, first, count, state.buses[b].returnLevel);
+        });
     }
-}
\ No newline at end of file
+}
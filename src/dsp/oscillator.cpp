@@ -0,0 +1,62 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <cmath>
+#include <pipsqueak/dsp/oscillator.hpp>
+
+namespace pipsqueak::dsp {
+    namespace {
+        constexpr double kTwoPi = 6.28318530717958647692;
+
+        // One sample of the waveform at a phase in cycles, [0, 1).
+        float shape(const Waveform waveform, const double phase) {
+            switch (waveform) {
+                case Waveform::Sine: return static_cast<float>(std::sin(kTwoPi * phase));
+                case Waveform::Saw: return static_cast<float>(2.0 * phase - 1.0);
+                case Waveform::Square: return phase < 0.5 ? 1.0f : -1.0f;
+                case Waveform::Triangle: return static_cast<float>(1.0 - 4.0 * std::abs(phase - 0.5));
+            }
+            return 0.0f;
+        }
+    }
+
+    Oscillator::Oscillator(const Waveform waveform, const double frequency, const double sampleRate,
+                           const float amplitude)
+        : waveform_(waveform), sampleRate_(sampleRate), amplitude_(amplitude) {
+        setFrequency(frequency);
+    }
+
+    void Oscillator::setFrequency(const double frequency) {
+        increment_ = sampleRate_ > 0.0 ? frequency / sampleRate_ : 0.0;
+    }
+
+    void Oscillator::setAmplitude(const float amplitude) {
+        amplitude_ = amplitude;
+    }
+
+    void Oscillator::setRunning(const bool running) {
+        running_ = running;
+    }
+
+    void Oscillator::process(core::AudioBuffer& buffer) {
+        if (!running_)
+            return;
+
+        const unsigned channels = buffer.numChannels();
+        const size_t frames = buffer.numFrames();
+        core::Sample* out = buffer.dataPtr();
+
+        for (size_t f = 0; f < frames; ++f) {
+            const float s = amplitude_ * shape(waveform_, phase_);
+            for (unsigned c = 0; c < channels; ++c) out[f * channels + c] += s;
+
+            phase_ += increment_;
+            phase_ -= std::floor(phase_);
+        }
+    }
+
+    bool Oscillator::isFinished() const {
+        return !running_;
+    }
+}
@@ -0,0 +1,211 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <pipsqueak/dsp/panner.hpp>
+
+namespace pipsqueak::dsp {
+    namespace {
+        constexpr double kPi = 3.14159265358979323846;
+        constexpr double kDegToRad = kPi / 180.0;
+
+        // Wraps an angle to [0, 2pi).
+        double wrap(double radians) {
+            radians = std::fmod(radians, 2.0 * kPi);
+            return radians < 0.0 ? radians + 2.0 * kPi : radians;
+        }
+    }
+
+    Panner::Panner(std::shared_ptr<AudioSource> input, const PanningMode mode, std::vector<double> speakerAzimuths)
+        : input_(std::move(input)), mode_(mode), direction_(packDirection(0.0f, 0.0f)) {
+        switch (mode_) {
+            case PanningMode::Ambisonic1: channels_ = 4; break;
+            case PanningMode::Ambisonic3: channels_ = 16; break;
+            case PanningMode::Vbap:
+                channels_ = static_cast<unsigned>(speakerAzimuths.size());
+                ring_.reserve(channels_);
+                for (unsigned c = 0; c < channels_; ++c)
+                    ring_.push_back({wrap(speakerAzimuths[c] * kDegToRad), c});
+                std::sort(ring_.begin(), ring_.end(),
+                          [](const Speaker& a, const Speaker& b) { return a.azimuth < b.azimuth; });
+                break;
+        }
+
+        // Start settled at the initial direction so the first block does not ramp in.
+        current_.assign(channels_, 0.0f);
+        target_.assign(channels_, 0.0f);
+        activeChannels_.reserve(channels_);
+        computeGains(0.0, 0.0, current_.data());
+        target_ = current_;
+        appliedDirection_ = direction_.load(std::memory_order_relaxed);
+    }
+
+    void Panner::setDirection(const double azimuthDegrees, const double elevationDegrees) {
+        direction_.store(packDirection(static_cast<float>(azimuthDegrees), static_cast<float>(elevationDegrees)),
+                         std::memory_order_release);
+    }
+
+    unsigned Panner::outputChannels() const noexcept {
+        return channels_;
+    }
+
+    bool Panner::isFinished() const {
+        return !input_ || input_->isFinished();
+    }
+
+    std::vector<float> Panner::gainsFor(const double azimuthDegrees, const double elevationDegrees) const {
+        std::vector<float> gains(channels_, 0.0f);
+        computeGains(azimuthDegrees, elevationDegrees, gains.data());
+        return gains;
+    }
+
+    void Panner::computeGains(const double azimuthDegrees, const double elevationDegrees, float* out) const {
+        std::fill(out, out + channels_, 0.0f);
+        if (channels_ == 0)
+            return;
+
+        if (mode_ == PanningMode::Vbap) {
+            const double az = wrap(azimuthDegrees * kDegToRad);
+            if (ring_.size() == 1) {
+                out[ring_[0].channel] = 1.0f;
+                return;
+            }
+
+            // Find the adjacent speaker pair enclosing the source (wrapping past the last speaker).
+            size_t hi = 0;
+            while (hi < ring_.size() && ring_[hi].azimuth < az) ++hi;
+            const Speaker& a = ring_[(hi + ring_.size() - 1) % ring_.size()];
+            const Speaker& b = ring_[hi % ring_.size()];
+
+            // Solve p = g1*l1 + g2*l2 for the 2x2 speaker base, then normalise to constant power.
+            const double px = std::cos(az), py = std::sin(az);
+            const double ax = std::cos(a.azimuth), ay = std::sin(a.azimuth);
+            const double bx = std::cos(b.azimuth), by = std::sin(b.azimuth);
+            const double det = ax * by - ay * bx;
+
+            double g1 = 1.0, g2 = 0.0;
+            if (std::abs(det) > 1e-9) {
+                g1 = (px * by - py * bx) / det;
+                g2 = (ax * py - ay * px) / det;
+            }
+            g1 = std::max(g1, 0.0);
+            g2 = std::max(g2, 0.0);
+            const double norm = std::sqrt(g1 * g1 + g2 * g2);
+            if (norm > 0.0) { g1 /= norm; g2 /= norm; }
+
+            out[a.channel] += static_cast<float>(g1);
+            out[b.channel] += static_cast<float>(g2);
+            return;
+        }
+
+        // ---- Ambisonic encoding: real spherical harmonics, ACN order, SN3D normalisation ----
+        const double az = azimuthDegrees * kDegToRad;
+        const double el = elevationDegrees * kDegToRad;
+        const double x = std::cos(el) * std::cos(az);
+        const double y = std::cos(el) * std::sin(az);
+        const double z = std::sin(el);
+
+        double sh[16];
+        sh[0] = 1.0;
+        sh[1] = y;
+        sh[2] = z;
+        sh[3] = x;
+        if (channels_ > 4) {
+            const double s3 = std::sqrt(3.0);
+            sh[4] = s3 * x * y;
+            sh[5] = s3 * y * z;
+            sh[6] = 0.5 * (3.0 * z * z - 1.0);
+            sh[7] = s3 * x * z;
+            sh[8] = 0.5 * s3 * (x * x - y * y);
+            sh[9] = std::sqrt(5.0 / 8.0) * y * (3.0 * x * x - y * y);
+            sh[10] = std::sqrt(15.0) * x * y * z;
+            sh[11] = std::sqrt(3.0 / 8.0) * y * (5.0 * z * z - 1.0);
+            sh[12] = 0.5 * z * (5.0 * z * z - 3.0);
+            sh[13] = std::sqrt(3.0 / 8.0) * x * (5.0 * z * z - 1.0);
+            sh[14] = 0.5 * std::sqrt(15.0) * z * (x * x - y * y);
+            sh[15] = std::sqrt(5.0 / 8.0) * x * (x * x - 3.0 * y * y);
+        }
+
+        for (unsigned c = 0; c < channels_; ++c)
+            out[c] = static_cast<float>(sh[c]);
+    }
+
+    void Panner::process(core::AudioBuffer& buffer) {
+        if (!input_ || channels_ == 0)
+            return;
+
+        const unsigned outCh = buffer.numChannels();
+        const size_t frames = buffer.numFrames();
+        if (outCh == 0 || frames == 0)
+            return;
+
+        // ---- Render the input in mono ----
+        if (!scratch_ || scratch_->numFrames() != frames) {
+            scratch_ = std::make_unique<core::AudioBuffer>(1, static_cast<unsigned>(frames));
+        }
+        scratch_->fill(0.0);
+        input_->process(*scratch_);
+
+        // ---- Block-rate gain update (only when the direction moved) ----
+        if (const auto packed = direction_.load(std::memory_order_acquire); packed != appliedDirection_) {
+            float az, el;
+            unpackDirection(packed, az, el);
+            computeGains(az, el, target_.data());
+            appliedDirection_ = packed;
+        }
+
+        // Channels that are silent at both ends of the ramp are skipped entirely.
+        const unsigned usable = std::min(outCh, channels_);
+        activeChannels_.clear();
+        for (unsigned c = 0; c < usable; ++c) {
+            if (current_[c] != 0.0f || target_[c] != 0.0f)
+                activeChannels_.push_back(c);
+        }
+
+        const core::Sample* x = scratch_->dataPtr();
+        core::Sample* out = buffer.dataPtr();
+        const float invFrames = 1.0f / static_cast<float>(frames);
+
+        if (activeChannels_.size() == usable) {
+            // Dense (ambisonic) case: contiguous channel run per frame, vectorises across channels.
+            for (size_t f = 0; f < frames; ++f) {
+                const float t = static_cast<float>(f + 1) * invFrames;
+                core::Sample* o = out + f * outCh;
+                const float s = x[f];
+                for (unsigned c = 0; c < usable; ++c) {
+                    const float g = current_[c] + (target_[c] - current_[c]) * t;
+                    o[c] += s * g;
+                }
+            }
+        } else {
+            // Sparse (VBAP) case: one strided pass per contributing speaker.
+            for (const unsigned c : activeChannels_) {
+                const float g0 = current_[c];
+                const float dg = (target_[c] - g0) * invFrames;
+                core::Sample* o = out + c;
+                for (size_t f = 0; f < frames; ++f) {
+                    o[f * outCh] += x[f] * (g0 + dg * static_cast<float>(f + 1));
+                }
+            }
+        }
+
+        std::copy(target_.begin(), target_.end(), current_.begin());
+    }
+
+    std::uint64_t Panner::packDirection(const float azimuth, const float elevation) noexcept {
+        std::uint32_t a, e;
+        std::memcpy(&a, &azimuth, sizeof(a));
+        std::memcpy(&e, &elevation, sizeof(e));
+        return (static_cast<std::uint64_t>(a) << 32) | e;
+    }
+
+    void Panner::unpackDirection(const std::uint64_t packed, float& azimuth, float& elevation) noexcept {
+        const auto a = static_cast<std::uint32_t>(packed >> 32);
+        const auto e = static_cast<std::uint32_t>(packed & 0xffffffffu);
+        std::memcpy(&azimuth, &a, sizeof(a));
+        std::memcpy(&elevation, &e, sizeof(e));
+    }
+}
@@ -40,14 +40,46 @@ namespace pipsqueak::dsp {
         tuneCents_ = cents;
     }
 
+    void Sampler::setPlaybackMode(const PlaybackMode mode, const double stretchRatio,
+                                  std::shared_ptr<const core::TransientMap> transients) {
+        for (auto& v : voices_) {
+            v.setPlaybackMode(mode, stretchRatio, transients);
+        }
+    }
+
     void Sampler::process(core::AudioBuffer& buffer) {
         // Render each active voice into the buffer
         const auto n = static_cast<size_t>(buffer.numFrames());
+        bool playing = false;
+        size_t endOffset = 0; // Frame within the block where the last voice ran out
         for (auto& v : voices_) {
             if (!v.finished()) {
-                v.render(buffer, n);
+                playing = true;
+                const size_t rendered = v.render(buffer, n);
+                if (v.finished())
+                    endOffset = std::max(endOffset, rendered);
             }
         }
+
+        if (events_ && playing && isFinished())
+            events_->post(core::EventType::SourceFinished, this, static_cast<std::uint32_t>(endOffset));
+    }
+
+    void Sampler::setMetadata(std::shared_ptr<const core::SampleMetadata> metadata, const bool skipLeadingSilence) {
+        metadata_ = std::move(metadata);
+        startFrame_ = metadata_ && skipLeadingSilence ? metadata_->leadingSilence : 0;
+    }
+
+    const core::SampleMetadata* Sampler::metadata() const noexcept {
+        return metadata_.get();
+    }
+
+    void Sampler::setEventSink(core::EventRing* events) {
+        events_ = events;
+    }
+
+    bool Sampler::postsOwnEvents() const {
+        return events_ != nullptr;
     }
 
     bool Sampler::isFinished() const {
@@ -61,7 +93,7 @@ namespace pipsqueak::dsp {
         // Find a free voice first
         for (auto& v : voices_) {
             if (v.finished()) {
-                v.start(note, velocity, rootNote_, tuneCents_);
+                v.start(note, velocity, rootNote_, tuneCents_, startFrame_);
                 return;
             }
         }
@@ -69,7 +101,9 @@ namespace pipsqueak::dsp {
         // Simple voice-steal policy for step 1: reuse voice 0
         // (When you add polyphony >1, consider oldest/quietest steal.)
         if (!voices_.empty()) {
-            voices_[0].start(note, velocity, rootNote_, tuneCents_);
+            if (events_)
+                events_->post(core::EventType::VoiceStolen, this, 0, 0);
+            voices_[0].start(note, velocity, rootNote_, tuneCents_, startFrame_);
         }
     }
 
@@ -3,10 +3,30 @@
 //
 
 #include <algorithm>
+#include <cmath>
 #include <pipsqueak/dsp/sampler_voice.hpp>
 #include <pipsqueak/core/channel_view.hpp>
+#include <pipsqueak/core/kernels.hpp>
 
 namespace pipsqueak::dsp {
+    namespace {
+        constexpr double kTwoPi = 6.28318530717958647692;
+
+        // Grain lengths (output frames) picked from the sample's transient analysis.
+        constexpr size_t kTonalGrainSize = 2048;
+        constexpr size_t kDefaultGrainSize = 1024;
+        constexpr size_t kPercussiveGrainSize = 512;
+
+        // Similarity search: number of compared points and coarse candidate stride.
+        constexpr size_t kCompareLength = 128;
+        constexpr size_t kCoarseStride = 8;
+
+        // Periodic Hann window; two of these at 50% overlap sum to exactly 1.
+        double hann(const size_t n, const size_t size) {
+            return 0.5 - 0.5 * std::cos(kTwoPi * static_cast<double>(n) / static_cast<double>(size));
+        }
+    }
+
     void SamplerVoice::configure(std::shared_ptr<const core::AudioBuffer> sample, double nativeRate, double engineRate) {
         sample_     = std::move(sample);
         nativeRate_ = nativeRate;
@@ -21,9 +41,29 @@ namespace pipsqueak::dsp {
             numFrames_   = 0;
             lastIndex_   = 0;
         }
+
+        // Rebuild the mix on the next render only if the source layout changed, so rate
+        // changes applied on the audio thread do not free the matrix.
+        if (matrix_ && matrix_->sourceChannels() != srcChannels_)
+            matrix_.reset();
     }
 
-    void SamplerVoice::start(const int note, const float velocity, const int rootNote, const double tuneCents) {
+    void SamplerVoice::setPlaybackMode(const PlaybackMode mode, const double stretchRatio,
+                                       std::shared_ptr<const core::TransientMap> transients) {
+        mode_ = mode;
+        stretchRatio_ = stretchRatio > 0.0 ? stretchRatio : 1.0;
+        transients_ = std::move(transients);
+
+        // Longer grains resolve pitch better on sustained material; short grains smear attacks less.
+        if (!transients_) {
+            grainSize_ = kDefaultGrainSize;
+        } else {
+            grainSize_ = transients_->tonal ? kTonalGrainSize : kPercussiveGrainSize;
+        }
+    }
+
+    void SamplerVoice::start(const int note, const float velocity, const int rootNote, const double tuneCents,
+                             const size_t startFrame) {
         // Check sample and values are valid
         if (!sample_ || numFrames_ < 2 || nativeRate_ <= 0.0 || engineRate_ <= 0.0) {
             active_ = false;
@@ -34,82 +74,250 @@ namespace pipsqueak::dsp {
         const double pitchScale = std::pow(2.0, semis / 12.0) * std::pow(2.0, tuneCents / 1200.0);
 
         step_ = (nativeRate_ / engineRate_) * pitchScale;
-        phase_ = 0.0;
+        // Start no later than the last frame so the voice still plays out normally.
+        const size_t first = std::min(startFrame, lastIndex_);
+        phase_ = static_cast<double>(first);
+
+        if (mode_ == PlaybackMode::TimeStretch) {
+            // Duration follows the stretch ratio only; pitch lives entirely in step_.
+            analysisStep_ = (nativeRate_ / engineRate_) / stretchRatio_;
+
+            // The first grain starts at its window peak so the attack is not faded in; the
+            // second grain is spawned on the first rendered frame and fades in underneath it.
+            const size_t hop = grainSize_ / 2;
+            grains_[0] = Grain{phase_, hop, true};
+            grains_[1] = Grain{};
+            nextGrain_ = 1;
+            sinceSpawn_ = hop;
+            onsetFloor_ = first + 1; // An onset at the first frame is the note start itself
+        }
 
         // Simple velocity to gain mapping for now (linear 0..1)
         gain_ = std::clamp(velocity, 0.0f, 1.0f);
         active_ = (step_ > 0.0);
     }
 
-    void SamplerVoice::render(core::AudioBuffer& out, size_t framesToRender) {
+    size_t SamplerVoice::render(core::AudioBuffer& out, size_t framesToRender) {
         // Bail out early if the voice isn't active, there's no sample, or there's nothing to render.
         if (!active_ || !sample_ || framesToRender == 0)
-            return;
+            return 0;
 
         // Query output channel count. If either output or source has 0 channels, stop this voice.
         const unsigned outCh = out.numChannels();
         if (outCh == 0 || srcChannels_ == 0) {
             active_ = false;
-            return;
+            return 0;
         }
 
-        // ---- Gather per-channel spans (views) once for this call ----
-        // Build a list of source-channel spans up to the number we can actually copy.
-        std::vector<decltype(sample_->channel(0).raw())> srcSpans;
-        const unsigned nCopy = std::min(outCh, srcChannels_);
-        srcSpans.reserve(nCopy);
-        for (unsigned c = 0; c < nCopy; ++c)
-            srcSpans.push_back(sample_->channel(c).raw());
-
-        // Build output-channel spans (we may have more outs than source channels).
-        std::vector<decltype(out.channel(0).raw())> outSpans;
-        outSpans.reserve(outCh);
-        for (unsigned c = 0; c < outCh; ++c)
-            outSpans.push_back(out.channel(c).raw());
-
-        // If the source is mono, we'll duplicate the same interpolated value to all output channels.
-        const bool monoSrc = (srcChannels_ == 1);
-        const auto monoSpan = monoSrc ? sample_->channel(0).raw()
-                                      : decltype(sample_->channel(0).raw()){}; // empty if not mono
-
-        // ---- Per-frame render loop ----
-        for (size_t f = 0; f < framesToRender; ++f) {
-            const auto i = static_cast<size_t>(phase_);
-            if (i > lastIndex_) { active_ = false; break; }
-
-            const double frac = phase_ - static_cast<double>(i);
-
-            if (monoSrc) {
-                core::Sample s;
-                if (i == lastIndex_) {
-                    s = monoSpan.at(i);
-                } else {
-                    const core::Sample x0 = monoSpan.at(i);
-                    const core::Sample x1 = monoSpan.at(i + 1);
-                    s = static_cast<core::Sample>(x0 + (x1 - x0) * frac);
-                }
-                for (unsigned c = 0; c < outCh; ++c) outSpans[c].at(f) += gain_ * s;
-            } else {
-                for (unsigned c = 0; c < nCopy; ++c) {
-                    core::Sample s;
-                    if (i == lastIndex_) {
-                        s = srcSpans[c].at(i);
-                    } else {
-                        const core::Sample x0 = srcSpans[c].at(i);
-                        const core::Sample x1 = srcSpans[c].at(i + 1);
-                        s = static_cast<core::Sample>(x0 + (x1 - x0) * frac);
+        framesToRender = std::min(framesToRender, static_cast<size_t>(out.numFrames()));
+
+        // Rebuild the up/down-mix only when the output shape changes (normally once). A device
+        // wider than stereo says nothing about its speakers (an 8-output interface is not 7.1),
+        // so such outputs are routed as discrete channels.
+        if (!matrix_ || matrix_->destinationChannels() != outCh) {
+            const ChannelLayout output = outCh <= 2 ? ChannelLayout::fromChannelCount(outCh)
+                                                    : ChannelLayout::discrete(outCh);
+            matrix_.emplace(ChannelLayout::fromChannelCount(srcChannels_), output);
+            route_ = classifyRoute();
+        }
+
+        // Common channel pairs skip the scratch block entirely (dispatched once per block).
+        if (mode_ == PlaybackMode::Resample && route_) {
+            return renderDirect(out, framesToRender);
+        }
+
+        // Grow-only scratch block holding the interpolated source frames for this call.
+        const size_t needed = framesToRender * srcChannels_;
+        if (block_.size() < needed)
+            block_.resize(needed);
+
+        // Render source-layout frames, then route them to the output layout in one pass.
+        const size_t rendered = (mode_ == PlaybackMode::TimeStretch)
+                                    ? renderStretched(framesToRender)
+                                    : renderResampled(framesToRender);
+
+        matrix_->accumulate(block_.data(), out.dataPtr(), rendered, gain_);
+        return rendered;
+    }
+
+    std::optional<core::kernels::MixRoute> SamplerVoice::classifyRoute() const {
+        using core::kernels::MixRoute;
+        const unsigned S = matrix_->sourceChannels();
+        const unsigned D = matrix_->destinationChannels();
+
+        // The fused kernels hard-code unit routing, so only take them when the matrix agrees.
+        const auto routesAsIdentity = [&](const unsigned channels) {
+            for (unsigned d = 0; d < D; ++d)
+                for (unsigned s = 0; s < S; ++s)
+                    if (matrix_->coefficient(d, s) != (d == s && d < channels ? 1.0f : 0.0f)) return false;
+            return true;
+        };
+
+        if (S == 1 && D == 1) return MixRoute::MonoToMono;
+        if (S == 1 && D == 2 && matrix_->coefficient(0, 0) == 1.0f && matrix_->coefficient(1, 0) == 1.0f)
+            return MixRoute::MonoToPair;
+        if (S == 2 && D == 2 && routesAsIdentity(2)) return MixRoute::PairToPair;
+        if (S == 2 && D > 2 && routesAsIdentity(2)) return MixRoute::PairToMany;
+        return std::nullopt;
+    }
+
+    size_t SamplerVoice::renderDirect(core::AudioBuffer& out, const size_t framesToRender) {
+        const size_t rendered = core::kernels::active().interpolateMix(
+            sample_->dataPtr(), *route_, lastIndex_, phase_, step_, gain_, out.dataPtr(), out.numChannels(),
+            framesToRender);
+
+        // Ran out of source, or advanced past the end (or exactly to it): the voice is finished.
+        if (rendered < framesToRender || phase_ >= static_cast<double>(lastIndex_))
+            active_ = false;
+
+        return rendered;
+    }
+
+    size_t SamplerVoice::renderResampled(const size_t framesToRender) {
+        // Interpolate as many frames as the source still has into the scratch block.
+        const size_t rendered = core::kernels::active().interpolate(
+            sample_->dataPtr(), srcChannels_, lastIndex_, phase_, step_, block_.data(), framesToRender);
+
+        // Ran out of source, or advanced past the end (or exactly to it): the voice is finished.
+        if (rendered < framesToRender || phase_ >= static_cast<double>(lastIndex_))
+            active_ = false;
+
+        return rendered;
+    }
+
+    size_t SamplerVoice::renderStretched(const size_t framesToRender) {
+        const size_t hop = grainSize_ / 2;
+        const core::Sample* src = sample_->dataPtr();
+
+        size_t f = 0;
+        for (; f < framesToRender; ++f) {
+            // ---- Grain scheduling: one new grain per hop ----
+            if (sinceSpawn_ >= hop) {
+                const Grain& older = grains_[nextGrain_ ^ 1u];
+                const double continuation = older.live ? older.position : phase_;
+                spawnGrain(grains_[nextGrain_], continuation);
+                nextGrain_ ^= 1u;
+                sinceSpawn_ = 0;
+            }
+
+            // ---- Overlap-add of the live grains into this frame ----
+            core::Sample* frame = block_.data() + f * srcChannels_;
+            std::fill(frame, frame + srcChannels_, 0.0f);
+            bool anyLive = false;
+            for (auto& g : grains_) {
+                if (!g.live)
+                    continue;
+                anyLive = true;
+
+                const auto w = static_cast<core::Sample>(hann(g.age, grainSize_));
+                const auto i = static_cast<size_t>(g.position);
+                if (i <= lastIndex_) {
+                    const double frac = g.position - static_cast<double>(i);
+                    const size_t j = (i == lastIndex_) ? i : i + 1;
+                    for (unsigned c = 0; c < srcChannels_; ++c) {
+                        const core::Sample x0 = src[i * srcChannels_ + c];
+                        const core::Sample x1 = src[j * srcChannels_ + c];
+                        frame[c] += w * static_cast<core::Sample>(x0 + (x1 - x0) * frac);
                     }
-                    outSpans[c].at(f) += gain_ * s;
                 }
+
+                g.position += step_;
+                if (++g.age >= grainSize_)
+                    g.live = false;
             }
 
-            phase_ += step_;
+            if (!anyLive) {
+                active_ = false;
+                break;
+            }
+
+            phase_ += analysisStep_;
+            ++sinceSpawn_;
         }
 
+        return f;
+    }
 
-        // If we've advanced past the end (or exactly to it), the voice is finished.
-        if (phase_ >= static_cast<double>(lastIndex_))
-            active_ = false;
+    void SamplerVoice::spawnGrain(Grain& grain, const double continuation) {
+        const double nominal = phase_;
+
+        // Past the end of the source: let the remaining grain fade out without a successor.
+        if (nominal > static_cast<double>(lastIndex_)) {
+            grain.live = false;
+            return;
+        }
+
+        const double tolerance = static_cast<double>(grainSize_) / 4.0;
+        double start = nominal;
+
+        // Lock onto an upcoming attack once, rather than letting the search smear it.
+        size_t onset = 0;
+        const double lo = std::max(nominal - tolerance, 0.0);
+        const size_t first = std::max(static_cast<size_t>(lo), onsetFloor_);
+        if (transients_ && transients_->firstOnsetIn(first, static_cast<size_t>(nominal + tolerance) + 1, onset)) {
+            start = static_cast<double>(onset);
+            onsetFloor_ = onset + 1;
+        } else {
+            start = searchGrainStart(nominal, continuation);
+        }
+
+        grain = Grain{start, 0, true};
+    }
+
+    double SamplerVoice::searchGrainStart(const double nominal, const double continuation) const {
+        const double tolerance = static_cast<double>(grainSize_) / 4.0;
+        const size_t length = std::min(kCompareLength, grainSize_ / 2);
+
+        // The waveform the outgoing grain is about to play; the new grain should line up with it.
+        double reference[kCompareLength];
+        for (size_t k = 0; k < length; ++k)
+            reference[k] = monoAt(continuation + static_cast<double>(2 * k) * step_);
+
+        const auto score = [&](const double candidate) {
+            double cross = 0.0, energy = 1e-12;
+            for (size_t k = 0; k < length; ++k) {
+                const double x = monoAt(candidate + static_cast<double>(2 * k) * step_);
+                cross += reference[k] * x;
+                energy += x * x;
+            }
+            return cross / std::sqrt(energy);
+        };
+
+        const double lo = std::max(nominal - tolerance, 0.0);
+        const double hi = nominal + tolerance;
+
+        // Coarse pass over the tolerance window, then a unit-stride refinement around the winner.
+        double best = nominal;
+        double bestScore = score(nominal);
+        for (double c = lo; c <= hi; c += static_cast<double>(kCoarseStride)) {
+            if (const double s = score(c); s > bestScore) { bestScore = s; best = c; }
+        }
+
+        const double fineLo = std::max(best - static_cast<double>(kCoarseStride - 1), 0.0);
+        const double fineHi = best + static_cast<double>(kCoarseStride - 1);
+        for (double c = fineLo; c <= fineHi; c += 1.0) {
+            if (const double s = score(c); s > bestScore) { bestScore = s; best = c; }
+        }
+
+        return best;
+    }
+
+    double SamplerVoice::monoAt(const double position) const {
+        // Range check before the cast: converting a negative or oversized double is undefined
+        if (!(position >= 0.0) || position >= static_cast<double>(lastIndex_) + 1.0)
+            return 0.0;
+        const auto i = static_cast<size_t>(position);
+
+        const core::Sample* src = sample_->dataPtr();
+        const size_t j = (i == lastIndex_) ? i : i + 1;
+        const double frac = position - static_cast<double>(i);
+
+        double x0 = 0.0, x1 = 0.0;
+        for (unsigned c = 0; c < srcChannels_; ++c) {
+            x0 += src[i * srcChannels_ + c];
+            x1 += src[j * srcChannels_ + c];
+        }
+        return x0 + (x1 - x0) * frac;
     }
 
     bool SamplerVoice::finished() const {
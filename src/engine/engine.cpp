@@ -3,45 +3,43 @@
 //
 #include "pipsqueak/engine/engine.hpp"
 #include "pipsqueak/core/logging.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 
 namespace pipsqueak::engine {
     int AudioEngine::audioCallback(void *outputBuffer, void * /*inputBuffer*/,
-        const unsigned int nFrames, double /*streamTime*/,
+        const unsigned int nFrames, const double streamTime,
         const RtAudioStreamStatus status, void *userData) {
 
-        if (status)
-            std::cerr << "Stream underflow or overflow detected!\n";
-
-        // If the cast is successful, process the audio
+        // If the cast is successful, process the audio (xruns are reported as Overload events)
         if (auto* engine = static_cast<AudioEngine*>(userData)) {
-            return engine->processBlock(outputBuffer, nFrames);
+            return engine->processBlock(outputBuffer, nFrames, status, streamTime);
         }
 
         return 0;
     }
 
     AudioEngine::AudioEngine() : audio_(std::make_unique<RtAudio>()) {
+        masterMixer_.setEventSink(&events_);
         core::logging::Logger::log("pipsqueak", "AudioEngine initialized!");
 
     }
 
     AudioEngine::~AudioEngine() {
-        if (isRunning()) {
+        if (isRunning() || offlineThread_.joinable()) {
             stopStream();
         }
 
         core::logging::Logger::log("pipsqueak", "AudioEngine destroyed!");
     }
 
-    int AudioEngine::processBlock(void* outputBuffer, unsigned int numFrames) {
-        // 1. Clear the buffer to silence
-        mixerBuffer_->fill(0.0);
+    int AudioEngine::processBlock(void* outputBuffer, unsigned int numFrames, const RtAudioStreamStatus status,
+                                  const double streamTime) {
+        // Timestamp the block first, as close to the device interrupt as we get
+        clock_.update(framePosition_, numFrames, StreamClock::now(), streamTime);
 
-        // 2. Process the mixer
-        masterMixer_.process(*mixerBuffer_);
-
-        // 3. TODO: process a master effect chain
+        renderBlock(numFrames, status);
 
         // 4. Copy the final mixed audio to the hardware output buffer.
         auto* hardwareBuffer = static_cast<core::Sample*>(outputBuffer);
@@ -51,10 +49,98 @@ namespace pipsqueak::engine {
             mixerBuffer_->data().data(),
             static_cast<size_t>(numFrames) * mixerBuffer_->numChannels() * sizeof(core::Sample)
         );
-
         return 0;
     }
 
+    void AudioEngine::renderBlock(const unsigned int numFrames, const RtAudioStreamStatus status) {
+        // 0. Stamp this block's events, then apply queued graph changes before anything renders
+        events_.beginBlock(framePosition_);
+        if (streamStarting_.exchange(false, std::memory_order_acquire))
+            events_.post(core::EventType::StreamStatus, this, 0, 1);
+        if (status)
+            events_.post(core::EventType::Overload, this, 0, static_cast<std::int32_t>(status));
+
+        commands_.drain(commandBudget_.load(std::memory_order_relaxed));
+
+        // 1. Clear the buffer to silence
+        mixerBuffer_->fill(0.0);
+
+        // 2. Process the mixer
+        masterMixer_.process(*mixerBuffer_);
+
+        // 3. TODO: process a master effect chain
+
+        // 4. Hand the block to the output taps
+        if (taps_) {
+            for (const auto& tap : *taps_)
+                tap->write(*mixerBuffer_, framePosition_);
+        }
+
+        framePosition_ += numFrames;
+        events_.endBlock();
+    }
+
+    bool AudioEngine::startOffline(std::shared_ptr<OutputSink> sink, const unsigned int channels,
+                                   const unsigned int sampleRate, const unsigned int bufferSize,
+                                   const Pacing pacing, const std::uint64_t maxFrames) {
+        if (isRunning() || offlineThread_.joinable() || channels == 0 || sampleRate == 0 || bufferSize == 0) {
+            core::logging::Logger::log("pipsqueak", "AudioEngine cannot start offline rendering");
+            return false;
+        }
+
+        core::logging::Logger::log("pipsqueak", "starting offline rendering (sample rate: " +
+            std::to_string(sampleRate) + " | buffer: " + std::to_string(bufferSize) + ")");
+
+        // Same setup as a device stream; the render thread then owns the master mixer
+        mixerBuffer_ = std::make_unique<core::AudioBuffer>(channels, bufferSize);
+        masterMixer_.setCommandBus(&commands_);
+        routeTaps(true);
+        clock_.reset(sampleRate, bufferSize, 0);
+        streamStarting_.store(true, std::memory_order_release);
+
+        offlineStop_.store(false, std::memory_order_relaxed);
+        offlineRunning_.store(true, std::memory_order_release);
+        offlineThread_ = std::thread(&AudioEngine::offlineLoop, this, std::move(sink), sampleRate, bufferSize,
+                                     pacing, maxFrames);
+        return true;
+    }
+
+    void AudioEngine::offlineLoop(const std::shared_ptr<OutputSink> sink, const unsigned int sampleRate,
+                                  const unsigned int bufferSize, const Pacing pacing, const std::uint64_t maxFrames) {
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        std::uint64_t rendered = 0;
+
+        while (!offlineStop_.load(std::memory_order_acquire) && (maxFrames == 0 || rendered < maxFrames)) {
+            // Release each block at its stream time, measured from the start so no drift builds up
+            if (pacing == Pacing::RealTime) {
+                const std::chrono::duration<double> due(static_cast<double>(rendered) / sampleRate);
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(due));
+                clock_.update(framePosition_, bufferSize, StreamClock::now());
+            }
+
+            const std::uint64_t position = framePosition_;
+            renderBlock(bufferSize, 0);
+            if (sink)
+                sink->write(*mixerBuffer_, position);
+            rendered += bufferSize;
+        }
+
+        // This thread is still the event producer: announce the stop
+        events_.beginBlock(framePosition_);
+        events_.post(core::EventType::StreamStatus, this, 0, 0);
+        events_.endBlock();
+        offlineRunning_.store(false, std::memory_order_release);
+    }
+
+    void AudioEngine::waitForOffline() {
+        if (!offlineThread_.joinable())
+            return;
+
+        offlineThread_.join();
+        releaseStream();
+    }
+
     bool AudioEngine::startStream(unsigned int deviceId, unsigned int sampleRate, unsigned int bufferSize) {
         core::logging::Logger::log("pipsqueak", "starting stream (sample rate: " +
             std::to_string(sampleRate) + " | buffer: " + std::to_string(bufferSize) + ")");
@@ -79,10 +165,20 @@ namespace pipsqueak::engine {
 
         // Create the mixer buffer with the appropriate size
         mixerBuffer_ = std::make_unique<core::AudioBuffer>(outputParams.nChannels, negotiatedBufferSize);
+        clock_.reset(sampleRate, negotiatedBufferSize, static_cast<unsigned>(std::max(0L, audio_->getStreamLatency())));
+
+        // From here on the audio thread owns the master mixer's state (and produces events)
+        masterMixer_.setCommandBus(&commands_);
+        routeTaps(true);
+        streamStarting_.store(true, std::memory_order_release);
 
         // Try to start the stream
         if (const auto err = audio_->startStream(); err != RTAUDIO_NO_ERROR) {
             std::cerr << "AudioEngine failed to start stream: " << audio_->getErrorText() << "\n";
+            masterMixer_.setCommandBus(nullptr);
+            routeTaps(false);
+            // No block ran, so no start event was posted and no stop event is owed
+            streamStarting_.store(false, std::memory_order_relaxed);
             return false;
         }
 
@@ -91,6 +187,13 @@ namespace pipsqueak::engine {
     }
 
     void AudioEngine::stopStream() {
+        if (offlineThread_.joinable()) {
+            offlineStop_.store(true, std::memory_order_release);
+            offlineThread_.join();
+            releaseStream();
+            return;
+        }
+
         if (!isRunning())
             return;
 
@@ -103,11 +206,30 @@ namespace pipsqueak::engine {
         if (audio_->isStreamOpen())
             audio_->closeStream();
 
+        // The audio thread has stopped, so this thread may act as the event producer.
+        events_.beginBlock(framePosition_);
+        events_.post(core::EventType::StreamStatus, this, 0, 0);
+        events_.endBlock();
+
+        releaseStream();
+    }
+
+    void AudioEngine::releaseStream() {
+        // No audio thread is left to drain the bus: apply what is pending here, then publish directly.
+        {
+            // Tap edits wait until the bus is empty, so none can be posted after the final drain
+            std::lock_guard lock(tapMutex_);
+            while (commands_.drain(commands_.capacity()) > 0) {}
+            tapsViaBus_ = false;
+        }
+        commands_.collect();
+        masterMixer_.setCommandBus(nullptr);
+
         core::logging::Logger::log("pipsqueak", "AudioEngine has stopped the stream!");
     }
 
     bool AudioEngine::isRunning() const {
-        return audio_->isStreamRunning();
+        return audio_->isStreamRunning() || offlineRunning_.load(std::memory_order_acquire);
     }
 
     RtAudio& AudioEngine::audio() {
@@ -117,4 +239,89 @@ namespace pipsqueak::engine {
     dsp::Mixer& AudioEngine::masterMixer() {
         return masterMixer_;
     }
+
+    core::CommandBus& AudioEngine::commands() {
+        return commands_;
+    }
+
+    core::EventRing& AudioEngine::events() {
+        return events_;
+    }
+
+    void AudioEngine::setCommandBudget(const size_t budget) {
+        commandBudget_.store(budget, std::memory_order_relaxed);
+    }
+
+    bool AudioEngine::setRenderThreads(const unsigned threads) {
+        if (isRunning() || offlineThread_.joinable())
+            return false;
+
+        masterMixer_.setRenderPool(threads > 0 ? std::make_shared<core::ForkJoinPool>(threads) : nullptr);
+        core::logging::Logger::log("pipsqueak", "AudioEngine render threads: " + std::to_string(threads));
+        return true;
+    }
+
+    template <typename Edit>
+    bool AudioEngine::updateTaps(Edit&& edit) {
+        std::lock_guard lock(tapMutex_);
+        auto next = stagedTaps_ ? std::make_shared<TapList>(*stagedTaps_) : std::make_shared<TapList>();
+        if (!edit(*next))
+            return false;
+
+        if (tapsViaBus_) {
+            core::Command command;
+            command.apply = &AudioEngine::installTaps;
+            command.retire = &AudioEngine::retireTaps;
+            command.target = this;
+            command.payload = new std::shared_ptr<const TapList>(next);
+            if (commands_.post(command) == 0) {
+                delete static_cast<std::shared_ptr<const TapList>*>(command.payload);
+                return false;
+            }
+        } else {
+            taps_ = next;
+        }
+        stagedTaps_ = std::move(next);
+        return true;
+    }
+
+    bool AudioEngine::addOutputTap(std::shared_ptr<OutputSink> tap) {
+        if (!tap)
+            return false;
+        tap->setRealtime();
+        return updateTaps([&](TapList& taps) {
+            taps.push_back(tap);
+            return true;
+        });
+    }
+
+    bool AudioEngine::removeOutputTap(const std::shared_ptr<OutputSink>& tap) {
+        return updateTaps([&](TapList& taps) {
+            const auto it = std::find(taps.begin(), taps.end(), tap);
+            if (it == taps.end())
+                return false;
+            taps.erase(it);
+            return true;
+        });
+    }
+
+    void AudioEngine::routeTaps(const bool viaBus) {
+        std::lock_guard lock(tapMutex_);
+        tapsViaBus_ = viaBus;
+    }
+
+    void AudioEngine::installTaps(core::Command& command) {
+        auto* engine = static_cast<AudioEngine*>(command.target);
+        auto* staged = static_cast<std::shared_ptr<const TapList>*>(command.payload);
+        // The payload carries the replaced list back, so it is released on the control side.
+        engine->taps_.swap(*staged);
+    }
+
+    void AudioEngine::retireTaps(core::Command& command) {
+        delete static_cast<std::shared_ptr<const TapList>*>(command.payload);
+    }
+
+    const StreamClock& AudioEngine::streamClock() const noexcept {
+        return clock_;
+    }
 }
@@ -0,0 +1,346 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include "pipsqueak/engine/fd_output.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "pipsqueak/core/kernels.hpp"
+#include "pipsqueak/core/logging.hpp"
+
+namespace pipsqueak::engine {
+    namespace {
+        constexpr size_t kWavHeaderBytes = 44;
+        constexpr size_t kMaxIov = 1024; // IOV_MAX on Linux and the BSDs
+
+        void put16(std::uint8_t* p, const std::uint16_t v) {
+            p[0] = static_cast<std::uint8_t>(v);
+            p[1] = static_cast<std::uint8_t>(v >> 8);
+        }
+
+        void put32(std::uint8_t* p, const std::uint32_t v) {
+            put16(p, static_cast<std::uint16_t>(v));
+            put16(p + 2, static_cast<std::uint16_t>(v >> 16));
+        }
+
+        // Writes all of [p, p + size) at the current offset, riding out EINTR and non-blocking fds.
+        bool writeAll(const int fd, const std::uint8_t* p, size_t size) {
+            while (size > 0) {
+                const ssize_t n = ::write(fd, p, size);
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        pollfd pfd{fd, POLLOUT, 0};
+                        ::poll(&pfd, 1, -1);
+                        continue;
+                    }
+                    return false;
+                }
+                p += n;
+                size -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+    }
+
+    FdOutput::FdOutput(const int fd, const FdOutputOptions& options)
+        : fd_(fd), options_(options) {
+        if (options_.channels == 0 || options_.segmentFrames == 0 || options_.segments == 0) {
+            throw std::invalid_argument("FdOutput: channels and ring geometry must be non-zero");
+        }
+
+        const size_t bytesPerSample = options_.format == PcmFormat::Int16 ? 2 : 4;
+        bytesPerFrame_ = bytesPerSample * options_.channels;
+        segmentBytes_ = bytesPerFrame_ * options_.segmentFrames;
+        const auto segmentMicros = static_cast<long long>(options_.segmentFrames) * 1000000 /
+                                   std::max(1u, options_.sampleRate);
+        pollInterval_ = std::chrono::microseconds(std::clamp(segmentMicros / 4, 500LL, 10000LL));
+        storage_.resize(segmentBytes_ * options_.segments);
+        used_.resize(options_.segments, 0);
+
+        writer_ = std::thread(&FdOutput::writerLoop, this);
+    }
+
+    std::unique_ptr<FdOutput> FdOutput::open(const std::string& path, FdOutputOptions options, std::string* error) {
+        // O_TRUNC is ignored for FIFOs, so one call covers both
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            if (error)
+                *error = path + ": " + std::strerror(errno);
+            return nullptr;
+        }
+        options.closeFd = true;
+        return std::make_unique<FdOutput>(fd, options);
+    }
+
+    FdOutput::~FdOutput() {
+        close();
+    }
+
+    void FdOutput::write(const core::AudioBuffer& block, std::uint64_t) {
+        if (block.numChannels() != options_.channels) {
+            framesDropped_.fetch_add(block.numFrames(), std::memory_order_relaxed);
+            return;
+        }
+        write(block.dataPtr(), block.numFrames());
+    }
+
+    void FdOutput::setRealtime() {
+        options_.blockWhenFull = false;
+    }
+
+    bool FdOutput::write(const core::Sample* interleaved, const size_t frames) {
+        const auto& kernels = core::kernels::active();
+        const size_t framesPerSegment = options_.segmentFrames;
+        size_t done = 0;
+
+        while (done < frames) {
+            if (closed_ || failed_.load(std::memory_order_relaxed) || !acquire()) {
+                framesDropped_.fetch_add(frames - done, std::memory_order_relaxed);
+                return false;
+            }
+
+            // Convert straight into the ring slot
+            const size_t n = std::min(frames - done, framesPerSegment - fill_ / bytesPerFrame_);
+            std::uint8_t* dst = storage_.data() + (filling_ % options_.segments) * segmentBytes_ + fill_;
+            const core::Sample* src = interleaved + done * options_.channels;
+            if (options_.format == PcmFormat::Int16)
+                kernels.toInt16(src, reinterpret_cast<std::int16_t*>(dst), n * options_.channels);
+            else
+                std::memcpy(dst, src, n * bytesPerFrame_);
+
+            fill_ += n * bytesPerFrame_;
+            done += n;
+            framesQueued_.fetch_add(n, std::memory_order_relaxed);
+            if (fill_ == segmentBytes_)
+                publish();
+        }
+        return true;
+    }
+
+    bool FdOutput::acquire() {
+        if (haveSegment_)
+            return true;
+
+        const std::uint64_t limit = options_.segments;
+        if (filling_ - written_.load(std::memory_order_acquire) >= limit) {
+            if (!options_.blockWhenFull)
+                return false;
+            std::unique_lock lock(mutex_);
+            spaceFree_.wait(lock, [&] {
+                return filling_ - written_.load(std::memory_order_acquire) < limit
+                    || failed_.load(std::memory_order_relaxed) || closed_;
+            });
+            if (failed_.load(std::memory_order_relaxed) || closed_)
+                return false;
+        }
+
+        haveSegment_ = true;
+        fill_ = 0;
+        return true;
+    }
+
+    void FdOutput::publish() {
+        used_[filling_ % options_.segments] = fill_;
+        ++filling_;
+        haveSegment_ = false;
+        fill_ = 0;
+
+        // No wake-up: the writer polls, so publishing stays lock- and syscall-free
+        published_.store(filling_, std::memory_order_release);
+    }
+
+    void FdOutput::flush() {
+        if (closed_)
+            return;
+        if (haveSegment_ && fill_ > 0)
+            publish();
+
+        std::unique_lock lock(mutex_);
+        spaceFree_.wait(lock, [&] {
+            return written_.load(std::memory_order_acquire) == published_.load(std::memory_order_acquire)
+                || failed_.load(std::memory_order_relaxed);
+        });
+    }
+
+    void FdOutput::close() {
+        if (closed_)
+            return;
+        flush();
+
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+            closed_ = true;
+        }
+        dataReady_.notify_all();
+        spaceFree_.notify_all();
+        if (writer_.joinable())
+            writer_.join();
+
+        patchHeader();
+        if (options_.closeFd && fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+    bool FdOutput::failed() const noexcept {
+        return failed_.load(std::memory_order_relaxed);
+    }
+
+    FdOutput::Stats FdOutput::stats() const noexcept {
+        Stats stats;
+        stats.framesQueued = framesQueued_.load(std::memory_order_relaxed);
+        stats.framesDropped = framesDropped_.load(std::memory_order_relaxed);
+        stats.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+        stats.writeCalls = writeCalls_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void FdOutput::writerLoop() {
+        // A closed pipe must fail the write, not kill the process
+        sigset_t pipeSignal;
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+
+        writeHeader();
+
+        for (;;) {
+            std::uint64_t to;
+            {
+                std::unique_lock lock(mutex_);
+                while (!stopping_ && published_.load(std::memory_order_acquire) == written_.load(std::memory_order_relaxed))
+                    dataReady_.wait_for(lock, pollInterval_);
+                to = published_.load(std::memory_order_acquire);
+                if (stopping_ && to == written_.load(std::memory_order_relaxed))
+                    break;
+            }
+
+            const std::uint64_t from = written_.load(std::memory_order_relaxed);
+            if (!failed_.load(std::memory_order_relaxed) && !writeSegments(from, to)) {
+                failed_.store(true, std::memory_order_relaxed);
+                core::logging::Logger::log("pipsqueak", std::string("FdOutput write failed: ") + std::strerror(errno));
+
+                // Swallow the SIGPIPE this thread has pending, if that was the cause
+                const timespec zero{0, 0};
+                sigtimedwait(&pipeSignal, nullptr, &zero);
+            }
+
+            {
+                std::lock_guard lock(mutex_);
+                written_.store(to, std::memory_order_release);
+            }
+            spaceFree_.notify_all();
+        }
+    }
+
+    bool FdOutput::writeSegments(std::uint64_t from, const std::uint64_t to) {
+        iovec iov[kMaxIov];
+        while (from < to) {
+            // Gather consecutive segments; the ring wraps, so each slot is its own iovec
+            size_t count = 0;
+            size_t total = 0;
+            for (std::uint64_t i = from; i < to && count < kMaxIov; ++i, ++count) {
+                const size_t slot = i % options_.segments;
+                iov[count].iov_base = storage_.data() + slot * segmentBytes_;
+                iov[count].iov_len = used_[slot];
+                total += used_[slot];
+            }
+
+            // Deliver, resuming after partial writes
+            size_t first = 0;
+            size_t remaining = total;
+            while (remaining > 0) {
+                const ssize_t n = ::writev(fd_, iov + first, static_cast<int>(count - first));
+                writeCalls_.fetch_add(1, std::memory_order_relaxed);
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        pollfd pfd{fd_, POLLOUT, 0};
+                        ::poll(&pfd, 1, -1);
+                        continue;
+                    }
+                    return false;
+                }
+
+                bytesWritten_.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed);
+                remaining -= static_cast<size_t>(n);
+                auto left = static_cast<size_t>(n);
+                while (left > 0 && left >= iov[first].iov_len) {
+                    left -= iov[first].iov_len;
+                    ++first;
+                }
+                if (left > 0) {
+                    iov[first].iov_base = static_cast<std::uint8_t*>(iov[first].iov_base) + left;
+                    iov[first].iov_len -= left;
+                }
+            }
+            from += count;
+        }
+        return true;
+    }
+
+    void FdOutput::writeHeader() {
+        if (options_.container != StreamContainer::Wav)
+            return;
+
+        // Streaming sizes are unknown: use the maximum, which readers treat as "until EOF"
+        std::uint8_t h[kWavHeaderBytes] = {};
+        const bool isFloat = options_.format == PcmFormat::Float32;
+        const auto bytesPerSample = static_cast<std::uint16_t>(isFloat ? 4 : 2);
+        std::memcpy(h, "RIFF", 4);
+        put32(h + 4, 0xFFFFFFFFu);
+        std::memcpy(h + 8, "WAVEfmt ", 8);
+        put32(h + 16, 16);
+        put16(h + 20, isFloat ? 3 : 1);
+        put16(h + 22, static_cast<std::uint16_t>(options_.channels));
+        put32(h + 24, options_.sampleRate);
+        put32(h + 28, options_.sampleRate * static_cast<std::uint32_t>(bytesPerFrame_));
+        put16(h + 32, static_cast<std::uint16_t>(bytesPerFrame_));
+        put16(h + 34, static_cast<std::uint16_t>(bytesPerSample * 8));
+        std::memcpy(h + 36, "data", 4);
+        put32(h + 40, 0xFFFFFFFFu);
+
+        if (writeAll(fd_, h, sizeof(h))) {
+            bytesWritten_.fetch_add(sizeof(h), std::memory_order_relaxed);
+        } else {
+            failed_.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void FdOutput::patchHeader() {
+        if (options_.container != StreamContainer::Wav || fd_ < 0 || failed_.load(std::memory_order_relaxed))
+            return;
+
+        // Only regular files can be rewritten in place; pipes keep the streaming sizes
+        struct stat info{};
+        if (::fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode))
+            return;
+
+        const std::uint64_t data = bytesWritten_.load(std::memory_order_relaxed) - kWavHeaderBytes;
+        const auto clamp = [](const std::uint64_t v) {
+            return static_cast<std::uint32_t>(std::min<std::uint64_t>(v, 0xFFFFFFFFu));
+        };
+        std::uint8_t riff[4];
+        std::uint8_t size[4];
+        put32(riff, clamp(data + kWavHeaderBytes - 8));
+        put32(size, clamp(data));
+        if (::pwrite(fd_, riff, 4, 4) != 4 || ::pwrite(fd_, size, 4, 40) != 4)
+            core::logging::Logger::log("pipsqueak", "FdOutput could not finalise the WAV header");
+    }
+}
@@ -0,0 +1,35 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include "pipsqueak/engine/output_sink.hpp"
+#include "pipsqueak/core/logging.hpp"
+
+namespace pipsqueak::engine {
+    void NullSink::write(const core::AudioBuffer& block, std::uint64_t) {
+        frames_.fetch_add(block.numFrames(), std::memory_order_relaxed);
+    }
+
+    std::uint64_t NullSink::framesWritten() const noexcept {
+        return frames_.load(std::memory_order_relaxed);
+    }
+
+    FileSink::FileSink(const std::string& path) : file_(std::fopen(path.c_str(), "wb")) {
+        if (!file_)
+            core::logging::Logger::log("pipsqueak", "FileSink failed to open " + path);
+    }
+
+    FileSink::~FileSink() {
+        if (file_)
+            std::fclose(file_);
+    }
+
+    bool FileSink::isOpen() const noexcept {
+        return file_ != nullptr;
+    }
+
+    void FileSink::write(const core::AudioBuffer& block, std::uint64_t) {
+        if (file_)
+            std::fwrite(block.dataPtr(), sizeof(core::Sample), block.data().size(), file_);
+    }
+}
@@ -0,0 +1,259 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include "pipsqueak/engine/render_host.hpp"
+#include "pipsqueak/core/logging.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+namespace pipsqueak::engine {
+    using Clock = std::chrono::steady_clock;
+
+    namespace {
+        // CPU time consumed by the calling thread; unlike wall time it stops while preempted.
+        std::chrono::nanoseconds threadCpuTime() {
+            timespec ts{};
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+        }
+    }
+
+    // ---- Tenant ----
+
+    Tenant::Tenant(TenantConfig config)
+        : config_(std::move(config)), store_(config_.storeCapacity) {
+        buffer_ = std::make_unique<core::AudioBuffer>(config_.channels, config_.blockFrames);
+        period_ = std::chrono::nanoseconds(static_cast<std::int64_t>(
+            1e9 * static_cast<double>(config_.blockFrames) / std::max(config_.sampleRate, 1.0)));
+
+        // Hosted mixers are always driven by a worker, so changes always go through the bus.
+        mixer_.setCommandBus(&commands_);
+        mixer_.setEventSink(&events_);
+    }
+
+    TenantStats Tenant::stats() const {
+        if (!hostMutex_)
+            return stats_;
+        std::lock_guard lock(*hostMutex_);
+        return stats_;
+    }
+
+    void Tenant::renderBlock() {
+        events_.beginBlock(framePosition_);
+        commands_.drain(config_.commandBudget);
+
+        buffer_->fill(0.0);
+        mixer_.process(*buffer_);
+        if (config_.sink)
+            config_.sink->write(*buffer_, framePosition_);
+
+        framePosition_ += config_.blockFrames;
+        events_.endBlock();
+    }
+
+    // ---- RenderHost ----
+
+    RenderHost::RenderHost(const unsigned workers, const Pacing pacing)
+        : workerCount_(workers ? workers : std::max(1u, std::thread::hardware_concurrency())), pacing_(pacing) {}
+
+    RenderHost::~RenderHost() {
+        stop();
+    }
+
+    Tenant& RenderHost::addTenant(TenantConfig config) {
+        auto tenant = std::make_unique<Tenant>(std::move(config));
+        const auto now = Clock::now();
+        tenant->deadline_ = now + tenant->period_;
+        tenant->refilled_ = now;
+        tenant->credit_ = tenant->period_;
+        tenant->hostMutex_ = &mutex_;
+
+        std::lock_guard lock(mutex_);
+        tenants_.push_back(std::move(tenant));
+        wake_.notify_one();
+        return *tenants_.back();
+    }
+
+    bool RenderHost::removeTenant(Tenant& tenant) {
+        std::unique_ptr<Tenant> removed;
+        {
+            std::unique_lock lock(mutex_);
+            const auto it = std::find_if(tenants_.begin(), tenants_.end(),
+                                         [&](const auto& owned) { return owned.get() == &tenant; });
+            if (it == tenants_.end())
+                return false;
+
+            // No worker picks it from here on; wait out the block one may be rendering now.
+            tenant.removing_ = true;
+            idle_.wait(lock, [&] { return !tenant.busy_; });
+            removed = std::move(*it);
+            tenants_.erase(it);
+            tenant.hostMutex_ = nullptr;
+            idle_.notify_all(); // waitIdle() no longer waits for it
+        }
+        return true; // The tenant is destroyed here, outside the host's lock
+    }
+
+    void RenderHost::start() {
+        if (running_.exchange(true))
+            return;
+
+        {
+            // Stream time starts now for every tenant added before start().
+            std::lock_guard lock(mutex_);
+            const auto now = Clock::now();
+            for (auto& tenant : tenants_) {
+                if (tenant->stats_.blocksRendered == 0) {
+                    tenant->deadline_ = now + tenant->period_;
+                    tenant->refilled_ = now;
+                }
+            }
+        }
+
+        workers_.reserve(workerCount_);
+        for (unsigned i = 0; i < workerCount_; ++i)
+            workers_.emplace_back([this] { run(); });
+
+        core::logging::Logger::log("pipsqueak", "RenderHost started with " + std::to_string(workerCount_) +
+                                                    " workers");
+    }
+
+    void RenderHost::stop() {
+        if (!running_.exchange(false))
+            return;
+
+        {
+            std::lock_guard lock(mutex_);
+            wake_.notify_all();
+            idle_.notify_all();
+        }
+        for (auto& worker : workers_)
+            worker.join();
+        workers_.clear();
+
+        core::logging::Logger::log("pipsqueak", "RenderHost stopped");
+    }
+
+    void RenderHost::waitIdle() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [&] {
+            return !running_ || std::all_of(tenants_.begin(), tenants_.end(), [](const auto& t) {
+                return t->config_.maxBlocks == 0 || done(*t);
+            });
+        });
+    }
+
+    bool RenderHost::isRunning() const noexcept {
+        return running_.load();
+    }
+
+    unsigned RenderHost::workerCount() const noexcept {
+        return workerCount_;
+    }
+
+    size_t RenderHost::tenantCount() const {
+        std::lock_guard lock(mutex_);
+        return tenants_.size();
+    }
+
+    bool RenderHost::done(const Tenant& tenant) {
+        return tenant.config_.maxBlocks != 0 && tenant.stats_.blocksRendered >= tenant.config_.maxBlocks;
+    }
+
+    void RenderHost::refill(Tenant& tenant, const Clock::time_point now) {
+        const auto earned = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            (now - tenant.refilled_) * tenant.config_.cpuQuota);
+        tenant.refilled_ = now;
+
+        // Bank at most two periods so an idle tenant cannot burst for long.
+        tenant.credit_ = std::min(tenant.credit_ + earned, 2 * tenant.period_);
+    }
+
+    Tenant* RenderHost::pick(const Clock::time_point now, Clock::time_point& wake) {
+        Tenant* best = nullptr;
+        for (auto& owned : tenants_) {
+            Tenant& t = *owned;
+            if (t.busy_ || t.removing_ || done(t))
+                continue;
+
+            // Not released yet: come back when it is.
+            if (pacing_ == Pacing::RealTime) {
+                if (const auto release = t.deadline_ - t.period_; release > now) {
+                    wake = std::min(wake, release);
+                    continue;
+                }
+            }
+
+            // Out of quota: come back when enough credit has been earned.
+            refill(t, now);
+            if (t.credit_ <= std::chrono::nanoseconds::zero()) {
+                if (!t.held_) {
+                    t.held_ = true;
+                    ++t.stats_.throttled;
+                }
+                if (t.config_.cpuQuota > 0.0) {
+                    const auto owed = std::chrono::duration_cast<Clock::duration>(
+                        -t.credit_ / t.config_.cpuQuota);
+                    wake = std::min(wake, now + owed + std::chrono::microseconds(1));
+                }
+                continue;
+            }
+            t.held_ = false;
+
+            if (!best || t.deadline_ < best->deadline_)
+                best = &t;
+        }
+        return best;
+    }
+
+    void RenderHost::run() {
+        if (pacing_ == Pacing::RealTime) {
+            sched_param param{};
+            param.sched_priority = kRealtimePriority;
+            if (const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+                error != 0 && !realtimeWarned_.exchange(true)) {
+                core::logging::Logger::log("pipsqueak", std::string("RenderHost workers keep normal scheduling; "
+                                                                    "SCHED_FIFO was refused: ") +
+                                                            std::strerror(error));
+            }
+        }
+
+        std::unique_lock lock(mutex_);
+        while (running_) {
+            const auto now = Clock::now();
+            auto wake = now + std::chrono::milliseconds(50);
+            Tenant* tenant = pick(now, wake);
+            if (!tenant) {
+                wake_.wait_until(lock, wake);
+                continue;
+            }
+
+            tenant->busy_ = true;
+            lock.unlock();
+
+            const auto cpuBegin = threadCpuTime();
+            tenant->renderBlock();
+            const auto cost = threadCpuTime() - cpuBegin;
+            const auto end = Clock::now();
+
+            lock.lock();
+            tenant->credit_ -= cost;
+            tenant->stats_.cpuSeconds += std::chrono::duration<double>(cost).count();
+            ++tenant->stats_.blocksRendered;
+            if (pacing_ == Pacing::RealTime && end > tenant->deadline_)
+                ++tenant->stats_.deadlineMisses;
+            tenant->deadline_ += tenant->period_;
+            tenant->busy_ = false;
+
+            if (done(*tenant) || tenant->removing_)
+                idle_.notify_all();
+            wake_.notify_one();
+        }
+    }
+}
@@ -0,0 +1,149 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include "pipsqueak/engine/shm_output.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "pipsqueak/core/logging.hpp"
+
+namespace pipsqueak::engine {
+    static_assert(std::is_same_v<core::Sample, float>, "the ring format is float32");
+
+    namespace {
+        constexpr size_t kAlign = 64;
+
+        size_t alignUp(const size_t value) {
+            return (value + kAlign - 1) / kAlign * kAlign;
+        }
+    }
+
+    std::unique_ptr<ShmOutput> ShmOutput::create(const std::string& name, const ShmOutputOptions& options,
+                                                 std::string* error) {
+        if (options.channels == 0 || options.slotFrames == 0 || options.slots == 0) {
+            throw std::invalid_argument("ShmOutput: channels and ring geometry must be non-zero");
+        }
+
+        const std::string path = name.empty() || name[0] != '/' ? "/" + name : name;
+        const size_t stride = alignUp(kShmSlotHeaderBytes
+                                      + static_cast<size_t>(options.slotFrames) * options.channels * sizeof(float));
+        const size_t dataOffset = alignUp(sizeof(ShmRingHeader));
+        const size_t bytes = dataOffset + stride * options.slots;
+
+        // Captures errno before any cleanup call can change it
+        const auto report = [&](const std::string& what) {
+            if (error)
+                *error = path + ": " + what + ": " + std::strerror(errno);
+        };
+
+        // Replace any ring left behind by a crashed producer: readers of the old one keep their mapping
+        ::shm_unlink(path.c_str());
+        const int fd = ::shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            report("shm_open");
+            return nullptr;
+        }
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            report("ftruncate");
+            ::close(fd);
+            ::shm_unlink(path.c_str());
+            return nullptr;
+        }
+        void* map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            report("mmap");
+            ::shm_unlink(path.c_str());
+            return nullptr;
+        }
+
+        // Touch every page now, so the audio thread never takes a page fault on first use
+        auto* base = static_cast<std::uint8_t*>(map);
+        std::memset(base, 0, bytes);
+
+        auto* header = new (base) ShmRingHeader{};
+        header->version = kShmRingVersion;
+        header->channels = options.channels;
+        header->sampleRate = options.sampleRate;
+        header->slotFrames = options.slotFrames;
+        header->slots = options.slots;
+        header->slotStride = stride;
+        header->dataOffset = dataOffset;
+        header->published.store(0, std::memory_order_relaxed);
+        header->producer.store(static_cast<std::int32_t>(::getpid()), std::memory_order_relaxed);
+        for (unsigned i = 0; i < options.slots; ++i)
+            new (base + dataOffset + i * stride) ShmSlotHeader{};
+
+        // The magic goes last: a reader that sees it sees a fully initialised ring
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, kShmRingMagic, sizeof(kShmRingMagic));
+
+        return std::unique_ptr<ShmOutput>(new ShmOutput(path, options, base, bytes));
+    }
+
+    ShmOutput::ShmOutput(std::string name, const ShmOutputOptions& options, std::uint8_t* base, const size_t bytes)
+        : name_(std::move(name)), options_(options), base_(base), bytes_(bytes),
+          header_(reinterpret_cast<ShmRingHeader*>(base)) {
+        core::logging::Logger::log("pipsqueak", "ShmOutput publishing to " + name_);
+    }
+
+    ShmOutput::~ShmOutput() {
+        header_->producer.store(0, std::memory_order_release);
+        ::munmap(base_, bytes_);
+        if (options_.unlinkOnClose)
+            ::shm_unlink(name_.c_str());
+    }
+
+    void ShmOutput::write(const core::AudioBuffer& block, const std::uint64_t frame) {
+        if (block.numChannels() != options_.channels) {
+            framesDropped_.fetch_add(block.numFrames(), std::memory_order_relaxed);
+            return;
+        }
+        write(block.dataPtr(), block.numFrames(), frame);
+    }
+
+    void ShmOutput::write(const core::Sample* interleaved, const size_t frames, const std::uint64_t frame) {
+        const size_t channels = options_.channels;
+        size_t done = 0;
+
+        // Blocks longer than a slot are split; each part is its own sequence number
+        while (done < frames) {
+            const auto n = static_cast<std::uint32_t>(std::min<size_t>(frames - done, options_.slotFrames));
+            const std::uint64_t sequence = sequence_ + 1;
+            auto* slot = reinterpret_cast<ShmSlotHeader*>(
+                base_ + header_->dataOffset + (sequence - 1) % options_.slots * header_->slotStride);
+
+            // Invalidate first, so readers still holding the old block notice the overwrite
+            slot->sequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            slot->frame = frame + done;
+            slot->frames = n;
+            std::memcpy(reinterpret_cast<std::uint8_t*>(slot) + kShmSlotHeaderBytes,
+                        interleaved + done * channels, n * channels * sizeof(float));
+
+            slot->sequence.store(sequence, std::memory_order_release);
+            header_->published.store(sequence, std::memory_order_release);
+            sequence_ = sequence;
+            done += n;
+        }
+    }
+
+    std::uint64_t ShmOutput::published() const noexcept {
+        return header_->published.load(std::memory_order_acquire);
+    }
+
+    std::uint64_t ShmOutput::framesDropped() const noexcept {
+        return framesDropped_.load(std::memory_order_relaxed);
+    }
+}
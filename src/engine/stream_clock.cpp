@@ -0,0 +1,116 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#include "pipsqueak/engine/stream_clock.hpp"
+
+#include <cmath>
+#include <ctime>
+
+namespace pipsqueak::engine {
+    namespace {
+        constexpr double kPi = 3.14159265358979323846;
+
+        // Time errors beyond this many block periods restart the loop instead of steering it
+        constexpr double kRestartPeriods = 4.0;
+    }
+
+    StreamClock::StreamClock(const double bandwidth) noexcept : bandwidth_(bandwidth) {}
+
+    std::int64_t StreamClock::now() noexcept {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    void StreamClock::reset(const double sampleRate, const unsigned blockFrames, const unsigned latencyFrames) noexcept {
+        sampleRate_ = sampleRate > 0.0 ? sampleRate : 48000.0;
+        latencyNs_ = static_cast<std::int64_t>(1e9 * (latencyFrames > 0 ? latencyFrames : blockFrames) / sampleRate_);
+        running_ = false;
+        updates_ = 0;
+
+        sequence_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        publishedUpdates_.store(0, std::memory_order_relaxed);
+        sequence_.fetch_add(1, std::memory_order_release);
+    }
+
+    void StreamClock::restart(const std::uint64_t frame, const unsigned frames, const double t) noexcept {
+        // omega = 2 pi B T per block; critically damped second-order loop
+        const double period = frames / sampleRate_;
+        const double omega = 2.0 * kPi * bandwidth_ * period;
+        b_ = std::sqrt(2.0) * omega;
+        c_ = omega * omega;
+
+        frames_ = frames;
+        frame_ = frame;
+        period_ = period;
+        t0_ = t;
+        t1_ = t + period;
+        running_ = true;
+    }
+
+    void StreamClock::update(const std::uint64_t frame, const unsigned frames, const std::int64_t nowNs,
+                             const double streamTime) noexcept {
+        if (frames == 0)
+            return;
+        if (!running_)
+            origin_ = nowNs;
+        const double t = static_cast<double>(nowNs - origin_) * 1e-9;
+
+        if (!running_ || frame != expected_ || frames != frames_) {
+            restart(frame, frames, t);
+        } else {
+            const double error = t - t1_;
+            if (std::fabs(error) > kRestartPeriods * period_) {
+                restart(frame, frames, t);
+            } else {
+                t0_ = t1_;
+                t1_ += b_ * error + period_;
+                period_ += c_ * error;
+                frame_ = frame;
+            }
+        }
+        expected_ = frame + frames;
+        ++updates_;
+        publish(streamTime);
+    }
+
+    void StreamClock::publish(const double streamTime) noexcept {
+        const double nsPerFrame = period_ * 1e9 / frames_;
+
+        sequence_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        publishedFrame_.store(frame_, std::memory_order_relaxed);
+        publishedTime_.store(origin_ + static_cast<std::int64_t>(std::llround(t0_ * 1e9)), std::memory_order_relaxed);
+        publishedPeriod_.store(nsPerFrame, std::memory_order_relaxed);
+        publishedLatency_.store(latencyNs_, std::memory_order_relaxed);
+        publishedStreamTime_.store(streamTime, std::memory_order_relaxed);
+        publishedUpdates_.store(updates_, std::memory_order_relaxed);
+        sequence_.fetch_add(1, std::memory_order_release);
+    }
+
+    bool StreamClock::snapshot(ClockSnapshot& out) const noexcept {
+        for (;;) {
+            const std::uint32_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1u)
+                continue;
+
+            ClockSnapshot read;
+            read.frame = publishedFrame_.load(std::memory_order_relaxed);
+            read.timeNs = publishedTime_.load(std::memory_order_relaxed);
+            read.nsPerFrame = publishedPeriod_.load(std::memory_order_relaxed);
+            read.latencyNs = publishedLatency_.load(std::memory_order_relaxed);
+            read.streamTime = publishedStreamTime_.load(std::memory_order_relaxed);
+            read.updates = publishedUpdates_.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) != before)
+                continue;
+            if (read.updates == 0)
+                return false;
+            out = read;
+            return true;
+        }
+    }
+}
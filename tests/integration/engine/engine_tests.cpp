@@ -4,6 +4,14 @@
 #include <gtest/gtest.h>
 #include <pipsqueak/audio_io/device_scanner.hpp>
 #include <pipsqueak/engine/engine.hpp>
+#include <pipsqueak/engine/shm_output.hpp>
+#include <pipsqueak/dsp/oscillator.hpp>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 
 /// Tests the engine can start a stream using the device id provided by the device manager.
 TEST(EngineIntegrationTest, StartsStreamWithGivenDevice) {
@@ -33,4 +41,131 @@ TEST(EngineIntegrationTest, StopsStreamCorrectly) {
 
     // ASSERT: Check that engine's isRunning method returns false
     EXPECT_FALSE(engine.isRunning());
-}
\ No newline at end of file
+}
+
+/// Tests stopping a device stream posts a StreamStatus event with value 0.
+TEST(EngineIntegrationTest, StopStreamPostsStatusEvent) {
+    // ARRANGE: Run the stream long enough for the start event to be posted
+    pipsqueak::engine::AudioEngine engine;
+    const pipsqueak::audio_io::DeviceScanner deviceManager(engine.audio());
+    ASSERT_TRUE(engine.startStream(deviceManager.defaultDevice().value().ID, 44100, 512));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // ACT: Stop the stream and drain every event it produced
+    engine.stopStream();
+    std::vector<std::int32_t> statuses;
+    engine.events().drain([&](const pipsqueak::core::Event& event) {
+        if (event.type == pipsqueak::core::EventType::StreamStatus)
+            statuses.push_back(event.value);
+    });
+
+    // ASSERT: Started, then stopped
+    ASSERT_EQ(statuses.size(), 2u);
+    EXPECT_EQ(statuses[0], 1);
+    EXPECT_EQ(statuses[1], 0);
+}
+
+/// Tests the engine renders a fixed length into a sink without any device.
+TEST(EngineIntegrationTest, RendersOfflineIntoSink) {
+    // ARRANGE: Count what reaches the sink
+    struct CountingSink final : pipsqueak::engine::OutputSink {
+        std::uint64_t frames{0};
+        std::uint64_t lastPosition{0};
+        void write(const pipsqueak::core::AudioBuffer& block, const std::uint64_t frame) override {
+            frames += block.numFrames();
+            lastPosition = frame;
+        }
+    };
+    pipsqueak::engine::AudioEngine engine;
+    auto sink = std::make_shared<CountingSink>();
+
+    // ACT: Render 1000 frames as fast as possible (rounded up to whole blocks)
+    ASSERT_TRUE(engine.startOffline(sink, 2, 48000, 256, pipsqueak::engine::Pacing::FreeRunning, 1000));
+    engine.waitForOffline();
+
+    // ASSERT: Four blocks were delivered and the engine stopped by itself
+    EXPECT_FALSE(engine.isRunning());
+    EXPECT_EQ(sink->frames, 1024u);
+    EXPECT_EQ(sink->lastPosition, 768u);
+}
+
+/// Tests an output tap publishes the master output to a shared-memory ring.
+TEST(EngineIntegrationTest, OutputTapPublishesToSharedMemory) {
+    // ARRANGE: A ring tap on an offline engine
+    const std::string name = "/pipsqueak-engine-tap-" + std::to_string(getpid());
+    pipsqueak::engine::ShmOutputOptions options;
+    options.slotFrames = 256;
+    auto ring = std::shared_ptr<pipsqueak::engine::ShmOutput>(pipsqueak::engine::ShmOutput::create(name, options));
+    ASSERT_NE(ring, nullptr);
+    pipsqueak::engine::ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+
+    pipsqueak::engine::AudioEngine engine;
+    ASSERT_TRUE(engine.addOutputTap(ring));
+
+    // ACT: Render four blocks
+    ASSERT_TRUE(engine.startOffline(std::make_shared<pipsqueak::engine::NullSink>(), 2, 48000, 256,
+                                    pipsqueak::engine::Pacing::FreeRunning, 1024));
+    engine.waitForOffline();
+
+    // ASSERT: The reader sees each block at its stream position, then the tap can be removed
+    pipsqueak::engine::ShmRingReader::Block block;
+    for (std::uint64_t frame = 0; frame < 1024; frame += 256) {
+        ASSERT_EQ(reader.next(block), pipsqueak::engine::ShmRingReader::Status::Ok);
+        EXPECT_EQ(block.frame, frame);
+    }
+    EXPECT_EQ(reader.next(block), pipsqueak::engine::ShmRingReader::Status::Empty);
+    EXPECT_TRUE(engine.removeOutputTap(ring));
+    EXPECT_FALSE(engine.removeOutputTap(ring));
+}
+
+/// Tests the stream clock follows a real-time paced offline stream.
+TEST(EngineIntegrationTest, StreamClockFollowsRealTimeRendering) {
+    // ARRANGE: An engine with no device
+    pipsqueak::engine::AudioEngine engine;
+
+    // ACT: Render 100 ms in real time
+    ASSERT_TRUE(engine.startOffline(std::make_shared<pipsqueak::engine::NullSink>(), 2, 48000, 480,
+                                    pipsqueak::engine::Pacing::RealTime, 4800));
+    engine.waitForOffline();
+
+    // ASSERT: Every block was timestamped, at roughly the nominal rate
+    pipsqueak::engine::ClockSnapshot snapshot;
+    ASSERT_TRUE(engine.streamClock().snapshot(snapshot));
+    EXPECT_EQ(snapshot.updates, 10u);
+    EXPECT_EQ(snapshot.frame, 4320u);
+    EXPECT_NEAR(snapshot.sampleRate(), 48000.0, 4800.0);
+}
+
+/// Tests offline renders are bit-identical whatever the render thread count.
+TEST(EngineIntegrationTest, OfflineRenderIsReproducibleAcrossThreadCounts) {
+    struct CaptureSink final : pipsqueak::engine::OutputSink {
+        std::vector<float> samples;
+        void write(const pipsqueak::core::AudioBuffer& block, std::uint64_t) override {
+            samples.insert(samples.end(), block.data().begin(), block.data().end());
+        }
+    };
+
+    const auto render = [](const unsigned threads) {
+        // ARRANGE: The same oscillator bank for every run
+        pipsqueak::engine::AudioEngine engine;
+        EXPECT_TRUE(engine.setRenderThreads(threads));
+        for (int i = 0; i < 8; ++i) {
+            engine.masterMixer().addSource(std::make_shared<pipsqueak::dsp::Oscillator>(
+                pipsqueak::dsp::Waveform::Sine, 220.0 + 31.0 * i, 48000.0, 0.1f));
+        }
+
+        // ACT: Render free-running
+        auto sink = std::make_shared<CaptureSink>();
+        EXPECT_TRUE(engine.startOffline(sink, 2, 48000, 512, pipsqueak::engine::Pacing::FreeRunning, 4096));
+        engine.waitForOffline();
+        return sink->samples;
+    };
+
+    // ASSERT: Identical bits for one and four threads
+    const auto single = render(1);
+    const auto parallel = render(4);
+    ASSERT_EQ(single.size(), 2u * 4096);
+    ASSERT_EQ(parallel.size(), single.size());
+    EXPECT_EQ(std::memcmp(single.data(), parallel.data(), single.size() * sizeof(float)), 0);
+}
@@ -0,0 +1,109 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include "perf_harness.hpp"
+#include <pipsqueak/core/audio_buffer.hpp>
+#include <pipsqueak/core/kernels.hpp>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace pipsqueak;
+
+namespace {
+    // One 4096-frame stereo block: stays in L1/L2, so the kernels are measured, not memory.
+    constexpr size_t kSamples = 4096 * 2;
+
+    std::vector<core::Sample> signal() {
+        std::vector<core::Sample> samples(kSamples);
+        for (size_t i = 0; i < kSamples; ++i)
+            samples[i] = static_cast<core::Sample>(i % 977) / 977.0f - 0.5f;
+        return samples;
+    }
+
+    double gain(const core::kernels::KernelTable& kernels, const perf::RunOptions& options) {
+        auto data = signal();
+        return perf::measure(options, kSamples, [&] {
+            kernels.gain(data.data(), data.size(), 0.999f);
+            perf::keep(data);
+        });
+    }
+
+    double mixAccumulate(const core::kernels::KernelTable& kernels, const perf::RunOptions& options) {
+        const auto src = signal();
+        std::vector<core::Sample> dst(kSamples, 0.0f);
+        return perf::measure(options, kSamples, [&] {
+            kernels.mixAccumulate(dst.data(), src.data(), kSamples, 0.5f);
+            perf::keep(dst);
+        });
+    }
+
+    double toInt16(const core::kernels::KernelTable& kernels, const perf::RunOptions& options) {
+        const auto src = signal();
+        std::vector<std::int16_t> dst(kSamples);
+        return perf::measure(options, kSamples, [&] {
+            kernels.toInt16(src.data(), dst.data(), kSamples);
+            perf::keep(dst);
+        });
+    }
+
+    double channelStats(const core::kernels::KernelTable& kernels, const perf::RunOptions& options) {
+        const auto src = signal();
+        float peak[2];
+        double sum[2];
+        double sumSquares[2];
+        return perf::measure(options, kSamples, [&] {
+            kernels.channelStats(src.data(), kSamples / 2, 2, peak, sum, sumSquares);
+            perf::keep(peak);
+            perf::keep(sumSquares);
+        });
+    }
+
+    double interpolateMix(const core::kernels::KernelTable& kernels, const perf::RunOptions& options) {
+        // The sampler's commonest fused route: a stereo sample into a stereo output, off-pitch
+        const auto src = signal();
+        std::vector<core::Sample> dst(kSamples, 0.0f);
+        return perf::measure(options, kSamples, [&] { // Per output sample, like the others
+            double phase = 0.0;
+            kernels.interpolateMix(src.data(), core::kernels::MixRoute::PairToPair, kSamples / 2 - 1, phase, 0.9,
+                                   0.5f, dst.data(), 2, kSamples / 2);
+            perf::keep(dst);
+        });
+    }
+
+    // Each kernel runs on every table this CPU supports ("kernels.<isa>.<kernel>"), so the
+    // reference machine also catches regressions in the paths older CPUs fall back to.
+    const bool kernelsRegistered = [] {
+        using Workload = double (*)(const core::kernels::KernelTable&, const perf::RunOptions&);
+        const std::pair<const char*, Workload> workloads[] = {
+            {"gain", &gain}, {"mixAccumulate", &mixAccumulate}, {"toInt16", &toInt16}, {"channelStats", &channelStats},
+            {"interpolateMix", &interpolateMix}};
+        for (const auto* table : core::kernels::available()) {
+            for (const auto& [kernel, workload] : workloads) {
+                perf::registry().push_back({std::string("kernels.") + table->name + "." + kernel, "ns/sample",
+                                            [table, workload = workload](const perf::RunOptions& options) {
+                                                return workload(*table, options);
+                                            },
+                                            true});
+            }
+        }
+        return true;
+    }();
+}
+
+PIPSQUEAK_BENCHMARK("audio_buffer.fillAndGain", "ns/sample") {
+    // Buffers used in turn: consecutive heap blocks start at different offsets within a cache
+    // line, so the timing does not hinge on where the allocator happened to put a single one.
+    std::vector<core::AudioBuffer> buffers;
+    buffers.reserve(4);
+    for (int i = 0; i < 4; ++i)
+        buffers.emplace_back(2, kSamples / 2);
+    size_t next = 0;
+    return perf::measure(options, kSamples, [&] {
+        auto& buffer = buffers[next++ % buffers.size()];
+        buffer.fill(0.25);
+        buffer.applyGain(0.5);
+        perf::keep(buffer);
+    });
+}
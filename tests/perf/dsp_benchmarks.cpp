@@ -0,0 +1,103 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include "perf_harness.hpp"
+#include <pipsqueak/core/audio_buffer.hpp>
+#include <pipsqueak/core/fork_join_pool.hpp>
+#include <pipsqueak/dsp/mixer.hpp>
+#include <pipsqueak/dsp/sampler.hpp>
+#include <memory>
+#include <vector>
+
+using namespace pipsqueak;
+
+namespace {
+    constexpr unsigned kBlockFrames = 256;
+    constexpr unsigned kVoices = 32;
+
+    // A 10 s stereo sample: long enough that no voice runs out inside a timed round
+    std::shared_ptr<const core::AudioBuffer> sample() {
+        static const auto buffer = [] {
+            auto b = std::make_shared<core::AudioBuffer>(2, 480000);
+            for (unsigned f = 0; f < b->numFrames(); ++f) {
+                b->at(0, f) = static_cast<core::Sample>(f % 331) / 331.0f - 0.5f;
+                b->at(1, f) = static_cast<core::Sample>(f % 257) / 257.0f - 0.5f;
+            }
+            return b;
+        }();
+        return buffer;
+    }
+
+    // kVoices samplers, each pitched differently so every voice resamples
+    std::vector<std::shared_ptr<dsp::Sampler>> voices() {
+        std::vector<std::shared_ptr<dsp::Sampler>> samplers;
+        for (unsigned i = 0; i < kVoices; ++i) {
+            auto sampler = std::make_shared<dsp::Sampler>(sample());
+            sampler->setNativeRate(44100.0);
+            sampler->setEngineRate(48000.0);
+            samplers.push_back(std::move(sampler));
+        }
+        return samplers;
+    }
+
+    void retrigger(const std::vector<std::shared_ptr<dsp::Sampler>>& samplers) {
+        for (unsigned i = 0; i < samplers.size(); ++i)
+            samplers[i]->noteOn(48 + static_cast<int>(i % 12), 0.5f);
+    }
+
+    // Renders blocks, retriggering every voice before it can reach the end of the sample
+    template <typename Render>
+    double renderVoices(const perf::RunOptions& options, const std::vector<std::shared_ptr<dsp::Sampler>>& samplers,
+                        Render&& render) {
+        core::AudioBuffer out(2, kBlockFrames);
+        unsigned blocks = 0;
+        retrigger(samplers);
+        return perf::measure(options, static_cast<double>(kBlockFrames) * kVoices, [&] {
+            if (++blocks == 800) {
+                retrigger(samplers);
+                blocks = 0;
+            }
+            out.fill(0.0);
+            render(out);
+            perf::keep(out);
+        });
+    }
+}
+
+PIPSQUEAK_BENCHMARK("sampler.resample", "ns/frame/voice") {
+    const auto samplers = voices();
+    return renderVoices(options, samplers, [&](core::AudioBuffer& out) {
+        for (const auto& sampler : samplers)
+            sampler->process(out);
+    });
+}
+
+PIPSQUEAK_BENCHMARK("mixer.direct", "ns/frame/voice") {
+    const auto samplers = voices();
+    dsp::Mixer mixer;
+    for (const auto& sampler : samplers)
+        mixer.addSource(sampler);
+    return renderVoices(options, samplers, [&](core::AudioBuffer& out) { mixer.process(out); });
+}
+
+PIPSQUEAK_BENCHMARK("mixer.gainAndSends", "ns/frame/voice") {
+    const auto samplers = voices();
+    dsp::Mixer mixer;
+    mixer.addAuxBus("fx", {});
+    for (const auto& sampler : samplers) {
+        mixer.addSource(sampler);
+        mixer.setSourceGain(sampler, 0.8f);
+        mixer.setSend(sampler, "fx", 0.25f);
+    }
+    return renderVoices(options, samplers, [&](core::AudioBuffer& out) { mixer.process(out); });
+}
+
+PIPSQUEAK_BENCHMARK("mixer.deterministic", "ns/frame/voice") {
+    // One thread: the overhead of isolated buffers and fixed-order sums, without scheduling noise
+    const auto samplers = voices();
+    dsp::Mixer mixer;
+    mixer.setRenderPool(std::make_shared<core::ForkJoinPool>(1));
+    for (const auto& sampler : samplers)
+        mixer.addSource(sampler);
+    return renderVoices(options, samplers, [&](core::AudioBuffer& out) { mixer.process(out); });
+}
@@ -0,0 +1,112 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+
+#ifndef PERF_HARNESS_HPP
+#define PERF_HARNESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace pipsqueak::perf {
+    /**
+     * @struct RunOptions
+     * @brief How hard each benchmark is measured.
+     */
+    struct RunOptions {
+        unsigned repetitions{7};                         ///< Timed rounds; the fastest one counts
+        std::chrono::milliseconds roundTime{40};         ///< Minimum duration of one round
+    };
+
+    /**
+     * @struct Benchmark
+     * @brief A fixed workload reporting nanoseconds per unit of work (sample, or frame per voice).
+     */
+    struct Benchmark {
+        std::string name; ///< "<component>.<workload>", the key in the baseline file
+        std::string unit;
+        std::function<double(const RunOptions& options)> run;
+        bool fixedKernels{false}; ///< Runs one named kernel table, not active(): comparable on any host that has it
+    };
+
+    /**
+     * @brief Every benchmark registered with PIPSQUEAK_BENCHMARK, in registration order.
+     */
+    std::vector<Benchmark>& registry();
+
+    struct Registrar {
+        Registrar(const char* name, const char* unit, double (*run)(const RunOptions&)) {
+            registry().push_back({name, unit, run});
+        }
+    };
+
+    /**
+     * @brief Times @p body, which performs @p unitsPerCall units of work per call.
+     * @details Calls are timed in batches long enough (~0.2 ms) that reading the clock costs
+     *          nothing measurable. After a warm-up that sizes the batch, @c repetitions rounds of
+     *          at least @c roundTime each are run and the fastest one is reported: interference
+     *          from the rest of the machine only ever makes a round slower.
+     * @return Nanoseconds per unit.
+     */
+    template <typename Body>
+    double measure(const RunOptions& options, const double unitsPerCall, Body&& body) {
+        using Clock = std::chrono::steady_clock;
+
+        size_t batch = 1;
+        for (;;) {
+            const auto start = Clock::now();
+            for (size_t i = 0; i < batch; ++i)
+                body();
+            if (Clock::now() - start >= std::chrono::microseconds(200) || batch >= (size_t{1} << 24))
+                break;
+            batch *= 2;
+        }
+
+        double best = 0.0;
+        for (unsigned round = 0; round < options.repetitions; ++round) {
+            size_t calls = 0;
+            const auto start = Clock::now();
+            auto elapsed = Clock::duration::zero();
+            do {
+                for (size_t i = 0; i < batch; ++i)
+                    body();
+                calls += batch;
+                elapsed = Clock::now() - start;
+            } while (elapsed < options.roundTime);
+
+            const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+            const double perUnit = ns / (static_cast<double>(calls) * unitsPerCall);
+            best = round == 0 ? perUnit : std::min(best, perUnit);
+        }
+        return best;
+    }
+
+    /**
+     * @brief Keeps the optimiser from discarding a computed result.
+     */
+    template <typename T>
+    void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+}
+
+#define PIPSQUEAK_PERF_CONCAT_(a, b) a##b
+#define PIPSQUEAK_PERF_CONCAT(a, b) PIPSQUEAK_PERF_CONCAT_(a, b)
+
+/// Defines and registers a benchmark: PIPSQUEAK_BENCHMARK("mixer.direct", "ns/frame/voice") { ... return ns; }
+#define PIPSQUEAK_BENCHMARK(name, unit)                                                                 \
+    static double PIPSQUEAK_PERF_CONCAT(benchmark_, __LINE__)(const pipsqueak::perf::RunOptions&);     \
+    static const pipsqueak::perf::Registrar PIPSQUEAK_PERF_CONCAT(registrar_, __LINE__)(                \
+        name, unit, &PIPSQUEAK_PERF_CONCAT(benchmark_, __LINE__));                                       \
+    static double PIPSQUEAK_PERF_CONCAT(benchmark_, __LINE__)(const pipsqueak::perf::RunOptions& options)
+
+#endif //PERF_HARNESS_HPP
@@ -0,0 +1,202 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+// Runs the performance workloads and compares them with a stored baseline.
+//
+//   pipsqueak_perf [--baseline FILE] [--tolerance FRACTION] [--write-baseline FILE]
+//                  [--filter TEXT] [--repetitions N]
+//
+// Exits with 1 if any benchmark is slower than its baseline by more than the tolerance, so
+// ctest reports performance regressions like failing tests. Against a baseline recorded with
+// another kernel table ("# Kernels:" line) only the per-table kernel benchmarks are compared;
+// if nothing at all can be compared it exits with 77, which ctest reports as skipped.
+#include "perf_harness.hpp"
+#include <pipsqueak/core/kernels.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+using namespace pipsqueak;
+
+namespace pipsqueak::perf {
+    std::vector<Benchmark>& registry() {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+}
+
+namespace {
+    constexpr unsigned kRetries = 2;
+    constexpr int kSkipped = 77; // SKIP_RETURN_CODE of the ctest entry
+
+    struct Arguments {
+        std::string baseline;
+        std::string writeBaseline;
+        std::string filter;
+        double tolerance{0.5};
+        perf::RunOptions run;
+    };
+
+    bool parse(const int argc, char** argv, Arguments& args) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string flag = argv[i];
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", flag.c_str());
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (flag == "--baseline") args.baseline = value;
+            else if (flag == "--write-baseline") args.writeBaseline = value;
+            else if (flag == "--filter") args.filter = value;
+            else if (flag == "--tolerance") args.tolerance = std::atof(value.c_str());
+            else if (flag == "--repetitions") args.run.repetitions = static_cast<unsigned>(std::atoi(value.c_str()));
+            else {
+                std::fprintf(stderr, "unknown option %s\n", flag.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // "<name> <ns per unit>" per line; '#' starts a comment. The "# Kernels: <isa>" comment
+    // names the kernel table the timings were taken with (empty if the file has none).
+    bool readBaseline(const std::string& path, std::map<std::string, double>& baseline, std::string& kernels) {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+        const std::string kernelsTag = "# Kernels:";
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.compare(0, kernelsTag.size(), kernelsTag) == 0) {
+                std::istringstream(line.substr(kernelsTag.size())) >> kernels;
+                continue;
+            }
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream fields(line);
+            std::string name;
+            double value = 0.0;
+            if (fields >> name >> value)
+                baseline[name] = value;
+        }
+        return true;
+    }
+
+    bool writeBaseline(const std::string& path, const std::map<std::string, double>& results) {
+        std::ofstream file(path);
+        if (!file)
+            return false;
+        file << "# pipsqueak performance baseline: <benchmark> <ns per unit>\n"
+             << "# Regenerate on the reference machine with a Release build:\n"
+             << "#   pipsqueak_perf --write-baseline tests/perf/baseline.txt\n"
+             << "# Kernels: " << core::kernels::active().name << "\n";
+        for (const auto& [name, value] : results) {
+            char number[32];
+            std::snprintf(number, sizeof(number), "%.4g", value);
+            file << name << ' ' << number << '\n';
+        }
+        return true;
+    }
+}
+
+int main(const int argc, char** argv) {
+    Arguments args;
+    if (!parse(argc, argv, args))
+        return 2;
+
+    std::map<std::string, double> baseline;
+    std::string baselineKernels;
+    if (!args.baseline.empty() && !readBaseline(args.baseline, baseline, baselineKernels)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", args.baseline.c_str());
+        return 2;
+    }
+
+    // Timings taken with another active kernel table say nothing about the benchmarks that use
+    // active(); the per-table ones still compare wherever this CPU has that table.
+    const std::string kernels = core::kernels::active().name;
+    const bool otherKernels = !baselineKernels.empty() && baselineKernels != kernels;
+    if (otherKernels) {
+        std::printf("baseline %s was recorded with %s kernels, this machine runs %s: comparing only the\n"
+                    "per-table kernel benchmarks; record a full baseline here with --write-baseline\n\n",
+                    args.baseline.c_str(), baselineKernels.c_str(), kernels.c_str());
+    }
+
+#ifndef NDEBUG
+    std::printf("warning: assertions are enabled; timings from a Debug build are not comparable\n");
+#endif
+    std::printf("kernels: %s | tolerance: %.0f%%\n\n", core::kernels::active().name, args.tolerance * 100.0);
+    std::printf("%-32s %-16s %10s %10s %9s  %s\n", "benchmark", "unit", "baseline", "measured", "change", "status");
+
+    std::map<std::string, double> results;
+    std::vector<std::string> regressions;
+    size_t compared = 0;
+    size_t skipped = 0;
+    for (const auto& benchmark : perf::registry()) {
+        if (!args.filter.empty() && benchmark.name.find(args.filter) == std::string::npos)
+            continue;
+
+        double measured = benchmark.run(args.run);
+        const bool comparable = !otherKernels || benchmark.fixedKernels;
+        const auto it = comparable ? baseline.find(benchmark.name) : baseline.end();
+
+        // A slow result is re-measured before it counts: one noisy burst must not fail the build.
+        // A new baseline always gets every attempt, so it is as much a best case as the checks.
+        for (unsigned retry = 0; retry < kRetries; ++retry) {
+            const bool suspect = it != baseline.end() && measured / it->second - 1.0 > args.tolerance;
+            if (!suspect && args.writeBaseline.empty())
+                break;
+            measured = std::min(measured, benchmark.run(args.run));
+        }
+        results[benchmark.name] = measured;
+
+        if (it == baseline.end()) {
+            const bool recorded = baseline.count(benchmark.name) != 0;
+            skipped += recorded ? 1 : 0;
+            std::printf("%-32s %-16s %10s %10.4f %9s  %s\n", benchmark.name.c_str(), benchmark.unit.c_str(),
+                        "-", measured, "-", recorded ? "skipped (other kernels)" : baseline.empty() ? "" : "new");
+            continue;
+        }
+        ++compared;
+
+        const double change = measured / it->second - 1.0;
+        const char* status = "ok";
+        if (change > args.tolerance) {
+            status = "REGRESSED";
+            char entry[96];
+            std::snprintf(entry, sizeof(entry), "%s (%+.1f%%)", benchmark.name.c_str(), change * 100.0);
+            regressions.emplace_back(entry);
+        } else if (change < -args.tolerance) {
+            status = "faster (update the baseline?)";
+        }
+        std::printf("%-32s %-16s %10.4f %10.4f %+8.1f%%  %s\n", benchmark.name.c_str(), benchmark.unit.c_str(),
+                    it->second, measured, change * 100.0, status);
+    }
+
+    if (!args.writeBaseline.empty()) {
+        if (!writeBaseline(args.writeBaseline, results)) {
+            std::fprintf(stderr, "cannot write baseline %s\n", args.writeBaseline.c_str());
+            return 2;
+        }
+        std::printf("\nbaseline written to %s\n", args.writeBaseline.c_str());
+    }
+
+    if (regressions.empty()) {
+        if (!baseline.empty() && compared == 0) {
+            std::printf("\nnothing comparable to the baseline: performance check skipped\n");
+            return kSkipped;
+        }
+        std::printf("\nno performance regressions");
+        if (skipped > 0)
+            std::printf(" (%zu of %zu skipped: recorded with other kernels)", skipped, compared + skipped);
+        std::printf("\n");
+        return 0;
+    }
+    std::printf("\n%zu of %zu benchmarks regressed:\n", regressions.size(), results.size());
+    for (const auto& entry : regressions)
+        std::printf("  %s\n", entry.c_str());
+    return 1;
+}
@@ -0,0 +1,334 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/batch_reader.hpp>
+#include <pipsqueak/core/wav_loader.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace pipsqueak::core;
+
+namespace {
+    // Writes a little-endian WAVE file with the given raw sample bytes and, optionally, raw chunks
+    // placed just before and just after the data chunk.
+    void writeWav(const std::string& path, const unsigned channels, const unsigned rate, const unsigned bits,
+                  const bool isFloat, const std::vector<std::uint8_t>& samples,
+                  const std::vector<std::uint8_t>& leading = {}, const std::vector<std::uint8_t>& trailing = {}) {
+        std::ofstream out(path, std::ios::binary);
+        const auto u32 = [&](const std::uint32_t v) { out.write(reinterpret_cast<const char*>(&v), 4); };
+        const auto u16 = [&](const std::uint16_t v) { out.write(reinterpret_cast<const char*>(&v), 2); };
+        const auto raw = [&](const std::vector<std::uint8_t>& bytes) {
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        };
+        out.write("RIFF", 4);
+        u32(static_cast<std::uint32_t>(4 + 8 + 16 + 8 + 8 + 6 + samples.size() + leading.size() + trailing.size()));
+        out.write("WAVE", 4);
+        out.write("fmt ", 4);
+        u32(16);
+        u16(isFloat ? 3 : 1);
+        u16(static_cast<std::uint16_t>(channels));
+        u32(rate);
+        u32(rate * channels * bits / 8);
+        u16(static_cast<std::uint16_t>(channels * bits / 8));
+        u16(static_cast<std::uint16_t>(bits));
+        // An unrelated chunk before the data, as many editors write
+        out.write("LIST", 4);
+        u32(6);
+        out.write("abcdef", 6);
+        raw(leading);
+        out.write("data", 4);
+        u32(static_cast<std::uint32_t>(samples.size()));
+        raw(samples);
+        raw(trailing);
+    }
+
+    // A 'smpl' chunk with the given MIDI unity note and one forward loop (end frame inclusive).
+    std::vector<std::uint8_t> smplChunk(const std::uint32_t unity, const std::uint32_t start, const std::uint32_t end) {
+        std::vector<std::uint8_t> bytes(8 + 36 + 24, 0);
+        const auto put = [&](const size_t at, const std::uint32_t v) { std::memcpy(bytes.data() + at, &v, 4); };
+        std::memcpy(bytes.data(), "smpl", 4);
+        put(4, 36 + 24);
+        put(8 + 12, unity);
+        put(8 + 28, 1); // One loop
+        put(8 + 36 + 8, start);
+        put(8 + 36 + 12, end);
+        return bytes;
+    }
+
+    std::vector<std::uint8_t> pcm16(const std::vector<std::int16_t>& values) {
+        std::vector<std::uint8_t> bytes(values.size() * 2);
+        std::memcpy(bytes.data(), values.data(), bytes.size());
+        return bytes;
+    }
+
+    std::vector<BatchReader::Backend> backends() {
+        return {BatchReader::Backend::Auto, BatchReader::Backend::ThreadPool};
+    }
+}
+
+// Many reads of one file land in the right places on every backend.
+TEST(BatchReaderTest, ReadAllReturnsEveryRange) {
+    const std::string path = ::testing::TempDir() + "batch_reader_ranges.bin";
+    std::vector<std::uint8_t> contents(200000);
+    for (size_t i = 0; i < contents.size(); ++i) contents[i] = static_cast<std::uint8_t>(i * 7 + 3);
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(contents.data()),
+                                                static_cast<std::streamsize>(contents.size()));
+
+    for (const auto backend : backends()) {
+        BatchReader reader({backend, 8, 2, 0});
+        const int fd = BatchReader::openForRead(path, false);
+        ASSERT_GE(fd, 0);
+
+        // More requests than the queue depth, the last one running past the end of the file
+        std::vector<std::vector<std::uint8_t>> destinations(20, std::vector<std::uint8_t>(10000));
+        std::vector<ReadRequest> requests;
+        for (size_t i = 0; i < destinations.size(); ++i)
+            requests.push_back({fd, i * 10000 + 1, destinations[i].data(), 10000, i});
+
+        const auto results = reader.readAll(requests);
+        ASSERT_EQ(results.size(), requests.size());
+        for (const auto& result : results) {
+            const auto i = static_cast<size_t>(result.userData);
+            const size_t expected = std::min<size_t>(10000, contents.size() - (i * 10000 + 1));
+            ASSERT_EQ(result.result, static_cast<std::int64_t>(expected));
+            EXPECT_EQ(std::memcmp(destinations[i].data(), contents.data() + i * 10000 + 1, expected), 0);
+        }
+        EXPECT_EQ(reader.inFlight(), 0u);
+        BatchReader::close(fd);
+    }
+}
+
+// Reads into the registered arena are served correctly, and errors come back as -errno.
+TEST(BatchReaderTest, ArenaReadsAndErrors) {
+    const std::string path = ::testing::TempDir() + "batch_reader_arena.bin";
+    std::vector<std::uint8_t> contents(3 * BatchReader::kDirectAlignment);
+    for (size_t i = 0; i < contents.size(); ++i) contents[i] = static_cast<std::uint8_t>(i ^ 0x5A);
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(contents.data()),
+                                                static_cast<std::streamsize>(contents.size()));
+
+    for (const auto backend : backends()) {
+        BatchReader reader({backend, 4, 1, 1u << 16});
+        ASSERT_NE(reader.arena(), nullptr);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(reader.arena()) % BatchReader::kDirectAlignment, 0u);
+
+        const int fd = BatchReader::openForRead(path, true);
+        ASSERT_GE(fd, 0);
+        auto* arena = static_cast<std::uint8_t*>(reader.arena());
+        const std::vector<ReadRequest> requests{
+            {fd, 0, arena, contents.size(), 1},
+            {-1, 0, arena + contents.size(), 16, 2},
+        };
+        for (const auto& result : reader.readAll(requests)) {
+            if (result.userData == 1) {
+                ASSERT_EQ(result.result, static_cast<std::int64_t>(contents.size()));
+                EXPECT_EQ(std::memcmp(arena, contents.data(), contents.size()), 0);
+            } else {
+                EXPECT_LT(result.result, 0);
+            }
+        }
+        BatchReader::close(fd);
+    }
+}
+
+// A read that returns short before end of file is continued, not reported short (io_uring only:
+// pread cannot read a pipe).
+TEST(BatchReaderTest, ShortReadsAreContinued) {
+    BatchReader reader({BatchReader::Backend::Auto, 4, 1, 0});
+    if (reader.backend() != BatchReader::Backend::IoUring)
+        GTEST_SKIP() << "io_uring unavailable";
+
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    const std::string first(100, 'a'), second(100, 'b');
+    ASSERT_EQ(::write(fds[1], first.data(), first.size()), 100);
+
+    // The first chunk completes the read short; the rest arrives once it has been submitted again
+    std::vector<char> destination(200);
+    ASSERT_EQ(reader.submit(std::vector<ReadRequest>{{fds[0], 0, destination.data(), 200, 7}}.data(), 1), 1u);
+    std::thread writer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_EQ(::write(fds[1], second.data(), second.size()), 100);
+        ::close(fds[1]);
+    });
+
+    ReadResult result;
+    ASSERT_EQ(reader.reap(&result, 1, true), 1u);
+    writer.join();
+    EXPECT_EQ(result.userData, 7u);
+    EXPECT_EQ(result.result, 200);
+    EXPECT_EQ(std::string(destination.data(), 200), first + second);
+    EXPECT_EQ(reader.inFlight(), 0u);
+    ::close(fds[0]);
+}
+
+// The header parser accepts PCM and float and rejects anything else.
+TEST(WavLoaderTest, ParsesHeaders) {
+    const std::string path = ::testing::TempDir() + "wav_header.wav";
+    writeWav(path, 2, 44100, 16, false, pcm16({1, 2, 3, 4}));
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    const auto info = parseWavHeader(bytes.data(), bytes.size());
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->channels, 2u);
+    EXPECT_EQ(info->sampleRate, 44100u);
+    EXPECT_EQ(info->bitsPerSample, 16u);
+    EXPECT_FALSE(info->isFloat);
+    EXPECT_EQ(info->dataOffset, bytes.size() - 8);
+    EXPECT_EQ(info->dataBytes, 8u);
+
+    EXPECT_EQ(info->unityNote, -1);
+    EXPECT_EQ(info->loopEnd, 0u);
+
+    bytes[8] = 'X'; // Not WAVE
+    EXPECT_FALSE(parseWavHeader(bytes.data(), bytes.size()).has_value());
+}
+
+// 'smpl' unity notes and loops are picked up before the data, after it within the header read,
+// and after it beyond the header read.
+TEST(WavLoaderTest, ReadsSamplerChunks) {
+    const std::string dir = ::testing::TempDir();
+    writeWav(dir + "smpl_lead.wav", 1, 44100, 16, false, pcm16(std::vector<std::int16_t>(100)),
+             smplChunk(62, 10, 49));
+    writeWav(dir + "smpl_tail.wav", 1, 44100, 16, false, pcm16(std::vector<std::int16_t>(100)), {},
+             smplChunk(64, 0, 99));
+    writeWav(dir + "smpl_far.wav", 1, 44100, 16, false, pcm16(std::vector<std::int16_t>(50000)), {},
+             smplChunk(70, 1000, 48999));
+    writeWav(dir + "smpl_bad.wav", 1, 44100, 16, false, pcm16(std::vector<std::int16_t>(100)), {},
+             smplChunk(200, 50, 500)); // Unity note out of range, loop past the end
+
+    std::ifstream in(dir + "smpl_lead.wav", std::ios::binary);
+    const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const auto info = parseWavHeader(bytes.data(), bytes.size());
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->unityNote, 62);
+    EXPECT_EQ(info->loopStart, 10u);
+    EXPECT_EQ(info->loopEnd, 50u);
+
+    for (const auto backend : backends()) {
+        BatchReader reader({backend, 4, 1, 0});
+        const auto loaded = loadWavFiles(
+            reader, {dir + "smpl_lead.wav", dir + "smpl_tail.wav", dir + "smpl_far.wav", dir + "smpl_bad.wav"});
+        ASSERT_EQ(loaded.size(), 4u);
+        for (const auto& sample : loaded) ASSERT_TRUE(sample.error.empty()) << sample.path << ": " << sample.error;
+
+        EXPECT_EQ(loaded[0].unityNote, 62);
+        EXPECT_EQ(loaded[0].loopStart, 10u);
+        EXPECT_EQ(loaded[0].loopEnd, 50u);
+        EXPECT_EQ(loaded[1].unityNote, 64);
+        EXPECT_EQ(loaded[1].loopEnd, 100u);
+        EXPECT_EQ(loaded[2].unityNote, 70);
+        EXPECT_EQ(loaded[2].loopStart, 1000u);
+        EXPECT_EQ(loaded[2].loopEnd, 49000u);
+        EXPECT_EQ(loaded[2].buffer->numFrames(), 50000u);
+        EXPECT_EQ(loaded[3].unityNote, -1);
+        EXPECT_EQ(loaded[3].loopEnd, 0u);
+    }
+}
+
+// Several files in mixed formats load in one call, chunked across many reads, into the store.
+TEST(WavLoaderTest, LoadsManyFilesIntoStore) {
+    const std::string dir = ::testing::TempDir();
+
+    // 16-bit stereo ramp, long enough to span many chunks
+    std::vector<std::int16_t> ramp(2 * 30000);
+    for (size_t i = 0; i < ramp.size(); ++i) ramp[i] = static_cast<std::int16_t>(static_cast<int>(i % 2000) - 1000);
+    writeWav(dir + "load_a.wav", 2, 48000, 16, false, pcm16(ramp));
+
+    // float mono
+    std::vector<float> tone(12345);
+    for (size_t i = 0; i < tone.size(); ++i) tone[i] = static_cast<float>(i) / 12345.0f;
+    std::vector<std::uint8_t> floats(tone.size() * 4);
+    std::memcpy(floats.data(), tone.data(), floats.size());
+    writeWav(dir + "load_b.wav", 1, 44100, 32, true, floats);
+
+    // 24-bit mono: +max, -1, -max
+    writeWav(dir + "load_c.wav", 1, 96000, 24, false, {0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x80});
+
+    const std::vector<std::string> paths{dir + "load_a.wav", dir + "load_b.wav", dir + "missing.wav",
+                                         dir + "load_c.wav"};
+
+    for (const auto backend : backends()) {
+        for (const bool direct : {false, true}) {
+            BatchReader reader({backend, 6, 2, 1u << 20});
+            BufferStore store(16);
+            WavLoadOptions options;
+            options.chunkBytes = 10000; // Not frame or page aligned on purpose
+            options.direct = direct;
+
+            const auto loaded = loadWavFiles(reader, paths, &store, options);
+            ASSERT_EQ(loaded.size(), paths.size());
+
+            ASSERT_TRUE(loaded[0].error.empty()) << loaded[0].error;
+            EXPECT_EQ(loaded[0].sampleRate, 48000u);
+            const auto a = store.get(loaded[0].key);
+            ASSERT_EQ(a, loaded[0].buffer);
+            ASSERT_EQ(a->numChannels(), 2u);
+            ASSERT_EQ(a->numFrames(), 30000u);
+            for (size_t i = 0; i < ramp.size(); ++i)
+                ASSERT_FLOAT_EQ(a->data()[i], static_cast<float>(ramp[i]) / 32768.0f) << i;
+
+            ASSERT_TRUE(loaded[1].error.empty()) << loaded[1].error;
+            const auto& b = *loaded[1].buffer;
+            ASSERT_EQ(b.numFrames(), tone.size());
+            EXPECT_EQ(std::memcmp(b.dataPtr(), tone.data(), floats.size()), 0);
+
+            EXPECT_FALSE(loaded[2].error.empty());
+            EXPECT_EQ(loaded[2].buffer, nullptr);
+
+            ASSERT_TRUE(loaded[3].error.empty()) << loaded[3].error;
+            const auto& c = *loaded[3].buffer;
+            ASSERT_EQ(c.numFrames(), 3u);
+            EXPECT_FLOAT_EQ(c.data()[0], 8388607.0f / 8388608.0f);
+            EXPECT_FLOAT_EQ(c.data()[1], -1.0f / 8388608.0f);
+            EXPECT_FLOAT_EQ(c.data()[2], -1.0f + 1.0f / 8388608.0f);
+            EXPECT_EQ(reader.inFlight(), 0u);
+        }
+    }
+}
+
+// Without a store the loader still returns the buffers.
+TEST(WavLoaderTest, LoadsWithoutStore) {
+    const std::string path = ::testing::TempDir() + "load_plain.wav";
+    writeWav(path, 1, 22050, 16, false, pcm16({-32768, 0, 16384}));
+
+    BatchReader reader;
+    const auto loaded = loadWavFiles(reader, {path});
+    ASSERT_EQ(loaded.size(), 1u);
+    ASSERT_TRUE(loaded[0].error.empty()) << loaded[0].error;
+    ASSERT_EQ(loaded[0].buffer->numFrames(), 3u);
+    EXPECT_FLOAT_EQ(loaded[0].buffer->data()[0], -1.0f);
+    EXPECT_FLOAT_EQ(loaded[0].buffer->data()[1], 0.0f);
+    EXPECT_FLOAT_EQ(loaded[0].buffer->data()[2], 0.5f);
+}
+
+// A reader with reads in flight is refused rather than having its completions taken over.
+TEST(WavLoaderTest, RefusesBusyReader) {
+    const std::string path = ::testing::TempDir() + "load_busy.wav";
+    writeWav(path, 1, 22050, 16, false, pcm16({1, 2, 3}));
+
+    BatchReader reader;
+    const int fd = BatchReader::openForRead(path, false);
+    ASSERT_GE(fd, 0);
+    std::vector<std::uint8_t> destination(16);
+    ASSERT_EQ(reader.submit(std::vector<ReadRequest>{{fd, 0, destination.data(), 16, 42}}.data(), 1), 1u);
+
+    const auto loaded = loadWavFiles(reader, {path});
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded[0].error, "reader is busy");
+    EXPECT_EQ(loaded[0].buffer, nullptr);
+
+    // The caller's own read is untouched.
+    ReadResult result{};
+    ASSERT_EQ(reader.reap(&result, 1, true), 1u);
+    EXPECT_EQ(result.userData, 42u);
+    EXPECT_EQ(result.result, 16);
+    BatchReader::close(fd);
+}
@@ -3,6 +3,8 @@
 //
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
 
 #include <pipsqueak/core/buffer_store.hpp>
 #include <pipsqueak/core/audio_buffer.hpp>
@@ -106,4 +108,254 @@ TEST_F(BufferStoreTest, ConcurrentInsertsAreThreadSafe) {
     // Verify that all insertions were successful by checking the final ID.
     const size_t finalKey = store->insert(finalBuffer);
     ASSERT_EQ(finalKey, numThreads);
-}
\ No newline at end of file
+}
+
+// Test that load-time transient analysis is cached alongside the entry.
+TEST_F(BufferStoreTest, InsertWithAnalysisCachesTransients) {
+    const auto buffer = std::make_shared<pipsqueak::core::AudioBuffer>(1, 4096);
+    for (unsigned f = 2048; f < 2112; ++f) {
+        buffer->at(0, f) = 0.8f;
+    }
+
+    const size_t plainKey = store->insert(buffer);
+    const size_t analyzedKey = store->insert(buffer, {true});
+
+    // Only the analysed entry carries a transient map
+    ASSERT_EQ(store->transients(plainKey), nullptr);
+    const auto map = store->transients(analyzedKey);
+    ASSERT_NE(map, nullptr);
+    ASSERT_EQ(map->onsets.size(), 1u);
+    EXPECT_EQ(map->onsets[0], 2048u);
+
+    // Erasing the entry drops the analysis with it
+    ASSERT_TRUE(store->erase(analyzedKey));
+    EXPECT_EQ(store->transients(analyzedKey), nullptr);
+}
+
+// Buffers inserted under a placement policy report their pages on the requested node.
+TEST_F(BufferStoreTest, InsertAppliesPlacementPolicy) {
+    using pipsqueak::core::PlacementPolicy;
+
+    PlacementPolicy policy;
+    policy.node = PlacementPolicy::kCallerNode;
+    policy.hugePages = pipsqueak::core::HugePages::Transparent;
+    store->setPlacementPolicy(policy);
+
+    const auto buffer = std::make_shared<pipsqueak::core::AudioBuffer>(2, 1u << 18); // 2 MiB
+    const size_t key = store->insert(buffer);
+
+    const auto report = store->placement(key);
+    EXPECT_EQ(report.bytes, buffer->data().size() * sizeof(float));
+    if (!report.supported)
+        GTEST_SKIP() << "Placement reporting is not available on this platform";
+
+    const int node = pipsqueak::core::placement::currentNode();
+    ASSERT_LT(static_cast<size_t>(node), report.pagesPerNode.size());
+    EXPECT_EQ(report.pagesPerNode[node] + report.nonResidentPages, report.pages);
+
+    EXPECT_EQ(store->placement(12345).bytes, 0u);
+}
+
+// Sample metadata is computed inline, on the background worker, or taken as given.
+TEST_F(BufferStoreTest, InsertAttachesSampleMetadata) {
+    const auto buffer = std::make_shared<pipsqueak::core::AudioBuffer>(1, 2000);
+    for (unsigned f = 500; f < 2000; ++f) {
+        buffer->at(0, f) = 0.25f;
+    }
+
+    pipsqueak::core::BufferStore::InsertOptions inline_;
+    inline_.analyzeSample = true;
+    const size_t inlineKey = store->insert(buffer, inline_);
+    const auto meta = store->metadata(inlineKey);
+    ASSERT_NE(meta, nullptr);
+    EXPECT_FLOAT_EQ(meta->peak, 0.25f);
+    EXPECT_EQ(meta->leadingSilence, 500u);
+    EXPECT_EQ(store->metadata(store->insert(buffer)), nullptr);
+
+    pipsqueak::core::BufferStore::InsertOptions background = inline_;
+    background.analyzeInBackground = true;
+    std::vector<size_t> keys;
+    for (int i = 0; i < 20; ++i) keys.push_back(store->insert(buffer, background));
+    store->erase(keys[3]); // Erased before its analysis lands: dropped quietly
+    store->waitForAnalysis();
+    for (const size_t key : keys) {
+        const auto m = store->metadata(key);
+        if (key == keys[3]) {
+            EXPECT_EQ(m, nullptr);
+        } else {
+            ASSERT_NE(m, nullptr);
+            EXPECT_EQ(m->leadingSilence, 500u);
+        }
+    }
+
+    pipsqueak::core::BufferStore::InsertOptions given;
+    given.analyzeSample = true;
+    given.metadata = std::make_shared<const pipsqueak::core::SampleMetadata>();
+    EXPECT_EQ(store->metadata(store->insert(buffer, given)), given.metadata);
+}
+
+// Overviews are built on insert or attached as given, and shared with the caller.
+TEST_F(BufferStoreTest, InsertAttachesWaveformOverview) {
+    const auto buffer = std::make_shared<pipsqueak::core::AudioBuffer>(1, 1000);
+    buffer->at(0, 700) = -0.5f;
+
+    pipsqueak::core::BufferStore::InsertOptions options;
+    options.buildOverview = true;
+    const auto overview = store->overview(store->insert(buffer, options));
+    ASSERT_NE(overview, nullptr);
+    pipsqueak::core::WaveformOverview::Column column;
+    ASSERT_EQ(overview->query(0, 0, 1000, &column, 1), 1u);
+    EXPECT_EQ(column.min, -0.5f);
+    EXPECT_EQ(store->overview(store->insert(buffer)), nullptr);
+
+    pipsqueak::core::BufferStore::InsertOptions live;
+    live.overview = std::make_shared<pipsqueak::core::WaveformOverview>(1);
+    const size_t key = store->insert(buffer, live);
+    live.overview->append(buffer->dataPtr(), 1000);
+    EXPECT_EQ(store->overview(key)->frames(), 1000u);
+}
+
+// Batched calls behave like their single-key counterparts.
+TEST_F(BufferStoreTest, BatchInsertGetErase) {
+    std::vector<std::shared_ptr<const pipsqueak::core::AudioBuffer>> buffers;
+    for (unsigned i = 1; i <= 50; ++i) {
+        buffers.push_back(std::make_shared<pipsqueak::core::AudioBuffer>(1, i));
+    }
+
+    store->reserve(64);
+    const auto keys = store->insertBatch(buffers, {});
+    ASSERT_EQ(keys.size(), 50u);
+    EXPECT_EQ(store->size(), 50u);
+
+    auto lookup = keys;
+    lookup.push_back(999);
+    const auto found = store->getBatch(lookup);
+    ASSERT_EQ(found.size(), 51u);
+    for (size_t i = 0; i < 50; ++i) {
+        EXPECT_EQ(found[i], buffers[i]);
+    }
+    EXPECT_EQ(found[50], nullptr);
+
+    EXPECT_EQ(store->eraseBatch({keys[0], keys[1], keys[1], 999}), 2u);
+    EXPECT_EQ(store->get(keys[0]), nullptr);
+    EXPECT_EQ(store->size(), 48u);
+}
+
+// Tagged entries can be listed and unloaded together.
+TEST_F(BufferStoreTest, EraseTagUnloadsGroup) {
+    using pipsqueak::core::BufferStore;
+    const auto buffer = std::make_shared<pipsqueak::core::AudioBuffer>(1, 10);
+
+    BufferStore::InsertOptions piano;
+    piano.tag = "piano";
+    BufferStore::InsertOptions drums;
+    drums.tag = "drums";
+    const auto pianoKeys = store->insertBatch({buffer, buffer, buffer}, piano);
+    const auto drumKeys = store->insertBatch({{buffer, drums}, {buffer, drums}, {buffer, {}}});
+    const size_t single = store->insert(buffer, piano);
+
+    auto listed = store->tagged("piano");
+    std::sort(listed.begin(), listed.end());
+    EXPECT_EQ(listed, (std::vector<size_t>{pianoKeys[0], pianoKeys[1], pianoKeys[2], single}));
+
+    // Erasing one member keeps the tag index consistent
+    ASSERT_TRUE(store->erase(pianoKeys[1]));
+    EXPECT_EQ(store->eraseTag("piano"), 3u);
+    EXPECT_EQ(store->eraseTag("piano"), 0u);
+    EXPECT_TRUE(store->tagged("piano").empty());
+    EXPECT_EQ(store->get(single), nullptr);
+
+    EXPECT_EQ(store->tagged("drums").size(), 2u);
+    EXPECT_NE(store->get(drumKeys[2]), nullptr);
+    EXPECT_EQ(store->size(), 3u);
+}
+
+// Counters, snapshots and the eviction history track what the store holds and who else does.
+TEST_F(BufferStoreTest, MemoryAccounting) {
+    using pipsqueak::core::BufferStore;
+    constexpr size_t bytes = 2 * 1000 * sizeof(float);
+
+    BufferStore::InsertOptions piano;
+    piano.tag = "piano";
+    const auto held = std::make_shared<pipsqueak::core::AudioBuffer>(2, 1000); // Kept by this test, like a voice would
+    const auto keys = store->insertBatch({held, std::make_shared<pipsqueak::core::AudioBuffer>(2, 1000)}, piano);
+    const size_t loose = store->insert(std::make_shared<pipsqueak::core::AudioBuffer>(2, 1000));
+
+    auto usage = store->usage();
+    EXPECT_EQ(usage.entries, 3u);
+    EXPECT_EQ(usage.bytes, 3 * bytes);
+    EXPECT_EQ(store->tagUsage("piano").bytes, 2 * bytes);
+    EXPECT_EQ(store->tagUsage("piano").entries, 2u);
+    EXPECT_EQ(store->tagUsage("organ").bytes, 0u);
+
+    const auto snapshot = store->snapshot();
+    ASSERT_EQ(snapshot.entries.size(), 3u);
+    EXPECT_EQ(snapshot.bytes, 3 * bytes);
+    EXPECT_EQ(snapshot.referencedBytes, bytes);
+    EXPECT_EQ(snapshot.storeOnlyBytes, 2 * bytes);
+    for (const auto& info : snapshot.entries) {
+        EXPECT_EQ(info.references, info.key == keys[0] ? 1 : 0);
+        EXPECT_EQ(info.tag, info.key == loose ? "" : "piano");
+        EXPECT_EQ(info.frames, 1000u);
+    }
+
+    ASSERT_TRUE(store->erase(loose));
+    EXPECT_EQ(store->eraseTag("piano"), 2u);
+    usage = store->usage();
+    EXPECT_EQ(usage.entries, 0u);
+    EXPECT_EQ(usage.bytes, 0u);
+    EXPECT_EQ(usage.evictions, 3u);
+    EXPECT_EQ(usage.evictedBytes, 3 * bytes);
+
+    const auto history = store->evictions();
+    ASSERT_EQ(history.size(), 3u);
+    EXPECT_EQ(history[0].key, loose);
+    EXPECT_EQ(history[0].cause, BufferStore::EvictionCause::Erased);
+    EXPECT_EQ(history[1].cause, BufferStore::EvictionCause::TagErased);
+    EXPECT_EQ(history[1].tag, "piano");
+    for (const auto& record : history) {
+        EXPECT_EQ(record.stillReferenced, record.key == keys[0]);
+    }
+}
+
+// Pointers handed out by get() move bytes between store-only and referenced without a lock.
+TEST_F(BufferStoreTest, LockFreeReferenceCounters) {
+    constexpr size_t bytes = 2 * 1000 * sizeof(float);
+    pipsqueak::core::BufferStore::InsertOptions drums;
+    drums.tag = "drums";
+    const size_t kick = store->insert(std::make_shared<pipsqueak::core::AudioBuffer>(2, 1000), drums);
+    const size_t snare = store->insert(std::make_shared<pipsqueak::core::AudioBuffer>(2, 1000), drums);
+
+    auto usage = store->usage();
+    EXPECT_EQ(usage.referencedBytes, 0u);
+    EXPECT_EQ(usage.storeOnlyBytes, 2 * bytes);
+
+    // Two voices share one pointer chain: the entry is counted once, until the last copy goes
+    auto voiceA = store->get(kick);
+    auto voiceB = voiceA;
+    auto other = store->getBatch({kick})[0];
+    EXPECT_EQ(store->usage().referencedBytes, bytes);
+    voiceA.reset();
+    other.reset();
+    EXPECT_EQ(store->usage().referencedBytes, bytes);
+    voiceB.reset();
+    EXPECT_EQ(store->usage().referencedBytes, 0u);
+
+    // An entry erased while referenced leaves the totals at once; the late release changes nothing
+    auto playing = store->get(snare);
+    EXPECT_EQ(store->usage().storeOnlyBytes, bytes);
+    ASSERT_TRUE(store->erase(snare));
+    usage = store->usage();
+    EXPECT_EQ(usage.referencedBytes, 0u);
+    EXPECT_EQ(usage.storeOnlyBytes, bytes);
+    EXPECT_EQ(store->tagUsage("drums").entries, 1u);
+    EXPECT_EQ(store->tagUsage("drums").bytes, bytes);
+    playing.reset();
+    EXPECT_EQ(store->usage().referencedBytes, 0u);
+
+    // A pointer may outlive the store itself
+    auto survivor = store->get(kick);
+    store.reset();
+    EXPECT_EQ(survivor->numFrames(), 1000u);
+    survivor.reset();
+}
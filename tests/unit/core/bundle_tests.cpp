@@ -0,0 +1,177 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/bundle.hpp>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace pipsqueak::core;
+
+namespace {
+    std::shared_ptr<AudioBuffer> makeRamp(const unsigned channels, const unsigned frames, const float scale) {
+        auto buffer = std::make_shared<AudioBuffer>(channels, frames);
+        for (size_t i = 0; i < buffer->data().size(); ++i)
+            buffer->data()[i] = scale * std::sin(static_cast<float>(i) * 0.01f);
+        return buffer;
+    }
+
+    // Overwrites a little-endian u64 field in a serialised bundle.
+    void patchU64(std::string& bytes, const size_t at, const std::uint64_t value) {
+        for (size_t b = 0; b < 8; ++b)
+            bytes[at + b] = static_cast<char>((value >> (8 * b)) & 0xff);
+    }
+}
+
+// Float32 bundles round-trip every sample and every metadata field exactly.
+TEST(BundleTest, Float32RoundTrip) {
+    const std::string path = ::testing::TempDir() + "roundtrip.bundle";
+    const auto a = makeRamp(2, 5000, 0.8f);
+    const auto b = makeRamp(1, 123, 0.25f);
+
+    BundleWriter writer;
+    writer.add({"kick", a, 48000, 36, 100, 4000, -1.0f});
+    writer.add({"hat", b, 44100, 42, 0, 0, -1.0f});
+    ASSERT_EQ(writer.count(), 2u);
+    ASSERT_TRUE(writer.write(path));
+
+    std::string error;
+    const auto bundle = Bundle::open(path, &error);
+    ASSERT_NE(bundle, nullptr) << error;
+    ASSERT_EQ(bundle->count(), 2u);
+
+    const BundleEntry& kick = bundle->entry(0);
+    EXPECT_EQ(kick.name, "kick");
+    EXPECT_EQ(kick.channels, 2u);
+    EXPECT_EQ(kick.frames, 5000u);
+    EXPECT_EQ(kick.sampleRate, 48000u);
+    EXPECT_EQ(kick.rootNote, 36);
+    EXPECT_TRUE(kick.hasLoop());
+    EXPECT_EQ(kick.loopStart, 100u);
+    EXPECT_EQ(kick.loopEnd, 4000u);
+    EXPECT_NEAR(kick.peak, 0.8f, 1e-3f);
+    EXPECT_FALSE(bundle->entry(1).hasLoop());
+
+    ASSERT_EQ(bundle->find("hat"), std::optional<size_t>(1));
+    EXPECT_FALSE(bundle->find("snare").has_value());
+
+    const auto loaded = bundle->load(0);
+    ASSERT_EQ(loaded->data(), a->data());
+    EXPECT_EQ(bundle->load(1)->data(), b->data());
+
+    // The writer's analysis travels with the entry
+    ASSERT_NE(kick.metadata, nullptr);
+    const auto fresh = analyzeSample(*a, {1.0e-4f, 100, 4000, 256});
+    EXPECT_EQ(kick.metadata->rms, fresh.rms);
+    EXPECT_EQ(kick.metadata->leadingSilence, fresh.leadingSilence);
+    EXPECT_EQ(kick.metadata->loopEndCrossing, fresh.loopEndCrossing);
+}
+
+// Int16 bundles are half the size and scale by the peak, so quiet samples keep their precision.
+TEST(BundleTest, Int16IsScaledByPeak) {
+    const std::string floatPath = ::testing::TempDir() + "quiet_f32.bundle";
+    const std::string intPath = ::testing::TempDir() + "quiet_i16.bundle";
+    const auto quiet = makeRamp(1, 100000, 0.01f);
+
+    BundleWriter f32;
+    f32.add({"quiet", quiet, 44100, 60, 0, 0, -1.0f});
+    ASSERT_TRUE(f32.write(floatPath));
+    BundleWriter i16(SampleEncoding::Int16);
+    i16.add({"quiet", quiet, 44100, 60, 0, 0, -1.0f});
+    ASSERT_TRUE(i16.write(intPath));
+
+    const auto size = [](const std::string& p) {
+        return static_cast<size_t>(std::ifstream(p, std::ios::binary | std::ios::ate).tellg());
+    };
+    EXPECT_LT(size(intPath), size(floatPath) * 6 / 10);
+
+    const auto bundle = Bundle::open(intPath);
+    ASSERT_NE(bundle, nullptr);
+    EXPECT_EQ(bundle->entry(0).encoding, SampleEncoding::Int16);
+    const auto loaded = bundle->load(0);
+    ASSERT_EQ(loaded->numFrames(), quiet->numFrames());
+    for (size_t i = 0; i < quiet->data().size(); ++i)
+        ASSERT_NEAR(loaded->data()[i], quiet->data()[i], 0.01f / 32767.0f) << i;
+}
+
+// Every entry lands in the store under the returned key.
+TEST(BundleTest, RegistersIntoStore) {
+    const std::string path = ::testing::TempDir() + "store.bundle";
+    BundleWriter writer;
+    for (int i = 0; i < 5; ++i)
+        writer.add({"s" + std::to_string(i), makeRamp(1, 1000 + i, 0.5f), 44100, 60 + i, 0, 0, -1.0f});
+    ASSERT_TRUE(writer.write(path));
+
+    const auto bundle = Bundle::open(path);
+    ASSERT_NE(bundle, nullptr);
+    BufferStore store(16);
+    const auto keys = bundle->registerInto(store);
+    ASSERT_EQ(keys.size(), 5u);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const auto buffer = store.get(keys[i]);
+        ASSERT_NE(buffer, nullptr);
+        EXPECT_EQ(buffer->numFrames(), 1000u + i);
+        EXPECT_EQ(store.metadata(keys[i]), bundle->entry(i).metadata); // Attached, not recomputed
+    }
+}
+
+// Missing, foreign and truncated files are rejected with a reason.
+TEST(BundleTest, RejectsBadFiles) {
+    std::string error;
+    EXPECT_EQ(Bundle::open(::testing::TempDir() + "no_such.bundle", &error), nullptr);
+    EXPECT_FALSE(error.empty());
+
+    const std::string foreign = ::testing::TempDir() + "foreign.bundle";
+    std::ofstream(foreign, std::ios::binary) << std::string(100, 'x');
+    error.clear();
+    EXPECT_EQ(Bundle::open(foreign, &error), nullptr);
+    EXPECT_FALSE(error.empty());
+
+    const std::string good = ::testing::TempDir() + "truncate.bundle";
+    BundleWriter writer;
+    writer.add({"long", makeRamp(2, 20000, 0.5f), 44100, 60, 0, 0, -1.0f});
+    ASSERT_TRUE(writer.write(good));
+    std::ifstream in(good, std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::string cut = ::testing::TempDir() + "truncated.bundle";
+    std::ofstream(cut, std::ios::binary) << bytes.substr(0, bytes.size() / 2);
+    error.clear();
+    EXPECT_EQ(Bundle::open(cut, &error), nullptr);
+    EXPECT_FALSE(error.empty());
+
+    // Loops outside the sample are refused at write time.
+    EXPECT_THROW(writer.add({"bad", makeRamp(1, 10, 0.5f), 44100, 60, 0, 50, -1.0f}), std::invalid_argument);
+}
+
+// Header and record ranges chosen to wrap around 2^64 are rejected instead of read out of bounds.
+TEST(BundleTest, RejectsWrappingRanges) {
+    const std::string good = ::testing::TempDir() + "wrap_source.bundle";
+    BundleWriter writer;
+    writer.add({"wrap", makeRamp(1, 100, 0.5f), 44100, 60, 0, 0, -1.0f});
+    ASSERT_TRUE(writer.write(good));
+    std::ifstream in(good, std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ASSERT_NE(Bundle::open(good), nullptr);
+
+    // Header: index offset at 16, names offset at 24, names size at 32. The single record
+    // starts at 64 with its data offset.
+    const std::uint64_t top = ~std::uint64_t{0};
+    const std::vector<std::pair<size_t, std::uint64_t>> patches = {
+        {16, top - 31},         // index offset + record size wraps to a small number
+        {32, top - 63},         // names offset + names size wraps
+        {64, top - 4095},       // block offset (still aligned) + block size wraps
+    };
+    for (const auto& [at, value] : patches) {
+        std::string crafted = bytes;
+        patchU64(crafted, at, value);
+        const std::string path = ::testing::TempDir() + "wrap.bundle";
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << crafted;
+
+        std::string error;
+        EXPECT_EQ(Bundle::open(path, &error), nullptr) << "field at " << at;
+        EXPECT_FALSE(error.empty());
+    }
+}
@@ -0,0 +1,124 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/command_bus.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace pipsqueak;
+
+namespace {
+    // Appends the command's arg to the vector in target.
+    void record(core::Command& c) {
+        static_cast<std::vector<int>*>(c.target)->push_back(c.arg);
+    }
+
+    // Counts retirements in the atomic in payload.
+    void countRetire(core::Command& c) {
+        static_cast<std::atomic<int>*>(c.payload)->fetch_add(1);
+    }
+
+    core::Command recordCommand(std::vector<int>& log, const int value, std::atomic<int>* retired = nullptr) {
+        core::Command c;
+        c.apply = &record;
+        c.retire = retired ? &countRetire : nullptr;
+        c.target = &log;
+        c.payload = retired;
+        c.arg = value;
+        return c;
+    }
+}
+
+// Commands apply in posting order and sequence numbers track completion.
+TEST(CommandBusTest, AppliesInOrderAndReportsCompletion) {
+    core::CommandBus bus(8);
+    std::vector<int> log;
+
+    const auto first = bus.post(recordCommand(log, 1));
+    const auto second = bus.post(recordCommand(log, 2));
+    EXPECT_EQ(second, first + 1);
+    EXPECT_FALSE(bus.isComplete(first));
+
+    EXPECT_EQ(bus.drain(16), 2u);
+    EXPECT_EQ(log, (std::vector<int>{1, 2}));
+    EXPECT_TRUE(bus.isComplete(second));
+}
+
+// A full queue rejects posts instead of blocking or allocating.
+TEST(CommandBusTest, RejectsWhenFull) {
+    core::CommandBus bus(4);
+    std::vector<int> log;
+    for (int i = 0; i < 4; ++i) ASSERT_NE(bus.post(recordCommand(log, i)), 0u);
+    EXPECT_EQ(bus.post(recordCommand(log, 99)), 0u);
+
+    bus.drain(1);
+    EXPECT_NE(bus.post(recordCommand(log, 4)), 0u);
+}
+
+// The budget caps work per block, but never splits a transaction.
+TEST(CommandBusTest, BudgetKeepsTransactionsWhole) {
+    core::CommandBus bus(16);
+    std::vector<int> log;
+
+    bus.post(recordCommand(log, 0));
+    core::Transaction tx(bus);
+    tx.add(recordCommand(log, 1)).add(recordCommand(log, 2)).add(recordCommand(log, 3));
+    ASSERT_NE(tx.commit(), 0u);
+
+    EXPECT_EQ(bus.drain(2), 1u); // The transaction does not fit after the first command
+    EXPECT_EQ(log, (std::vector<int>{0}));
+    EXPECT_EQ(bus.drain(2), 3u); // Alone at the head, it is applied despite exceeding the budget
+    EXPECT_EQ(log, (std::vector<int>{0, 1, 2, 3}));
+}
+
+// Retire hooks run on collect(), and for unapplied commands when the bus is destroyed.
+TEST(CommandBusTest, RetiresAppliedAndDiscardedCommands) {
+    std::atomic<int> retired{0};
+    std::vector<int> log;
+    {
+        core::CommandBus bus(8);
+        bus.post(recordCommand(log, 1, &retired));
+        bus.post(recordCommand(log, 2, &retired));
+        bus.drain(1);
+        EXPECT_EQ(retired.load(), 0);
+        EXPECT_EQ(bus.collect(), 1u);
+        EXPECT_EQ(retired.load(), 1);
+    }
+    EXPECT_EQ(retired.load(), 2);
+    EXPECT_EQ(log, (std::vector<int>{1}));
+}
+
+// Concurrent producers never lose or duplicate commands, and each producer's order is kept.
+TEST(CommandBusTest, ManyProducersOneConsumer) {
+    constexpr int producers = 4;
+    constexpr int perProducer = 2000;
+    core::CommandBus bus(64);
+    std::vector<int> log;
+    log.reserve(producers * perProducer);
+
+    std::atomic<bool> done{false};
+    std::thread consumer([&] {
+        while (!done.load() || bus.drain(64) > 0) bus.drain(64);
+    });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                while (bus.post(recordCommand(log, p * perProducer + i)) == 0) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    done = true;
+    consumer.join();
+
+    ASSERT_EQ(log.size(), static_cast<size_t>(producers * perProducer));
+    std::vector<int> next(producers, 0);
+    for (const int v : log) {
+        const int p = v / perProducer;
+        EXPECT_EQ(v % perProducer, next[p]++);
+    }
+}
@@ -0,0 +1,68 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/event_ring.hpp>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#endif
+
+using namespace pipsqueak;
+
+// Events carry the block position plus their offset, in posting order.
+TEST(EventRingTest, StampsEventsWithStreamPosition) {
+    core::EventRing ring(8);
+    int tag = 0;
+
+    ring.beginBlock(1024);
+    ring.post(core::EventType::SourceFinished, &tag, 17);
+    ring.post(core::EventType::Overload, nullptr, 0, 2);
+    ring.endBlock();
+
+    core::Event event;
+    ASSERT_TRUE(ring.poll(event));
+    EXPECT_EQ(event.type, core::EventType::SourceFinished);
+    EXPECT_EQ(event.frame, 1041u);
+    EXPECT_EQ(event.source, &tag);
+
+    ASSERT_TRUE(ring.poll(event));
+    EXPECT_EQ(event.type, core::EventType::Overload);
+    EXPECT_EQ(event.value, 2);
+    EXPECT_FALSE(ring.poll(event));
+}
+
+// A full ring drops and counts events rather than blocking the audio thread.
+TEST(EventRingTest, CountsDroppedEvents) {
+    core::EventRing ring(2);
+    ring.beginBlock(0);
+    EXPECT_TRUE(ring.post(core::EventType::VoiceStolen, nullptr));
+    EXPECT_TRUE(ring.post(core::EventType::VoiceStolen, nullptr));
+    EXPECT_FALSE(ring.post(core::EventType::VoiceStolen, nullptr));
+    EXPECT_EQ(ring.dropped(), 1u);
+
+    std::vector<core::EventType> seen;
+    EXPECT_EQ(ring.drain([&](const core::Event& e) { seen.push_back(e.type); }), 2u);
+    EXPECT_EQ(seen.size(), 2u);
+}
+
+#ifdef __linux__
+// The eventfd becomes readable at the end of a block that posted, and is cleared by drain().
+TEST(EventRingTest, WakesFileDescriptorOncePerBlock) {
+    core::EventRing ring(8);
+    ASSERT_GE(ring.fd(), 0);
+
+    pollfd pfd{ring.fd(), POLLIN, 0};
+    EXPECT_EQ(::poll(&pfd, 1, 0), 0);
+
+    ring.beginBlock(0);
+    ring.post(core::EventType::StreamStatus, nullptr, 0, 1);
+    EXPECT_EQ(::poll(&pfd, 1, 0), 0); // Not signalled until the block ends
+    ring.endBlock();
+    EXPECT_EQ(::poll(&pfd, 1, 0), 1);
+
+    ring.drain([](const core::Event&) {});
+    EXPECT_EQ(::poll(&pfd, 1, 0), 0);
+}
+#endif
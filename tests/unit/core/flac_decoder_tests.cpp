@@ -0,0 +1,410 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/flac_decoder.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace pipsqueak::core;
+
+namespace {
+    // ---- A small FLAC encoder, just enough to produce every construct the decoder handles ----
+
+    class BitWriter {
+    public:
+        void put(const std::uint64_t value, const unsigned bits) {
+            for (unsigned i = bits; i-- > 0;) putBit((value >> i) & 1);
+        }
+        void putSigned(const std::int64_t value, const unsigned bits) {
+            put(static_cast<std::uint64_t>(value) & ((std::uint64_t{1} << bits) - 1), bits);
+        }
+        void putUnary(const std::uint32_t zeros) {
+            for (std::uint32_t i = 0; i < zeros; ++i) putBit(0);
+            putBit(1);
+        }
+        void putRice(const std::int32_t value, const unsigned k) {
+            const std::uint32_t u = value >= 0 ? static_cast<std::uint32_t>(value) << 1
+                                               : (static_cast<std::uint32_t>(-(value + 1)) << 1) | 1;
+            putUnary(u >> k);
+            put(u & ((1u << k) - 1), k);
+        }
+        void align() { while (bits_ % 8) putBit(0); }
+        std::vector<std::uint8_t>& bytes() { return bytes_; }
+
+    private:
+        void putBit(const unsigned bit) {
+            if (bits_ % 8 == 0) bytes_.push_back(0);
+            if (bit) bytes_.back() |= static_cast<std::uint8_t>(0x80 >> (bits_ % 8));
+            ++bits_;
+        }
+
+        std::vector<std::uint8_t> bytes_;
+        size_t bits_{0};
+    };
+
+    std::uint8_t crc8(const std::uint8_t* p, const size_t n) {
+        std::uint8_t crc = 0;
+        for (size_t i = 0; i < n; ++i) {
+            crc ^= p[i];
+            for (int b = 0; b < 8; ++b) crc = static_cast<std::uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+        return crc;
+    }
+
+    std::uint16_t crc16(const std::uint8_t* p, const size_t n) {
+        std::uint16_t crc = 0;
+        for (size_t i = 0; i < n; ++i) {
+            crc ^= static_cast<std::uint16_t>(p[i] << 8);
+            for (int b = 0; b < 8; ++b) crc = static_cast<std::uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1);
+        }
+        return crc;
+    }
+
+    void putUtf8(BitWriter& w, const std::uint64_t v) {
+        if (v < 0x80) { w.put(v, 8); return; }
+        unsigned extra = 1;
+        while (extra < 6 && v >= (std::uint64_t{1} << (6 * extra + 6 - extra))) ++extra;
+        const unsigned leadBits = 6 - extra; // payload bits in the lead byte
+        const std::uint64_t lead = (0xFF00u >> (extra + 1)) & 0xFF;
+        w.put(lead | ((v >> (6 * extra)) & ((1u << leadBits) - 1)), 8);
+        for (unsigned i = extra; i-- > 0;) w.put(0x80 | ((v >> (6 * i)) & 0x3F), 8);
+    }
+
+    enum class Kind { Constant, Verbatim, Fixed, Lpc, LpcEscape };
+
+    // Residual with a single rice parameter per partition, at the given partition order.
+    void putResidual(BitWriter& w, const std::vector<std::int32_t>& residual, const unsigned order,
+                     const unsigned partitionOrder, const bool escapeFirst) {
+        const size_t n = residual.size();
+        const unsigned partitions = 1u << partitionOrder;
+        const size_t per = n >> partitionOrder;
+
+        // Pick the method from the largest parameter any partition needs.
+        std::vector<unsigned> params;
+        for (unsigned p = 0; p < partitions; ++p) {
+            const size_t from = p == 0 ? order : p * per;
+            double mean = 0.0;
+            for (size_t i = from; i < (p + 1) * per; ++i) mean += std::abs(static_cast<double>(residual[i]));
+            mean /= std::max<size_t>(1, (p + 1) * per - from);
+            params.push_back(mean < 1.0 ? 0u : static_cast<unsigned>(std::log2(mean)));
+        }
+        const bool fiveBit = *std::max_element(params.begin(), params.end()) >= 15;
+        w.put(fiveBit ? 1 : 0, 2);
+        w.put(partitionOrder, 4);
+
+        for (unsigned p = 0; p < partitions; ++p) {
+            const size_t from = p == 0 ? order : p * per;
+            if (p == 0 && escapeFirst) {
+                unsigned bits = 1;
+                for (size_t i = from; i < per; ++i)
+                    while (residual[i] < -(1 << (bits - 1)) || residual[i] >= (1 << (bits - 1))) ++bits;
+                w.put(fiveBit ? 31 : 15, fiveBit ? 5 : 4);
+                w.put(bits, 5);
+                for (size_t i = from; i < per; ++i) w.putSigned(residual[i], bits);
+                continue;
+            }
+            w.put(params[p], fiveBit ? 5 : 4);
+            for (size_t i = from; i < (p + 1) * per; ++i) w.putRice(residual[i], params[p]);
+        }
+    }
+
+    void putSubframe(BitWriter& w, std::vector<std::int32_t> s, unsigned bps, Kind kind, const unsigned order) {
+        const size_t n = s.size();
+        if (std::all_of(s.begin(), s.end(), [&](const std::int32_t v) { return v == s[0]; }))
+            kind = Kind::Constant;
+
+        // Wasted bits: shared trailing zeros
+        unsigned wasted = 0;
+        std::int32_t all = 0;
+        for (const auto v : s) all |= v;
+        if (kind != Kind::Constant && all != 0)
+            while (!((all >> wasted) & 1) && wasted + 1 < bps) ++wasted;
+
+        w.put(0, 1);
+        switch (kind) {
+            case Kind::Constant: w.put(0, 6); break;
+            case Kind::Verbatim: w.put(1, 6); break;
+            case Kind::Fixed: w.put(8 + order, 6); break;
+            default: w.put(31 + order, 6); break;
+        }
+        if (wasted) {
+            w.put(1, 1);
+            w.putUnary(wasted - 1);
+            for (auto& v : s) v >>= wasted;
+            bps -= wasted;
+        } else {
+            w.put(0, 1);
+        }
+
+        if (kind == Kind::Constant) {
+            w.putSigned(s[0], bps);
+            return;
+        }
+        if (kind == Kind::Verbatim) {
+            for (const auto v : s) w.putSigned(v, bps);
+            return;
+        }
+
+        for (unsigned i = 0; i < order; ++i) w.putSigned(s[i], bps);
+        std::vector<std::int32_t> residual(n, 0);
+        unsigned partitionOrder = 0;
+        while (partitionOrder < 4 && n % (2u << partitionOrder) == 0 && (n >> (partitionOrder + 1)) >= order)
+            ++partitionOrder;
+
+        if (kind == Kind::Fixed) {
+            for (size_t i = order; i < n; ++i) {
+                std::int64_t p = 0;
+                switch (order) {
+                    case 1: p = s[i - 1]; break;
+                    case 2: p = 2 * std::int64_t{s[i - 1]} - s[i - 2]; break;
+                    case 3: p = 3 * std::int64_t{s[i - 1]} - 3 * std::int64_t{s[i - 2]} + s[i - 3]; break;
+                    case 4: p = 4 * std::int64_t{s[i - 1]} - 6 * std::int64_t{s[i - 2]} + 4 * std::int64_t{s[i - 3]} - s[i - 4]; break;
+                    default: break;
+                }
+                residual[i] = static_cast<std::int32_t>(s[i] - p);
+            }
+            putResidual(w, residual, order, partitionOrder, false);
+            return;
+        }
+
+        // LPC: a second-order predictor spread over 'order' taps, at 15-bit precision
+        const unsigned precision = 15;
+        const int shift = 12;
+        std::vector<std::int32_t> q(order, 0);
+        q[0] = static_cast<std::int32_t>(std::lround(1.6 * (1 << shift)));
+        if (order > 1) q[1] = static_cast<std::int32_t>(std::lround(-0.7 * (1 << shift)));
+        for (unsigned j = 2; j < order; ++j) q[j] = (static_cast<std::int32_t>(j % 3) - 1) * 9;
+        w.put(precision - 1, 4);
+        w.putSigned(shift, 5);
+        for (const auto c : q) w.putSigned(c, precision);
+        for (size_t i = order; i < n; ++i) {
+            std::int64_t sum = 0;
+            for (unsigned j = 0; j < order; ++j) sum += std::int64_t{q[j]} * s[i - 1 - j];
+            residual[i] = static_cast<std::int32_t>(s[i] - (sum >> shift));
+        }
+        putResidual(w, residual, order, partitionOrder, kind == Kind::LpcEscape);
+    }
+
+    struct Stream {
+        unsigned channels{2};
+        unsigned bps{16};
+        unsigned rate{44100};
+        std::vector<std::vector<std::int32_t>> samples; // [channel][frame]
+    };
+
+    // Encodes @p stream with a fixed block size, or with the given variable block sizes.
+    std::vector<std::uint8_t> encode(const Stream& stream, const unsigned blockSize,
+                                     const std::vector<unsigned>& variableSizes = {}) {
+        const size_t total = stream.samples[0].size();
+        BitWriter w;
+        for (const char c : std::string("fLaC")) w.put(static_cast<std::uint8_t>(c), 8);
+
+        // STREAMINFO, then a PADDING block the decoder must skip
+        const unsigned maxBlock = variableSizes.empty() ? blockSize
+                                                        : *std::max_element(variableSizes.begin(), variableSizes.end());
+        w.put(0, 1); w.put(0, 7); w.put(34, 24);
+        w.put(variableSizes.empty() ? blockSize : 16, 16);
+        w.put(maxBlock, 16);
+        w.put(0, 24); w.put(0, 24);
+        w.put(stream.rate, 20);
+        w.put(stream.channels - 1, 3);
+        w.put(stream.bps - 1, 5);
+        w.put(total, 36);
+        for (int i = 0; i < 16; ++i) w.put(0, 8);
+        w.put(1, 1); w.put(1, 7); w.put(10, 24);
+        for (int i = 0; i < 10; ++i) w.put(0, 8);
+
+        static constexpr unsigned kSizeCodes[33] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 4,
+                                                    0, 0, 0, 5, 0, 0, 0, 6, 0, 0, 0, 0, 0, 0, 0, 7};
+        const Kind kinds[] = {Kind::Lpc, Kind::Fixed, Kind::Verbatim, Kind::Lpc, Kind::LpcEscape, Kind::Fixed};
+        const unsigned lpcOrders[] = {2, 8, 12, 13, 32, 5};
+
+        size_t position = 0;
+        for (size_t frame = 0; position < total; ++frame) {
+            const unsigned n = static_cast<unsigned>(std::min<size_t>(
+                variableSizes.empty() ? blockSize : variableSizes[frame % variableSizes.size()], total - position));
+
+            // Header
+            const size_t start = w.bytes().size();
+            w.put(0x3FFE, 14); w.put(0, 1); w.put(variableSizes.empty() ? 0 : 1, 1);
+            const unsigned blockCode = n == 4096 ? 12 : (n <= 256 ? 6 : 7);
+            w.put(blockCode, 4);
+            w.put(0, 4); // Sample rate from STREAMINFO
+            unsigned assignment = stream.channels - 1;
+            if (stream.channels == 2) assignment = frame % 4 == 0 ? 1 : 7 + static_cast<unsigned>(frame % 4);
+            w.put(assignment, 4);
+            w.put(kSizeCodes[stream.bps], 3);
+            w.put(0, 1);
+            putUtf8(w, variableSizes.empty() ? frame : position);
+            if (blockCode == 6) w.put(n - 1, 8);
+            if (blockCode == 7) w.put(n - 1, 16);
+            w.put(crc8(w.bytes().data() + start, w.bytes().size() - start), 8);
+
+            // Subframes, decorrelated as the assignment says
+            std::vector<std::vector<std::int32_t>> ch(stream.channels);
+            for (unsigned c = 0; c < stream.channels; ++c)
+                ch[c].assign(stream.samples[c].begin() + position, stream.samples[c].begin() + position + n);
+            std::vector<unsigned> bps(stream.channels, stream.bps);
+            if (assignment >= 8) {
+                std::vector<std::int32_t> a(n), b(n);
+                for (unsigned i = 0; i < n; ++i) {
+                    const std::int32_t l = ch[0][i], r = ch[1][i];
+                    if (assignment == 8) { a[i] = l; b[i] = l - r; }
+                    if (assignment == 9) { a[i] = l - r; b[i] = r; }
+                    if (assignment == 10) { a[i] = (l + r) >> 1; b[i] = l - r; }
+                }
+                ch = {a, b};
+                bps[assignment == 9 ? 0 : 1] += 1;
+            }
+            for (unsigned c = 0; c < stream.channels; ++c) {
+                const Kind kind = kinds[(frame + c) % 6];
+                const unsigned order = kind == Kind::Fixed ? static_cast<unsigned>((frame + c) % 5)
+                                                           : lpcOrders[(frame + c) % 6];
+                putSubframe(w, ch[c], bps[c], kind, std::min(order, n - 1));
+            }
+
+            w.align();
+            w.put(crc16(w.bytes().data() + start, w.bytes().size() - start), 16);
+            position += n;
+        }
+        return w.bytes();
+    }
+
+    // Deterministic tone plus noise, with a silent stretch and an even-only stretch (wasted bits).
+    Stream makeStream(const unsigned channels, const unsigned bps, const size_t frames) {
+        Stream stream;
+        stream.channels = channels;
+        stream.bps = bps;
+        stream.samples.assign(channels, std::vector<std::int32_t>(frames));
+        const double peak = static_cast<double>((1 << (bps - 1)) - 1);
+        std::uint32_t seed = 12345;
+        for (unsigned c = 0; c < channels; ++c) {
+            for (size_t i = 0; i < frames; ++i) {
+                seed = seed * 1664525u + 1013904223u;
+                const double noise = (static_cast<double>(seed >> 8) / 16777216.0 - 0.5) * 0.02;
+                double v = 0.6 * std::sin(0.013 * static_cast<double>(i) * (c + 1)) + noise;
+                if (i > frames / 3 && i < frames / 3 + 700) v = 0.0;
+                auto s = static_cast<std::int32_t>(std::lround(v * peak));
+                if (i > frames / 2 && i < frames / 2 + 900) s &= ~7;
+                stream.samples[c][i] = s;
+            }
+        }
+        return stream;
+    }
+
+    void expectDecoded(const AudioBuffer& buffer, const Stream& stream) {
+        ASSERT_EQ(buffer.numChannels(), stream.channels);
+        ASSERT_EQ(buffer.numFrames(), stream.samples[0].size());
+        const float scale = 1.0f / static_cast<float>(1u << (stream.bps - 1));
+        for (unsigned c = 0; c < stream.channels; ++c)
+            for (unsigned i = 0; i < buffer.numFrames(); ++i)
+                ASSERT_EQ(buffer.at(c, i), static_cast<float>(stream.samples[c][i]) * scale)
+                    << "channel " << c << " frame " << i;
+    }
+}
+
+// The header parser reads STREAMINFO and skips other metadata blocks.
+TEST(FlacDecoderTest, ParsesStreamInfo) {
+    const auto stream = makeStream(2, 16, 5000);
+    const auto bytes = encode(stream, 1152);
+    const auto info = parseFlacHeader(bytes.data(), bytes.size());
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->channels, 2u);
+    EXPECT_EQ(info->bitsPerSample, 16u);
+    EXPECT_EQ(info->sampleRate, 44100u);
+    EXPECT_EQ(info->totalFrames, 5000u);
+    EXPECT_EQ(info->maxBlockSize, 1152u);
+    EXPECT_EQ(info->framesOffset, 4u + 4 + 34 + 4 + 10);
+
+    EXPECT_FALSE(parseFlacHeader(bytes.data(), 20).has_value());
+}
+
+// Every subframe type and stereo mode decodes exactly, whether one thread decodes the whole
+// stream or many threads split it into small ranges.
+TEST(FlacDecoderTest, DecodesExactlyAcrossThreadsAndRanges) {
+    const auto stream = makeStream(2, 16, 40000);
+    const auto bytes = encode(stream, 1152);
+
+    for (const unsigned threads : {1u, 4u}) {
+        for (const size_t bytesPerTask : {size_t{1} << 24, size_t{700}}) {
+            FlacDecodeOptions options;
+            options.threads = threads;
+            options.bytesPerTask = bytesPerTask;
+            std::string error;
+            const auto buffer = decodeFlac(bytes.data(), bytes.size(), options, &error);
+            ASSERT_NE(buffer, nullptr) << error;
+            expectDecoded(*buffer, stream);
+        }
+    }
+}
+
+// 24-bit multichannel streams use the wide LPC accumulator; variable block sizes are placed by sample number.
+TEST(FlacDecoderTest, Decodes24BitAndVariableBlocks) {
+    const auto deep = makeStream(3, 24, 9000);
+    const auto deepBytes = encode(deep, 4096);
+    FlacDecodeOptions options;
+    options.bytesPerTask = 2000;
+    std::string error;
+    auto buffer = decodeFlac(deepBytes.data(), deepBytes.size(), options, &error);
+    ASSERT_NE(buffer, nullptr) << error;
+    expectDecoded(*buffer, deep);
+
+    const auto stereo = makeStream(2, 16, 20000);
+    const auto variableBytes = encode(stereo, 0, {1000, 333, 4096, 64, 2500});
+    buffer = decodeFlac(variableBytes.data(), variableBytes.size(), options, &error);
+    ASSERT_NE(buffer, nullptr) << error;
+    expectDecoded(*buffer, stereo);
+}
+
+// Damaged streams are rejected rather than returned with holes.
+TEST(FlacDecoderTest, RejectsCorruptStreams) {
+    const auto stream = makeStream(1, 16, 30000);
+    auto bytes = encode(stream, 1152);
+    bytes[bytes.size() / 2] ^= 0x10;
+
+    for (const size_t bytesPerTask : {size_t{1} << 24, size_t{500}}) {
+        FlacDecodeOptions options;
+        options.bytesPerTask = bytesPerTask;
+        std::string error;
+        EXPECT_EQ(decodeFlac(bytes.data(), bytes.size(), options, &error), nullptr);
+        EXPECT_FALSE(error.empty());
+    }
+
+    const auto good = encode(stream, 1152);
+    EXPECT_EQ(decodeFlac(good.data(), good.size() - 100), nullptr);
+}
+
+// Many files decode on one pool and land in the store.
+TEST(FlacDecoderTest, LoadsManyFilesIntoStore) {
+    std::vector<Stream> streams;
+    std::vector<std::string> paths;
+    for (unsigned i = 0; i < 5; ++i) {
+        streams.push_back(makeStream(1 + i % 2, 16, 3000 + 7000 * i));
+        paths.push_back(::testing::TempDir() + "flac_load_" + std::to_string(i) + ".flac");
+        const auto bytes = encode(streams.back(), 4096);
+        std::ofstream(paths.back(), std::ios::binary)
+            .write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+    paths.push_back(::testing::TempDir() + "flac_missing.flac");
+
+    BufferStore store(16);
+    FlacDecodeOptions options;
+    options.threads = 3;
+    options.bytesPerTask = 4000;
+    const auto loaded = loadFlacFiles(paths, &store, options);
+    ASSERT_EQ(loaded.size(), paths.size());
+    for (size_t i = 0; i < streams.size(); ++i) {
+        ASSERT_TRUE(loaded[i].error.empty()) << loaded[i].error;
+        EXPECT_EQ(loaded[i].sampleRate, 44100u);
+        const auto buffer = store.get(loaded[i].key);
+        ASSERT_EQ(buffer, loaded[i].buffer);
+        expectDecoded(*buffer, streams[i]);
+    }
+    EXPECT_FALSE(loaded.back().error.empty());
+    EXPECT_EQ(loaded.back().buffer, nullptr);
+}
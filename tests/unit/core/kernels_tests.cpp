@@ -0,0 +1,159 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <pipsqueak/core/kernels.hpp>
+
+using pipsqueak::core::Sample;
+namespace kernels = pipsqueak::core::kernels;
+
+// Helper: a deterministic test signal in [-1.5, 1.5] with an odd length (exercises loop tails)
+static std::vector<Sample> makeSignal(const size_t n) {
+    std::vector<Sample> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = static_cast<Sample>((static_cast<int>(i * 37 % 101) - 50) * 0.03);
+    return v;
+}
+
+// The baseline variant always exists and the active table is one of the available ones.
+TEST(KernelsTest, ActiveTableIsAvailable) {
+    const auto tables = kernels::available();
+    ASSERT_FALSE(tables.empty());
+    EXPECT_EQ(tables.front()->isa, kernels::Isa::Baseline);
+
+    bool found = false;
+    for (const auto* t : tables) found |= (t == &kernels::active());
+    EXPECT_TRUE(found);
+}
+
+// Every variant produces bit-identical results to straightforward reference loops.
+TEST(KernelsTest, AllVariantsMatchReference) {
+    constexpr size_t n = 1027;
+    const auto src = makeSignal(n);
+
+    for (const auto* t : kernels::available()) {
+        SCOPED_TRACE(t->name);
+
+        auto g = src;
+        t->gain(g.data(), n, 0.75f);
+        for (size_t i = 0; i < n; ++i) ASSERT_EQ(g[i], src[i] * 0.75f);
+
+        std::vector<Sample> f(n, 0.0f);
+        t->fill(f.data(), n, 0.25f);
+        for (size_t i = 0; i < n; ++i) ASSERT_EQ(f[i], 0.25f);
+
+        auto acc = src;
+        t->mixAccumulate(acc.data(), src.data(), n, 0.5f);
+        for (size_t i = 0; i < n; ++i) ASSERT_EQ(acc[i], src[i] + 0.5f * src[i]);
+
+        std::vector<std::int16_t> pcm(n);
+        std::vector<Sample> back(n);
+        t->toInt16(src.data(), pcm.data(), n);
+        t->fromInt16(pcm.data(), back.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            const Sample clamped = std::max(-1.0f, std::min(1.0f, src[i]));
+            ASSERT_EQ(pcm[i], static_cast<std::int16_t>(clamped * 32767.0f));
+            ASSERT_NEAR(back[i], clamped, 1.0 / 16384.0);
+        }
+    }
+}
+
+// Interpolation stops at the last source frame and advances the phase by what it wrote.
+TEST(KernelsTest, InterpolateStopsAtEndOfSource) {
+    // Stereo ramp: L = frame, R = -frame
+    constexpr size_t frames = 9;
+    std::vector<Sample> src(frames * 2);
+    for (size_t i = 0; i < frames; ++i) { src[2 * i] = static_cast<Sample>(i); src[2 * i + 1] = -static_cast<Sample>(i); }
+
+    for (const auto* t : kernels::available()) {
+        SCOPED_TRACE(t->name);
+
+        double phase = 0.5;
+        std::vector<Sample> out(2 * 32, 0.0f);
+        const size_t written = t->interpolate(src.data(), 2, frames - 1, phase, 1.5, out.data(), 32);
+
+        // Positions 0.5, 2.0, ..., 8.0 -> 6 frames
+        ASSERT_EQ(written, 6u);
+        EXPECT_DOUBLE_EQ(phase, 0.5 + 6 * 1.5);
+        for (size_t f = 0; f < written; ++f) {
+            EXPECT_FLOAT_EQ(out[2 * f], static_cast<Sample>(0.5 + 1.5 * f));
+            EXPECT_FLOAT_EQ(out[2 * f + 1], -static_cast<Sample>(0.5 + 1.5 * f));
+        }
+    }
+}
+
+// The fused resample-and-mix kernel reads exactly what interpolate() reads, for every route.
+TEST(KernelsTest, InterpolateMixMatchesInterpolate) {
+    constexpr size_t frames = 301;
+    const auto mono = makeSignal(frames);
+    const auto stereo = makeSignal(2 * frames);
+
+    struct Case { kernels::MixRoute route; unsigned srcCh; unsigned dstCh; };
+    const Case cases[] = {{kernels::MixRoute::MonoToMono, 1, 1}, {kernels::MixRoute::MonoToPair, 1, 2},
+                          {kernels::MixRoute::PairToPair, 2, 2}, {kernels::MixRoute::PairToMany, 2, 6}};
+
+    for (const auto* t : kernels::available()) {
+        SCOPED_TRACE(t->name);
+        for (const auto& c : cases) {
+            const Sample* src = c.srcCh == 1 ? mono.data() : stereo.data();
+
+            // Reference: interpolate into a block, then add it to the routed channels
+            double refPhase = 0.25;
+            std::vector<Sample> block(c.srcCh * 512);
+            const size_t expected = t->interpolate(src, c.srcCh, frames - 1, refPhase, 0.73, block.data(), 512);
+            std::vector<Sample> reference(c.dstCh * 512, 0.1f);
+            for (size_t f = 0; f < expected; ++f) {
+                for (unsigned d = 0; d < std::min(c.dstCh, 2u); ++d)
+                    reference[f * c.dstCh + d] += 0.6f * block[f * c.srcCh + std::min(d, c.srcCh - 1)];
+            }
+
+            double phase = 0.25;
+            std::vector<Sample> out(c.dstCh * 512, 0.1f);
+            const size_t written = t->interpolateMix(src, c.route, frames - 1, phase, 0.73, 0.6f, out.data(), c.dstCh, 512);
+            ASSERT_EQ(written, expected);
+            EXPECT_DOUBLE_EQ(phase, refPhase);
+            for (size_t i = 0; i < out.size(); ++i) ASSERT_EQ(out[i], reference[i]) << "at " << i;
+        }
+    }
+}
+
+// LPC restoration matches a scalar reference at every order, in both accumulator widths.
+TEST(KernelsTest, LpcRestoreMatchesReference) {
+    constexpr size_t n = 700;
+    for (const auto* t : kernels::available()) {
+        SCOPED_TRACE(t->name);
+        for (const unsigned order : {1u, 2u, 5u, 8u, 12u, 13u, 16u, 24u, 32u}) {
+            std::vector<std::int32_t> coefficients(order);
+            for (unsigned j = 0; j < order; ++j)
+                coefficients[j] = (static_cast<std::int32_t>(j * 211 % 97) - 48) * (j == 0 ? 40 : 3);
+
+            std::vector<std::int32_t> residual(n);
+            for (size_t i = 0; i < n; ++i) residual[i] = static_cast<std::int32_t>(i * 7919 % 601) - 300;
+
+            for (const bool wide : {false, true}) {
+                // Reference: straightforward 64-bit prediction
+                auto expected = residual;
+                for (size_t i = order; i < n; ++i) {
+                    std::int64_t sum = 0;
+                    for (unsigned j = 0; j < order; ++j) sum += std::int64_t{coefficients[j]} * expected[i - 1 - j];
+                    expected[i] += static_cast<std::int32_t>(sum >> 10);
+                    // Keep the signal bounded so the 32-bit path stays in range
+                    expected[i] = std::max(-4000, std::min(4000, expected[i]));
+                }
+
+                // The kernel has no clamp, so feed it residuals that reproduce the clamped signal.
+                auto actual = expected;
+                for (size_t i = order; i < n; ++i) {
+                    std::int64_t sum = 0;
+                    for (unsigned j = 0; j < order; ++j) sum += std::int64_t{coefficients[j]} * expected[i - 1 - j];
+                    actual[i] = expected[i] - static_cast<std::int32_t>(sum >> 10);
+                }
+                t->lpcRestore(actual.data(), n, coefficients.data(), order, 10, wide);
+                ASSERT_EQ(actual, expected) << "order " << order << (wide ? " wide" : " narrow");
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/memory_placement.hpp>
+#include <numeric>
+#include <vector>
+
+using namespace pipsqueak::core;
+
+// The report accounts for every page of the range.
+TEST(MemoryPlacementTest, ReportCoversEveryPage) {
+    std::vector<float> data(300000, 1.0f);
+    const auto report = placement::query(data.data(), data.size() * sizeof(float));
+    EXPECT_EQ(report.bytes, data.size() * sizeof(float));
+    if (!report.supported)
+        GTEST_SKIP() << "Placement reporting is not available on this platform";
+
+    const size_t resident = std::accumulate(report.pagesPerNode.begin(), report.pagesPerNode.end(), size_t{0});
+    EXPECT_EQ(resident + report.nonResidentPages, report.pages);
+    EXPECT_GT(resident, 0u); // The vector was just written
+    EXPECT_GE(report.pages * 4096, report.bytes);
+}
+
+// Binding to an existing node succeeds and leaves the data intact.
+TEST(MemoryPlacementTest, BindsToNodeWithoutTouchingData) {
+    std::vector<float> data(1 << 20);
+    std::iota(data.begin(), data.end(), 0.0f);
+
+    PlacementPolicy policy;
+    policy.node = placement::nodeCount() - 1;
+    policy.hugePages = HugePages::Collapse;
+    if (!placement::apply(data.data(), data.size() * sizeof(float), policy))
+        GTEST_SKIP() << "Page placement is not permitted here";
+
+    for (size_t i = 0; i < data.size(); i += 4099)
+        ASSERT_EQ(data[i], static_cast<float>(i));
+
+    const auto report = placement::query(data.data(), data.size() * sizeof(float));
+    if (report.supported) {
+        EXPECT_EQ(report.pagesPerNode[policy.node] + report.nonResidentPages, report.pages);
+    }
+}
+
+// Ranges too small to own a mapping are not placed, so heap neighbours are never rebound.
+TEST(MemoryPlacementTest, SkipsSmallRanges) {
+    std::vector<float> data(4096, 1.0f);
+    PlacementPolicy policy;
+    policy.node = 0;
+    policy.hugePages = HugePages::Transparent;
+    EXPECT_FALSE(placement::apply(data.data() + 1, 100 * sizeof(float), policy));
+    EXPECT_FALSE(placement::apply(data.data(), data.size() * sizeof(float), policy));
+}
+
+// Node queries are always usable.
+TEST(MemoryPlacementTest, NodeQueriesAreSane) {
+    EXPECT_GE(placement::nodeCount(), 1);
+    EXPECT_GE(placement::currentNode(), 0);
+    EXPECT_LT(placement::currentNode(), placement::nodeCount());
+}
@@ -0,0 +1,90 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/kernels.hpp>
+#include <pipsqueak/core/sample_analysis.hpp>
+#include <cmath>
+#include <vector>
+
+using namespace pipsqueak::core;
+
+// A square wave with a silent head and tail gives exact, known statistics.
+TEST(SampleAnalysisTest, MeasuresLevelsAndSilence) {
+    AudioBuffer buffer(2, 1000);
+    for (unsigned f = 100; f < 950; ++f) {
+        const float v = (f / 10) % 2 ? 0.5f : -0.25f;
+        buffer.at(0, f) = v;
+        buffer.at(1, f) = v;
+    }
+
+    const auto meta = analyzeSample(buffer);
+    EXPECT_FLOAT_EQ(meta.peak, 0.5f);
+    EXPECT_EQ(meta.leadingSilence, 100u);
+    EXPECT_EQ(meta.trailingSilence, 50u);
+
+    // 850 loud frames: 420 at 0.5 and 430 at -0.25 (blocks of 10 starting at a -0.25 block)
+    size_t high = 0;
+    for (unsigned f = 100; f < 950; ++f) high += (f / 10) % 2;
+    const double n = 2000.0;
+    const double mean = 2.0 * (high * 0.5 - (850 - high) * 0.25) / n;
+    const double rms = std::sqrt(2.0 * (high * 0.25 + (850 - high) * 0.0625) / n);
+    EXPECT_NEAR(meta.dcOffset, mean, 1e-6);
+    EXPECT_NEAR(meta.rms, rms, 1e-6);
+}
+
+// Silent samples report their whole length as both head and tail.
+TEST(SampleAnalysisTest, SilentSample) {
+    AudioBuffer buffer(1, 300);
+    buffer.fill(1.0e-6);
+    const auto meta = analyzeSample(buffer);
+    EXPECT_EQ(meta.leadingSilence, 300u);
+    EXPECT_EQ(meta.trailingSilence, 300u);
+    EXPECT_NEAR(meta.peak, 1.0e-6f, 1e-9f);
+}
+
+// Loop points snap to the nearest upward zero crossing of the channel sum.
+TEST(SampleAnalysisTest, FindsLoopCrossings) {
+    AudioBuffer buffer(1, 4800);
+    for (unsigned f = 0; f < 4800; ++f)
+        buffer.at(0, f) = static_cast<float>(std::sin(2.0 * M_PI * (f + 0.5) / 100.0)); // Rises through 0 at f = 0, 100, ...
+
+    SampleAnalysisOptions options;
+    options.loopStart = 1030;
+    options.loopEnd = 3790;
+    const auto meta = analyzeSample(buffer, options);
+    EXPECT_EQ(meta.loopStartCrossing, 1000u);
+    EXPECT_EQ(meta.loopEndCrossing, 3800u);
+
+    // Without a loop the crossings stay unset
+    EXPECT_EQ(analyzeSample(buffer).loopStartCrossing, 0u);
+}
+
+// The statistics kernel agrees exactly across ISA variants and channel counts.
+TEST(SampleAnalysisTest, StatsKernelVariantsAgree) {
+    for (const unsigned channels : {1u, 2u, 3u, 8u, 20u}) {
+        const size_t frames = 1001;
+        std::vector<Sample> data(frames * channels);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<Sample>(std::sin(0.37 * static_cast<double>(i)) * (1.0 + static_cast<double>(i % channels)));
+
+        std::vector<float> refPeak(channels);
+        std::vector<double> refSum(channels), refSq(channels);
+        kernels::available().front()->channelStats(data.data(), frames, channels, refPeak.data(), refSum.data(), refSq.data());
+        for (unsigned c = 0; c < channels; ++c) {
+            float peak = 0.0f;
+            for (size_t f = 0; f < frames; ++f) peak = std::max(peak, std::fabs(data[f * channels + c]));
+            ASSERT_EQ(refPeak[c], peak);
+        }
+
+        for (const auto* t : kernels::available()) {
+            SCOPED_TRACE(t->name);
+            std::vector<float> peak(channels);
+            std::vector<double> sum(channels), sq(channels);
+            t->channelStats(data.data(), frames, channels, peak.data(), sum.data(), sq.data());
+            EXPECT_EQ(peak, refPeak);
+            EXPECT_EQ(sum, refSum);
+            EXPECT_EQ(sq, refSq);
+        }
+    }
+}
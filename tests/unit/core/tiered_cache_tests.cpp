@@ -0,0 +1,167 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/tiered_cache.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+using namespace pipsqueak::core;
+
+namespace {
+    // Quantised to 16 bits, like most sample libraries.
+    std::shared_ptr<AudioBuffer> makeSample(const unsigned channels, const unsigned frames, const double hz) {
+        auto buffer = std::make_shared<AudioBuffer>(channels, frames);
+        for (unsigned f = 0; f < frames; ++f)
+            for (unsigned c = 0; c < channels; ++c)
+                buffer->at(c, f) = static_cast<float>(std::round(std::sin(hz * f + c) * 0.5 * 32767.0) / 32768.0);
+        return buffer;
+    }
+
+    bool sameBits(const AudioBuffer& a, const AudioBuffer& b) {
+        return a.data().size() == b.data().size()
+            && std::memcmp(a.dataPtr(), b.dataPtr(), a.data().size() * sizeof(Sample)) == 0;
+    }
+
+    size_t spillFiles(const std::filesystem::path& directory) {
+        size_t n = 0;
+        for (const auto& file : std::filesystem::directory_iterator(directory))
+            n += file.path().extension() == ".spill";
+        return n;
+    }
+
+    class TieredCacheTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            directory = std::filesystem::path(::testing::TempDir()) / "pipsqueak_tiered_cache";
+            std::filesystem::remove_all(directory);
+            std::filesystem::create_directories(directory);
+            options.spillDirectory = directory.string();
+            options.headFrames = 1024;
+            options.background = false;
+        }
+
+        void TearDown() override { std::filesystem::remove_all(directory); }
+
+        std::filesystem::path directory;
+        TieredCacheOptions options;
+    };
+}
+
+// The warm-tier codec is lossless for any bit pattern and shrinks 16-bit material.
+TEST(SampleCompressionTest, RoundTripsExactly) {
+    std::mt19937 random(7);
+    std::vector<Sample> noise(3 * 4001);
+    for (auto& x : noise) {
+        const std::uint32_t bits = random();
+        std::memcpy(&x, &bits, sizeof(bits));
+    }
+    const auto packed = compressSamples(noise.data(), 4001, 3);
+    std::vector<Sample> back(noise.size());
+    ASSERT_TRUE(decompressSamples(packed.data(), packed.size(), back.data(), 4001, 3));
+    EXPECT_EQ(std::memcmp(back.data(), noise.data(), noise.size() * sizeof(Sample)), 0);
+    EXPECT_FALSE(decompressSamples(packed.data(), packed.size() - 1, back.data(), 4001, 3));
+
+    const auto sample = makeSample(2, 48000, 0.01);
+    const auto small = compressSamples(sample->dataPtr(), 48000, 2);
+    EXPECT_LT(small.size(), sample->data().size() * sizeof(Sample) * 6 / 10);
+}
+
+// Over-budget entries move down a tier at a time and come back bit-identical.
+TEST_F(TieredCacheTest, DemotesAndPromotes) {
+    options.hotBytes = 3 * 20000 * sizeof(Sample) + 500 * sizeof(Sample);
+    options.warmBytes = 60000;
+    TieredCache cache(options);
+
+    std::vector<std::shared_ptr<AudioBuffer>> samples;
+    std::vector<size_t> keys;
+    for (int i = 0; i < 6; ++i) {
+        samples.push_back(makeSample(1, 20000, 0.001 * (i + 1)));
+        keys.push_back(cache.insert(samples.back()));
+    }
+    const size_t tiny = cache.insert(makeSample(1, 500, 0.1)); // Its head is the whole sample
+    samples.clear();
+
+    // Keep the first three in use so the others are the least used
+    for (int round = 0; round < 3; ++round)
+        for (int i = 0; i < 3; ++i) cache.head(keys[i]);
+    cache.maintain();
+
+    auto usage = cache.usage();
+    EXPECT_LE(usage.hotBytes, options.hotBytes);
+    EXPECT_LE(usage.warmBytes, options.warmBytes);
+    EXPECT_GT(usage.demotions, 3u);
+    EXPECT_EQ(cache.tier(keys[0]), CacheTier::Hot);
+    EXPECT_EQ(cache.tier(tiny), CacheTier::Hot);
+    EXPECT_NE(cache.tier(keys[5]), CacheTier::Hot);
+    EXPECT_GE(usage.coldEntries, 1u);
+    EXPECT_EQ(spillFiles(directory), usage.coldEntries);
+    EXPECT_EQ(usage.headBytes, 6 * 1024 * sizeof(Sample));
+
+    // Heads stay resident; full data comes back from RAM or disk unchanged
+    EXPECT_EQ(cache.head(keys[3])->numFrames(), 1024u);
+    EXPECT_EQ(cache.tryGet(keys[3]), nullptr);
+    for (int i = 0; i < 6; ++i) {
+        const auto buffer = cache.get(keys[i]);
+        ASSERT_NE(buffer, nullptr);
+        EXPECT_TRUE(sameBits(*buffer, *makeSample(1, 20000, 0.001 * (i + 1)))) << i;
+        EXPECT_EQ(cache.tier(keys[i]), CacheTier::Hot);
+    }
+    EXPECT_GE(cache.usage().promotions, 3u);
+
+    ASSERT_TRUE(cache.erase(keys[5]));
+    EXPECT_FALSE(cache.erase(keys[5]));
+}
+
+// Buffers still in use are never demoted; frequently touched cold entries come back on their own.
+TEST_F(TieredCacheTest, RespectsReferencesAndFrequency) {
+    options.hotBytes = 20000 * sizeof(Sample);
+    TieredCache cache(options);
+
+    const size_t playing = cache.insert(makeSample(1, 20000, 0.002));
+    const auto held = cache.get(playing);
+    const size_t cold = cache.insert(makeSample(1, 20000, 0.003), CacheTier::Cold);
+    EXPECT_EQ(cache.tier(cold), CacheTier::Cold);
+    EXPECT_EQ(cache.usage().coldBytes, 20000 * sizeof(Sample));
+
+    for (int i = 0; i < 4; ++i) cache.head(cold);
+    cache.maintain();
+    EXPECT_EQ(cache.tier(playing), CacheTier::Hot); // Over budget, but playing
+
+    // No room for a frequency promotion until the playing sample is released
+    EXPECT_EQ(cache.tier(cold), CacheTier::Cold);
+    cache.prefetch(cold);
+    cache.maintain();
+    EXPECT_EQ(cache.tier(cold), CacheTier::Hot);
+    EXPECT_EQ(cache.tier(playing), CacheTier::Hot);
+}
+
+// Entries with a loader go cold without a spill file; the worker serves tryGet() misses.
+TEST_F(TieredCacheTest, LoaderAndBackgroundWorker) {
+    options.background = true;
+    options.interval = std::chrono::milliseconds(5);
+    {
+        TieredCache cache(options);
+        int loads = 0;
+        const size_t key = cache.insert(makeSample(2, 5000, 0.01), CacheTier::Cold, [&loads] {
+            ++loads;
+            return std::shared_ptr<const AudioBuffer>(makeSample(2, 5000, 0.01));
+        });
+        const size_t spilled = cache.insert(makeSample(2, 5000, 0.02), CacheTier::Cold);
+        EXPECT_EQ(spillFiles(directory), 1u);
+
+        std::shared_ptr<const AudioBuffer> buffer;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!(buffer = cache.tryGet(key)) && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ASSERT_NE(buffer, nullptr);
+        EXPECT_EQ(loads, 1);
+        EXPECT_TRUE(sameBits(*buffer, *makeSample(2, 5000, 0.01)));
+        EXPECT_TRUE(sameBits(*cache.get(spilled), *makeSample(2, 5000, 0.02)));
+    }
+    EXPECT_EQ(spillFiles(directory), 0u);
+}
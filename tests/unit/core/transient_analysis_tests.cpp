@@ -0,0 +1,57 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <cmath>
+
+#include <pipsqueak/core/audio_buffer.hpp>
+#include <pipsqueak/core/transient_analysis.hpp>
+
+using pipsqueak::core::AudioBuffer;
+
+// Helper: silence with short full-scale bursts at the given frames
+static AudioBuffer makeClicks(const unsigned frames, const std::vector<unsigned>& at) {
+    AudioBuffer buf(1, frames);
+    for (const unsigned start : at) {
+        for (unsigned f = start; f < std::min(start + 64u, frames); ++f) {
+            buf.at(0, f) = (f % 2) ? 0.9f : -0.9f;
+        }
+    }
+    return buf;
+}
+
+// Bursts after silence are reported as onsets on hop boundaries.
+TEST(TransientAnalysisTest, DetectsBurstOnsets) {
+    const auto buf = makeClicks(16384, {1024, 8192});
+
+    const auto map = pipsqueak::core::detectTransients(buf, 256);
+
+    ASSERT_EQ(map.onsets.size(), 2u);
+    EXPECT_EQ(map.onsets[0], 1024u);
+    EXPECT_EQ(map.onsets[1], 8192u);
+    EXPECT_EQ(map.hopSize, 256u);
+}
+
+// A steady tone has no onsets after its start and is classified as tonal.
+TEST(TransientAnalysisTest, SteadyToneIsTonal) {
+    AudioBuffer buf(1, 44100);
+    for (unsigned f = 0; f < buf.numFrames(); ++f) {
+        buf.at(0, f) = 0.5f * static_cast<float>(std::sin(2.0 * 3.14159265358979 * 220.0 * f / 44100.0));
+    }
+
+    const auto map = pipsqueak::core::detectTransients(buf);
+
+    EXPECT_LE(map.onsets.size(), 1u);
+    EXPECT_TRUE(map.tonal);
+}
+
+// firstOnsetIn finds onsets by half-open range.
+TEST(TransientAnalysisTest, FirstOnsetInUsesHalfOpenRange) {
+    pipsqueak::core::TransientMap map;
+    map.onsets = {100, 500, 900};
+
+    size_t onset = 0;
+    EXPECT_TRUE(map.firstOnsetIn(101, 901, onset));
+    EXPECT_EQ(onset, 500u);
+    EXPECT_FALSE(map.firstOnsetIn(501, 900, onset));
+}
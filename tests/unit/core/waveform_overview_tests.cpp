@@ -0,0 +1,120 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/core/kernels.hpp>
+#include <pipsqueak/core/waveform_overview.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace pipsqueak::core;
+
+namespace {
+    std::shared_ptr<AudioBuffer> makeSignal(const unsigned channels, const unsigned frames) {
+        auto buffer = std::make_shared<AudioBuffer>(channels, frames);
+        for (unsigned f = 0; f < frames; ++f)
+            for (unsigned c = 0; c < channels; ++c)
+                buffer->at(c, f) = static_cast<float>(std::sin(0.013 * f * (c + 1)) * (0.2 + 0.8 * ((f * 7919u) % 1000) / 1000.0));
+        return buffer;
+    }
+
+    // The exact column for frames [a, b) after rounding outwards to level-0 buckets.
+    WaveformOverview::Column reference(const AudioBuffer& buffer, const unsigned channel, size_t a, size_t b,
+                                       const size_t baseFrames) {
+        a = a / baseFrames * baseFrames;
+        b = std::min<size_t>((b + baseFrames - 1) / baseFrames * baseFrames, buffer.numFrames());
+        WaveformOverview::Column column{1e9f, -1e9f, 0.0f};
+        double sq = 0.0;
+        for (size_t f = a; f < b; ++f) {
+            const float x = buffer.at(channel, static_cast<unsigned>(f));
+            column.min = std::min(column.min, x);
+            column.max = std::max(column.max, x);
+            sq += static_cast<double>(x) * x;
+        }
+        column.rms = static_cast<float>(std::sqrt(sq / static_cast<double>(b - a)));
+        return column;
+    }
+}
+
+// Columns at every zoom match a brute-force scan of the same frames.
+TEST(WaveformOverviewTest, QueryMatchesBruteForce) {
+    const auto buffer = makeSignal(2, 100003);
+    const auto overview = WaveformOverview::build(*buffer);
+    EXPECT_EQ(overview.frames(), 100003u);
+    EXPECT_GT(overview.levels(), 5u);
+
+    for (const size_t pixels : {1u, 7u, 300u, 5000u}) {
+        for (const auto& [start, end] : {std::pair<size_t, size_t>{0, 100003}, {12345, 67891}, {99000, 100003}}) {
+            std::vector<WaveformOverview::Column> columns(pixels);
+            ASSERT_EQ(overview.query(1, start, end, columns.data(), pixels), pixels);
+            for (size_t p = 0; p < pixels; ++p) {
+                const size_t a = start + static_cast<size_t>(static_cast<double>(end - start) * p / pixels);
+                const size_t b = std::max(a + 1, start + static_cast<size_t>(static_cast<double>(end - start) * (p + 1) / pixels));
+                const auto expected = reference(*buffer, 1, a, b, 64);
+                ASSERT_EQ(columns[p].min, expected.min) << pixels << " px, column " << p;
+                ASSERT_EQ(columns[p].max, expected.max);
+                ASSERT_NEAR(columns[p].rms, expected.rms, 1e-4f);
+            }
+        }
+    }
+}
+
+// Growing the overview in uneven appends gives the same pyramid as building it at once.
+TEST(WaveformOverviewTest, IncrementalAppendMatchesBuild) {
+    const auto buffer = makeSignal(2, 50000);
+    const auto built = WaveformOverview::build(*buffer, {32, 3});
+
+    WaveformOverview live(2, {32, 3});
+    size_t at = 0;
+    for (size_t step = 1; at < buffer->numFrames(); step = step * 3 % 997 + 1) {
+        const size_t n = std::min<size_t>(step, buffer->numFrames() - at);
+        live.append(buffer->dataPtr() + at * 2, n);
+        at += n;
+    }
+    ASSERT_EQ(live.frames(), built.frames());
+    ASSERT_EQ(live.levels(), built.levels());
+
+    std::vector<WaveformOverview::Column> a(640), b(640);
+    built.query(WaveformOverview::kAllChannels, 0, 50000, a.data(), a.size());
+    live.query(WaveformOverview::kAllChannels, 0, 50000, b.data(), b.size());
+    for (size_t p = 0; p < a.size(); ++p) {
+        ASSERT_EQ(a[p].min, b[p].min);
+        ASSERT_EQ(a[p].max, b[p].max);
+        ASSERT_NEAR(a[p].rms, b[p].rms, 1e-5f);
+    }
+}
+
+// Columns past the data are zeroed and not counted; bad arguments throw.
+TEST(WaveformOverviewTest, EdgesAndErrors) {
+    const auto buffer = makeSignal(1, 1000);
+    const auto overview = WaveformOverview::build(*buffer);
+
+    std::vector<WaveformOverview::Column> columns(10);
+    EXPECT_EQ(overview.query(0, 0, 2000, columns.data(), 10), 5u);
+    EXPECT_EQ(columns[9].max, 0.0f);
+    EXPECT_GT(columns[0].max, 0.0f);
+
+    EXPECT_THROW(overview.query(1, 0, 10, columns.data(), 1), std::invalid_argument);
+    EXPECT_THROW(WaveformOverview(0), std::invalid_argument);
+    EXPECT_THROW(WaveformOverview(1, {64, 1}), std::invalid_argument);
+}
+
+// The bucket kernel agrees exactly across ISA variants.
+TEST(WaveformOverviewTest, BlockKernelVariantsAgree) {
+    for (const unsigned channels : {1u, 2u, 3u, 8u}) {
+        const auto buffer = makeSignal(channels, 64 * 20 + 5);
+        std::vector<float> refMin(21 * channels), refMax(21 * channels), refSq(21 * channels);
+        const auto* base = kernels::available().front();
+        base->blockMinMax(buffer->dataPtr(), 20, 64, channels, refMin.data(), refMax.data(), refSq.data());
+
+        for (const auto* t : kernels::available()) {
+            SCOPED_TRACE(t->name);
+            std::vector<float> mn(21 * channels), mx(21 * channels), sq(21 * channels);
+            t->blockMinMax(buffer->dataPtr(), 20, 64, channels, mn.data(), mx.data(), sq.data());
+            EXPECT_EQ(mn, refMin);
+            EXPECT_EQ(mx, refMax);
+            EXPECT_EQ(sq, refSq);
+        }
+    }
+}
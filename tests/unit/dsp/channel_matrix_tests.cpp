@@ -0,0 +1,104 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/dsp/channel_matrix.hpp>
+#include <pipsqueak/core/audio_buffer.hpp>
+#include <pipsqueak/core/channel_view.hpp>
+
+using pipsqueak::core::AudioBuffer;
+using pipsqueak::dsp::ChannelLayout;
+using pipsqueak::dsp::ChannelMatrix;
+
+// Bare channel counts map onto the standard layouts.
+TEST(ChannelMatrixTest, LayoutFromChannelCount) {
+    EXPECT_EQ(ChannelLayout::fromChannelCount(1), ChannelLayout::mono());
+    EXPECT_EQ(ChannelLayout::fromChannelCount(2), ChannelLayout::stereo());
+    EXPECT_EQ(ChannelLayout::fromChannelCount(6), ChannelLayout::surround51());
+    EXPECT_EQ(ChannelLayout::fromChannelCount(8), ChannelLayout::surround71());
+    EXPECT_EQ(ChannelLayout::fromChannelCount(16), ChannelLayout::discrete(16));
+}
+
+// Identical layouts pass audio through unchanged (and accumulate).
+TEST(ChannelMatrixTest, IdentityAccumulates) {
+    AudioBuffer in(2, 4), out(2, 4);
+    in.channel(0).fill(0.25);
+    in.channel(1).fill(-0.5);
+    out.fill(0.1);
+
+    const ChannelMatrix m(ChannelLayout::stereo(), ChannelLayout::stereo());
+    m.accumulate(in, out);
+
+    for (unsigned f = 0; f < 4; ++f) {
+        EXPECT_FLOAT_EQ(out.at(0, f), 0.35f);
+        EXPECT_FLOAT_EQ(out.at(1, f), -0.4f);
+    }
+}
+
+// Mono duplicates to stereo and averages back down.
+TEST(ChannelMatrixTest, MonoStereoRoundTrip) {
+    const ChannelMatrix up(ChannelLayout::mono(), ChannelLayout::stereo());
+    EXPECT_FLOAT_EQ(up.coefficient(0, 0), 1.0f);
+    EXPECT_FLOAT_EQ(up.coefficient(1, 0), 1.0f);
+
+    const ChannelMatrix down(ChannelLayout::stereo(), ChannelLayout::mono());
+    AudioBuffer in(2, 3), out(1, 3);
+    in.channel(0).fill(1.0);
+    in.channel(1).fill(0.0);
+    down.accumulate(in, out, 2.0f);
+
+    for (unsigned f = 0; f < 3; ++f) {
+        EXPECT_FLOAT_EQ(out.at(0, f), 1.0f); // 0.5 * 1.0 * gain 2
+    }
+}
+
+// Mono feeds the centre of a known surround layout, but only the first pair of discrete outputs.
+TEST(ChannelMatrixTest, MonoIntoSurroundAndDiscrete) {
+    const ChannelMatrix surround(ChannelLayout::mono(), ChannelLayout::surround71());
+    const ChannelMatrix discrete(ChannelLayout::mono(), ChannelLayout::discrete(8));
+
+    for (unsigned d = 0; d < 8; ++d) {
+        EXPECT_FLOAT_EQ(surround.coefficient(d, 0), d == 2 ? 1.0f : 0.0f);
+        EXPECT_FLOAT_EQ(discrete.coefficient(d, 0), d < 2 ? 1.0f : 0.0f);
+    }
+}
+
+// 5.1 folds down to stereo with -3 dB centre and surrounds, dropping LFE.
+TEST(ChannelMatrixTest, Surround51FoldsToStereo) {
+    const ChannelMatrix m(ChannelLayout::surround51(), ChannelLayout::stereo());
+
+    AudioBuffer in(6, 2), out(2, 2);
+    in.channel(2).fill(1.0); // C
+    in.channel(3).fill(1.0); // LFE
+    in.channel(4).fill(1.0); // Ls
+    m.accumulate(in, out);
+
+    EXPECT_NEAR(out.at(0, 0), 2.0 * 0.70710678, 1e-6);
+    EXPECT_NEAR(out.at(1, 0), 0.70710678, 1e-6);
+}
+
+// Shapes without a specialised kernel (e.g. 3 -> 16) still route index-for-index.
+TEST(ChannelMatrixTest, DiscreteFallbackRoutesByIndex) {
+    const ChannelMatrix m(ChannelLayout::discrete(3), ChannelLayout::discrete(16));
+
+    AudioBuffer in(3, 5), out(16, 5);
+    for (unsigned c = 0; c < 3; ++c) in.channel(c).fill(0.1 * (c + 1));
+    m.accumulate(in, out, 0.5f);
+
+    for (unsigned f = 0; f < 5; ++f) {
+        for (unsigned c = 0; c < 16; ++c) {
+            const float expected = c < 3 ? 0.05f * static_cast<float>(c + 1) : 0.0f;
+            EXPECT_FLOAT_EQ(out.at(c, f), expected);
+        }
+    }
+}
+
+// Mismatched buffer shapes are ignored rather than overrun.
+TEST(ChannelMatrixTest, MismatchedBuffersAreIgnored) {
+    const ChannelMatrix m(ChannelLayout::stereo(), ChannelLayout::mono());
+    AudioBuffer in(1, 4), out(1, 4);
+    in.fill(1.0);
+    m.accumulate(in, out);
+
+    for (const auto s : out.data()) EXPECT_FLOAT_EQ(s, 0.0f);
+}
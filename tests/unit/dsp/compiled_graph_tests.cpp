@@ -0,0 +1,133 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/dsp/compiled_graph.hpp>
+#include <pipsqueak/dsp/mixer.hpp>
+#include <pipsqueak/core/audio_buffer.hpp>
+#include <memory>
+#include <stdexcept>
+
+using namespace pipsqueak;
+using Graph = dsp::CompiledGraph;
+
+// Helper: a constant-level mono sampler at equal rates (not yet triggered)
+static dsp::Sampler makeSampler(const unsigned frames, const double value) {
+    auto buf = std::make_shared<core::AudioBuffer>(1, frames);
+    buf->fill(value);
+    dsp::Sampler sampler(buf);
+    sampler.setNativeRate(48000.0);
+    sampler.setEngineRate(48000.0);
+    return sampler;
+}
+
+// Leaves sum into their bus, and nested bus gains multiply down the tree.
+TEST(CompiledGraphTest, NestedBusesApplyGains) {
+    Graph::Builder builder;
+    const auto group = builder.addBus(builder.root(), 0.5f);
+    const auto a = builder.addSampler(group, makeSampler(256, 0.2));
+    const auto b = builder.addSampler(builder.root(), makeSampler(256, 0.1));
+    auto graph = builder.build();
+
+    graph->noteOn(a, 48, 1.0f);
+    graph->noteOn(b, 48, 1.0f);
+
+    core::AudioBuffer out(2, 64);
+    out.fill(0.0);
+    graph->process(out);
+
+    for (unsigned f = 0; f < out.numFrames(); ++f) {
+        EXPECT_NEAR(out.at(0, f), 0.2 * 0.5 + 0.1, 1e-6);
+        EXPECT_NEAR(out.at(1, f), 0.2 * 0.5 + 0.1, 1e-6);
+    }
+}
+
+// A non-unity root scales the whole graph, and output is added to what the buffer held.
+TEST(CompiledGraphTest, RootGainScalesAndAccumulates) {
+    Graph::Builder builder;
+    const auto s = builder.addSampler(builder.root(), makeSampler(256, 0.4));
+    auto graph = builder.build();
+    graph->setBusGain(builder.root(), 0.25f);
+    graph->noteOn(s, 48, 1.0f);
+
+    core::AudioBuffer out(1, 32);
+    out.fill(0.5);
+    graph->process(out);
+
+    for (unsigned f = 0; f < out.numFrames(); ++f)
+        EXPECT_NEAR(out.at(0, f), 0.5 + 0.1, 1e-6);
+}
+
+// The graph matches the same topology built from Mixers.
+TEST(CompiledGraphTest, MatchesEquivalentMixerTree) {
+    Graph::Builder builder;
+    const auto bus = builder.addBus(builder.root(), 1.0f);
+    const auto s1 = builder.addSampler(bus, makeSampler(128, 0.3));
+    builder.addOscillator(builder.root(), dsp::Oscillator(dsp::Waveform::Sine, 440.0, 48000.0, 0.5f));
+    auto graph = builder.build();
+    graph->noteOn(s1, 48, 1.0f);
+
+    auto sampler = std::make_shared<dsp::Sampler>(makeSampler(128, 0.3));
+    sampler->noteOn(48, 1.0f);
+    auto inner = std::make_shared<dsp::Mixer>();
+    inner->addSource(sampler);
+    dsp::Mixer outer;
+    outer.addSource(inner);
+    outer.addSource(std::make_shared<dsp::Oscillator>(dsp::Waveform::Sine, 440.0, 48000.0, 0.5f));
+
+    core::AudioBuffer expected(2, 64), actual(2, 64);
+    for (int block = 0; block < 3; ++block) {
+        expected.fill(0.0);
+        actual.fill(0.0);
+        outer.process(expected);
+        graph->process(actual);
+        for (size_t i = 0; i < expected.data().size(); ++i)
+            ASSERT_NEAR(actual.data()[i], expected.data()[i], 1e-6) << "block " << block << " index " << i;
+    }
+}
+
+// Dynamic sources run alongside the by-value nodes.
+TEST(CompiledGraphTest, DynamicSourcesAreProcessed) {
+    auto sampler = std::make_shared<dsp::Sampler>(makeSampler(64, 0.7));
+    sampler->noteOn(48, 1.0f);
+
+    Graph::Builder builder;
+    builder.addSource(builder.root(), sampler);
+    auto graph = builder.build();
+    EXPECT_EQ(graph->count(Graph::NodeKind::Source), 1u);
+
+    core::AudioBuffer out(1, 16);
+    out.fill(0.0);
+    graph->process(out);
+    EXPECT_NEAR(out.at(0, 0), 0.7, 1e-6);
+}
+
+// The finished state is a running count of live leaves.
+TEST(CompiledGraphTest, TracksActiveLeaves) {
+    Graph::Builder builder;
+    const auto s = builder.addSampler(builder.root(), makeSampler(32, 1.0));
+    const auto o = builder.addOscillator(builder.root(), dsp::Oscillator(dsp::Waveform::Square, 100.0, 48000.0));
+    auto graph = builder.build();
+
+    EXPECT_EQ(graph->activeLeaves(), 1u); // Only the oscillator runs until the note starts
+    graph->noteOn(s, 48, 1.0f);
+    EXPECT_EQ(graph->activeLeaves(), 2u);
+
+    core::AudioBuffer out(1, 64);
+    graph->process(out); // Runs past the end of the sample
+    EXPECT_EQ(graph->activeLeaves(), 1u);
+    EXPECT_FALSE(graph->isFinished());
+
+    graph->oscillator(o).setRunning(false);
+    graph->process(out);
+    EXPECT_TRUE(graph->isFinished());
+}
+
+// Parents must be buses of the builder.
+TEST(CompiledGraphTest, RejectsNonBusParents) {
+    Graph::Builder builder;
+    const auto s = builder.addSampler(builder.root(), makeSampler(16, 0.1));
+    EXPECT_THROW(builder.addBus(s), std::invalid_argument);
+    EXPECT_THROW(builder.addBus({Graph::NodeKind::Bus, 42}), std::invalid_argument);
+    EXPECT_THROW(builder.addSource(builder.root(), nullptr), std::invalid_argument);
+}
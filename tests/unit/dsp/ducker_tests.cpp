@@ -0,0 +1,71 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/dsp/ducker.hpp>
+#include <pipsqueak/dsp/mixer.hpp>
+#include <pipsqueak/dsp/sampler.hpp>
+#include <pipsqueak/core/audio_buffer.hpp>
+#include <memory>
+
+using namespace pipsqueak;
+
+// Helper: a triggered constant-level mono sampler at equal rates
+static std::shared_ptr<dsp::Sampler> makeTriggered(const unsigned frames, const double value) {
+    auto buf = std::make_shared<core::AudioBuffer>(1, frames);
+    buf->fill(value);
+    auto sampler = std::make_shared<dsp::Sampler>(buf);
+    sampler->setNativeRate(48000.0);
+    sampler->setEngineRate(48000.0);
+    sampler->noteOn(48, 1.0f);
+    return sampler;
+}
+
+// Without a connected key the ducker passes its input through.
+TEST(DuckerTest, PassesThroughWithoutSidechain) {
+    dsp::Ducker ducker(makeTriggered(64, 0.5), 0.1f, 1.0f);
+
+    core::AudioBuffer out(1, 16);
+    ducker.process(out);
+
+    for (unsigned f = 0; f < out.numFrames(); ++f) {
+        EXPECT_NEAR(out.at(0, f), 0.5, 1e-6);
+    }
+}
+
+// In a mixer, the key is rendered first even when added after the ducker.
+TEST(DuckerTest, MixerEvaluatesKeyBeforeDependent) {
+    dsp::Mixer mixer;
+    constexpr unsigned numFrames = 16;
+
+    auto music = std::make_shared<dsp::Ducker>(makeTriggered(64, 0.5), 0.2f, 0.5f);
+    auto voice = makeTriggered(64, 0.4);
+    mixer.addSource(music);
+    mixer.addSource(voice);
+    ASSERT_TRUE(mixer.setSidechains(music, {voice}));
+
+    core::AudioBuffer out(1, numFrames);
+    out.fill(0.0);
+    mixer.process(out);
+
+    // Key above threshold -> full depth: 0.5 * (1 - 0.5) + 0.4 of voice
+    for (unsigned f = 0; f < numFrames; ++f) {
+        EXPECT_NEAR(out.at(0, f), 0.25 + 0.4, 1e-6);
+    }
+}
+
+// Cycles and non-sidechain nodes are rejected.
+TEST(DuckerTest, MixerRejectsInvalidSidechains) {
+    dsp::Mixer mixer;
+    auto a = std::make_shared<dsp::Ducker>(makeTriggered(64, 0.1), 0.5f, 1.0f);
+    auto b = std::make_shared<dsp::Ducker>(makeTriggered(64, 0.1), 0.5f, 1.0f);
+    auto plain = makeTriggered(64, 0.1);
+    mixer.addSource(a);
+    mixer.addSource(b);
+    mixer.addSource(plain);
+
+    EXPECT_TRUE(mixer.setSidechains(a, {b}));
+    EXPECT_FALSE(mixer.setSidechains(b, {a}));      // would form a cycle
+    EXPECT_FALSE(mixer.setSidechains(plain, {a}));  // not a SidechainSource
+    EXPECT_FALSE(mixer.setSidechains(a, {makeTriggered(8, 0.1)})); // key not an input
+}
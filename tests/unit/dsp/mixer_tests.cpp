@@ -2,9 +2,27 @@
 #include <gtest/gtest.h>
 #include <pipsqueak/dsp/mixer.hpp>
 #include <pipsqueak/dsp/sampler.hpp>
+#include <pipsqueak/dsp/oscillator.hpp>
+#include <pipsqueak/dsp/ducker.hpp>
 #include <pipsqueak/core/audio_buffer.hpp>
+#include <pipsqueak/core/channel_view.hpp>
 #include <atomic>
+#include <cstring>
 #include <thread>
+#include <vector>
+
+// Helper: an in-place processor that counts calls and records the bus level it saw
+struct RecordingProcessor final : pipsqueak::dsp::AudioProcessor {
+    int calls{0};
+    float lastInput{0.0f};
+    float outputGain{1.0f};
+
+    void process(pipsqueak::core::AudioBuffer& buffer) override {
+        ++calls;
+        lastInput = buffer.at(0, 0);
+        buffer.applyGain(outputGain);
+    }
+};
 
 // Helper: make a mono buffer filled with a value
 static std::shared_ptr<pipsqueak::core::AudioBuffer>
@@ -79,6 +97,150 @@ TEST(MixerTest, ClearSourcesResultsInSilence) {
     }
 }
 
+// A source added with a channel matrix is rendered in its own layout and routed.
+TEST(MixerTest, RoutesForeignLayoutThroughMatrix) {
+    using namespace pipsqueak;
+
+    dsp::Mixer mixer;
+    constexpr unsigned int numFrames = 16;
+
+    // A stereo source (L = 0.4, R = 0.2) mixed into a mono bus
+    auto stereo = std::make_shared<core::AudioBuffer>(2, numFrames);
+    stereo->channel(0).fill(0.4);
+    stereo->channel(1).fill(0.2);
+
+    auto sampler = std::make_shared<dsp::Sampler>(stereo);
+    sampler->setNativeRate(48000.0);
+    sampler->setEngineRate(48000.0);
+    sampler->noteOn(48, 1.0f);
+
+    mixer.addSource(sampler, dsp::ChannelMatrix(dsp::ChannelLayout::stereo(), dsp::ChannelLayout::mono()));
+
+    core::AudioBuffer out(1, numFrames);
+    out.fill(0.0);
+    mixer.process(out);
+
+    // Downmix averages the channels: (0.4 + 0.2) / 2
+    for (unsigned i = 0; i < numFrames - 1; ++i) {
+        EXPECT_NEAR(out.at(0, i), 0.3, 1e-6);
+    }
+}
+
+// Helper: a triggered constant-level mono sampler at equal rates
+static std::shared_ptr<pipsqueak::dsp::Sampler> makeTriggered(unsigned frames, double value) {
+    auto sampler = std::make_shared<pipsqueak::dsp::Sampler>(makeMonoFilled(frames, value));
+    sampler->setNativeRate(48000.0);
+    sampler->setEngineRate(48000.0);
+    sampler->noteOn(48, 1.0f);
+    return sampler;
+}
+
+// Inputs of different widths that each need a scratch buffer mix correctly, also across
+// block size and graph changes (their buffers are built with each state, not per block).
+TEST(MixerTest, MixesScratchInputsOfDifferentWidths) {
+    using namespace pipsqueak;
+    dsp::Mixer mixer;
+
+    auto mono = makeTriggered(4096, 0.25);
+    EXPECT_TRUE(mixer.addSource(mono, dsp::ChannelMatrix(dsp::ChannelLayout::mono(), dsp::ChannelLayout::stereo())));
+
+    auto wide = std::make_shared<core::AudioBuffer>(2, 4096);
+    wide->channel(0).fill(0.4);
+    wide->channel(1).fill(0.2);
+    auto stereo = std::make_shared<dsp::Sampler>(wide);
+    stereo->setNativeRate(48000.0);
+    stereo->setEngineRate(48000.0);
+    stereo->noteOn(48, 1.0f);
+    EXPECT_TRUE(mixer.addSource(stereo));
+    EXPECT_TRUE(mixer.setSourceGain(stereo, 0.5f));
+
+    for (const unsigned frames : {16u, 32u, 16u}) {
+        core::AudioBuffer out(2, frames);
+        for (int block = 0; block < 3; ++block) {
+            out.fill(0.0);
+            mixer.process(out);
+            EXPECT_NEAR(out.at(0, frames - 1), 0.45, 1e-6);
+            EXPECT_NEAR(out.at(1, frames - 1), 0.35, 1e-6);
+        }
+    }
+
+    EXPECT_TRUE(mixer.setSourceGain(stereo, 1.0f)); // Back on the fast path
+    core::AudioBuffer out(2, 16);
+    out.fill(0.0);
+    mixer.process(out);
+    EXPECT_NEAR(out.at(0, 0), 0.65, 1e-6);
+    EXPECT_NEAR(out.at(1, 0), 0.45, 1e-6);
+}
+
+// Sends from many inputs accumulate into one bus that is processed once per block.
+TEST(MixerTest, AuxBusProcessesSharedSendsOnce) {
+    using namespace pipsqueak;
+
+    dsp::Mixer mixer;
+    constexpr unsigned int numFrames = 16;
+    auto reverb = std::make_shared<RecordingProcessor>();
+    reverb->outputGain = 0.5f;
+    mixer.addAuxBus("reverb", {reverb});
+
+    auto s1 = makeTriggered(4 * numFrames, 0.2);
+    auto s2 = makeTriggered(4 * numFrames, 0.4);
+    mixer.addSource(s1);
+    mixer.addSource(s2);
+    ASSERT_TRUE(mixer.setSend(s1, "reverb", 1.0f));
+    ASSERT_TRUE(mixer.setSend(s2, "reverb", 0.5f));
+
+    core::AudioBuffer out(1, numFrames);
+    out.fill(0.0);
+    mixer.process(out);
+
+    // The bus saw 0.2 * 1.0 + 0.4 * 0.5 = 0.4 and its processor ran exactly once
+    EXPECT_EQ(reverb->calls, 1);
+    EXPECT_NEAR(reverb->lastInput, 0.4, 1e-6);
+
+    // Dry (0.6) plus the processed return (0.4 * 0.5)
+    EXPECT_NEAR(out.at(0, 0), 0.8, 1e-6);
+}
+
+// Pre-fader sends ignore the input gain; post-fader sends follow it.
+TEST(MixerTest, PreAndPostFaderSends) {
+    using namespace pipsqueak;
+
+    dsp::Mixer mixer;
+    constexpr unsigned int numFrames = 8;
+    auto pre = std::make_shared<RecordingProcessor>();
+    auto post = std::make_shared<RecordingProcessor>();
+    mixer.addAuxBus("pre", {pre}, 0.0f);
+    mixer.addAuxBus("post", {post}, 0.0f);
+
+    auto s = makeTriggered(4 * numFrames, 0.5);
+    mixer.addSource(s);
+    ASSERT_TRUE(mixer.setSourceGain(s, 0.0f));
+    ASSERT_TRUE(mixer.setSend(s, "pre", 1.0f, dsp::SendTiming::PreFader));
+    ASSERT_TRUE(mixer.setSend(s, "post", 1.0f, dsp::SendTiming::PostFader));
+
+    core::AudioBuffer out(1, numFrames);
+    out.fill(0.0);
+    mixer.process(out);
+
+    EXPECT_NEAR(pre->lastInput, 0.5, 1e-6);
+    EXPECT_NEAR(post->lastInput, 0.0, 1e-6);
+    EXPECT_NEAR(out.at(0, 0), 0.0, 1e-6); // faded out, returns muted
+}
+
+// Sends to unknown buses or from unknown sources are rejected.
+TEST(MixerTest, SendRejectsUnknownTargets) {
+    using namespace pipsqueak;
+
+    dsp::Mixer mixer;
+    auto s = makeTriggered(16, 0.1);
+    mixer.addSource(s);
+
+    EXPECT_FALSE(mixer.setSend(s, "missing", 1.0f));
+    mixer.addAuxBus("bus", {});
+    EXPECT_FALSE(mixer.setSend(makeTriggered(16, 0.1), "bus", 1.0f));
+    EXPECT_TRUE(mixer.setSend(s, "bus", 1.0f));
+}
+
 // Stress test: writer adds/clears samplers while reader processes.
 TEST(MixerTest, ConcurrentReadWriteIsSafe) {
     using namespace pipsqueak;
@@ -115,3 +277,217 @@ TEST(MixerTest, ConcurrentReadWriteIsSafe) {
 
     SUCCEED();
 }
+
+// With a command bus attached, changes are staged and only take effect once the bus is drained.
+TEST(MixerTest, CommandBusDefersChangesUntilDrained) {
+    using namespace pipsqueak;
+    core::CommandBus bus(16);
+    dsp::Mixer mixer;
+    mixer.setCommandBus(&bus);
+
+    auto sample = std::make_shared<core::AudioBuffer>(1, 64);
+    sample->fill(0.25);
+    auto sampler = std::make_shared<dsp::Sampler>(sample);
+    sampler->setNativeRate(48000.0);
+    sampler->setEngineRate(48000.0);
+    sampler->noteOn(48, 1.0f);
+
+    mixer.addSource(sampler);
+    ASSERT_TRUE(mixer.setSourceGain(sampler, 2.0f)); // Staged on top of the pending add
+    EXPECT_EQ(mixer.version(), 0u);
+
+    core::AudioBuffer out(1, 16);
+    out.fill(0.0);
+    mixer.process(out);
+    EXPECT_FLOAT_EQ(out.at(0, 0), 0.0f);
+
+    EXPECT_EQ(bus.drain(16), 2u);
+    EXPECT_EQ(mixer.version(), 2u);
+    EXPECT_EQ(bus.collect(), 2u);
+
+    mixer.process(out);
+    EXPECT_NEAR(out.at(0, 0), 0.5, 1e-6);
+}
+
+// A change that does not fit in a full bus is reported and leaves the mixer untouched.
+TEST(MixerTest, CommandBusFullRejectsChanges) {
+    using namespace pipsqueak;
+    core::CommandBus bus(4);
+    dsp::Mixer mixer;
+    mixer.setCommandBus(&bus);
+
+    auto sample = std::make_shared<core::AudioBuffer>(1, 64);
+    sample->fill(0.25);
+
+    std::vector<std::shared_ptr<dsp::Sampler>> accepted;
+    std::shared_ptr<dsp::Sampler> rejected;
+    for (size_t i = 0; i <= bus.capacity(); ++i) {
+        auto sampler = std::make_shared<dsp::Sampler>(sample);
+        sampler->setNativeRate(48000.0);
+        sampler->setEngineRate(48000.0);
+        sampler->noteOn(48, 1.0f);
+        if (mixer.addSource(sampler))
+            accepted.push_back(sampler);
+        else
+            rejected = sampler;
+    }
+    ASSERT_EQ(accepted.size(), bus.capacity());
+    ASSERT_NE(rejected, nullptr);
+    EXPECT_FALSE(mixer.clearSources());
+    EXPECT_FALSE(mixer.addAuxBus("fx", {}));
+
+    // Only the accepted additions are installed, and the bus accepts changes again once drained
+    EXPECT_EQ(bus.drain(bus.capacity()), bus.capacity());
+    bus.collect();
+    EXPECT_FALSE(mixer.setSourceGain(rejected, 0.5f));
+    EXPECT_TRUE(mixer.addSource(rejected));
+
+    bus.drain(1);
+    core::AudioBuffer out(1, 16);
+    out.fill(0.0);
+    mixer.process(out);
+    EXPECT_NEAR(out.at(0, 0), 0.25 * static_cast<double>(bus.capacity() + 1), 1e-5);
+}
+
+// A mixer with an event sink reports each input once, when it stops playing.
+TEST(MixerTest, PostsSourceFinishedOnce) {
+    using namespace pipsqueak;
+    core::EventRing events(8);
+    dsp::Mixer mixer;
+    mixer.setEventSink(&events);
+
+    auto sample = std::make_shared<core::AudioBuffer>(1, 20);
+    sample->fill(0.1);
+    auto sampler = std::make_shared<dsp::Sampler>(sample);
+    sampler->setNativeRate(48000.0);
+    sampler->setEngineRate(48000.0);
+    sampler->noteOn(48, 1.0f);
+    mixer.addSource(sampler);
+
+    core::AudioBuffer out(1, 16);
+    for (std::uint64_t block = 0; block < 4; ++block) {
+        events.beginBlock(block * 16);
+        mixer.process(out);
+        events.endBlock();
+    }
+
+    core::Event event;
+    ASSERT_TRUE(events.poll(event));
+    EXPECT_EQ(event.type, core::EventType::SourceFinished);
+    EXPECT_EQ(event.source, sampler.get());
+    EXPECT_EQ(event.frame, 32u); // End of the block in which it finished
+    EXPECT_FALSE(events.poll(event));
+}
+
+// Helper: renders a fixed graph (layouts, gains, sends, a return chain, a sidechain) in
+// deterministic mode on the given number of threads and returns the concatenated output.
+static std::vector<float> renderDeterministic(const unsigned threads) {
+    using namespace pipsqueak;
+
+    dsp::Mixer mixer;
+    if (threads > 0)
+        mixer.setRenderPool(std::make_shared<core::ForkJoinPool>(threads));
+
+    auto reverb = std::make_shared<RecordingProcessor>();
+    reverb->outputGain = 0.3f;
+    mixer.addAuxBus("reverb", {reverb});
+
+    std::vector<std::shared_ptr<dsp::AudioSource>> sources;
+    for (int i = 0; i < 12; ++i) {
+        const auto waveform = i % 2 ? dsp::Waveform::Saw : dsp::Waveform::Sine;
+        auto osc = std::make_shared<dsp::Oscillator>(waveform, 110.0 * (i + 1) + 0.37 * i, 48000.0, 0.1f + 0.01f * i);
+        if (i % 3 == 0)
+            mixer.addSource(osc, dsp::ChannelMatrix(dsp::ChannelLayout::mono(), dsp::ChannelLayout::stereo()));
+        else
+            mixer.addSource(osc);
+        mixer.setSourceGain(osc, 0.7f + 0.013f * i);
+        mixer.setSend(osc, "reverb", 0.05f * i, i % 2 ? dsp::SendTiming::PreFader : dsp::SendTiming::PostFader);
+        sources.push_back(osc);
+    }
+    auto ducked = std::make_shared<dsp::Ducker>(
+        std::make_shared<dsp::Oscillator>(dsp::Waveform::Square, 55.0, 48000.0, 0.2f), 0.05f, 0.6f);
+    mixer.addSource(ducked);
+    EXPECT_TRUE(mixer.setSidechains(ducked, {sources[1], sources[4]}));
+
+    std::vector<float> rendered;
+    core::AudioBuffer out(2, 1000); // Not a multiple of the summing range
+    for (int block = 0; block < 6; ++block) {
+        out.fill(0.0);
+        mixer.process(out);
+        rendered.insert(rendered.end(), out.data().begin(), out.data().end());
+    }
+    return rendered;
+}
+
+// Deterministic mode gives bit-identical output for every thread count and run.
+TEST(MixerTest, DeterministicModeIsBitIdenticalAcrossThreadCounts) {
+    const auto reference = renderDeterministic(1);
+    for (const unsigned threads : {1u, 2u, 3u, 8u}) {
+        const auto output = renderDeterministic(threads);
+        ASSERT_EQ(output.size(), reference.size());
+        EXPECT_EQ(std::memcmp(output.data(), reference.data(), output.size() * sizeof(float)), 0)
+            << "differs with " << threads << " threads";
+    }
+
+    // Same mix as the default mode, up to summation rounding
+    const auto direct = renderDeterministic(0);
+    for (size_t i = 0; i < reference.size(); ++i) {
+        ASSERT_NEAR(reference[i], direct[i], 1e-5) << "at sample " << i;
+    }
+}
+
+// Helper: renders samplers that post to the ring themselves and returns the events, in order.
+static std::vector<pipsqueak::core::Event> renderSamplerEvents(const unsigned threads) {
+    using namespace pipsqueak;
+    core::EventRing events(256);
+    dsp::Mixer mixer;
+    mixer.setEventSink(&events);
+    if (threads > 0)
+        mixer.setRenderPool(std::make_shared<core::ForkJoinPool>(threads));
+
+    std::vector<std::shared_ptr<dsp::Sampler>> samplers;
+    for (unsigned i = 0; i < 16; ++i) {
+        auto sample = std::make_shared<core::AudioBuffer>(1, 10 + 7 * i);
+        sample->fill(0.1);
+        auto sampler = std::make_shared<dsp::Sampler>(sample);
+        sampler->setNativeRate(48000.0);
+        sampler->setEngineRate(48000.0);
+        sampler->setEventSink(&events);
+        sampler->noteOn(48, 1.0f);
+        mixer.addSource(sampler);
+        samplers.push_back(sampler);
+    }
+
+    core::AudioBuffer out(1, 32);
+    for (std::uint64_t block = 0; block < 6; ++block) {
+        events.beginBlock(block * 32);
+        mixer.process(out);
+        events.endBlock();
+    }
+
+    std::vector<core::Event> posted;
+    events.drain([&](const core::Event& event) { posted.push_back(event); });
+    EXPECT_EQ(events.dropped(), 0u);
+    return posted;
+}
+
+// In deterministic mode, events sources post themselves arrive in the same order as in the
+// default mode, whatever the thread count, and never from a worker thread.
+TEST(MixerTest, DeterministicModeForwardsSourceEventsInOrder) {
+    // One SourceFinished per sampler, from the sampler itself at the exact frame; the mixer
+    // neither polls nor reports inputs that post their own.
+    const auto reference = renderSamplerEvents(0);
+    ASSERT_EQ(reference.size(), 16u);
+    for (size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_EQ(reference[i].type, pipsqueak::core::EventType::SourceFinished);
+        EXPECT_EQ(reference[i].frame, 10 + 7 * i);
+    }
+    for (const unsigned threads : {1u, 4u, 8u}) {
+        const auto posted = renderSamplerEvents(threads);
+        ASSERT_EQ(posted.size(), reference.size()) << threads << " threads";
+        for (size_t i = 0; i < posted.size(); ++i) {
+            EXPECT_EQ(posted[i].type, reference[i].type);
+            EXPECT_EQ(posted[i].frame, reference[i].frame);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/dsp/panner.hpp>
+#include <pipsqueak/dsp/sampler.hpp>
+#include <pipsqueak/core/audio_buffer.hpp>
+#include <cmath>
+#include <memory>
+
+using namespace pipsqueak;
+
+// Helper: a sampler playing a constant mono level, already triggered
+static std::shared_ptr<dsp::Sampler> makeConstantSource(const unsigned frames, const double value) {
+    auto buf = std::make_shared<core::AudioBuffer>(1, frames);
+    buf->fill(value);
+    auto sampler = std::make_shared<dsp::Sampler>(buf);
+    sampler->setNativeRate(48000.0);
+    sampler->setEngineRate(48000.0);
+    sampler->noteOn(48, 1.0f);
+    return sampler;
+}
+
+// A source pointed straight at a speaker plays only from that speaker.
+TEST(PannerTest, VbapOnSpeakerUsesSingleChannel) {
+    const dsp::Panner panner(nullptr, dsp::PanningMode::Vbap, {0.0, 90.0, 180.0, 270.0});
+
+    const auto gains = panner.gainsFor(90.0, 0.0);
+    ASSERT_EQ(gains.size(), 4u);
+    EXPECT_NEAR(gains[0], 0.0, 1e-6);
+    EXPECT_NEAR(gains[1], 1.0, 1e-6);
+    EXPECT_NEAR(gains[2], 0.0, 1e-6);
+    EXPECT_NEAR(gains[3], 0.0, 1e-6);
+}
+
+// Between two speakers the gains are equal and constant-power, including across the wrap.
+TEST(PannerTest, VbapBetweenSpeakersIsConstantPower) {
+    const dsp::Panner panner(nullptr, dsp::PanningMode::Vbap, {0.0, 90.0, 180.0, 270.0});
+
+    const auto gains = panner.gainsFor(-45.0, 0.0); // between 270 and 0
+    EXPECT_NEAR(gains[0], std::sqrt(0.5), 1e-6);
+    EXPECT_NEAR(gains[3], std::sqrt(0.5), 1e-6);
+    EXPECT_NEAR(gains[1] + gains[2], 0.0, 1e-6);
+}
+
+// First-order encoding of a front source: W = 1, X = 1, Y = Z = 0.
+TEST(PannerTest, AmbisonicFrontEncoding) {
+    const dsp::Panner panner(nullptr, dsp::PanningMode::Ambisonic1);
+    ASSERT_EQ(panner.outputChannels(), 4u);
+
+    const auto gains = panner.gainsFor(0.0, 0.0);
+    EXPECT_NEAR(gains[0], 1.0, 1e-6); // W
+    EXPECT_NEAR(gains[1], 0.0, 1e-6); // Y
+    EXPECT_NEAR(gains[2], 0.0, 1e-6); // Z
+    EXPECT_NEAR(gains[3], 1.0, 1e-6); // X
+}
+
+// Third-order encoding at the zenith: only the zonal harmonics are non-zero.
+TEST(PannerTest, AmbisonicThirdOrderZenith) {
+    const dsp::Panner panner(nullptr, dsp::PanningMode::Ambisonic3);
+    ASSERT_EQ(panner.outputChannels(), 16u);
+
+    const auto gains = panner.gainsFor(0.0, 90.0);
+    for (unsigned acn = 0; acn < 16; ++acn) {
+        const bool zonal = (acn == 0 || acn == 2 || acn == 6 || acn == 12);
+        EXPECT_NEAR(gains[acn], zonal ? 1.0 : 0.0, 1e-6) << "ACN " << acn;
+    }
+}
+
+// Moving the source ramps gains across the block instead of jumping.
+TEST(PannerTest, DirectionChangeRampsAcrossBlock) {
+    constexpr unsigned frames = 64;
+    dsp::Panner panner(makeConstantSource(4 * frames, 1.0), dsp::PanningMode::Vbap, {0.0, 90.0});
+
+    core::AudioBuffer out(2, frames);
+    panner.process(out); // settled at the front speaker
+    EXPECT_NEAR(out.at(0, frames - 1), 1.0, 1e-6);
+    EXPECT_NEAR(out.at(1, frames - 1), 0.0, 1e-6);
+
+    panner.setDirection(90.0);
+    out.fill(0.0);
+    panner.process(out);
+
+    // Starts close to the old gains and ends exactly at the new ones
+    EXPECT_GT(out.at(0, 0), 0.9f);
+    EXPECT_LT(out.at(1, 0), 0.1f);
+    EXPECT_NEAR(out.at(0, frames - 1), 0.0, 1e-6);
+    EXPECT_NEAR(out.at(1, frames - 1), 1.0, 1e-6);
+}
@@ -2,8 +2,10 @@
 
 #include <gtest/gtest.h>
 #include <pipsqueak/dsp/sampler.hpp>
+#include <pipsqueak/engine/commands.hpp>
 #include <pipsqueak/core/audio_buffer.hpp>
 #include <pipsqueak/core/channel_view.hpp>
+#include <cmath>
 #include <memory>
 #include <vector>
 
@@ -103,6 +105,86 @@ TEST(SamplerTest, ProcessCopiesStereoSourceToStereoOutput) {
     }
 }
 
+// Stereo source into a mono output is downmixed rather than truncated to the left channel.
+TEST(SamplerTest, ProcessDownmixesStereoSourceToMonoOutput) {
+    auto sample = makeBuffer(2, 512);
+    sample->channel(0).fill(0.5);
+    sample->channel(1).fill(0.1);
+
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+    sampler.noteOn(48, 1.0f);
+
+    pipsqueak::core::AudioBuffer out(1, 256);
+    out.fill(0.0);
+    sampler.process(out);
+
+    for (unsigned f = 0; f < out.numFrames(); ++f) {
+        EXPECT_NEAR(out.at(0, f), 0.3, 1e-6);
+    }
+}
+
+// Stereo source into a wider discrete output fills the first two channels and leaves the rest alone.
+TEST(SamplerTest, ProcessRoutesStereoSourceIntoWideOutputByIndex) {
+    auto sample = makeBuffer(2, 512);
+    sample->channel(0).fill(0.5);
+    sample->channel(1).fill(-0.25);
+
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+    sampler.noteOn(48, 1.0f);
+
+    pipsqueak::core::AudioBuffer out(4, 256);
+    out.fill(0.1);
+    sampler.process(out);
+
+    for (unsigned f = 0; f < out.numFrames(); ++f) {
+        EXPECT_NEAR(out.at(0, f), 0.6, 1e-6);
+        EXPECT_NEAR(out.at(1, f), -0.15, 1e-6);
+        EXPECT_NEAR(out.at(2, f), 0.1, 1e-6);
+        EXPECT_NEAR(out.at(3, f), 0.1, 1e-6);
+    }
+}
+
+// An 8-output device is not assumed to be 7.1: a mono source plays on the first pair only.
+TEST(SamplerTest, ProcessRoutesMonoSourceToFirstPairOfWideDevice) {
+    auto sample = makeBuffer(1, 512);
+    sample->fill(0.4);
+
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+    sampler.noteOn(48, 1.0f);
+
+    pipsqueak::core::AudioBuffer out(8, 128);
+    out.fill(0.0);
+    sampler.process(out);
+
+    for (unsigned f = 0; f < out.numFrames(); ++f) {
+        for (unsigned c = 0; c < 8; ++c) {
+            EXPECT_NEAR(out.at(c, f), c < 2 ? 0.4 : 0.0, 1e-6);
+        }
+    }
+}
+
+// Pitched playback interpolates between source frames (one octave up reads every other frame).
+TEST(SamplerTest, PitchedMonoPlaybackInterpolatesRamp) {
+    auto sample = makeBuffer(1, 256);
+    for (unsigned f = 0; f < sample->numFrames(); ++f)
+        sample->at(0, f) = static_cast<float>(f) / 256.0f;
+
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+    sampler.noteOn(60, 1.0f); // root is 48: +12 semitones, step 2
+
+    pipsqueak::core::AudioBuffer out(1, 64);
+    out.fill(0.0);
+    sampler.process(out);
+
+    for (unsigned f = 0; f < out.numFrames(); ++f) {
+        EXPECT_NEAR(out.at(0, f), static_cast<float>(2 * f) / 256.0f, 1e-5);
+    }
+}
+
 // While noteOff isn’t implemented, rendering past the end should finish the voice.
 TEST(SamplerTest, FinishesAfterEndOfSample) {
     auto sample = makeBuffer(1, 64);
@@ -119,3 +201,143 @@ TEST(SamplerTest, FinishesAfterEndOfSample) {
 
     EXPECT_TRUE(sampler.isFinished());
 }
+
+// Time-stretch mode lengthens playback without changing the read step (pitch).
+TEST(SamplerTest, TimeStretchDoublesDuration) {
+    constexpr unsigned frames = 4800;
+    auto sample = makeBuffer(1, frames);
+    sample->fill(0.5);
+
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+    sampler.setPlaybackMode(pipsqueak::dsp::PlaybackMode::TimeStretch, 2.0);
+    sampler.noteOn(48, 1.0f);
+
+    // At 2x stretch the sample must still be sounding well past its native length...
+    pipsqueak::core::AudioBuffer out(1, frames + frames / 2);
+    out.fill(0.0);
+    sampler.process(out);
+    EXPECT_FALSE(sampler.isFinished());
+
+    // ...and the overlap-added grains reconstruct the constant level.
+    for (unsigned f = 0; f < out.numFrames(); ++f) {
+        ASSERT_NEAR(out.at(0, f), 0.5, 1e-4) << "frame " << f;
+    }
+
+    // It finishes shortly after twice the native length.
+    pipsqueak::core::AudioBuffer tail(1, frames);
+    tail.fill(0.0);
+    sampler.process(tail);
+    EXPECT_TRUE(sampler.isFinished());
+}
+
+// Time-stretch keeps the pitch of a tone: zero-crossing rate is unchanged.
+TEST(SamplerTest, TimeStretchPreservesPitch) {
+    constexpr unsigned frames = 48000;
+    auto sample = makeBuffer(1, frames);
+    for (unsigned f = 0; f < frames; ++f) {
+        sample->at(0, f) = 0.5f * static_cast<float>(std::sin(2.0 * 3.14159265358979 * 440.0 * f / 48000.0));
+    }
+
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+    sampler.setPlaybackMode(pipsqueak::dsp::PlaybackMode::TimeStretch, 1.5);
+    sampler.noteOn(48, 1.0f);
+
+    pipsqueak::core::AudioBuffer out(1, 24000);
+    out.fill(0.0);
+    sampler.process(out);
+
+    // Count sign changes over the steady part (skip the first grain)
+    unsigned crossings = 0;
+    for (unsigned f = 4001; f < 24000; ++f) {
+        if ((out.at(0, f - 1) < 0.0f) != (out.at(0, f) < 0.0f)) ++crossings;
+    }
+
+    // 440 Hz -> 880 crossings per second -> ~366 over 20000 frames
+    EXPECT_NEAR(static_cast<double>(crossings), 880.0 * 19999.0 / 48000.0, 10.0);
+}
+
+// Sampler commands take effect when the bus is drained, between blocks.
+TEST(SamplerTest, CommandsApplyWhenDrained) {
+    auto sample = makeBuffer(1, 256);
+    sample->fill(0.5);
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+
+    pipsqueak::core::CommandBus bus(8);
+    pipsqueak::core::Transaction tx(bus);
+    tx.add(pipsqueak::engine::commands::setNativeRate(sampler, 48000.0))
+      .add(pipsqueak::engine::commands::noteOn(sampler, 48, 1.0f));
+    ASSERT_NE(tx.commit(), 0u);
+    EXPECT_TRUE(sampler.isFinished());
+
+    bus.drain(8);
+    EXPECT_FALSE(sampler.isFinished());
+
+    pipsqueak::core::AudioBuffer out(1, 16);
+    out.fill(0.0);
+    sampler.process(out);
+    EXPECT_NEAR(out.at(0, 0), 0.5, 1e-6);
+}
+
+// A sampler with an event sink reports the exact frame its note ran out, and voice steals.
+TEST(SamplerTest, PostsFinishAndStealEvents) {
+    auto sample = makeBuffer(1, 40);
+    sample->fill(0.5);
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+
+    pipsqueak::core::EventRing events(8);
+    sampler.setEventSink(&events);
+
+    events.beginBlock(0);
+    sampler.noteOn(48, 1.0f);
+    sampler.noteOn(50, 1.0f); // Single voice: the first note is stolen
+    events.endBlock();
+
+    pipsqueak::core::Event event;
+    ASSERT_TRUE(events.poll(event));
+    EXPECT_EQ(event.type, pipsqueak::core::EventType::VoiceStolen);
+    EXPECT_EQ(event.source, &sampler);
+
+    sampler.noteOn(48, 1.0f); // Steals again, back to the root note (40 frames at step 1)
+    events.poll(event);
+
+    pipsqueak::core::AudioBuffer out(1, 32);
+    events.beginBlock(0);
+    sampler.process(out);
+    events.endBlock();
+    EXPECT_FALSE(events.poll(event)); // Still playing
+
+    events.beginBlock(32);
+    sampler.process(out);
+    events.endBlock();
+    ASSERT_TRUE(events.poll(event));
+    EXPECT_EQ(event.type, pipsqueak::core::EventType::SourceFinished);
+    EXPECT_EQ(event.frame, 40u);
+}
+
+// With metadata attached, notes start at the first audible frame.
+TEST(SamplerTest, SkipsLeadingSilenceFromMetadata) {
+    auto sample = makeBuffer(1, 1000);
+    for (unsigned f = 600; f < 1000; ++f) sample->at(0, f) = 0.5f;
+    pipsqueak::dsp::Sampler sampler(sample);
+    setRates(sampler, 48000.0);
+
+    auto meta = std::make_shared<const pipsqueak::core::SampleMetadata>(pipsqueak::core::analyzeSample(*sample));
+    sampler.setMetadata(meta);
+    ASSERT_EQ(sampler.metadata(), meta.get());
+
+    sampler.noteOn(48, 1.0f);
+    pipsqueak::core::AudioBuffer out(1, 16);
+    sampler.process(out);
+    EXPECT_NEAR(out.at(0, 0), 0.5, 1e-6);
+
+    // Opting out plays from frame 0 again
+    sampler.setMetadata(meta, false);
+    sampler.noteOn(48, 1.0f);
+    out.fill(0.0);
+    sampler.process(out);
+    EXPECT_EQ(out.at(0, 0), 0.0f);
+}
@@ -0,0 +1,169 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/engine/fd_output.hpp>
+#include <pipsqueak/core/wav_loader.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace pipsqueak;
+
+namespace {
+    std::vector<core::Sample> ramp(const size_t count) {
+        std::vector<core::Sample> samples(count);
+        for (size_t i = 0; i < count; ++i)
+            samples[i] = static_cast<core::Sample>(i % 2000) / 2000.0f - 0.5f;
+        return samples;
+    }
+}
+
+// Raw float32 reaches the reader byte for byte, in fewer writev() calls than segments.
+TEST(FdOutputTest, StreamsRawFloatThroughPipe) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    std::vector<std::uint8_t> received;
+    std::thread reader([&] {
+        std::uint8_t chunk[4096];
+        ssize_t n;
+        while ((n = read(fds[0], chunk, sizeof(chunk))) > 0)
+            received.insert(received.end(), chunk, chunk + n);
+        close(fds[0]);
+    });
+
+    engine::FdOutputOptions options;
+    options.channels = 2;
+    options.segmentFrames = 64;
+    options.segments = 8;
+    options.closeFd = true;
+
+    const auto samples = ramp(2 * 5000);
+    {
+        engine::FdOutput output(fds[1], options);
+        // Odd block sizes, so blocks straddle segment boundaries
+        for (size_t frame = 0; frame < 5000; frame += 333)
+            EXPECT_TRUE(output.write(samples.data() + frame * 2, std::min<size_t>(333, 5000 - frame)));
+        output.close();
+
+        const auto stats = output.stats();
+        EXPECT_EQ(stats.framesQueued, 5000u);
+        EXPECT_EQ(stats.framesDropped, 0u);
+        EXPECT_EQ(stats.bytesWritten, samples.size() * sizeof(core::Sample));
+        EXPECT_LE(stats.writeCalls, (5000u + 63) / 64);
+        EXPECT_FALSE(output.failed());
+    }
+    reader.join();
+
+    ASSERT_EQ(received.size(), samples.size() * sizeof(core::Sample));
+    EXPECT_EQ(std::memcmp(received.data(), samples.data(), received.size()), 0);
+}
+
+// A 16-bit WAV file gets its header sizes patched on close.
+TEST(FdOutputTest, WritesWavFileWithPatchedHeader) {
+    const std::string path = testing::TempDir() + "pipsqueak_fd_output.wav";
+
+    engine::FdOutputOptions options;
+    options.channels = 1;
+    options.sampleRate = 44100;
+    options.format = engine::PcmFormat::Int16;
+    options.container = engine::StreamContainer::Wav;
+    options.segmentFrames = 256;
+
+    const auto samples = ramp(1000);
+    {
+        auto output = engine::FdOutput::open(path, options);
+        ASSERT_NE(output, nullptr);
+        output->write(samples.data(), samples.size());
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const auto info = core::parseWavHeader(bytes.data(), bytes.size());
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->channels, 1u);
+    EXPECT_EQ(info->sampleRate, 44100u);
+    EXPECT_EQ(info->bitsPerSample, 16u);
+    EXPECT_EQ(info->dataBytes, 2000u);
+    ASSERT_EQ(bytes.size(), info->dataOffset + 2000);
+
+    std::int16_t first;
+    std::memcpy(&first, bytes.data() + info->dataOffset, 2);
+    EXPECT_NEAR(first, -0.5 * 32767, 2);
+    std::remove(path.c_str());
+}
+
+// A reader that goes away fails the output instead of killing the process, and nothing blocks.
+TEST(FdOutputTest, ClosedReaderFailsWithoutBlocking) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    close(fds[0]);
+
+    engine::FdOutputOptions options;
+    options.segmentFrames = 32;
+    options.segments = 4;
+    options.blockWhenFull = false;
+    options.closeFd = true;
+    engine::FdOutput output(fds[1], options);
+
+    const auto samples = ramp(2 * 256);
+    for (int i = 0; i < 50; ++i)
+        output.write(samples.data(), 256);
+    output.flush();
+
+    EXPECT_TRUE(output.failed());
+    EXPECT_GT(output.stats().framesDropped, 0u);
+    EXPECT_FALSE(output.write(samples.data(), 256));
+}
+
+// A block with the wrong channel count is dropped, not reinterpreted as interleaved frames.
+TEST(FdOutputTest, DropsBlocksWithMismatchedChannels) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    engine::FdOutputOptions options;
+    options.channels = 2;
+    options.segmentFrames = 64;
+    options.closeFd = true;
+    engine::FdOutput output(fds[1], options);
+
+    core::AudioBuffer mono(1, 128);
+    output.write(mono, 0);
+    core::AudioBuffer stereo(2, 128);
+    output.write(stereo, 128);
+    output.close();
+
+    EXPECT_EQ(output.stats().framesDropped, 128u);
+    EXPECT_EQ(output.stats().framesQueued, 128u);
+    close(fds[0]);
+}
+
+// Used as a realtime tap, a stalled reader makes the output drop blocks instead of blocking.
+TEST(FdOutputTest, RealtimeTapDropsWhenReaderStalls) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    engine::FdOutputOptions options;
+    options.channels = 2;
+    options.segmentFrames = 256;
+    options.segments = 4;
+    options.closeFd = true;
+    engine::FdOutput output(fds[1], options);
+    output.setRealtime();
+    EXPECT_FALSE(output.options().blockWhenFull);
+
+    // Far more than the ring and the pipe buffer hold; nobody reads
+    core::AudioBuffer block(2, 256);
+    for (int i = 0; i < 1000; ++i)
+        output.write(block, static_cast<std::uint64_t>(i) * 256);
+    EXPECT_GT(output.stats().framesDropped, 0u);
+
+    close(fds[0]);
+    output.close();
+}
@@ -0,0 +1,180 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/engine/render_host.hpp>
+#include <pipsqueak/dsp/sampler.hpp>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pipsqueak;
+
+namespace {
+    // Records which tenant rendered, in order, across all tenants of a host.
+    struct OrderLog {
+        std::mutex mutex;
+        std::vector<std::string> order;
+    };
+
+    class RecordingSink final : public engine::OutputSink {
+    public:
+        RecordingSink(std::string name, OrderLog& log) : name_(std::move(name)), log_(log) {}
+        void write(const core::AudioBuffer&, std::uint64_t) override {
+            std::lock_guard lock(log_.mutex);
+            log_.order.push_back(name_);
+        }
+
+    private:
+        std::string name_;
+        OrderLog& log_;
+    };
+
+    // A source that burns a fixed amount of CPU per block.
+    class BusySource final : public dsp::AudioSource {
+    public:
+        explicit BusySource(const std::chrono::microseconds cost) : cost_(cost) {}
+        void process(core::AudioBuffer&) override {
+            const auto until = std::chrono::steady_clock::now() + cost_;
+            while (std::chrono::steady_clock::now() < until) {}
+        }
+        bool isFinished() const override { return false; }
+
+    private:
+        std::chrono::microseconds cost_;
+    };
+}
+
+// Every tenant renders its own mixer into its own sink.
+TEST(RenderHostTest, RendersEachTenantToItsSink) {
+    engine::RenderHost host(2, engine::Pacing::FreeRunning);
+
+    auto sinkA = std::make_shared<engine::NullSink>();
+    auto sinkB = std::make_shared<engine::NullSink>();
+    host.addTenant({"a", 2, 256, 48000.0, 1.0, 10, 16, sinkA});
+    host.addTenant({"b", 1, 128, 48000.0, 1.0, 20, 16, sinkB});
+
+    host.start();
+    host.waitIdle();
+    host.stop();
+
+    EXPECT_EQ(sinkA->framesWritten(), 10u * 256u);
+    EXPECT_EQ(sinkB->framesWritten(), 20u * 128u);
+}
+
+// With one worker, blocks are picked earliest-deadline-first: a tenant with half the block
+// period is rendered twice as often.
+TEST(RenderHostTest, SchedulesEarliestDeadlineFirst) {
+    OrderLog log;
+    engine::RenderHost host(1, engine::Pacing::FreeRunning);
+    host.addTenant({"short", 1, 64, 48000.0, 1.0, 8, 16, std::make_shared<RecordingSink>("short", log)});
+    host.addTenant({"long", 1, 128, 48000.0, 1.0, 4, 16, std::make_shared<RecordingSink>("long", log)});
+
+    host.start();
+    host.waitIdle();
+    host.stop();
+
+    ASSERT_EQ(log.order.size(), 12u);
+    // Over every prefix, "short" has rendered about twice as many blocks as "long".
+    int shortCount = 0, longCount = 0;
+    for (const auto& name : log.order) {
+        (name == "short" ? shortCount : longCount)++;
+        EXPECT_LE(std::abs(shortCount - 2 * longCount), 2);
+    }
+}
+
+// A tenant over its CPU quota is throttled while a tenant within quota keeps running.
+TEST(RenderHostTest, EnforcesCpuQuota) {
+    engine::RenderHost host(1, engine::Pacing::FreeRunning);
+    auto& greedy = host.addTenant({"greedy", 1, 64, 48000.0, 0.05, 0, 16, nullptr});
+    auto& fair = host.addTenant({"fair", 1, 64, 48000.0, 1.0, 0, 16, nullptr});
+
+    // Blocks cost more than the 1.3 ms period, so neither tenant can keep real time.
+    greedy.masterMixer().addSource(std::make_shared<BusySource>(std::chrono::microseconds(500)));
+    fair.masterMixer().addSource(std::make_shared<BusySource>(std::chrono::microseconds(500)));
+
+    host.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    host.stop();
+
+    const auto g = greedy.stats();
+    const auto f = fair.stats();
+    EXPECT_GT(g.throttled, 0u);
+    EXPECT_LT(g.blocksRendered * 4, f.blocksRendered);
+}
+
+// Each tenant has its own buffer store namespace.
+// A removed tenant is never rendered again, even while a worker was busy with it.
+TEST(RenderHostTest, RemovesTenantWhileRunning) {
+    engine::RenderHost host(2, engine::Pacing::FreeRunning);
+    auto sink = std::make_shared<engine::NullSink>();
+    auto& tenant = host.addTenant({"gone", 1, 64, 48000.0, 1.0, 0, 16, sink});
+    host.addTenant({"kept", 1, 64, 48000.0, 1.0, 0, 16, nullptr});
+    tenant.masterMixer().addSource(std::make_shared<BusySource>(std::chrono::microseconds(200)));
+
+    host.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(host.removeTenant(tenant));
+    const auto frames = sink->framesWritten();
+    EXPECT_GT(frames, 0u);
+    EXPECT_EQ(host.tenantCount(), 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    host.stop();
+    EXPECT_EQ(sink->framesWritten(), frames);
+
+    engine::RenderHost other(1, engine::Pacing::FreeRunning);
+    auto& foreign = other.addTenant({"foreign", 1, 64, 48000.0, 1.0, 1, 16, nullptr});
+    EXPECT_FALSE(host.removeTenant(foreign));
+}
+
+TEST(RenderHostTest, TenantsHaveSeparateStores) {
+    engine::RenderHost host(1, engine::Pacing::FreeRunning);
+    engine::TenantConfig config;
+    config.name = "a";
+    auto& a = host.addTenant(config);
+    config.name = "b";
+    auto& b = host.addTenant(config);
+
+    const auto key = a.store().insert(std::make_shared<core::AudioBuffer>(1, 8));
+    EXPECT_NE(a.store().get(key), nullptr);
+    EXPECT_EQ(b.store().get(key), nullptr);
+}
+
+// A file sink receives the raw interleaved float32 stream.
+TEST(RenderHostTest, FileSinkWritesRawPcm) {
+    const std::string path = ::testing::TempDir() + "render_host_file_sink.raw";
+    {
+        engine::RenderHost host(1, engine::Pacing::FreeRunning);
+        auto sink = std::make_shared<engine::FileSink>(path);
+        ASSERT_TRUE(sink->isOpen());
+        auto& tenant = host.addTenant({"file", 2, 32, 48000.0, 1.0, 3, 16, sink});
+
+        auto sample = std::make_shared<core::AudioBuffer>(2, 512);
+        sample->fill(0.25);
+        auto sampler = std::make_shared<dsp::Sampler>(sample);
+        sampler->setNativeRate(48000.0);
+        sampler->setEngineRate(48000.0);
+        sampler->noteOn(48, 1.0f);
+        tenant.masterMixer().addSource(sampler);
+
+        host.start();
+        host.waitIdle();
+        host.stop();
+    }
+
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    ASSERT_NE(f, nullptr);
+    std::vector<float> samples(3 * 32 * 2 + 1);
+    const size_t read = std::fread(samples.data(), sizeof(float), samples.size(), f);
+    std::fclose(f);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(read, 3u * 32u * 2u);
+    EXPECT_FLOAT_EQ(samples[0], 0.25f);
+    EXPECT_FLOAT_EQ(samples[read - 1], 0.25f);
+}
@@ -0,0 +1,113 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/engine/shm_output.hpp>
+#include <pipsqueak/engine/shm_ring.hpp>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace pipsqueak;
+
+namespace {
+    std::string uniqueName(const char* what) {
+        return "/pipsqueak-test-" + std::to_string(getpid()) + "-" + what;
+    }
+
+    core::AudioBuffer blockOf(const unsigned channels, const unsigned frames, const float base) {
+        core::AudioBuffer block(channels, frames);
+        for (unsigned f = 0; f < frames; ++f)
+            for (unsigned c = 0; c < channels; ++c)
+                block.at(c, f) = base + static_cast<float>(f * channels + c);
+        return block;
+    }
+}
+
+// Readers see every block in order, in place, with its stream position.
+TEST(ShmOutputTest, ReaderSeesBlocksInPlace) {
+    const std::string name = uniqueName("order");
+    engine::ShmOutputOptions options;
+    options.slotFrames = 128;
+    options.slots = 8;
+    auto output = engine::ShmOutput::create(name, options);
+    ASSERT_NE(output, nullptr);
+
+    engine::ShmRingReader reader;
+    engine::ShmRingReader other;
+    std::string error;
+    ASSERT_TRUE(reader.open(name, &error)) << error;
+    ASSERT_TRUE(other.open(name));
+    EXPECT_EQ(reader.channels(), 2u);
+    EXPECT_EQ(reader.sampleRate(), 48000u);
+    EXPECT_TRUE(reader.producerAlive());
+
+    engine::ShmRingReader::Block block;
+    EXPECT_EQ(reader.next(block), engine::ShmRingReader::Status::Empty);
+
+    for (unsigned i = 0; i < 3; ++i)
+        output->write(blockOf(2, 128, 1000.0f * i), 128u * i);
+
+    for (unsigned i = 0; i < 3; ++i) {
+        ASSERT_EQ(reader.next(block), engine::ShmRingReader::Status::Ok);
+        EXPECT_EQ(block.sequence, i + 1);
+        EXPECT_EQ(block.frame, 128u * i);
+        EXPECT_EQ(block.frames, 128u);
+        EXPECT_FLOAT_EQ(block.data[0], 1000.0f * i);
+        EXPECT_FLOAT_EQ(block.data[255], 1000.0f * i + 255);
+        EXPECT_TRUE(reader.valid(block));
+    }
+    EXPECT_EQ(reader.next(block), engine::ShmRingReader::Status::Empty);
+
+    // A second reader has its own cursor
+    std::vector<float> copy(2 * 128);
+    ASSERT_EQ(other.read(copy.data(), block), engine::ShmRingReader::Status::Ok);
+    EXPECT_EQ(block.sequence, 1u);
+    EXPECT_FLOAT_EQ(copy[17], 17.0f);
+
+    // Blocks longer than a slot are split
+    output->write(blockOf(2, 300, 0.0f), 384);
+    for (const unsigned expected : {128u, 128u, 44u}) {
+        ASSERT_EQ(reader.next(block), engine::ShmRingReader::Status::Ok);
+        EXPECT_EQ(block.frames, expected);
+    }
+    EXPECT_EQ(block.frame, 384u + 256u);
+
+    output.reset();
+    EXPECT_FALSE(reader.producerAlive());
+}
+
+// A reader that falls a ring behind is told so, counts the loss and resumes at the newest block.
+TEST(ShmOutputTest, DetectsOverrunBySequence) {
+    const std::string name = uniqueName("overrun");
+    engine::ShmOutputOptions options;
+    options.channels = 1;
+    options.slotFrames = 64;
+    options.slots = 4;
+    auto output = engine::ShmOutput::create(name, options);
+    ASSERT_NE(output, nullptr);
+
+    engine::ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+
+    engine::ShmRingReader::Block held;
+    output->write(blockOf(1, 64, 0.0f), 0);
+    ASSERT_EQ(reader.next(held), engine::ShmRingReader::Status::Ok);
+
+    for (unsigned i = 1; i <= 10; ++i)
+        output->write(blockOf(1, 64, 0.0f), 64u * i);
+
+    // The held view was overwritten, and the cursor is ten blocks behind a four-slot ring
+    EXPECT_FALSE(reader.valid(held));
+    engine::ShmRingReader::Block block;
+    EXPECT_EQ(reader.next(block), engine::ShmRingReader::Status::Overrun);
+    EXPECT_EQ(reader.lost(), 9u);
+    ASSERT_EQ(reader.next(block), engine::ShmRingReader::Status::Ok);
+    EXPECT_EQ(block.sequence, 11u);
+    EXPECT_EQ(block.frame, 640u);
+
+    // Blocks of the wrong width are dropped, not published
+    output->write(blockOf(2, 64, 0.0f), 0);
+    EXPECT_EQ(output->framesDropped(), 64u);
+    EXPECT_EQ(output->published(), 11u);
+}
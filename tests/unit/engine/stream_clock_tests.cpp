@@ -0,0 +1,92 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+#include <gtest/gtest.h>
+#include <pipsqueak/engine/stream_clock.hpp>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using namespace pipsqueak;
+
+namespace {
+    // Drives a clock with callbacks from a device running at trueRate, each late by up to jitterNs.
+    struct Device {
+        double trueRate;
+        unsigned block;
+        std::int64_t jitterNs;
+        std::int64_t startNs{1'000'000'000'000};
+        std::mt19937 rng{7};
+        std::uint64_t frame{0};
+
+        std::int64_t idealTime(const std::uint64_t position) const {
+            return startNs + static_cast<std::int64_t>(std::llround(position * 1e9 / trueRate));
+        }
+
+        void run(engine::StreamClock& clock, const unsigned blocks) {
+            std::uniform_int_distribution<std::int64_t> late(0, jitterNs);
+            for (unsigned i = 0; i < blocks; ++i) {
+                clock.update(frame, block, idealTime(frame) + late(rng));
+                frame += block;
+            }
+        }
+    };
+}
+
+// No snapshot exists before the first block.
+TEST(StreamClockTest, InvalidUntilFirstUpdate) {
+    engine::StreamClock clock;
+    clock.reset(48000.0, 256, 512);
+
+    engine::ClockSnapshot snapshot;
+    EXPECT_FALSE(clock.snapshot(snapshot));
+
+    clock.update(0, 256, engine::StreamClock::now());
+    ASSERT_TRUE(clock.snapshot(snapshot));
+    EXPECT_EQ(snapshot.updates, 1u);
+    EXPECT_NEAR(snapshot.sampleRate(), 48000.0, 1e-6);
+    EXPECT_EQ(snapshot.latencyNs, static_cast<std::int64_t>(512 * 1e9 / 48000));
+}
+
+// The loop locks onto the device's real rate and filters callback jitter out of the timeline.
+TEST(StreamClockTest, TracksDriftingDeviceThroughJitter) {
+    engine::StreamClock clock;
+    clock.reset(48000.0, 256, 0);
+
+    // A device 200 ppm fast, with callbacks up to 1 ms late (a fifth of a block)
+    Device device{48009.6, 256, 1'000'000};
+    device.run(clock, 6000);
+
+    engine::ClockSnapshot snapshot;
+    ASSERT_TRUE(clock.snapshot(snapshot));
+    EXPECT_NEAR(snapshot.sampleRate(), 48009.6, 5.0);
+
+    // Mean lateness is 0.5 ms; the filtered line sits on it, far tighter than the raw jitter
+    const std::int64_t error = snapshot.timeOf(snapshot.frame) - device.idealTime(snapshot.frame) - 500'000;
+    EXPECT_LT(std::llabs(error), 150'000);
+
+    // Extrapolation one second ahead and the inverse mapping agree with the device
+    const std::uint64_t ahead = snapshot.frame + 48000;
+    EXPECT_LT(std::llabs(snapshot.timeOf(ahead) - device.idealTime(ahead) - 500'000), 200'000);
+    EXPECT_NEAR(snapshot.frameAt(snapshot.timeOf(ahead)), static_cast<double>(ahead), 0.01);
+}
+
+// A gap in the stream (an xrun or a restart) restarts the loop at the new position.
+TEST(StreamClockTest, RestartsOnDiscontinuity) {
+    engine::StreamClock clock;
+    clock.reset(44100.0, 128, 0);
+
+    Device device{44100.0, 128, 0};
+    device.run(clock, 100);
+
+    // Skip 10 blocks of frames and half a second of time
+    device.frame += 1280;
+    device.startNs += 500'000'000;
+    device.run(clock, 1);
+
+    engine::ClockSnapshot snapshot;
+    ASSERT_TRUE(clock.snapshot(snapshot));
+    EXPECT_EQ(snapshot.frame, 128u * 110);
+    EXPECT_EQ(snapshot.timeNs, device.idealTime(snapshot.frame));
+    EXPECT_NEAR(snapshot.sampleRate(), 44100.0, 1e-6);
+}
@@ -0,0 +1,118 @@
+//
+// Created by Daftpy on 10/18/2026.
+//
+// pipsqueak_bundle: packs a folder of WAVE files into a single instrument bundle.
+//
+//   pipsqueak_bundle [--int16] [--root NOTE] <sample folder> <output bundle>
+//
+// A sample's root note is the MIDI unity note of its 'smpl' chunk; failing that, a trailing
+// number in its file name ("piano_60.wav"); otherwise --root (default 60). The chunk's first
+// loop becomes the sample's loop.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pipsqueak/core/batch_reader.hpp>
+#include <pipsqueak/core/bundle.hpp>
+#include <pipsqueak/core/wav_loader.hpp>
+
+namespace fs = std::filesystem;
+using namespace pipsqueak::core;
+
+namespace {
+    int usage() {
+        std::cerr << "usage: pipsqueak_bundle [--int16] [--root NOTE] <sample folder> <output bundle>\n";
+        return 2;
+    }
+
+    // The trailing MIDI note number in a file stem, or the fallback.
+    int rootNoteFromName(const std::string& stem, const int fallback) {
+        size_t digits = stem.size();
+        while (digits > 0 && std::isdigit(static_cast<unsigned char>(stem[digits - 1]))) --digits;
+        if (digits == stem.size() || stem.size() - digits > 3)
+            return fallback;
+        const int note = std::stoi(stem.substr(digits));
+        return note <= 127 ? note : fallback;
+    }
+
+    // Parses a MIDI note argument; false if it is not a whole number in 0..127.
+    bool parseNote(const std::string& text, int& note) {
+        try {
+            size_t used = 0;
+            note = std::stoi(text, &used);
+            return used == text.size() && note >= 0 && note <= 127;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    SampleEncoding encoding = SampleEncoding::Float32;
+    int defaultRoot = 60;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--int16") {
+            encoding = SampleEncoding::Int16;
+        } else if (arg == "--root" && i + 1 < argc) {
+            if (!parseNote(argv[++i], defaultRoot))
+                return usage();
+        } else if (!arg.empty() && arg[0] == '-') {
+            return usage();
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2)
+        return usage();
+
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(positional[0], ec)) {
+        std::string extension = item.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (item.is_regular_file() && extension == ".wav")
+            paths.push_back(item.path().string());
+    }
+    if (ec) {
+        std::cerr << "cannot read " << positional[0] << ": " << ec.message() << "\n";
+        return 1;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    BatchReader reader;
+    const auto loaded = loadWavFiles(reader, paths);
+
+    BundleWriter writer(encoding);
+    for (const auto& sample : loaded) {
+        if (!sample.error.empty()) {
+            std::cerr << "skipping " << sample.path << ": " << sample.error << "\n";
+            continue;
+        }
+        const std::string stem = fs::path(sample.path).stem().string();
+        BundleSample entry;
+        entry.name = stem;
+        entry.buffer = sample.buffer;
+        entry.sampleRate = sample.sampleRate;
+        entry.rootNote = sample.unityNote >= 0 ? sample.unityNote : rootNoteFromName(stem, defaultRoot);
+        entry.loopStart = sample.loopStart;
+        entry.loopEnd = sample.loopEnd;
+        writer.add(std::move(entry));
+    }
+
+    std::string error;
+    if (!writer.write(positional[1], &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cout << "wrote " << writer.count() << " samples to " << positional[1] << "\n";
+    return 0;
+}